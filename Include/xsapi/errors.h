@@ -652,6 +652,14 @@ namespace xbox {
                 /// </summary>
                 unsupported = 3001,
 
+                /// <summary>
+                /// <b>0x80004005</b>
+                /// xbox_live_error_code 3002
+                /// The call failed fast without being sent because recent calls to the same endpoint keep failing.
+                /// Calls are let through again once the endpoint has had time to recover.
+                /// </summary>
+                http_endpoint_circuit_open = 3002,
+
                 //////////////////////////////////////////////////////////////////////////
                 // xbox live auth errors
                 //////////////////////////////////////////////////////////////////////////
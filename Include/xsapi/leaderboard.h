@@ -161,6 +161,119 @@ private:
     friend leaderboard_result;
 };
 
+/// <summary>
+/// How a column's values are stored in a leaderboard_table.
+/// </summary>
+enum class leaderboard_column_storage
+{
+    /// <summary>Integer and boolean statistics, stored as unsigned 64 bit integers.</summary>
+    uint64,
+
+    /// <summary>Double statistics.</summary>
+    floating_point,
+
+    /// <summary>String, DateTime and unknown statistics, stored as interned strings.</summary>
+    string
+};
+
+/// <summary>
+/// A page of leaderboard results stored column by column, with each statistic parsed to its type once.
+/// Rows keep the order the service returned them in, and a row index stays valid for the life of the table.
+/// Useful for titles that sort or render large pages every frame, where leaderboard_row::column_values()
+/// would have to be parsed again each time.
+/// </summary>
+class leaderboard_table
+{
+public:
+    _XSAPIIMP leaderboard_table();
+
+    /// <summary>
+    /// The number of rows in the table.
+    /// </summary>
+    _XSAPIIMP size_t row_count() const;
+
+    /// <summary>
+    /// The columns of the table, in the same order as leaderboard_result::columns().
+    /// </summary>
+    _XSAPIIMP const std::vector<leaderboard_column>& columns() const;
+
+    /// <summary>
+    /// How the values of the column at columnIndex are stored.
+    /// </summary>
+    _XSAPIIMP leaderboard_column_storage column_storage(_In_ size_t columnIndex) const;
+
+    /// <summary>
+    /// The Gamertag of the player in the row. Rows for the same player share one copy.
+    /// </summary>
+    _XSAPIIMP const string_t& gamertag(_In_ size_t rowIndex) const;
+
+    /// <summary>
+    /// The Xbox user ID of the player in the row, as a number.
+    /// </summary>
+    _XSAPIIMP uint64_t xbox_user_id(_In_ size_t rowIndex) const;
+
+    /// <summary>
+    /// The rank of the player in the row.
+    /// </summary>
+    _XSAPIIMP uint32_t rank(_In_ size_t rowIndex) const;
+
+    /// <summary>
+    /// The percentile rank of the player in the row.
+    /// </summary>
+    _XSAPIIMP double percentile(_In_ size_t rowIndex) const;
+
+    /// <summary>
+    /// The value of a uint64 column. Floating point values are truncated, negative ones to 0, and string columns return 0.
+    /// </summary>
+    _XSAPIIMP uint64_t uint64_value(_In_ size_t rowIndex, _In_ size_t columnIndex) const;
+
+    /// <summary>
+    /// The value of a uint64 column reinterpreted as signed, for statistics that hold negative values.
+    /// Floating point values are truncated, and string columns return 0.
+    /// </summary>
+    _XSAPIIMP int64_t int64_value(_In_ size_t rowIndex, _In_ size_t columnIndex) const;
+
+    /// <summary>
+    /// The value of a floating_point column. Integer values are converted, and string columns return 0.
+    /// </summary>
+    _XSAPIIMP double double_value(_In_ size_t rowIndex, _In_ size_t columnIndex) const;
+
+    /// <summary>
+    /// The value of a string column. Numeric columns return an empty string.
+    /// </summary>
+    _XSAPIIMP const string_t& string_value(_In_ size_t rowIndex, _In_ size_t columnIndex) const;
+
+    /// <summary>
+    /// Approximate number of bytes held by the table's values.
+    /// </summary>
+    _XSAPIIMP size_t memory_footprint() const;
+
+    /// <summary>
+    /// Internal function
+    /// </summary>
+    _XSAPIIMP static leaderboard_table _Create(
+        _In_ const std::vector<leaderboard_column>& columns,
+        _In_ const std::vector<leaderboard_row>& rows
+        );
+
+private:
+    struct column_values
+    {
+        leaderboard_column_storage storage;
+        std::vector<uint64_t> uint64Values;
+        std::vector<double> doubleValues;
+        std::vector<uint32_t> stringIndices;
+    };
+
+    std::vector<leaderboard_column> m_columns;
+    std::vector<column_values> m_columnValues;
+    std::vector<uint32_t> m_gamertagIndices;
+    std::vector<uint64_t> m_xboxUserIds;
+    std::vector<uint32_t> m_ranks;
+    std::vector<double> m_percentiles;
+    std::vector<string_t> m_strings;
+};
+
 class leaderboard_query
 {
 public:
@@ -316,6 +429,12 @@ public:
     /// </summary>
     _XSAPIIMP const std::vector<leaderboard_row>& rows() const;
 
+    /// <summary>
+    /// Parses rows() into a columnar table with typed values. Build it once per page and keep it,
+    /// rather than reading column_values() strings every frame.
+    /// </summary>
+    _XSAPIIMP leaderboard_table to_table() const;
+
     /// <summary>
     /// Indicates whether there is a next page of results.
     /// </summary>
@@ -1421,6 +1421,39 @@ public:
         _In_ uint32_t quantityToConsume,
         _In_ const string_t& transactionId
         );
+
+    /// <summary>
+    /// Consumes the specified quantity of a consumable inventory item. Consumptions of the same item made
+    /// within a short window are sent together as a single request.
+    /// </summary>
+    /// <param name="inventoryItem">The InventoryItem to consume quantity from.</param>
+    /// <param name="quantityToConsume">The quantity to consume of the specified InventoryItem.</param>
+    /// <returns>A ConsumeInventoryItemResult object for the request that carried this consumption.</returns>
+    /// <remarks>
+    /// Each request gets its own transaction Id, so it is safely retried. If the service rejects a combined
+    /// request, it is replayed in smaller chunks so that only the consumptions it won't accept fail.
+    ///
+    /// Calls V4 POST /users/me/consumables/{consumableId}
+    /// </remarks>
+    _XSAPIIMP pplx::task<xbox_live_result<consume_inventory_item_result>> consume_inventory_item_batched(
+        _In_ const inventory_item& inventoryItem,
+        _In_ uint32_t quantityToConsume
+        );
+
+    /// <summary>
+    /// The remaining balance of a consumable inventory item, with consumptions that haven't been
+    /// confirmed by the service already taken off.
+    /// </summary>
+    /// <param name="inventoryItem">The consumable InventoryItem.</param>
+    _XSAPIIMP uint32_t local_consumable_balance(
+        _In_ const inventory_item& inventoryItem
+        );
+
+    /// <summary>
+    /// Internal function
+    /// </summary>
+    uint32_t _Consumption_service_call_count() const;
+
 private:
     inventory_service();
 
@@ -214,6 +214,70 @@ private:
     uint32_t m_playersWaitingToMatch;
 };
 
+/// <summary>
+/// Controls how multiplayer_manager::find_match() looks after its match ticket. By default an expired
+/// ticket ends the search. With a policy, the manager resubmits the expired ticket, optionally relaxing its
+/// attributes first, and stretches each ticket's timeout to cover the hopper's estimated wait.
+/// </summary>
+class match_ticket_retry_policy
+{
+public:
+    /// <summary>
+    /// Called before each resubmission with the attributes of the ticket that expired and the number of
+    /// resubmissions so far, starting at 1. Returns the attributes for the next ticket.
+    /// </summary>
+    typedef std::function<web::json::value(const web::json::value& attributes, uint32_t resubmitCount)> relax_attributes_handler;
+
+    _XSAPIIMP match_ticket_retry_policy();
+
+    /// <summary>
+    /// The most times an expired ticket is resubmitted before the search ends as expired. Defaults to 3.
+    /// </summary>
+    _XSAPIIMP uint32_t max_resubmits() const;
+
+    /// <summary>
+    /// Sets the most times an expired ticket is resubmitted.
+    /// </summary>
+    _XSAPIIMP void set_max_resubmits(_In_ uint32_t maxResubmits);
+
+    /// <summary>
+    /// Whether the hopper's statistics are read before each ticket to choose its timeout. Defaults to true.
+    /// </summary>
+    _XSAPIIMP bool use_hopper_statistics() const;
+
+    /// <summary>
+    /// Sets whether the hopper's statistics are read before each ticket to choose its timeout.
+    /// </summary>
+    _XSAPIIMP void set_use_hopper_statistics(_In_ bool useHopperStatistics);
+
+    /// <summary>
+    /// The longest timeout chosen from hopper statistics. A longer timeout passed to find_match() is kept as is.
+    /// Defaults to 300 seconds.
+    /// </summary>
+    _XSAPIIMP const std::chrono::seconds& max_ticket_timeout() const;
+
+    /// <summary>
+    /// Sets the longest timeout chosen from hopper statistics.
+    /// </summary>
+    _XSAPIIMP void set_max_ticket_timeout(_In_ const std::chrono::seconds& maxTicketTimeout);
+
+    /// <summary>
+    /// The handler that relaxes ticket attributes between resubmissions, or nullptr to resubmit them unchanged.
+    /// </summary>
+    _XSAPIIMP const relax_attributes_handler& relax_attributes() const;
+
+    /// <summary>
+    /// Sets the handler that relaxes ticket attributes between resubmissions.
+    /// </summary>
+    _XSAPIIMP void set_relax_attributes(_In_ relax_attributes_handler handler);
+
+private:
+    uint32_t m_maxResubmits;
+    bool m_useHopperStatistics;
+    std::chrono::seconds m_maxTicketTimeout;
+    relax_attributes_handler m_relaxAttributes;
+};
+
 /// <summary>
 /// Represents the Matchmaking Service.
 /// </summary>
@@ -1496,6 +1496,22 @@ public:
         _In_ const std::chrono::seconds& timeout = std::chrono::seconds(60)
         );
 
+    /// <summary>
+    /// Sends a matchmaking request to the server and keeps it alive according to retryPolicy. An expired
+    /// ticket is resubmitted, with relaxed attributes if the policy provides them, until the policy's
+    /// resubmissions run out. Only then does find_match_completed_event() report the search as expired.
+    /// </summary>
+    /// <param name="hopperName">The name of the hopper.</param>
+    /// <param name="attributes">The ticket attributes for the first ticket.</param>
+    /// <param name="timeout">The shortest time to wait for members to join each ticket.</param>
+    /// <param name="retryPolicy">How expired tickets are resubmitted and how their timeouts are chosen.</param>
+    _XSAPIIMP xbox_live_result<void> find_match(
+        _In_ const string_t& hopperName,
+        _In_ const web::json::value& attributes,
+        _In_ const std::chrono::seconds& timeout,
+        _In_ const xbox::services::matchmaking::match_ticket_retry_policy& retryPolicy
+        );
+
     /// <summary>
     /// Cancels the match request on the server, if one exists.
     /// </summary>
@@ -1512,6 +1528,12 @@ public:
     /// </summary>
     std::chrono::seconds estimated_match_wait_time() const;
 
+    /// <summary>
+    /// Time spent searching so far, added up across every ticket submitted for the last find_match() call.
+    /// Only grows past a single ticket's wait when find_match() was given a match_ticket_retry_policy.
+    /// </summary>
+    std::chrono::seconds cumulative_match_wait_time() const;
+
     /// <summary>
     /// Indicates whether the game should auto fill open slots during gameplay.
     /// </summary>
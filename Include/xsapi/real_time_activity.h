@@ -16,6 +16,7 @@ namespace xbox {
 namespace services {
 namespace real_time_activity {
     class real_time_activity_service_factory;
+    struct real_time_activity_service_state;
     class real_time_activity_subscription_error_event_args;
 }}}
 
@@ -259,6 +260,47 @@ public:
     /// <param name="remove">The function_context object that was returned when the event handler was registered. </param>
     _XSAPIIMP void remove_resync_handler(_In_ function_context remove);
 
+    /// <summary>
+    /// Conflates change events so that each subscription receives at most one event per minDeliveryInterval.
+    /// Events that arrive sooner are held back, and only the latest one per subscription is delivered once the
+    /// interval has passed; the ones it replaced are dropped. Useful for statistic and presence subscriptions
+    /// on users whose values change many times a second when only the latest value matters.
+    /// Conflation is off by default.
+    /// </summary>
+    /// <param name="minDeliveryInterval">The minimum time between two events delivered to the same subscription.</param>
+    _XSAPIIMP void enable_event_conflation(_In_ std::chrono::milliseconds minDeliveryInterval);
+
+    /// <summary>
+    /// Turns off event conflation. An event still held back for a subscription is delivered when its interval
+    /// passes, unless a newer event for that subscription arrives first.
+    /// </summary>
+    _XSAPIIMP void disable_event_conflation();
+
+    /// <summary>
+    /// The number of change events for a subscription that were dropped because a later event replaced them
+    /// before they were delivered. Each one is a gap in the sequence of events the subscription has seen.
+    /// </summary>
+    /// <param name="subscription">The subscription to count dropped events for.</param>
+    _XSAPIIMP uint64_t conflated_event_count(_In_ const std::shared_ptr<real_time_activity_subscription>& subscription);
+
+    /// <summary>
+    /// Spreads subscriptions over up to maxConnections websocket connections. Another connection is opened once every
+    /// open one holds maxSubscriptionsPerConnection subscriptions. Each subscription is placed by consistent hashing of
+    /// its resource URI, so adding a connection moves few subscriptions and a re-added subscription lands on the same one.
+    /// Each connection reconnects and resyncs on its own. When one reconnects, its subscriptions are placed again so that
+    /// they fill in connections that have room. Resync and subscription error handlers fire for events on any connection.
+    /// Connection state handlers are called with the combined state of all connections: connected once every connection
+    /// is connected, otherwise disconnected if any connection is, otherwise connecting.
+    /// Connections opened for sharding do not count towards MAXIMUM_WEBSOCKETS_ACTIVATIONS_ALLOWED_PER_USER.
+    /// Call before adding subscriptions. Sharding is off by default.
+    /// </summary>
+    /// <param name="maxSubscriptionsPerConnection">The most subscriptions placed on one connection. Zero turns sharding off.</param>
+    /// <param name="maxConnections">The most connections to open. Once all are full, subscriptions are placed on their hashed connection regardless.</param>
+    _XSAPIIMP void enable_connection_sharding(
+        _In_ uint32_t maxSubscriptionsPerConnection,
+        _In_ uint32_t maxConnections
+        );
+
     /// <summary>
     /// Internal function
     /// </summary>
@@ -307,6 +349,12 @@ public:
         return m_pendingSubmission.size() + m_pendingResponseSubscriptions.size() + m_subscriptions.size() + m_pendingUnsubscriptions.size();
     }
 
+    /// <summary>
+    /// Internal function
+    /// Number of websocket connections subscriptions are spread over
+    /// </summary>
+    size_t _Connection_count();
+
     /// <summary>
     /// Internal function
     /// </summary>
@@ -335,6 +383,10 @@ private:
     void handle_change_event(
         _In_ web::json::value& message
         );
+
+    void deliver_conflated_event(
+        _In_ uint32_t subscriptionId
+        );
     
     void trigger_resync_event();
     void trigger_connection_state_changed_event(_In_ real_time_activity_connection_state connectionState);
@@ -345,6 +397,27 @@ private:
 
     void clear_all_subscriptions();
 
+    std::shared_ptr<real_time_activity_service> get_or_create_shard(
+        _In_ real_time_activity_service_state& state,
+        _In_ size_t shardIndex
+        );
+
+    void add_shard_to_ring(
+        _In_ real_time_activity_service_state& state,
+        _In_ size_t shardIndex
+        );
+
+    std::vector<size_t> shard_subscription_counts(_In_ real_time_activity_service_state& state);
+
+    size_t place_subscription(
+        _In_ const real_time_activity_service_state& state,
+        _In_ const string_t& resourceUri,
+        _In_ const std::vector<size_t>& subscriptionCounts
+        ) const;
+
+    void rebalance_shards();
+    void report_combined_connection_state();
+
     std::shared_ptr<xbox::services::user_context> m_userContext;
     std::shared_ptr<xbox::services::xbox_live_context_settings> m_xboxLiveContextSettings;
     std::shared_ptr<xbox::services::xbox_live_app_config> m_appConfig;
@@ -362,6 +435,8 @@ private:
     std::map<uint32_t, std::shared_ptr<real_time_activity_subscription>> m_pendingUnsubscriptions;
     std::recursive_mutex m_lock;
 
+    static const uint32_t VIRTUAL_NODES_PER_SHARD;
+
     real_time_activity_connection_state m_connectionState;
     std::shared_ptr<xbox::services::web_socket_connection> m_webSocketConnection;
 
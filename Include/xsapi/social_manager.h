@@ -29,6 +29,7 @@ namespace xbox {
 class social_graph;
 struct xbox_social_user_context;
 struct user_group_status_change;
+class social_event_users_union;
 enum class change_list_enum;
 
 static const uint32_t GAMERSCORE_CHAR_SIZE = 16;
@@ -41,6 +42,9 @@ static const uint32_t COLOR_CHAR_SIZE = 7;
 static const uint32_t RICH_PRESENCE_CHAR_SIZE = 100;
 static const uint32_t NUM_PRESENCE_RECORDS = 6;
 
+/// <summary>
+/// No longer enforced; list groups can track any number of users. Kept for source compatibility.
+/// </summary>
 static const uint32_t MAX_USERS_FROM_LIST = 100;
 /// <summary>
 /// Detail level controls how much information is exposed in each xbox_live_social_graph_user
@@ -443,12 +447,19 @@ public:
     _XSAPIIMP const xbox::services::social::manager::social_manager_presence_record& presence_record() const;
 
     /// <summary>
-    /// Title history for the user
+    /// Title history for the user.
+    /// Social manager only fetches title history once a title has read it. The first read of a user
+    /// fetched without it returns empty title history, and the data arrives with a later refresh of the
+    /// social graph. Reads are tracked per process, so after the first one every local user's graph fetches it
+    /// until the last local user is removed. Groups with the all_title or title_offline presence filter
+    /// request title history when they are created.
     /// </summary>
     _XSAPIIMP const xbox::services::social::manager::title_history& title_history() const;
 
     /// <summary>
-    /// Preferred color for the user
+    /// Preferred color for the user.
+    /// Fetched on demand like title_history(): the first read of a user fetched without it returns an
+    /// empty preferred color, and every local user's graph fetches it from then on.
     /// </summary>
     _XSAPIIMP const preferred_color& preferred_color() const;
 
@@ -497,6 +508,7 @@ private:
 
     friend class social_graph;
     friend class user_buffers_holder;
+    friend class xbox_social_user_group;
 };
 
 /// <summary>
@@ -704,7 +716,7 @@ private:
 
     void update_view(
         _In_ const xsapi_internal_unordered_map(uint64_t, xbox_social_user_context)& snapshotList,
-        _In_ const std::vector<social_event>& socialEvents
+        _In_ const social_event_users_union& usersAffected
         );
 
     void initialize_filter_list(
@@ -713,7 +725,7 @@ private:
 
     void filter_list(
         _In_ const xsapi_internal_unordered_map(uint64_t, xbox_social_user_context)& snapshotList,
-        _In_ const std::vector<social_event>& socialEvents
+        _In_ const social_event_users_union& usersAffected
         );
 
     bool get_presence_filter_result(
@@ -822,7 +834,7 @@ public:
     /// The result of a user group being loaded will be triggered through the social_user_group_loaded event in do_work
     /// </summary>
     /// <param name="user">Xbox Live User</param>
-    /// <param name="xboxUserIdList">List of users to populate the Xbox Social User Group with. This is currently capped at 100 users total.</param>
+    /// <param name="xboxUserIdList">List of users to populate the Xbox Social User Group with. Users not already in the social graph are fetched in chunks and appear as each chunk arrives.</param>
     /// <returns>An xbox_live_result of the created Xbox Social User Group</returns>
     _XSAPIIMP xbox_live_result<std::shared_ptr<xbox_social_user_group>> create_social_user_group_from_list(
         _In_ xbox_live_user_t user,
@@ -850,7 +862,7 @@ public:
     /// The result of a user group being updated will be triggered through the social_user_group_updated event in do_work
     /// </summary>
     /// <param name="group">The xbox social user group to add users to</param>
-    /// <param name="users">List of users to add to the xbox social user group. Total number of users not in social graph is limited at 100.</param>
+    /// <param name="users">List of users to add to the xbox social user group. Users not already in the social graph are fetched in chunks.</param>
     /// <returns>An xbox_live_result representing the success of adding the users to the group</returns>
     _XSAPIIMP xbox_live_result<void> update_social_user_group(
         _In_ const std::shared_ptr<xbox_social_user_group>& group,
@@ -868,11 +880,53 @@ public:
         _In_ bool shouldEnablePolling
         );
 
+    /// <summary>
+    /// Sets the maximum number of users a single internal change event can carry for every local user's graph.
+    /// Larger batches produce fewer social events for bulk changes such as a presence refresh; the default is 10.
+    /// Changes that are already queued keep the size they were split with.
+    /// </summary>
+    /// <param name="maxUsersAffectedPerEvent">The maximum number of users per event. Must be greater than 0.</param>
+    /// <returns>An xbox_live_result representing the success of changing the setting</returns>
+    _XSAPIIMP xbox_live_result<void> set_max_users_affected_per_event(
+        _In_ uint32_t maxUsersAffectedPerEvent
+        );
+
+    /// <summary>
+    /// The maximum number of users a single internal change event can carry
+    /// </summary>
+    _XSAPIIMP uint32_t max_users_affected_per_event() const;
+
     /// <summary>
     /// Internal function
     /// </summary>
     void _Log_state();
 
+    /// <summary>
+    /// Internal function
+    /// Registers a handler that is handed the events produced by each do_work call.
+    /// </summary>
+    function_context _Add_social_event_handler(
+        _In_ std::function<void(const std::vector<social_event>&)> handler
+        );
+
+    /// <summary>
+    /// Internal function
+    /// </summary>
+    void _Remove_social_event_handler(
+        _In_ function_context context
+        );
+
+    /// <summary>
+    /// Internal function
+    /// Returns the users in the local user's loaded social graph that belong to the "people" (or "friends")
+    /// or "favorites" social group. Fails if the local user has no loaded graph or the group can't be
+    /// resolved from the graph.
+    /// </summary>
+    xbox_live_result<std::vector<string_t>> _Social_group_members(
+        _In_ const string_t& localXboxUserId,
+        _In_ const string_t& socialGroup
+        );
+
 #if defined(XSAPI_CPPWINRT)
 #if TV_API
     _XSAPIIMP virtual xbox_live_result<void> add_local_user(
@@ -923,7 +977,7 @@ protected:
     xsapi_internal_unordered_map(string_t, std::shared_ptr<xbox_social_user_group>) m_xboxSocialUserGroups;
     xsapi_internal_unordered_map(string_t, xsapi_internal_vector(string_t)) m_userToViewMap;
     xsapi_internal_unordered_map(string_t, std::shared_ptr<social_graph>) m_localGraphs;
-    std::mutex m_socialMangerLock;
+    mutable std::mutex m_socialMangerLock;
     std::mutex m_socialManagerEventLock;
 
     friend class xbox_social_user_group;
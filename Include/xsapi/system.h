@@ -152,6 +152,47 @@ public:
     /// <param name="context">The function_context object that was returned when the event handler was registered. </param>
     _XSAPIIMP void remove_wns_handler(_In_ function_context context);
 
+    /// <summary>
+    /// Turns on the write journal. Stats, achievement and reputation writes are recorded on disk until the
+    /// service acknowledges them, so progress made just before a crash or power loss isn't lost. Writes left
+    /// pending by a previous launch are sent again when an xbox_live_context for their user is initialized.
+    /// </summary>
+    /// <param name="journalDirectory">An existing directory the title can write to. The journal persists across launches.</param>
+    _XSAPIIMP xbox_live_result<void> enable_write_journal(_In_ const string_t& journalDirectory);
+
+    /// <summary>
+    /// Turns off the write journal. Writes still pending are left on disk for the next launch.
+    /// </summary>
+    _XSAPIIMP void disable_write_journal();
+
+    /// <summary>
+    /// Writes the flight recorder to a file. The flight recorder always keeps the last few thousand HTTP calls
+    /// with their status and latency, websocket connection state changes, real-time activity resyncs, and
+    /// Social Manager and Multiplayer Manager event counts, so that they can be looked at after an incident.
+    /// </summary>
+    /// <param name="filePath">The file to write. It is replaced if it exists.</param>
+    _XSAPIIMP xbox_live_result<void> dump_flight_recorder(_In_ const string_t& filePath);
+
+    /// <summary>
+    /// Writes the flight recorder to a file if the process terminates on an unhandled exception.
+    /// A terminate handler the title set earlier still runs afterwards.
+    /// </summary>
+    /// <param name="filePath">The file to write. An empty string turns this off.</param>
+    _XSAPIIMP void set_flight_recorder_crash_dump_path(_In_ const string_t& filePath);
+
+    /// <summary>
+    /// Starts recording spans: one per HTTP attempt, plus Social Manager's add_local_user and the
+    /// calls it leads to, each tied to the operation that caused it.
+    /// </summary>
+    _XSAPIIMP void start_span_tracing();
+
+    /// <summary>
+    /// Stops recording spans and writes the ones recorded since start_span_tracing() to a file in the
+    /// Chrome trace event format, which chrome://tracing and Perfetto can open.
+    /// </summary>
+    /// <param name="filePath">The file to write. It is replaced if it exists. An empty string discards the spans.</param>
+    _XSAPIIMP xbox_live_result<void> stop_span_tracing(_In_ const string_t& filePath);
+
     /// <summary>
     /// Internal function
     /// </summary>
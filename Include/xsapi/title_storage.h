@@ -518,6 +518,166 @@ private:
     title_storage_blob_metadata m_blobMetadata;
 };
 
+/// <summary>
+/// Describes a bulk sync between a title storage folder and the title's local copy of it.
+/// </summary>
+class title_storage_sync_request
+{
+public:
+    /// <summary>
+    /// Initializes a new instance of the title_storage_sync_request class.
+    /// </summary>
+    /// <param name="serviceConfigurationId">The service configuration ID (SCID) of the title</param>
+    /// <param name="storageType">The storage type to sync.</param>
+    /// <param name="blobPath">The root path to sync.  Blobs in this path and all subpaths are synced.</param>
+    /// <param name="xboxUserId">The Xbox User ID of the title storage to sync. Ignored for GlobalStorage. (Optional)</param>
+    /// <param name="manifestFilePath">Local file recording the ETag, length and client timestamp of every blob as of the last sync.
+    /// It is written once, when the sync completes.</param>
+    _XSAPIIMP title_storage_sync_request(
+        _In_ string_t serviceConfigurationId,
+        _In_ title_storage_type storageType,
+        _In_ string_t blobPath,
+        _In_ string_t xboxUserId,
+        _In_ string_t manifestFilePath
+        );
+
+    /// <summary>
+    /// Queues a local change to upload.  The upload is skipped and reported as a conflict if the remote blob
+    /// changed since the last sync; the remote version is downloaded instead.
+    /// </summary>
+    /// <param name="blobMetadata">The metadata of the blob to upload.</param>
+    /// <param name="blobBuffer">The blob data.  Clients should not modify the buffer while the sync is in progress.</param>
+    _XSAPIIMP void add_upload(
+        _In_ title_storage_blob_metadata blobMetadata,
+        _In_ std::shared_ptr<std::vector<unsigned char>> blobBuffer
+        );
+
+    /// <summary>
+    /// Sets the transfer priority of a blob.  Higher priority blobs are transferred first.  Blobs default to priority 0.
+    /// </summary>
+    _XSAPIIMP void set_blob_priority(
+        _In_ const string_t& blobPath,
+        _In_ int32_t priority
+        );
+
+    /// <summary>
+    /// Sets the maximum number of blobs transferred at the same time.  Defaults to DEFAULT_MAX_CONCURRENT_TRANSFERS.
+    /// </summary>
+    _XSAPIIMP void set_max_concurrent_transfers(_In_ uint32_t maxConcurrentTransfers);
+
+    /// <summary>
+    /// The service configuration ID (SCID) of the title
+    /// </summary>
+    _XSAPIIMP const string_t& service_configuration_id() const;
+
+    /// <summary>
+    /// The storage type to sync.
+    /// </summary>
+    _XSAPIIMP title_storage_type storage_type() const;
+
+    /// <summary>
+    /// The root path to sync.
+    /// </summary>
+    _XSAPIIMP const string_t& blob_path() const;
+
+    /// <summary>
+    /// The Xbox User ID of the title storage to sync.
+    /// </summary>
+    _XSAPIIMP const string_t& xbox_user_id() const;
+
+    /// <summary>
+    /// Local file the sync manifest is stored in.
+    /// </summary>
+    _XSAPIIMP const string_t& manifest_file_path() const;
+
+    /// <summary>
+    /// The maximum number of blobs transferred at the same time.
+    /// </summary>
+    _XSAPIIMP uint32_t max_concurrent_transfers() const;
+
+    /// <summary>
+    /// Internal function
+    /// </summary>
+    const std::vector<title_storage_blob_result>& _Uploads() const;
+
+    /// <summary>
+    /// Internal function
+    /// </summary>
+    int32_t _Blob_priority(_In_ const string_t& blobPath) const;
+
+    _XSAPIIMP static const uint32_t DEFAULT_MAX_CONCURRENT_TRANSFERS;
+
+private:
+    string_t m_serviceConfigurationId;
+    title_storage_type m_storageType;
+    string_t m_blobPath;
+    string_t m_xboxUserId;
+    string_t m_manifestFilePath;
+    uint32_t m_maxConcurrentTransfers;
+    std::vector<title_storage_blob_result> m_uploads;
+    std::unordered_map<string_t, int32_t> m_blobPriorities;
+};
+
+/// <summary>
+/// The outcome of a bulk sync.
+/// </summary>
+class title_storage_sync_result
+{
+public:
+    /// <summary>
+    /// Internal function
+    /// </summary>
+    title_storage_sync_result();
+
+    /// <summary>
+    /// Blobs that changed remotely since the last sync, with their downloaded contents.
+    /// </summary>
+    _XSAPIIMP const std::vector<title_storage_blob_result>& downloaded_blobs() const;
+
+    /// <summary>
+    /// Local changes that were uploaded, with their updated ETag and Length.
+    /// </summary>
+    _XSAPIIMP const std::vector<title_storage_blob_metadata>& uploaded_blobs() const;
+
+    /// <summary>
+    /// Blob paths whose upload was skipped because the remote blob changed since the last sync.
+    /// </summary>
+    _XSAPIIMP const std::vector<string_t>& conflicted_blob_paths() const;
+
+    /// <summary>
+    /// Blob paths that were in the manifest but no longer exist remotely.
+    /// </summary>
+    _XSAPIIMP const std::vector<string_t>& removed_blob_paths() const;
+
+    /// <summary>
+    /// Blob paths whose transfer failed.  These keep their previous manifest entry and are retried on the next sync.
+    /// </summary>
+    _XSAPIIMP const std::vector<string_t>& failed_blob_paths() const;
+
+    /// <summary>
+    /// The number of remote blobs that were already up to date.
+    /// </summary>
+    _XSAPIIMP uint32_t unchanged_blob_count() const;
+
+    /// <summary>
+    /// How long the sync took, from listing the remote blobs to committing the manifest.
+    /// </summary>
+    _XSAPIIMP std::chrono::milliseconds sync_duration() const;
+
+private:
+    std::vector<title_storage_blob_result> m_downloadedBlobs;
+    std::vector<title_storage_blob_metadata> m_uploadedBlobs;
+    std::vector<string_t> m_conflictedBlobPaths;
+    std::vector<string_t> m_removedBlobPaths;
+    std::vector<string_t> m_failedBlobPaths;
+    uint32_t m_unchangedBlobCount;
+    std::chrono::milliseconds m_syncDuration;
+
+    friend class title_storage_sync_operation;
+};
+
+class title_storage_blob_cache;
+
 /// <summary>
 /// Services that manage title storage.
 /// </summary>
@@ -698,6 +858,65 @@ public:
         _In_ uint32_t preferredUploadBlockSize = DEFAULT_UPLOAD_BLOCK_SIZE
         );
 
+    /// <summary>
+    /// Uploads blob data to title storage from a source that is read as the upload progresses.  The blob length doesn't
+    /// need to be known up front; the upload ends when the source returns 0.  The next block is read while the current
+    /// one is being sent, and binary block sizes adapt to the measured throughput within the allowed range.
+    /// </summary>
+    /// <param name="blobMetadata">Contains properties required to upload the buffer to title storage.  Uploads require a service configuration Id, blob path, blob type and storage type at a minimum.</param>
+    /// <param name="blobSource">Called with a buffer and its size; fills the buffer with the next part of the blob and returns the number of bytes written,
+    /// or 0 once the blob has ended.  Called from a background thread, one call at a time.</param>
+    /// <param name="etagMatchCondition">The ETag match condition used to determine if the blob data should be uploaded.</param>
+    /// <param name="preferredUploadBlockSize">The block size in bytes to start binary uploads with.  Clamped to the MIN_UPLOAD_BLOCK_SIZE to MAX_UPLOAD_BLOCK_SIZE range.</param>
+    /// <returns>title_storage_blob_metadata object with updated Etag and Length properties.</returns>
+    /// <remarks>
+    /// V1 PUT json/users/xuid({xuid})/scids/{scid}/data/{path},{type} or
+    /// V1 PUT global/scids/{scid}/data/{path},{type} or
+    /// V1 PUT sessions/{sessionId}/scids/{scid}/data/{path},{type}
+    /// </remarks>
+    _XSAPIIMP pplx::task<xbox_live_result<title_storage_blob_metadata>> upload_blob(
+        _In_ title_storage_blob_metadata blobMetadata,
+        _In_ std::function<size_t(unsigned char* buffer, size_t bufferSize)> blobSource,
+        _In_ title_storage_e_tag_match_condition etagMatchCondition,
+        _In_ uint32_t preferredUploadBlockSize = DEFAULT_UPLOAD_BLOCK_SIZE
+        );
+
+    /// <summary>
+    /// Brings a title storage folder and the title's local copy of it in sync.  Remote blob metadata is compared
+    /// against the local manifest, and only blobs whose ETag, length or client timestamp changed are downloaded.
+    /// Queued local changes are uploaded.  Transfers run in priority order with bounded parallelism, and the
+    /// manifest is committed atomically once they finish.
+    /// </summary>
+    /// <param name="syncRequest">The folder to sync, the manifest location and any local changes to upload.</param>
+    /// <returns>title_storage_sync_result object describing what was transferred.</returns>
+    /// <remarks>Calls get_blob_metadata, then download_blob and upload_blob for each changed blob.</remarks>
+    _XSAPIIMP pplx::task<xbox_live_result<title_storage_sync_result>> sync_blobs(
+        _In_ const title_storage_sync_request& syncRequest
+        );
+
+    /// <summary>
+    /// Turns on the local blob cache for downloads from this service. Downloads that don't specify an ETag
+    /// match condition are revalidated with If-None-Match, and a blob that hasn't changed is read from the
+    /// cache instead of being transferred again.
+    /// </summary>
+    /// <param name="cacheDirectory">An existing directory the title can write to. The cache persists across launches,
+    /// and services enabled on the same directory share one cache.</param>
+    /// <param name="maxCacheSizeInBytes">Least recently used blobs are evicted to keep the cache within this size.</param>
+    _XSAPIIMP xbox_live_result<void> enable_blob_cache(
+        _In_ const string_t& cacheDirectory,
+        _In_ uint64_t maxCacheSizeInBytes
+        );
+
+    /// <summary>
+    /// Turns off the local blob cache. Cached files are left on disk for the next launch.
+    /// </summary>
+    _XSAPIIMP void disable_blob_cache();
+
+    /// <summary>
+    /// Internal function
+    /// </summary>
+    std::shared_ptr<title_storage_blob_cache> _Blob_cache() const;
+
     _XSAPIIMP static const uint32_t MIN_UPLOAD_BLOCK_SIZE;
     _XSAPIIMP static const uint32_t MAX_UPLOAD_BLOCK_SIZE;
     _XSAPIIMP static const uint32_t DEFAULT_UPLOAD_BLOCK_SIZE;
@@ -107,6 +107,14 @@ public:
     /// </summary>
     _XSAPIIMP std::shared_ptr<xbox_live_app_config> application_config();
 
+    /// <summary>
+    /// Resolves the Xbox Live service hosts most titles call at startup and opens idle connections to them
+    /// in parallel, so the first call to each host doesn't wait on DNS resolution and the TLS handshake.
+    /// Call it right after sign-in. Pre-warming is best effort; a host that can't be reached is skipped.
+    /// </summary>
+    /// <returns>A task that completes once every host has been connected to or has failed.</returns>
+    _XSAPIIMP pplx::task<xbox_live_result<void>> prewarm_service_connections();
+
     /// <summary>
     /// A service for storing data in the cloud.
     /// </summary>
@@ -8,6 +8,7 @@
 #include "xsapi/achievements.h"
 #include "xsapi/services.h"
 #include "xbox_live_context_impl.h"
+#include "write_behind_journal.h"
 
 #if TV_API
 #pragma pack(push, 16)
@@ -113,7 +114,7 @@ achievement_service::update_achievement(
 #if TV_API
     {
         auto xsapiSingleton = get_xsapi_singleton();
-        std::lock_guard<std::mutex> lock(xsapiSingleton->m_achievementServiceInitLock);
+        std::lock_guard<xsapi_mutex> lock(xsapiSingleton->m_achievementServiceInitLock);
         if (!xsapiSingleton->m_bHasAchievementServiceInitialized)
         {
             HRESULT hr = CoCreateGuid(&xsapiSingleton->m_eventPlayerSessionId);
@@ -179,12 +180,21 @@ achievement_service::update_achievement(
 
     httpCall->set_request_body(request.serialize());
 
+    // Progress updates only ever raise percentComplete, so a replayed update can't undo a later one
+    string_t journalKey = write_behind_journal::get_write_behind_journal_singleton()->record(
+        m_userContext->xbox_user_id(),
+        xbox_live_api::update_achievement,
+        httpCall
+        );
+
     auto userContext = m_userContext;
     auto xboxLiveContextImpl = m_xboxLiveContextImpl.lock();
 
     auto task = httpCall->get_response_with_auth(m_userContext)
-    .then([userContext, xboxUserId, titleId, serviceConfigurationId, achievementId, percentComplete, xboxLiveContextImpl](std::shared_ptr<http_call_response> response)
+    .then([userContext, xboxUserId, titleId, serviceConfigurationId, achievementId, percentComplete, xboxLiveContextImpl, journalKey](std::shared_ptr<http_call_response> response)
     {
+        write_behind_journal::get_write_behind_journal_singleton()->complete(journalKey, response);
+
         if (response->err_code() == xbox_live_error_condition::network ||
             response->err_code() == xbox_live_error_code::http_status_429_too_many_requests ||
             response->err_code() == xbox_live_error_code::generic_error ||
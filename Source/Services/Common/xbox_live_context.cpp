@@ -152,6 +152,12 @@ xbox_live_context::privacy_service()
     return m_xboxLiveContextImpl->privacy_service();
 }
 
+pplx::task<xbox_live_result<void>>
+xbox_live_context::prewarm_service_connections()
+{
+    return m_xboxLiveContextImpl->prewarm_service_connections();
+}
+
 system::string_service&
 xbox_live_context::string_service()
 {
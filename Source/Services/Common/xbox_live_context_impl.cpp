@@ -13,6 +13,7 @@
 #endif
 #include "presence_internal.h"
 #include "real_time_activity_internal.h"
+#include "write_behind_journal.h"
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_BEGIN
 
@@ -159,6 +160,13 @@ void xbox_live_context_impl::init()
     m_contextualSearchService = xbox::services::contextual_search::contextual_search_service(m_userContext, m_xboxLiveContextSettings, m_appConfig);
     m_stringService = xbox::services::system::string_service(m_userContext, m_xboxLiveContextSettings, m_appConfig);
     m_clubsService = xbox::services::clubs::clubs_service(m_userContext, m_xboxLiveContextSettings, m_appConfig);
+
+    // Send what a previous run left in the write journal, whichever services the title goes on to use
+    auto journal = write_behind_journal::get_write_behind_journal_singleton();
+    if (journal->has_pending_writes(m_userContext->xbox_user_id()))
+    {
+        journal->replay(m_userContext, m_xboxLiveContextSettings);
+    }
     
 #if (UWP_API || XSAPI_U)
     m_eventsService = events::events_service(m_userContext, m_appConfig);
@@ -368,6 +376,26 @@ xbox_live_context_impl::settings()
     return m_xboxLiveContextSettings;
 }
 
+pplx::task<xbox_live_result<void>>
+xbox_live_context_impl::prewarm_service_connections()
+{
+    // The hosts nearly every title calls during startup: social graph, Social Manager, presence, multiplayer and stats
+    std::vector<string_t> serverNames;
+    serverNames.push_back(utils::create_xboxlive_endpoint(_T("social"), m_appConfig));
+    serverNames.push_back(utils::create_xboxlive_endpoint(_T("peoplehub"), m_appConfig));
+    serverNames.push_back(utils::create_xboxlive_endpoint(_T("userpresence"), m_appConfig));
+    serverNames.push_back(utils::create_xboxlive_endpoint(_T("sessiondirectory"), m_appConfig));
+    serverNames.push_back(utils::create_xboxlive_endpoint(_T("statsread"), m_appConfig));
+
+    // Warm the same client the first attempt of a call will use
+    auto clientConfig = http_call_impl::create_client_config(http_call_impl::get_http_timeout(m_xboxLiveContextSettings, std::chrono::milliseconds::zero()));
+    return http_client_pool::get_http_client_pool_singleton()->prewarm(serverNames, clientConfig)
+    .then([]()
+    {
+        return xbox_live_result<void>();
+    });
+}
+
 std::shared_ptr<xbox_live_app_config> 
 xbox_live_context_impl::application_config()
 {
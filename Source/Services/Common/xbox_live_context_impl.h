@@ -132,6 +132,11 @@ public:
     /// </summary>
     std::shared_ptr<xbox_live_context_settings> settings();
 
+    /// <summary>
+    /// Opens connections to the service hosts titles call right after sign-in.
+    /// </summary>
+    pplx::task<xbox_live_result<void>> prewarm_service_connections();
+
     /// <summary>
     /// A service used to check for offensive strings.
     /// </summary>
@@ -54,6 +54,11 @@ const std::vector<leaderboard_row>& leaderboard_result::rows() const
     return m_rows;
 }
 
+leaderboard_table leaderboard_result::to_table() const
+{
+    return leaderboard_table::_Create(m_columns, m_rows);
+}
+
 void leaderboard_result::_Set_next_query(std::shared_ptr<leaderboard_global_query> query)
 {
     m_globalQuery = std::move(query);
@@ -0,0 +1,261 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#include "shared_macros.h"
+#include "utils.h"
+#include "xsapi/leaderboard.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_LEADERBOARD_CPP_BEGIN
+
+static uint64_t parse_uint64(_In_ const string_t& value)
+{
+    if (value == _T("true")) return 1;
+#if XSAPI_U
+    return std::strtoull(value.c_str(), nullptr, 10);
+#else
+    return _wcstoui64(value.c_str(), nullptr, 10);
+#endif
+}
+
+static double parse_double(_In_ const string_t& value)
+{
+#if XSAPI_U
+    return std::strtod(value.c_str(), nullptr);
+#else
+    return wcstod(value.c_str(), nullptr);
+#endif
+}
+
+static leaderboard_column_storage storage_for_stat_type(_In_ leaderboard_stat_type statType)
+{
+    switch (statType)
+    {
+        case leaderboard_stat_type::stat_uint64:
+        case leaderboard_stat_type::stat_boolean:
+            return leaderboard_column_storage::uint64;
+        case leaderboard_stat_type::stat_double:
+            return leaderboard_column_storage::floating_point;
+        default:
+            return leaderboard_column_storage::string;
+    }
+}
+
+static const string_t s_emptyString;
+
+leaderboard_table::leaderboard_table()
+{
+}
+
+leaderboard_table
+leaderboard_table::_Create(
+    _In_ const std::vector<leaderboard_column>& columns,
+    _In_ const std::vector<leaderboard_row>& rows
+    )
+{
+    leaderboard_table table;
+    table.m_columns = columns;
+
+    // Only needed while building; the table keeps the pool and each row keeps an index into it
+    std::unordered_map<string_t, uint32_t> stringIndex;
+    auto intern = [&table, &stringIndex](const string_t& value)
+    {
+        auto existing = stringIndex.find(value);
+        if (existing != stringIndex.end())
+        {
+            return existing->second;
+        }
+
+        uint32_t index = static_cast<uint32_t>(table.m_strings.size());
+        table.m_strings.push_back(value);
+        stringIndex[value] = index;
+        return index;
+    };
+
+    // Index 0 is the empty string, used for missing values
+    intern(string_t());
+
+    table.m_gamertagIndices.reserve(rows.size());
+    table.m_xboxUserIds.reserve(rows.size());
+    table.m_ranks.reserve(rows.size());
+    table.m_percentiles.reserve(rows.size());
+    for (const auto& row : rows)
+    {
+        table.m_gamertagIndices.push_back(intern(row.gamertag()));
+        table.m_xboxUserIds.push_back(utils::string_t_to_uint64(row.xbox_user_id()));
+        table.m_ranks.push_back(row.rank());
+        table.m_percentiles.push_back(row.percentile());
+    }
+
+    table.m_columnValues.resize(columns.size());
+    for (size_t columnIndex = 0; columnIndex < columns.size(); ++columnIndex)
+    {
+        auto& values = table.m_columnValues[columnIndex];
+        values.storage = storage_for_stat_type(columns[columnIndex].stat_type());
+        for (const auto& row : rows)
+        {
+            const auto& columnValues = row.column_values();
+            const string_t& value = columnIndex < columnValues.size() ? columnValues[columnIndex] : s_emptyString;
+            switch (values.storage)
+            {
+                case leaderboard_column_storage::uint64:
+                    values.uint64Values.push_back(parse_uint64(value));
+                    break;
+                case leaderboard_column_storage::floating_point:
+                    values.doubleValues.push_back(parse_double(value));
+                    break;
+                default:
+                    values.stringIndices.push_back(intern(value));
+                    break;
+            }
+        }
+    }
+
+    return table;
+}
+
+size_t
+leaderboard_table::row_count() const
+{
+    return m_ranks.size();
+}
+
+const std::vector<leaderboard_column>&
+leaderboard_table::columns() const
+{
+    return m_columns;
+}
+
+leaderboard_column_storage
+leaderboard_table::column_storage(
+    _In_ size_t columnIndex
+    ) const
+{
+    return m_columnValues[columnIndex].storage;
+}
+
+const string_t&
+leaderboard_table::gamertag(
+    _In_ size_t rowIndex
+    ) const
+{
+    return m_strings[m_gamertagIndices[rowIndex]];
+}
+
+uint64_t
+leaderboard_table::xbox_user_id(
+    _In_ size_t rowIndex
+    ) const
+{
+    return m_xboxUserIds[rowIndex];
+}
+
+uint32_t
+leaderboard_table::rank(
+    _In_ size_t rowIndex
+    ) const
+{
+    return m_ranks[rowIndex];
+}
+
+double
+leaderboard_table::percentile(
+    _In_ size_t rowIndex
+    ) const
+{
+    return m_percentiles[rowIndex];
+}
+
+uint64_t
+leaderboard_table::uint64_value(
+    _In_ size_t rowIndex,
+    _In_ size_t columnIndex
+    ) const
+{
+    const auto& values = m_columnValues[columnIndex];
+    switch (values.storage)
+    {
+        case leaderboard_column_storage::uint64:
+            return values.uint64Values[rowIndex];
+        case leaderboard_column_storage::floating_point:
+            return values.doubleValues[rowIndex] < 0 ? 0 : static_cast<uint64_t>(values.doubleValues[rowIndex]);
+        default:
+            return 0;
+    }
+}
+
+int64_t
+leaderboard_table::int64_value(
+    _In_ size_t rowIndex,
+    _In_ size_t columnIndex
+    ) const
+{
+    const auto& values = m_columnValues[columnIndex];
+    switch (values.storage)
+    {
+        case leaderboard_column_storage::uint64:
+            return static_cast<int64_t>(values.uint64Values[rowIndex]);
+        case leaderboard_column_storage::floating_point:
+            return static_cast<int64_t>(values.doubleValues[rowIndex]);
+        default:
+            return 0;
+    }
+}
+
+double
+leaderboard_table::double_value(
+    _In_ size_t rowIndex,
+    _In_ size_t columnIndex
+    ) const
+{
+    const auto& values = m_columnValues[columnIndex];
+    switch (values.storage)
+    {
+        case leaderboard_column_storage::uint64:
+            return static_cast<double>(values.uint64Values[rowIndex]);
+        case leaderboard_column_storage::floating_point:
+            return values.doubleValues[rowIndex];
+        default:
+            return 0;
+    }
+}
+
+const string_t&
+leaderboard_table::string_value(
+    _In_ size_t rowIndex,
+    _In_ size_t columnIndex
+    ) const
+{
+    const auto& values = m_columnValues[columnIndex];
+    if (values.storage != leaderboard_column_storage::string)
+    {
+        return s_emptyString;
+    }
+
+    return m_strings[values.stringIndices[rowIndex]];
+}
+
+size_t
+leaderboard_table::memory_footprint() const
+{
+    size_t bytes = sizeof(leaderboard_table);
+    bytes += m_gamertagIndices.capacity() * sizeof(uint32_t);
+    bytes += m_xboxUserIds.capacity() * sizeof(uint64_t);
+    bytes += m_ranks.capacity() * sizeof(uint32_t);
+    bytes += m_percentiles.capacity() * sizeof(double);
+    for (const auto& values : m_columnValues)
+    {
+        bytes += sizeof(column_values);
+        bytes += values.uint64Values.capacity() * sizeof(uint64_t);
+        bytes += values.doubleValues.capacity() * sizeof(double);
+        bytes += values.stringIndices.capacity() * sizeof(uint32_t);
+    }
+    for (const auto& value : m_strings)
+    {
+        bytes += sizeof(string_t) + value.capacity() * sizeof(char_t);
+    }
+
+    return bytes;
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_LEADERBOARD_CPP_END
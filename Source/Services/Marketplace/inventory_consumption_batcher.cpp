@@ -0,0 +1,374 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#include "utils.h"
+#include "user_context.h"
+#include "xbox_system_factory.h"
+#include "marketplace_internal.h"
+#if !XSAPI_U
+#include "ppltasks_extra.h"
+#else
+#include "ppltasks_extra_unix.h"
+#endif
+
+using namespace pplx;
+using namespace Concurrency::extras;
+using namespace xbox::services::system;
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MARKETPLACE_CPP_BEGIN
+
+const string_t::value_type c_consumableContractVersionHeaderValue[] = _T("4");
+
+// Long enough to catch a burst of per-use consumptions, short enough that the balance settles quickly
+const std::chrono::milliseconds inventory_consumption_batcher::CONSUMPTION_WINDOW = std::chrono::milliseconds(500);
+// Each level of halving can double the calls a rejected aggregate costs; past this the remaining chunk fails as a whole
+const uint32_t inventory_consumption_batcher::MAX_REPLAY_SPLIT_DEPTH = 4;
+
+inventory_consumption_batcher::inventory_consumption_batcher(
+    _In_ std::shared_ptr<xbox::services::user_context> userContext,
+    _In_ std::shared_ptr<xbox::services::xbox_live_context_settings> xboxLiveContextSettings
+    ) :
+    m_userContext(std::move(userContext)),
+    m_xboxLiveContextSettings(std::move(xboxLiveContextSettings)),
+    m_serviceCallCount(0)
+{
+}
+
+inventory_consumption_batcher::~inventory_consumption_batcher()
+{
+    // Consumptions still waiting on their window would otherwise never complete
+    xbox_live_result<consume_inventory_item_result> destroyedResult(xbox_live_error_code::runtime_error, "inventory_service was destroyed.");
+    for (const auto& pendingConsumptions : m_pendingConsumptions)
+    {
+        for (const auto& consumption : pendingConsumptions.second)
+        {
+            consumption.tce.set(destroyedResult);
+        }
+    }
+}
+
+struct inventory_consumption_batcher_entry
+{
+    std::weak_ptr<xbox::services::user_context> userContext;
+    std::shared_ptr<inventory_consumption_batcher> batcher;
+};
+
+static xsapi_mutex& batcher_registry_lock()
+{
+    static xsapi_mutex s_registryLock XSAPI_LOCK_SITE("inventory_consumption_batcher::s_registryLock");
+    return s_registryLock;
+}
+
+static std::unordered_map<const xbox::services::user_context*, inventory_consumption_batcher_entry>& batcher_registry()
+{
+    static std::unordered_map<const xbox::services::user_context*, inventory_consumption_batcher_entry> s_batchers;
+    return s_batchers;
+}
+
+std::shared_ptr<inventory_consumption_batcher>
+inventory_consumption_batcher::get(
+    _In_ const std::shared_ptr<xbox::services::user_context>& userContext
+    )
+{
+    if (userContext == nullptr)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard<xsapi_mutex> lock(batcher_registry_lock());
+    auto& batchers = batcher_registry();
+    auto entry = batchers.find(userContext.get());
+    if (entry == batchers.end() || entry->second.userContext.lock() != userContext)
+    {
+        return nullptr;
+    }
+    return entry->second.batcher;
+}
+
+std::shared_ptr<inventory_consumption_batcher>
+inventory_consumption_batcher::get_or_create(
+    _In_ const std::shared_ptr<xbox::services::user_context>& userContext,
+    _In_ const std::shared_ptr<xbox::services::xbox_live_context_settings>& xboxLiveContextSettings
+    )
+{
+    std::vector<std::shared_ptr<inventory_consumption_batcher>> expiredBatchers;
+    std::shared_ptr<inventory_consumption_batcher> batcher;
+    {
+        std::lock_guard<xsapi_mutex> lock(batcher_registry_lock());
+        auto& batchers = batcher_registry();
+        for (auto entry = batchers.begin(); entry != batchers.end();)
+        {
+            if (entry->second.userContext.expired())
+            {
+                // Destroyed outside the lock, since that completes their pending consumptions
+                expiredBatchers.push_back(std::move(entry->second.batcher));
+                entry = batchers.erase(entry);
+            }
+            else
+            {
+                ++entry;
+            }
+        }
+
+        auto& entry = batchers[userContext.get()];
+        if (entry.batcher == nullptr)
+        {
+            entry.userContext = userContext;
+            entry.batcher = std::make_shared<inventory_consumption_batcher>(userContext, xboxLiveContextSettings);
+        }
+        batcher = entry.batcher;
+    }
+
+    return batcher;
+}
+
+pplx::task<xbox_live_result<consume_inventory_item_result>>
+inventory_consumption_batcher::consume(
+    _In_ const inventory_item& inventoryItem,
+    _In_ uint32_t quantityToConsume
+    )
+{
+    RETURN_TASK_CPP_INVALIDARGUMENT_IF(inventoryItem.consumable_url().to_string().empty(), consume_inventory_item_result, "inventoryItems consumableUrl cannot be empty");
+    RETURN_TASK_CPP_INVALIDARGUMENT_IF(quantityToConsume == 0, consume_inventory_item_result, "quantityToConsume");
+
+    string_t consumableUrl = inventoryItem.consumable_url().to_string();
+
+    inventory_consumption consumption;
+    consumption.quantity = quantityToConsume;
+    consumption.transactionId = utils::create_guid(true);
+    auto task = pplx::create_task(consumption.tce);
+
+    bool startWindow = false;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        if (m_serviceBalances.find(consumableUrl) == m_serviceBalances.end())
+        {
+            m_serviceBalances[consumableUrl] = inventoryItem.consumable_balance();
+        }
+        m_outstandingQuantities[consumableUrl] += quantityToConsume;
+
+        auto& pendingConsumptions = m_pendingConsumptions[consumableUrl];
+        startWindow = pendingConsumptions.empty();
+        pendingConsumptions.push_back(std::move(consumption));
+    }
+
+    if (startWindow)
+    {
+        std::weak_ptr<inventory_consumption_batcher> thisWeakPtr = shared_from_this();
+        create_delayed_task(
+            CONSUMPTION_WINDOW,
+            [thisWeakPtr, consumableUrl]()
+        {
+            std::shared_ptr<inventory_consumption_batcher> pThis(thisWeakPtr.lock());
+            if (pThis != nullptr)
+            {
+                pThis->flush(consumableUrl);
+            }
+        });
+    }
+
+    return task;
+}
+
+uint32_t
+inventory_consumption_batcher::local_balance(
+    _In_ const inventory_item& inventoryItem
+    )
+{
+    string_t consumableUrl = inventoryItem.consumable_url().to_string();
+
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    auto serviceBalance = m_serviceBalances.find(consumableUrl);
+    if (serviceBalance == m_serviceBalances.end())
+    {
+        return inventoryItem.consumable_balance();
+    }
+
+    uint32_t outstandingQuantity = m_outstandingQuantities[consumableUrl];
+    return serviceBalance->second > outstandingQuantity ? serviceBalance->second - outstandingQuantity : 0;
+}
+
+uint32_t
+inventory_consumption_batcher::service_call_count() const
+{
+    return m_serviceCallCount;
+}
+
+void
+inventory_consumption_batcher::flush(
+    _In_ const string_t& consumableUrl
+    )
+{
+    std::vector<inventory_consumption> consumptions;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        auto pendingConsumptions = m_pendingConsumptions.find(consumableUrl);
+        if (pendingConsumptions == m_pendingConsumptions.end())
+        {
+            return;
+        }
+
+        consumptions.swap(pendingConsumptions->second);
+        m_pendingConsumptions.erase(pendingConsumptions);
+    }
+
+    if (!consumptions.empty())
+    {
+        string_t transactionId = consumptions.size() == 1 ? consumptions[0].transactionId : utils::create_guid(true);
+        send_chunk(consumableUrl, std::move(consumptions), transactionId, 0);
+    }
+}
+
+pplx::task<void>
+inventory_consumption_batcher::send_chunk(
+    _In_ const string_t& consumableUrl,
+    _In_ std::vector<inventory_consumption> consumptions,
+    _In_ const string_t& transactionId,
+    _In_ uint32_t splitDepth
+    )
+{
+    uint32_t quantityToConsume = 0;
+    for (const auto& consumption : consumptions)
+    {
+        quantityToConsume += consumption.quantity;
+    }
+
+    std::shared_ptr<xbox::services::user_context> userContext(m_userContext.lock());
+    if (userContext == nullptr)
+    {
+        complete_chunk(consumableUrl, consumptions, xbox_live_result<consume_inventory_item_result>(xbox_live_error_code::runtime_error, "inventory_service was destroyed."));
+        return pplx::task_from_result();
+    }
+
+    ++m_serviceCallCount;
+    LOGS_DEBUG << "inventory_consumption_batcher: consuming " << quantityToConsume << " in " << consumptions.size() << " consumptions, service calls so far: " << m_serviceCallCount;
+
+    std::shared_ptr<http_call> httpCall = xbox_system_factory::get_factory()->create_http_call(
+        m_xboxLiveContextSettings,
+        _T("POST"),
+        consumableUrl,
+        _T(""),
+        xbox_live_api::consume_inventory_item
+        );
+    consume_inventory_item_request request(
+        transactionId,
+        quantityToConsume
+        );
+
+    // Every chunk keeps its transaction Id across retries, so unlike a single
+    // consume_inventory_item() call it is safe to let the http layer retry it.
+    httpCall->set_request_body(request._Serialize().serialize());
+    httpCall->set_xbox_contract_version_header_value(c_consumableContractVersionHeaderValue);
+
+    std::weak_ptr<inventory_consumption_batcher> thisWeakPtr = shared_from_this();
+    return httpCall->get_response_with_auth(userContext)
+    .then([thisWeakPtr, consumableUrl, consumptions, splitDepth](pplx::task<std::shared_ptr<http_call_response>> responseTask)
+    {
+        xbox_live_result<consume_inventory_item_result> result;
+        try
+        {
+            auto response = responseTask.get();
+            result = utils::generate_xbox_live_result<consume_inventory_item_result>(
+                consume_inventory_item_result::_Deserialize(response->response_body_json()),
+                response
+                );
+        }
+        catch (const std::exception& e)
+        {
+            result = xbox_live_result<consume_inventory_item_result>(xbox_live_error_code::generic_error, e.what());
+        }
+
+        std::shared_ptr<inventory_consumption_batcher> pThis(thisWeakPtr.lock());
+        if (pThis == nullptr)
+        {
+            for (const auto& consumption : consumptions)
+            {
+                consumption.tce.set(result);
+            }
+            return pplx::task_from_result();
+        }
+
+        if (result.err() && consumptions.size() > 1 && splitDepth < MAX_REPLAY_SPLIT_DEPTH && is_rejection(result.err()))
+        {
+            // Replay the aggregate in halves so only the consumptions the service won't accept fail
+            size_t half = consumptions.size() / 2;
+            std::vector<inventory_consumption> firstHalf(consumptions.begin(), consumptions.begin() + half);
+            std::vector<inventory_consumption> secondHalf(consumptions.begin() + half, consumptions.end());
+            string_t firstTransactionId = firstHalf.size() == 1 ? firstHalf[0].transactionId : utils::create_guid(true);
+            string_t secondTransactionId = secondHalf.size() == 1 ? secondHalf[0].transactionId : utils::create_guid(true);
+
+            LOGS_DEBUG << "inventory_consumption_batcher: aggregate rejected, replaying " << consumptions.size() << " consumptions in smaller chunks";
+
+            return pThis->send_chunk(consumableUrl, firstHalf, firstTransactionId, splitDepth + 1)
+            .then([thisWeakPtr, consumableUrl, secondHalf, secondTransactionId, splitDepth](pplx::task<void> firstHalfTask)
+            {
+                // The first half has settled its own consumptions either way, so the second half still goes out
+                try
+                {
+                    firstHalfTask.get();
+                }
+                catch (const std::exception&)
+                {
+                }
+
+                std::shared_ptr<inventory_consumption_batcher> pThis(thisWeakPtr.lock());
+                if (pThis == nullptr)
+                {
+                    xbox_live_result<consume_inventory_item_result> destroyedResult(xbox_live_error_code::runtime_error, "inventory_service was destroyed.");
+                    for (const auto& consumption : secondHalf)
+                    {
+                        consumption.tce.set(destroyedResult);
+                    }
+                    return pplx::task_from_result();
+                }
+
+                return pThis->send_chunk(consumableUrl, secondHalf, secondTransactionId, splitDepth + 1);
+            });
+        }
+
+        pThis->complete_chunk(consumableUrl, consumptions, result);
+        return pplx::task_from_result();
+    });
+}
+
+void
+inventory_consumption_batcher::complete_chunk(
+    _In_ const string_t& consumableUrl,
+    _In_ const std::vector<inventory_consumption>& consumptions,
+    _In_ const xbox_live_result<consume_inventory_item_result>& result
+    )
+{
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        uint32_t& outstandingQuantity = m_outstandingQuantities[consumableUrl];
+        for (const auto& consumption : consumptions)
+        {
+            outstandingQuantity = outstandingQuantity > consumption.quantity ? outstandingQuantity - consumption.quantity : 0;
+        }
+
+        // A failed chunk needs no rollback; dropping it from the outstanding quantity restores the local balance
+        if (!result.err())
+        {
+            m_serviceBalances[consumableUrl] = result.payload().consumable_balance();
+        }
+    }
+
+    for (const auto& consumption : consumptions)
+    {
+        consumption.tce.set(result);
+    }
+}
+
+bool
+inventory_consumption_batcher::is_rejection(
+    _In_ const std::error_code& errc
+    )
+{
+    // The service looked at the request and refused it, e.g. the aggregate exceeds the remaining balance.
+    // Anything else (network, throttling, server errors) would fail the smaller chunks the same way.
+    return errc == xbox_live_error_code::http_status_400_bad_request ||
+        errc == xbox_live_error_code::http_status_409_conflict;
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MARKETPLACE_CPP_END
@@ -5,7 +5,7 @@
 #include "utils.h"
 #include "user_context.h"
 #include "xbox_system_factory.h"
-#include "xsapi/marketplace.h"
+#include "marketplace_internal.h"
 
 using namespace pplx;
 using namespace xbox::services::system;
@@ -235,6 +235,36 @@ inventory_service::consume_inventory_item(
     });
 }
 
+pplx::task<xbox_live_result<consume_inventory_item_result>>
+inventory_service::consume_inventory_item_batched(
+    _In_ const inventory_item& inventoryItem,
+    _In_ uint32_t quantityToConsume
+    )
+{
+    RETURN_TASK_CPP_INVALIDARGUMENT_IF(m_userContext == nullptr, consume_inventory_item_result, "inventory_service is not initialized");
+    return inventory_consumption_batcher::get_or_create(m_userContext, m_xboxLiveContextSettings)->consume(inventoryItem, quantityToConsume);
+}
+
+uint32_t
+inventory_service::local_consumable_balance(
+    _In_ const inventory_item& inventoryItem
+    )
+{
+    auto batcher = inventory_consumption_batcher::get(m_userContext);
+    if (batcher == nullptr)
+    {
+        return inventoryItem.consumable_balance();
+    }
+    return batcher->local_balance(inventoryItem);
+}
+
+uint32_t
+inventory_service::_Consumption_service_call_count() const
+{
+    auto batcher = inventory_consumption_batcher::get(m_userContext);
+    return batcher == nullptr ? 0 : batcher->service_call_count();
+}
+
 pplx::task<xbox_live_result<inventory_items_result>> 
 inventory_service::get_inventory_items(
     _In_ media_item_type mediaItemType,
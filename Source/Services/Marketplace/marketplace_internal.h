@@ -0,0 +1,81 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+#include "xsapi/marketplace.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MARKETPLACE_CPP_BEGIN
+
+// A single consume request made by the title
+struct inventory_consumption
+{
+    uint32_t quantity;
+    string_t transactionId;
+    pplx::task_completion_event<xbox_live_result<consume_inventory_item_result>> tce;
+};
+
+// Coalesces consumptions of the same consumable made within a short window into a single
+// POST /users/me/consumables/{consumableId} request, so per-use consumption (ammo, boosts)
+// doesn't turn into a call per use.
+// Batchers are looked up by user context rather than held by the public inventory_service, so its layout
+// stays unchanged and copies of a service share one batcher. An entry goes once its user context is released.
+class inventory_consumption_batcher : public std::enable_shared_from_this<inventory_consumption_batcher>
+{
+public:
+    static std::shared_ptr<inventory_consumption_batcher> get(_In_ const std::shared_ptr<xbox::services::user_context>& userContext);
+
+    static std::shared_ptr<inventory_consumption_batcher> get_or_create(
+        _In_ const std::shared_ptr<xbox::services::user_context>& userContext,
+        _In_ const std::shared_ptr<xbox::services::xbox_live_context_settings>& xboxLiveContextSettings
+        );
+
+    inventory_consumption_batcher(
+        _In_ std::shared_ptr<xbox::services::user_context> userContext,
+        _In_ std::shared_ptr<xbox::services::xbox_live_context_settings> xboxLiveContextSettings
+        );
+
+    ~inventory_consumption_batcher();
+
+    pplx::task<xbox_live_result<consume_inventory_item_result>> consume(
+        _In_ const inventory_item& inventoryItem,
+        _In_ uint32_t quantityToConsume
+        );
+
+    // Balance with queued and in flight consumptions already taken off
+    uint32_t local_balance(_In_ const inventory_item& inventoryItem);
+
+    uint32_t service_call_count() const;
+
+private:
+    void flush(_In_ const string_t& consumableUrl);
+
+    pplx::task<void> send_chunk(
+        _In_ const string_t& consumableUrl,
+        _In_ std::vector<inventory_consumption> consumptions,
+        _In_ const string_t& transactionId,
+        _In_ uint32_t splitDepth
+        );
+
+    void complete_chunk(
+        _In_ const string_t& consumableUrl,
+        _In_ const std::vector<inventory_consumption>& consumptions,
+        _In_ const xbox_live_result<consume_inventory_item_result>& result
+        );
+
+    static bool is_rejection(_In_ const std::error_code& errc);
+
+    static const std::chrono::milliseconds CONSUMPTION_WINDOW;
+    static const uint32_t MAX_REPLAY_SPLIT_DEPTH;
+
+    // Weak so the registry entry doesn't keep the user context alive
+    std::weak_ptr<xbox::services::user_context> m_userContext;
+    std::shared_ptr<xbox::services::xbox_live_context_settings> m_xboxLiveContextSettings;
+
+    xsapi_mutex m_lock XSAPI_LOCK_SITE("inventory_consumption_batcher::m_lock");
+    std::unordered_map<string_t, std::vector<inventory_consumption>> m_pendingConsumptions;
+    std::unordered_map<string_t, uint32_t> m_serviceBalances;
+    std::unordered_map<string_t, uint32_t> m_outstandingQuantities;
+    std::atomic<uint32_t> m_serviceCallCount;
+};
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MARKETPLACE_CPP_END
@@ -0,0 +1,167 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#include "utils.h"
+#include "Matchmaking/matchmaking_internal.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MATCHMAKING_CPP_BEGIN
+
+// The hopper's estimate is an average, so a ticket sized to exactly that expires on about half of searches
+const uint32_t match_ticket_lifecycle::HOPPER_WAIT_TIMEOUT_MULTIPLIER = 2;
+
+match_ticket_lifecycle::match_ticket_lifecycle(
+    _In_ match_ticket_retry_policy policy,
+    _In_ web::json::value attributes,
+    _In_ std::chrono::seconds requestedTimeout
+    ) :
+    m_policy(std::move(policy)),
+    m_requestedTimeout(requestedTimeout),
+    m_attributes(std::move(attributes)),
+    m_resubmitCount(0),
+    m_isTicketActive(false),
+    m_completedWaitTicks(0)
+{
+}
+
+pplx::task<std::chrono::seconds>
+match_ticket_lifecycle::choose_ticket_timeout(
+    _In_ matchmaking_service matchmakingService,
+    _In_ const string_t& serviceConfigurationId,
+    _In_ const string_t& hopperName
+    )
+{
+    if (!m_policy.use_hopper_statistics())
+    {
+        return pplx::task_from_result(m_requestedTimeout);
+    }
+
+    auto pThis = shared_from_this();
+    return matchmakingService.get_hopper_statistics(serviceConfigurationId, hopperName)
+    .then([pThis](pplx::task<xbox_live_result<hopper_statistics_response>> statsTask)
+    {
+        try
+        {
+            auto statsResult = statsTask.get();
+            if (!statsResult.err())
+            {
+                return pThis->ticket_timeout_for_estimated_wait(statsResult.payload().estimated_wait_time());
+            }
+        }
+        catch (...)
+        {
+        }
+
+        return pThis->m_requestedTimeout;
+    });
+}
+
+std::chrono::seconds
+match_ticket_lifecycle::ticket_timeout_for_estimated_wait(
+    _In_ const std::chrono::seconds& estimatedWaitTime
+    ) const
+{
+    if (!m_policy.use_hopper_statistics())
+    {
+        return m_requestedTimeout;
+    }
+
+    return __max(m_requestedTimeout, __min(estimatedWaitTime * HOPPER_WAIT_TIMEOUT_MULTIPLIER, m_policy.max_ticket_timeout()));
+}
+
+void
+match_ticket_lifecycle::on_ticket_submitted(
+    _In_ const utility::datetime& now
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    m_isTicketActive = true;
+    m_ticketSubmittedTime = now;
+}
+
+bool
+match_ticket_lifecycle::on_ticket_expired(
+    _In_ const utility::datetime& now
+    )
+{
+    match_ticket_retry_policy::relax_attributes_handler relaxAttributes;
+    web::json::value attributes;
+    uint32_t resubmitCount;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        stop_ticket_clock(now);
+        if (m_resubmitCount >= m_policy.max_resubmits())
+        {
+            return false;
+        }
+
+        resubmitCount = ++m_resubmitCount;
+        relaxAttributes = m_policy.relax_attributes();
+        attributes = m_attributes;
+    }
+
+    // The handler is title code, so it runs without the lock
+    if (relaxAttributes != nullptr)
+    {
+        attributes = relaxAttributes(attributes, resubmitCount);
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        m_attributes = std::move(attributes);
+    }
+
+    LOGS_DEBUG << "match_ticket_lifecycle: resubmitting expired ticket, attempt " << resubmitCount;
+    return true;
+}
+
+void
+match_ticket_lifecycle::on_ticket_finished(
+    _In_ const utility::datetime& now
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    stop_ticket_clock(now);
+}
+
+web::json::value
+match_ticket_lifecycle::attributes() const
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    return m_attributes;
+}
+
+uint32_t
+match_ticket_lifecycle::resubmit_count() const
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    return m_resubmitCount;
+}
+
+std::chrono::seconds
+match_ticket_lifecycle::cumulative_wait_time(
+    _In_ const utility::datetime& now
+    ) const
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    uint64_t waitTicks = m_completedWaitTicks;
+    if (m_isTicketActive && now.to_interval() > m_ticketSubmittedTime.to_interval())
+    {
+        waitTicks += now.to_interval() - m_ticketSubmittedTime.to_interval();
+    }
+
+    // datetime intervals are in 100ns ticks
+    return std::chrono::seconds(waitTicks / 10000000);
+}
+
+void
+match_ticket_lifecycle::stop_ticket_clock(
+    _In_ const utility::datetime& now
+    )
+{
+    if (m_isTicketActive && now.to_interval() > m_ticketSubmittedTime.to_interval())
+    {
+        m_completedWaitTicks += now.to_interval() - m_ticketSubmittedTime.to_interval();
+    }
+
+    m_isTicketActive = false;
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MATCHMAKING_CPP_END
@@ -0,0 +1,72 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#include "xsapi/matchmaking.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MATCHMAKING_CPP_BEGIN
+
+match_ticket_retry_policy::match_ticket_retry_policy() :
+    m_maxResubmits(3),
+    m_useHopperStatistics(true),
+    m_maxTicketTimeout(std::chrono::seconds(300))
+{
+}
+
+uint32_t
+match_ticket_retry_policy::max_resubmits() const
+{
+    return m_maxResubmits;
+}
+
+void
+match_ticket_retry_policy::set_max_resubmits(
+    _In_ uint32_t maxResubmits
+    )
+{
+    m_maxResubmits = maxResubmits;
+}
+
+bool
+match_ticket_retry_policy::use_hopper_statistics() const
+{
+    return m_useHopperStatistics;
+}
+
+void
+match_ticket_retry_policy::set_use_hopper_statistics(
+    _In_ bool useHopperStatistics
+    )
+{
+    m_useHopperStatistics = useHopperStatistics;
+}
+
+const std::chrono::seconds&
+match_ticket_retry_policy::max_ticket_timeout() const
+{
+    return m_maxTicketTimeout;
+}
+
+void
+match_ticket_retry_policy::set_max_ticket_timeout(
+    _In_ const std::chrono::seconds& maxTicketTimeout
+    )
+{
+    m_maxTicketTimeout = maxTicketTimeout;
+}
+
+const match_ticket_retry_policy::relax_attributes_handler&
+match_ticket_retry_policy::relax_attributes() const
+{
+    return m_relaxAttributes;
+}
+
+void
+match_ticket_retry_policy::set_relax_attributes(
+    _In_ relax_attributes_handler handler
+    )
+{
+    m_relaxAttributes = std::move(handler);
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MATCHMAKING_CPP_END
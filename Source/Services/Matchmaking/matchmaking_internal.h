@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+#include "xsapi/matchmaking.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MATCHMAKING_CPP_BEGIN
+
+/// internal class
+/// Tracks one find_match() request across the tickets submitted for it. It chooses each ticket's timeout,
+/// decides whether an expired ticket is resubmitted and with which attributes, and adds up the time spent
+/// waiting on every ticket so far.
+class match_ticket_lifecycle : public std::enable_shared_from_this<match_ticket_lifecycle>
+{
+public:
+    match_ticket_lifecycle(
+        _In_ match_ticket_retry_policy policy,
+        _In_ web::json::value attributes,
+        _In_ std::chrono::seconds requestedTimeout
+        );
+
+    // Reads the hopper's statistics if the policy asks for it. Never fails: without statistics the requested timeout is used.
+    pplx::task<std::chrono::seconds> choose_ticket_timeout(
+        _In_ matchmaking_service matchmakingService,
+        _In_ const string_t& serviceConfigurationId,
+        _In_ const string_t& hopperName
+        );
+
+    std::chrono::seconds ticket_timeout_for_estimated_wait(_In_ const std::chrono::seconds& estimatedWaitTime) const;
+
+    void on_ticket_submitted(_In_ const utility::datetime& now);
+
+    // Stops the clock on the current ticket. Returns true if a replacement should go out, in which case
+    // attributes() already holds the relaxed attributes for it.
+    bool on_ticket_expired(_In_ const utility::datetime& now);
+
+    // Stops the clock on the current ticket once the search has ended for any other reason
+    void on_ticket_finished(_In_ const utility::datetime& now);
+
+    web::json::value attributes() const;
+    uint32_t resubmit_count() const;
+
+    // Includes the time spent so far on a ticket that is still searching
+    std::chrono::seconds cumulative_wait_time(_In_ const utility::datetime& now) const;
+
+    static const uint32_t HOPPER_WAIT_TIMEOUT_MULTIPLIER;
+
+private:
+    void stop_ticket_clock(_In_ const utility::datetime& now);
+
+    mutable xsapi_mutex m_lock XSAPI_LOCK_SITE("match_ticket_lifecycle::m_lock");
+    const match_ticket_retry_policy m_policy;
+    const std::chrono::seconds m_requestedTimeout;
+    web::json::value m_attributes;
+    uint32_t m_resubmitCount;
+    bool m_isTicketActive;
+    utility::datetime m_ticketSubmittedTime;
+    uint64_t m_completedWaitTicks;
+};
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MATCHMAKING_CPP_END
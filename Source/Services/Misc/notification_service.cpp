@@ -20,7 +20,7 @@ std::shared_ptr<notification_service>
 notification_service::get_notification_service_singleton()
 {
     auto xsapiSingleton = get_xsapi_singleton();
-    std::lock_guard<std::mutex> guard(xsapiSingleton->m_singletonLock);
+    std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_singletonLock);
     if (xsapiSingleton->m_notificationSingleton == nullptr)
     {
 #if XSAPI_A
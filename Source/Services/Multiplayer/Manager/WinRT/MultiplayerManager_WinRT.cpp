@@ -32,7 +32,7 @@ MultiplayerManager::SingletonInstance::get()
         MultiplayerManager^ mpManager = ref new MultiplayerManager();
 
         {
-            std::lock_guard<std::mutex> guard(xsapiSingleton->m_singletonLock);
+            std::lock_guard<xbox::services::xsapi_mutex> guard(xsapiSingleton->m_singletonLock);
             if (xsapiSingleton->m_winrt_multiplayerManagerInstance == nullptr)
             {
                 xsapiSingleton->m_winrt_multiplayerManagerInstance = mpManager;
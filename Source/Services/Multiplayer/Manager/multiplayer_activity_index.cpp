@@ -0,0 +1,377 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+
+#include "pch.h"
+#include "multiplayer_manager_internal.h"
+
+using namespace xbox::services;
+using namespace xbox::services::multiplayer;
+using namespace xbox::services::social::manager;
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MULTIPLAYER_MANAGER_CPP_BEGIN
+
+// Upper bound on staleness for users whose presence changes Social Manager doesn't see
+const std::chrono::seconds multiplayer_activity_index::MAX_INDEX_AGE = std::chrono::seconds(60);
+// Social Manager's do_work is expected every frame; after a gap this long its events can't be relied on
+const std::chrono::seconds multiplayer_activity_index::MAX_SOCIAL_EVENT_GAP = std::chrono::seconds(2);
+
+multiplayer_activity_index::multiplayer_activity_index(
+    _In_ const multiplayer_service& multiplayerService,
+    _In_ const string_t& serviceConfigurationId,
+    _In_ const string_t& localXboxUserId,
+    _In_ const string_t& socialGroup,
+    _In_ social_group_member_resolver groupMemberResolver
+    ) :
+    m_multiplayerService(multiplayerService),
+    m_serviceConfigurationId(serviceConfigurationId),
+    m_localXboxUserId(localXboxUserId),
+    m_socialGroup(socialGroup),
+    m_groupMemberResolver(std::move(groupMemberResolver)),
+    m_isSeeded(false),
+    m_isTrackingGroup(false),
+    m_updateInProgress(false),
+    m_socialEventContext(-1),
+    m_serviceCallCount(0)
+{
+    if (m_groupMemberResolver == nullptr)
+    {
+        m_groupMemberResolver = [](const string_t& localXboxUserId, const string_t& socialGroup)
+        {
+            return social_manager::get_singleton_instance()->_Social_group_members(localXboxUserId, socialGroup);
+        };
+    }
+}
+
+multiplayer_activity_index::~multiplayer_activity_index()
+{
+    if (m_socialEventContext != -1)
+    {
+        social_manager::get_singleton_instance()->_Remove_social_event_handler(m_socialEventContext);
+    }
+}
+
+pplx::task<xbox_live_result<std::vector<multiplayer_activity_details>>>
+multiplayer_activity_index::get_activities(
+    _In_ uint32_t titleId,
+    _In_ const string_t& sessionTemplateName
+    )
+{
+    register_social_event_handler();
+
+    std::weak_ptr<multiplayer_activity_index> thisWeakPtr = shared_from_this();
+    return update_index()
+    .then([thisWeakPtr, titleId, sessionTemplateName](xbox_live_result<void> result)
+    {
+        std::shared_ptr<multiplayer_activity_index> pThis(thisWeakPtr.lock());
+        if (pThis == nullptr)
+        {
+            return xbox_live_result<std::vector<multiplayer_activity_details>>(xbox_live_error_code::runtime_error, "Activity index was destroyed.");
+        }
+
+        std::lock_guard<xsapi_mutex> lock(pThis->m_lock);
+        if (result.err() && !pThis->m_isSeeded)
+        {
+            return xbox_live_result<std::vector<multiplayer_activity_details>>(result.err(), result.err_message());
+        }
+
+        // A failed incremental refresh still leaves a usable index; the users are retried next time
+        return xbox_live_result<std::vector<multiplayer_activity_details>>(pThis->query(titleId, sessionTemplateName));
+    });
+}
+
+void
+multiplayer_activity_index::on_social_events(
+    _In_ const std::vector<social_event>& socialEvents
+    )
+{
+    // Only says do_work is being pumped; update_index checks that this user has a graph to hear changes from
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    m_lastSocialEventsTime = std::chrono::steady_clock::now();
+    for (const auto& socialEvent : socialEvents)
+    {
+        if (socialEvent.err() || multiplayer_manager_utils::get_local_user_xbox_user_id(socialEvent.user()) != m_localXboxUserId)
+        {
+            continue;
+        }
+
+        switch (socialEvent.event_type())
+        {
+        case social_event_type::presence_changed:
+        case social_event_type::users_added_to_social_graph:
+            // Users new to the group are picked up when update_index next resolves the members
+            for (const auto& user : socialEvent.users_affected())
+            {
+                string_t xboxUserId = user.xbox_user_id();
+                if (m_groupMembers.find(xboxUserId) != m_groupMembers.end())
+                {
+                    m_changedUsers.insert(xboxUserId);
+                }
+            }
+            break;
+
+        case social_event_type::users_removed_from_social_graph:
+            for (const auto& user : socialEvent.users_affected())
+            {
+                string_t xboxUserId = user.xbox_user_id();
+                m_changedUsers.erase(xboxUserId);
+                m_activities.erase(
+                    std::remove_if(m_activities.begin(), m_activities.end(), [&xboxUserId](const multiplayer_activity_details& activity)
+                    {
+                        return activity.owner_xbox_user_id() == xboxUserId;
+                    }),
+                    m_activities.end()
+                    );
+            }
+            break;
+
+        case social_event_type::local_user_removed:
+            clear();
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+uint32_t
+multiplayer_activity_index::service_call_count() const
+{
+    return m_serviceCallCount;
+}
+
+pplx::task<xbox_live_result<void>>
+multiplayer_activity_index::update_index()
+{
+    // Resolved before taking m_lock, since Social Manager holds its own lock while it calls on_social_events
+    auto groupMembers = m_groupMemberResolver(m_localXboxUserId, m_socialGroup);
+
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    if (m_updateInProgress)
+    {
+        return m_pendingUpdate;
+    }
+
+    bool wasTrackingGroup = m_isTrackingGroup;
+    update_group_members(groupMembers);
+
+    // Changes only reach the index through the local user's social graph and a recent do_work.
+    // Without both, or when the group was only just resolved, only a fresh seed is current.
+    auto now = std::chrono::steady_clock::now();
+    bool isTrackingChanges = wasTrackingGroup && m_isTrackingGroup && (now - m_lastSocialEventsTime) <= MAX_SOCIAL_EVENT_GAP;
+    bool needsSeed = !m_isSeeded || !isTrackingChanges || (now - m_lastSeedTime) > MAX_INDEX_AGE;
+    if (!needsSeed && m_changedUsers.empty())
+    {
+        return pplx::task_from_result(xbox_live_result<void>());
+    }
+
+    std::vector<string_t> changedUsers(m_changedUsers.begin(), m_changedUsers.end());
+    m_changedUsers.clear();
+    m_updateInProgress = true;
+
+    auto updateTask = needsSeed ? seed_index() : refresh_changed_users(changedUsers);
+
+    std::weak_ptr<multiplayer_activity_index> thisWeakPtr = shared_from_this();
+    m_pendingUpdate = updateTask.then([thisWeakPtr, changedUsers](pplx::task<xbox_live_result<void>> updateTask)
+    {
+        // Task-based, so an update that throws still clears m_updateInProgress
+        xbox_live_result<void> result;
+        try
+        {
+            result = updateTask.get();
+        }
+        catch (const std::exception& e)
+        {
+            result = xbox_live_result<void>(xbox_live_error_code::generic_error, e.what());
+        }
+
+        std::shared_ptr<multiplayer_activity_index> pThis(thisWeakPtr.lock());
+        if (pThis != nullptr)
+        {
+            std::lock_guard<xsapi_mutex> lock(pThis->m_lock);
+            pThis->m_updateInProgress = false;
+            if (result.err())
+            {
+                pThis->m_changedUsers.insert(changedUsers.begin(), changedUsers.end());
+            }
+        }
+        return result;
+    });
+
+    return m_pendingUpdate;
+}
+
+pplx::task<xbox_live_result<void>>
+multiplayer_activity_index::seed_index()
+{
+    ++m_serviceCallCount;
+    LOGS_DEBUG << "multiplayer_activity_index: seeding, service calls so far: " << m_serviceCallCount;
+
+    std::weak_ptr<multiplayer_activity_index> thisWeakPtr = shared_from_this();
+    return m_multiplayerService.get_activities_for_social_group(
+        m_serviceConfigurationId,
+        m_localXboxUserId,
+        m_socialGroup
+        )
+    .then([thisWeakPtr](xbox_live_result<std::vector<multiplayer_activity_details>> result)
+    {
+        if (result.err())
+        {
+            return xbox_live_result<void>(result.err(), result.err_message());
+        }
+
+        std::shared_ptr<multiplayer_activity_index> pThis(thisWeakPtr.lock());
+        if (pThis != nullptr)
+        {
+            std::lock_guard<xsapi_mutex> lock(pThis->m_lock);
+            pThis->m_activities = result.payload();
+            pThis->m_isSeeded = true;
+            pThis->m_lastSeedTime = std::chrono::steady_clock::now();
+        }
+        return xbox_live_result<void>();
+    });
+}
+
+pplx::task<xbox_live_result<void>>
+multiplayer_activity_index::refresh_changed_users(
+    _In_ const std::vector<string_t>& changedUsers
+    )
+{
+    ++m_serviceCallCount;
+    LOGS_DEBUG << "multiplayer_activity_index: refreshing " << changedUsers.size() << " users, service calls so far: " << m_serviceCallCount;
+
+    std::weak_ptr<multiplayer_activity_index> thisWeakPtr = shared_from_this();
+    return m_multiplayerService.get_activities_for_users(
+        m_serviceConfigurationId,
+        changedUsers
+        )
+    .then([thisWeakPtr, changedUsers](xbox_live_result<std::vector<multiplayer_activity_details>> result)
+    {
+        if (result.err())
+        {
+            return xbox_live_result<void>(result.err(), result.err_message());
+        }
+
+        std::shared_ptr<multiplayer_activity_index> pThis(thisWeakPtr.lock());
+        if (pThis != nullptr)
+        {
+            std::set<string_t> changedUserSet(changedUsers.begin(), changedUsers.end());
+            std::lock_guard<xsapi_mutex> lock(pThis->m_lock);
+            auto& activities = pThis->m_activities;
+            activities.erase(
+                std::remove_if(activities.begin(), activities.end(), [&changedUserSet](const multiplayer_activity_details& activity)
+                {
+                    return changedUserSet.find(activity.owner_xbox_user_id()) != changedUserSet.end();
+                }),
+                activities.end()
+                );
+
+            const auto& refreshedActivities = result.payload();
+            activities.insert(activities.end(), refreshedActivities.begin(), refreshedActivities.end());
+        }
+        return xbox_live_result<void>();
+    });
+}
+
+std::vector<multiplayer_activity_details>
+multiplayer_activity_index::query(
+    _In_ uint32_t titleId,
+    _In_ const string_t& sessionTemplateName
+    ) const
+{
+    std::vector<multiplayer_activity_details> matchingActivities;
+    for (const auto& activity : m_activities)
+    {
+        if (titleId != 0 && activity.title_id() != titleId)
+        {
+            continue;
+        }
+
+        if (!sessionTemplateName.empty() &&
+            utils::str_icmp(activity.session_reference().session_template_name(), sessionTemplateName) != 0)
+        {
+            continue;
+        }
+
+        matchingActivities.push_back(activity);
+    }
+
+    return matchingActivities;
+}
+
+void
+multiplayer_activity_index::update_group_members(
+    _In_ const xbox_live_result<std::vector<string_t>>& groupMembers
+    )
+{
+    if (groupMembers.err())
+    {
+        m_isTrackingGroup = false;
+        m_groupMembers.clear();
+        return;
+    }
+
+    std::set<string_t> members(groupMembers.payload().begin(), groupMembers.payload().end());
+    if (m_isTrackingGroup)
+    {
+        // Users who joined the group since the last update are queried; users who left it are dropped
+        for (const auto& member : members)
+        {
+            if (m_groupMembers.find(member) == m_groupMembers.end())
+            {
+                m_changedUsers.insert(member);
+            }
+        }
+
+        for (auto iter = m_changedUsers.begin(); iter != m_changedUsers.end();)
+        {
+            iter = members.find(*iter) == members.end() ? m_changedUsers.erase(iter) : std::next(iter);
+        }
+
+        m_activities.erase(
+            std::remove_if(m_activities.begin(), m_activities.end(), [&members](const multiplayer_activity_details& activity)
+            {
+                return members.find(activity.owner_xbox_user_id()) == members.end();
+            }),
+            m_activities.end()
+            );
+    }
+
+    m_groupMembers.swap(members);
+    m_isTrackingGroup = true;
+}
+
+void
+multiplayer_activity_index::clear()
+{
+    // The local user left Social Manager, so nothing the index holds can be kept current
+    m_activities.clear();
+    m_changedUsers.clear();
+    m_groupMembers.clear();
+    m_isTrackingGroup = false;
+    m_isSeeded = false;
+}
+
+void
+multiplayer_activity_index::register_social_event_handler()
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    if (m_socialEventContext != -1)
+    {
+        return;
+    }
+
+    std::weak_ptr<multiplayer_activity_index> thisWeakPtr = shared_from_this();
+    m_socialEventContext = social_manager::get_singleton_instance()->_Add_social_event_handler(
+        [thisWeakPtr](const std::vector<social_event>& socialEvents)
+        {
+            std::shared_ptr<multiplayer_activity_index> pThis(thisWeakPtr.lock());
+            if (pThis != nullptr)
+            {
+                pThis->on_social_events(socialEvents);
+            }
+        });
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MULTIPLAYER_MANAGER_CPP_END
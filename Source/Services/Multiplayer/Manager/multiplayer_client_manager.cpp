@@ -19,7 +19,7 @@ NAMESPACE_MICROSOFT_XBOX_SERVICES_MULTIPLAYER_MANAGER_CPP_BEGIN
 
 multiplayer_client_manager::multiplayer_client_manager(const multiplayer_client_manager& other) 
 {
-    std::lock_guard<std::mutex> lock(other.m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(other.m_clientRequestLock);
 
     m_sessionChangedContext = other.m_sessionChangedContext;
     m_subscriptionLostContext = other.m_subscriptionLostContext;
@@ -95,7 +95,7 @@ multiplayer_client_manager::initialize()
 
 void multiplayer_client_manager::shutdown()
 {
-    std::lock_guard<std::mutex> guard(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> guard(m_clientRequestLock);
     destroy();
 }
 
@@ -104,6 +104,7 @@ multiplayer_client_manager::destroy()
 {
     m_latestPendingRead.reset();
     m_lastPendingRead.reset();
+    m_activityIndexes.clear();
     if (m_multiplayerLocalUserManager != nullptr)
     {
         m_multiplayerLocalUserManager->remove_multiplayer_session_changed_handler(m_sessionChangedContext);
@@ -130,7 +131,7 @@ multiplayer_client_manager::set_properties(
     // Note: sessionRef can be empty for the lobby initially as we may have not created one yet.
     RETURN_CPP_IF(name.empty(), void, xbox_live_error_code::invalid_argument, "Name was empty");
 
-    std::lock_guard<std::mutex> guard(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> guard(m_clientRequestLock);
     auto latestPending = latest_pending_read();
     RETURN_CPP_IF(latestPending == nullptr || get_xbox_live_context_map().size() == 0, void, xbox_live_error_code::logic_error, "Call add_local_user() before writing lobby properties.");
 
@@ -144,7 +145,7 @@ multiplayer_client_manager::set_joinability(
     _In_opt_ context_t context
     )
 {
-    std::lock_guard<std::mutex> guard(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> guard(m_clientRequestLock);
     auto latestPending = latest_pending_read();
     RETURN_CPP_IF(latestPending == nullptr || get_xbox_live_context_map().size() == 0, void, xbox_live_error_code::logic_error, "Call add_local_user() before writing lobby properties.");
 
@@ -161,7 +162,7 @@ multiplayer_client_manager::set_synchronized_host(
     // Note: sessionRef can be empty for the lobby initially as we may have not created one yet.
     RETURN_CPP_IF(hostDeviceToken.empty(), void, xbox_live_error_code::invalid_argument, "HostDeviceToken was empty");
 
-    std::lock_guard<std::mutex> guard(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> guard(m_clientRequestLock);
     auto latestPending = latest_pending_read();
     RETURN_CPP_IF(latestPending == nullptr || get_xbox_live_context_map().size() == 0, void, xbox_live_error_code::logic_error, "Call add_local_user() before writing host properties.");
 
@@ -180,7 +181,7 @@ multiplayer_client_manager::set_synchronized_properties(
     // Note: sessionRef can be empty for the lobby initially as we may have not created one yet.
     RETURN_CPP_IF(name.empty(), void, xbox_live_error_code::invalid_argument, "Name was empty");
 
-    std::lock_guard<std::mutex> guard(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> guard(m_clientRequestLock);
     auto latestPending = latest_pending_read();
     RETURN_CPP_IF(latestPending == nullptr || get_xbox_live_context_map().size() == 0, void, xbox_live_error_code::logic_error, "Call add_local_user() before writing lobby properties.");
 
@@ -306,7 +307,7 @@ multiplayer_client_manager::join_lobby(
     if (!invitedUserFound)
     {
         // The invited user hasn't been added.
-        std::shared_ptr<join_lobby_completed_event_args> joinLobbyEventArgs = std::make_shared<join_lobby_completed_event_args>(invitedXuid);
+        std::shared_ptr<join_lobby_completed_event_args> joinLobbyEventArgs = make_event_args<join_lobby_completed_event_args>(invitedXuid);
 
         multiplayer_event multiplayerEvent(
             xbox_live_error_code::logic_error,
@@ -416,7 +417,7 @@ multiplayer_client_manager::join_game(
                     result.err(),
                     result.err_message(),
                     multiplayer_event_type::join_game_completed,
-                    std::make_shared<multiplayer_event_args>(),
+                    make_event_args<multiplayer_event_args>(),
                     multiplayer_session_type::game_session
                     );
 
@@ -464,15 +465,37 @@ multiplayer_client_manager::leave_game()
 pplx::task<xbox_live_result<std::vector<multiplayer_activity_details>>>
 multiplayer_client_manager::get_activities_for_social_group(
     _In_ xbox_live_user_t user,
-    _In_ const string_t& socialGroup
+    _In_ const string_t& socialGroup,
+    _In_ uint32_t titleId,
+    _In_ const string_t& sessionTemplateName
     )
 {
     RETURN_TASK_CPP_INVALIDARGUMENT_IF(user == nullptr, std::vector<multiplayer_activity_details>, "Invalid xboxLiveContext argument passed.");
+    RETURN_TASK_CPP_INVALIDARGUMENT_IF_STRING_EMPTY(socialGroup, std::vector<multiplayer_activity_details>, "socialGroup is empty");
+
+    string_t xboxUserId = multiplayer_manager_utils::get_local_user_xbox_user_id(user);
+    std::shared_ptr<multiplayer_activity_index> activityIndex;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
+        string_t indexKey = xboxUserId + _T("/") + socialGroup;
+        auto iter = m_activityIndexes.find(indexKey);
+        if (iter == m_activityIndexes.end())
+        {
+            activityIndex = std::make_shared<multiplayer_activity_index>(
+                get_multiplayer_service(user),
+                utils::try_get_override_scid(),
+                xboxUserId,
+                socialGroup
+                );
+            m_activityIndexes[indexKey] = activityIndex;
+        }
+        else
+        {
+            activityIndex = iter->second;
+        }
+    }
 
-    return get_multiplayer_service(user).get_activities_for_social_group(
-        utils::try_get_override_scid(),
-        multiplayer_manager_utils::get_local_user_xbox_user_id(user),
-        socialGroup);
+    return activityIndex->get_activities(titleId, sessionTemplateName);
 }
 
 xbox_live_result<void>
@@ -613,7 +636,7 @@ multiplayer_client_manager::latest_pending_read() const
 std::shared_ptr<multiplayer_client_pending_reader>
 multiplayer_client_manager::last_pending_read() const
 {
-    std::lock_guard<std::mutex> guard(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> guard(m_clientRequestLock);
     return m_lastPendingRead;
 }
 
@@ -662,7 +685,7 @@ multiplayer_client_manager::is_update_avaialable()
 std::vector<multiplayer_event>
 multiplayer_client_manager::do_work()
 {
-    std::lock_guard<std::mutex> guard(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> guard(m_clientRequestLock);
 
     if (m_latestPendingRead == nullptr)
     {
@@ -676,7 +699,7 @@ multiplayer_client_manager::do_work()
     process_events(m_latestPendingRead->match_client()->session(), m_lastPendingRead->match_client()->session(), multiplayer_session_type::match_session);
 
     m_lastPendingRead->deep_copy_if_updated(*m_latestPendingRead);
-    auto eventQueue = m_lastPendingRead->multiplayer_event_queue();
+    auto eventQueue = m_lastPendingRead->take_multiplayer_event_queue();
 
     if (get_xbox_live_context_map().size() == 0 && !is_request_in_progress())
     {
@@ -720,7 +743,7 @@ multiplayer_client_manager::on_multiplayer_subscriptions_lost()
         std::shared_ptr<multiplayer_client_manager> pThis(thisWeakPtr.lock());
         if (pThis != nullptr)
         {
-            std::lock_guard<std::mutex> guard(pThis->m_clientRequestLock);
+            std::lock_guard<xsapi_mutex> guard(pThis->m_clientRequestLock);
 
             bool expected = false;
             if (pThis->m_subscriptionsLostFired.compare_exchange_strong(expected, true))
@@ -761,7 +784,7 @@ multiplayer_client_manager::on_session_changed(
     _In_ const multiplayer_session_change_event_args& args
     )
 {
-    std::lock_guard<std::mutex> guard(m_synchronizeWriteWithTapLock);
+    std::lock_guard<xsapi_mutex> guard(m_synchronizeWriteWithTapLock);
 
     if (m_latestPendingRead != nullptr)
     {
@@ -783,17 +806,15 @@ multiplayer_client_manager::on_session_changed(
 }
 
 std::vector<multiplayer_event>
-multiplayer_client_manager::event_queue() const
+multiplayer_client_manager::take_event_queue()
 {
-    std::lock_guard<std::mutex> guard(m_clientRequestLock);
-    return m_multiplayerEventQueue;
-}
+    std::vector<multiplayer_event> eventQueue;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
+        eventQueue.swap(m_multiplayerEventQueue);
+    }
 
-void
-multiplayer_client_manager::clear_event_queue()
-{
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
-    m_multiplayerEventQueue.clear();
+    return eventQueue;
 }
 
 void
@@ -805,7 +826,7 @@ multiplayer_client_manager::add_to_multiplayer_event_queue(
 
     if (m_latestPendingRead != nullptr)
     {
-        m_latestPendingRead->add_to_multiplayer_event_queue(multiplayerEvent);
+        m_latestPendingRead->add_to_multiplayer_event_queue(std::move(multiplayerEvent));
     }
 }
 
@@ -821,7 +842,7 @@ multiplayer_client_manager::add_multiplayer_event_helper(
         errorCode,
         errorMessage,
         eventType,
-        std::make_shared<multiplayer_event_args>(),
+        make_event_args<multiplayer_event_args>(),
         sessionType
         );
 
@@ -836,7 +857,7 @@ multiplayer_client_manager::add_multiplayer_event(
     _In_ std::string errorMessage
     )
 {
-    std::lock_guard<std::mutex> guard(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> guard(m_clientRequestLock);
     add_multiplayer_event_helper(eventType, sessionType, errorCode, errorMessage);
 }
 
@@ -990,7 +1011,7 @@ multiplayer_client_manager::handle_member_list_changed(
                 gameMembers.push_back(latestPendingRead->convert_to_game_member(member));
             }
 
-            std::shared_ptr<member_joined_event_args> memberJoinedEventArgs = std::make_shared<member_joined_event_args>(
+            std::shared_ptr<member_joined_event_args> memberJoinedEventArgs = make_event_args<member_joined_event_args>(
                 gameMembers
                 );
 
@@ -1013,7 +1034,7 @@ multiplayer_client_manager::handle_member_list_changed(
                 gameMembers.push_back(latestPendingRead->convert_to_game_member(member));
             }
 
-            std::shared_ptr<member_left_event_args> memberLeftEventArgs = std::make_shared<member_left_event_args>(
+            std::shared_ptr<member_left_event_args> memberLeftEventArgs = make_event_args<member_left_event_args>(
                 gameMembers
                 );
 
@@ -1076,7 +1097,7 @@ multiplayer_client_manager::handle_member_properties_changed(
             {
                 continue;
             }
-            std::shared_ptr<member_property_changed_event_args> memberPropertiesChangedArgs = std::make_shared<member_property_changed_event_args>(
+            std::shared_ptr<member_property_changed_event_args> memberPropertiesChangedArgs = make_event_args<member_property_changed_event_args>(
                 latestPendingRead->convert_to_game_member(member),
                 member->member_custom_properties_json()
                 );
@@ -1129,7 +1150,7 @@ multiplayer_client_manager::handle_session_properties_changed(
         return;
     }
 
-    auto gamePropertiesChangedArgs = std::make_shared<session_property_changed_event_args>(
+    auto gamePropertiesChangedArgs = make_event_args<session_property_changed_event_args>(
         currentSession->session_properties()->session_custom_properties_json()
         );
 
@@ -1162,7 +1183,7 @@ multiplayer_client_manager::handle_host_changed(
         }
     }
 
-    std::shared_ptr<host_changed_event_args> hostChangedEventArgs = std::make_shared<host_changed_event_args>(
+    std::shared_ptr<host_changed_event_args> hostChangedEventArgs = make_event_args<host_changed_event_args>(
         hostMember
         );
 
@@ -1189,7 +1210,7 @@ multiplayer_client_manager::handle_tournament_properties_changed(
     if (currTournamentsServer.registration_state() != oldTournamentsServer.registration_state() ||
         currTournamentsServer.registration_reason() != oldTournamentsServer.registration_reason())
     {
-        auto registrationStateChangedEventArgs = std::make_shared<tournament_registration_state_changed_event_args>(
+        auto registrationStateChangedEventArgs = make_event_args<tournament_registration_state_changed_event_args>(
             currTournamentsServer.registration_state(),
             currTournamentsServer.registration_reason()
             );
@@ -1235,12 +1256,13 @@ xbox_live_result<void>
 multiplayer_client_manager::find_match(
     _In_ const string_t& hopperName,
     _In_ const web::json::value& attributes,
-    _In_ const std::chrono::seconds& timeout
+    _In_ const std::chrono::seconds& timeout,
+    _In_ std::shared_ptr<xbox::services::matchmaking::match_ticket_retry_policy> retryPolicy
 )
 {
     auto latestPendingRead = latest_pending_read();
     RETURN_CPP_IF(latestPendingRead == nullptr || latestPendingRead->lobby_client()->session() == nullptr, void, xbox_live_error_code::logic_error, "No local user added. Call add_local_user() first.");
-    return latestPendingRead->find_match(hopperName, attributes, timeout);
+    return latestPendingRead->find_match(hopperName, attributes, timeout, retryPolicy);
 }
 
 void
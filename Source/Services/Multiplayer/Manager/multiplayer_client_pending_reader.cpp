@@ -13,7 +13,7 @@ void multiplayer_client_pending_reader::deep_copy_if_updated(
     _In_ const multiplayer_client_pending_reader& other
     )
 {
-    std::lock_guard<std::mutex> lock(other.m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(other.m_clientRequestLock);
 
     m_multiplayerEventQueue = other.m_multiplayerEventQueue;
     if (other.m_lobbyClient == nullptr)
@@ -80,7 +80,7 @@ multiplayer_client_pending_reader::is_update_avaialable(
     _In_ const multiplayer_client_pending_reader& other
     )
 {
-    std::lock_guard<std::mutex> lock(other.m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(other.m_clientRequestLock);
 
     if (other.m_lobbyClient->is_pending_lobby_changes() ||
         other.m_gameClient->is_pending_game_changes())
@@ -130,7 +130,7 @@ multiplayer_client_pending_reader::update_session(
     _In_ std::shared_ptr<multiplayer_session> session
     )
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
 
     if (is_lobby(sessionRef))
     {
@@ -198,40 +198,53 @@ multiplayer_client_pending_reader::is_match(
     return multiplayer_manager_utils::do_session_references_match(sessionRef, m_matchClient->session()->session_reference());
 }
 
-std::vector<multiplayer_event>
+const std::vector<multiplayer_event>&
 multiplayer_client_pending_reader::multiplayer_event_queue() const
 {
     return m_multiplayerEventQueue;
 }
 
+std::vector<multiplayer_event>
+multiplayer_client_pending_reader::take_multiplayer_event_queue()
+{
+    std::vector<multiplayer_event> eventQueue;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
+        eventQueue.swap(m_multiplayerEventQueue);
+    }
+
+    return eventQueue;
+}
+
 void
 multiplayer_client_pending_reader::add_to_multiplayer_event_queue(
     _In_ multiplayer_event multiplayerEvent
     )
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
-    m_multiplayerEventQueue.push_back(multiplayerEvent);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
+    m_multiplayerEventQueue.push_back(std::move(multiplayerEvent));
 }
 
 void
 multiplayer_client_pending_reader::add_to_multiplayer_event_queue(
-    _In_ std::vector<multiplayer_event> multiplayerEventQueue
+    _In_ std::vector<multiplayer_event>&& multiplayerEventQueue
     )
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
-    if (multiplayerEventQueue.size() > 0)
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
+    if (m_multiplayerEventQueue.empty())
     {
-        for (const auto& multiplayerEvent : multiplayerEventQueue)
-        {
-            m_multiplayerEventQueue.push_back(multiplayerEvent);
-        }
+        m_multiplayerEventQueue.swap(multiplayerEventQueue);
+    }
+    else
+    {
+        std::move(multiplayerEventQueue.begin(), multiplayerEventQueue.end(), std::back_inserter(m_multiplayerEventQueue));
     }
 }
 
 void
 multiplayer_client_pending_reader::clear_multiplayer_event_queue()
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
     m_multiplayerEventQueue.clear();
 }
 
@@ -255,11 +268,8 @@ multiplayer_client_pending_reader::do_work()
     m_lobbyClient->update_objects(lobbySession, gameSession);
     m_gameClient->update_objects(gameSession, lobbySession);
 
-    auto lobbyClientEventQueue = m_lobbyClient->do_work();
-    add_to_multiplayer_event_queue(lobbyClientEventQueue);
-
-    auto gameClientEventQueue = m_gameClient->do_work();
-    add_to_multiplayer_event_queue(gameClientEventQueue);
+    add_to_multiplayer_event_queue(m_lobbyClient->do_work());
+    add_to_multiplayer_event_queue(m_gameClient->do_work());
 
     process_match_events();
 }
@@ -429,7 +439,8 @@ xbox_live_result<void>
 multiplayer_client_pending_reader::find_match(
     _In_ const string_t& hopperName,
     _In_ const web::json::value& attributes,
-    _In_ const std::chrono::seconds& timeout
+    _In_ const std::chrono::seconds& timeout,
+    _In_ std::shared_ptr<xbox::services::matchmaking::match_ticket_retry_policy> retryPolicy
     )
 {
     RETURN_CPP_IF(!m_autoFillMembers && m_gameClient->session() != nullptr, void, xbox_live_error_code::logic_error, "A game already exists. Call leave_game() before you can start matchmaking.");
@@ -437,10 +448,10 @@ multiplayer_client_pending_reader::find_match(
 
     if (m_autoFillMembers && m_gameClient->session() != nullptr)
     {
-        return m_matchClient->find_match(hopperName, attributes, timeout, m_gameClient->session(), true);
+        return m_matchClient->find_match(hopperName, attributes, timeout, m_gameClient->session(), true, retryPolicy);
     }
 
-    return m_matchClient->find_match(hopperName, attributes, timeout, m_lobbyClient->session(), false);
+    return m_matchClient->find_match(hopperName, attributes, timeout, m_lobbyClient->session(), false, retryPolicy);
 }
 
 void
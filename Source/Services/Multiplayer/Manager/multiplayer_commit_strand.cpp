@@ -0,0 +1,81 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+
+#include "pch.h"
+#include "multiplayer_manager_internal.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MULTIPLAYER_MANAGER_CPP_BEGIN
+
+multiplayer_commit_strand::multiplayer_commit_strand() :
+    m_isBusy(false)
+{
+}
+
+bool
+multiplayer_commit_strand::try_acquire()
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    if (m_isBusy)
+    {
+        return false;
+    }
+
+    m_isBusy = true;
+    return true;
+}
+
+pplx::task<void>
+multiplayer_commit_strand::acquire()
+{
+    pplx::task_completion_event<void> tce;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        if (m_isBusy)
+        {
+            m_waiters.push(tce);
+            return pplx::create_task(tce);
+        }
+
+        m_isBusy = true;
+    }
+
+    return pplx::task_from_result();
+}
+
+void
+multiplayer_commit_strand::release()
+{
+    pplx::task_completion_event<void> next;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        if (m_waiters.empty())
+        {
+            m_isBusy = false;
+            return;
+        }
+
+        // Ownership passes straight to the next waiter so do_work() can't slip in between.
+        next = m_waiters.front();
+        m_waiters.pop();
+    }
+
+    // Resume the waiter outside the lock; its continuation may re-enter the strand.
+    next.set();
+}
+
+bool
+multiplayer_commit_strand::is_busy() const
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    return m_isBusy;
+}
+
+size_t
+multiplayer_commit_strand::waiter_count() const
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    return m_waiters.size();
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MULTIPLAYER_MANAGER_CPP_END
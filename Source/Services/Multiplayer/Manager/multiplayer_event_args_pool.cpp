@@ -0,0 +1,130 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+
+#include "pch.h"
+#include "multiplayer_manager_internal.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MULTIPLAYER_MANAGER_CPP_BEGIN
+
+// Size classes of 64, 128, ... 512 bytes cover every event args type plus its shared_ptr control block
+const size_t multiplayer_event_args_pool::SIZE_CLASS_GRANULARITY = 64;
+const size_t multiplayer_event_args_pool::SIZE_CLASS_COUNT = 8;
+
+// Bounds what an event burst can leave parked on the free lists, and how far a free list is scanned
+const size_t multiplayer_event_args_pool::MAX_FREE_BLOCKS_PER_SIZE_CLASS = 64;
+
+multiplayer_event_args_pool*
+multiplayer_event_args_pool::get_singleton_instance()
+{
+    static multiplayer_event_args_pool* s_multiplayerEventArgsPool = new multiplayer_event_args_pool();
+    return s_multiplayerEventArgsPool;
+}
+
+multiplayer_event_args_pool::multiplayer_event_args_pool() :
+    m_freeSlots(new std::atomic<void*>[SIZE_CLASS_COUNT * MAX_FREE_BLOCKS_PER_SIZE_CLASS]),
+    m_freeCounts(new std::atomic<int32_t>[SIZE_CLASS_COUNT]),
+    m_recycledCount(0),
+    m_heapAllocationCount(0)
+{
+    for (size_t i = 0; i < SIZE_CLASS_COUNT * MAX_FREE_BLOCKS_PER_SIZE_CLASS; ++i)
+    {
+        m_freeSlots[i].store(nullptr);
+    }
+    for (size_t i = 0; i < SIZE_CLASS_COUNT; ++i)
+    {
+        m_freeCounts[i].store(0);
+    }
+}
+
+multiplayer_event_args_pool::~multiplayer_event_args_pool()
+{
+    for (size_t i = 0; i < SIZE_CLASS_COUNT * MAX_FREE_BLOCKS_PER_SIZE_CLASS; ++i)
+    {
+        ::operator delete(m_freeSlots[i].load());
+    }
+}
+
+size_t
+multiplayer_event_args_pool::size_class(
+    _In_ size_t size
+    )
+{
+    return (size + SIZE_CLASS_GRANULARITY - 1) / SIZE_CLASS_GRANULARITY - 1;
+}
+
+void*
+multiplayer_event_args_pool::allocate(
+    _In_ size_t size
+    )
+{
+    size_t sizeClass = size_class(size);
+    if (size == 0 || sizeClass >= SIZE_CLASS_COUNT)
+    {
+        ++m_heapAllocationCount;
+        return ::operator new(size);
+    }
+
+    if (m_freeCounts[sizeClass].load(std::memory_order_relaxed) > 0)
+    {
+        std::atomic<void*>* freeList = &m_freeSlots[sizeClass * MAX_FREE_BLOCKS_PER_SIZE_CLASS];
+        for (size_t i = 0; i < MAX_FREE_BLOCKS_PER_SIZE_CLASS; ++i)
+        {
+            // Only one thread can swap a given block out, so a block is never handed out twice
+            void* block = freeList[i].exchange(nullptr, std::memory_order_acquire);
+            if (block != nullptr)
+            {
+                m_freeCounts[sizeClass].fetch_sub(1, std::memory_order_relaxed);
+                ++m_recycledCount;
+                return block;
+            }
+        }
+    }
+
+    ++m_heapAllocationCount;
+    return ::operator new((sizeClass + 1) * SIZE_CLASS_GRANULARITY);
+}
+
+void
+multiplayer_event_args_pool::deallocate(
+    _In_ void* block,
+    _In_ size_t size
+    )
+{
+    if (block == nullptr)
+    {
+        return;
+    }
+
+    size_t sizeClass = size_class(size);
+    if (size != 0 && sizeClass < SIZE_CLASS_COUNT &&
+        m_freeCounts[sizeClass].load(std::memory_order_relaxed) < static_cast<int32_t>(MAX_FREE_BLOCKS_PER_SIZE_CLASS))
+    {
+        std::atomic<void*>* freeList = &m_freeSlots[sizeClass * MAX_FREE_BLOCKS_PER_SIZE_CLASS];
+        for (size_t i = 0; i < MAX_FREE_BLOCKS_PER_SIZE_CLASS; ++i)
+        {
+            void* emptySlot = nullptr;
+            if (freeList[i].compare_exchange_strong(emptySlot, block, std::memory_order_release, std::memory_order_relaxed))
+            {
+                m_freeCounts[sizeClass].fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+
+    ::operator delete(block);
+}
+
+uint64_t
+multiplayer_event_args_pool::recycled_count() const
+{
+    return m_recycledCount;
+}
+
+uint64_t
+multiplayer_event_args_pool::heap_allocation_count() const
+{
+    return m_heapAllocationCount;
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MULTIPLAYER_MANAGER_CPP_END
@@ -11,8 +11,7 @@ using namespace xbox::services::multiplayer;
 NAMESPACE_MICROSOFT_XBOX_SERVICES_MULTIPLAYER_MANAGER_CPP_BEGIN
 
 multiplayer_game_client::multiplayer_game_client() :
-    m_updateNumber(0),
-    m_pendingCommitInProgress(false)
+    m_updateNumber(0)
 {
     m_sessionWriter = std::make_shared<multiplayer_session_writer>();
 }
@@ -21,8 +20,7 @@ multiplayer_game_client::multiplayer_game_client(
     _In_ std::shared_ptr<multiplayer_local_user_manager> localUserManager
     ) :
     m_multiplayerLocalUserManager(localUserManager),
-    m_updateNumber(0),
-    m_pendingCommitInProgress(false)
+    m_updateNumber(0)
 {
     m_sessionWriter = std::make_shared<multiplayer_session_writer>(m_multiplayerLocalUserManager);
 }
@@ -77,7 +75,7 @@ multiplayer_game_client::deep_copy_if_updated(
     _In_ const multiplayer_game_client& other
     )
 {
-    std::lock_guard<std::mutex> lock(other.m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(other.m_clientRequestLock);
 
     if (other.m_sessionWriter->session() == nullptr)
     {
@@ -125,7 +123,7 @@ multiplayer_game_client::update_game(
 const std::shared_ptr<multiplayer_session>&
 multiplayer_game_client::session() const
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
     return m_sessionWriter->session();
 }
 
@@ -148,7 +146,7 @@ multiplayer_game_client::update_game_session(
     _In_ const std::shared_ptr<multiplayer_session>& updatedSession
     )
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
     m_sessionWriter->update_session(updatedSession);
 }
 
@@ -158,7 +156,7 @@ multiplayer_game_client::update_objects(
     const std::shared_ptr<multiplayer_session>& lobbySession
     )
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
     if (updatedSession == nullptr)
     {
         update_game(nullptr);
@@ -217,7 +215,7 @@ multiplayer_game_client::multiplayer_event_queue()
 void
 multiplayer_game_client::clear_pending_queue()
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
     while (!m_pendingRequestQueue.empty())
     {
         m_pendingRequestQueue.pop();
@@ -229,7 +227,7 @@ multiplayer_game_client::add_to_pending_queue(
     _In_ std::shared_ptr<multiplayer_client_pending_request> pendingRequest
     )
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
     m_pendingRequestQueue.push(pendingRequest);
 }
 
@@ -268,8 +266,7 @@ multiplayer_game_client::get_processing_queue()
 std::vector<multiplayer_event>
 multiplayer_game_client::do_work()
 {
-    bool expected = false;
-    if (m_pendingCommitInProgress.compare_exchange_strong(expected, true))
+    if (m_commitStrand.try_acquire())
     {
         if (m_pendingRequestQueue.size() > 0)
         {
@@ -278,7 +275,7 @@ multiplayer_game_client::do_work()
             bool doneProcessing = false;
             do
             {
-                std::lock_guard<std::mutex> lock(m_clientRequestLock);
+                std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
                 {
                     auto pendingRequest = m_pendingRequestQueue.front();
                     processingQueue.push_back(pendingRequest);
@@ -316,45 +313,50 @@ multiplayer_game_client::do_work()
                 std::weak_ptr<multiplayer_game_client> thisWeakPtr = shared_from_this();
 
                 create_task(asyncOp)
-                .then([thisWeakPtr, processingQueue](xbox_live_result<std::vector<multiplayer_event>> result)
+                .then([thisWeakPtr, processingQueue](pplx::task<xbox_live_result<std::vector<multiplayer_event>>> t)
                 {
                     std::shared_ptr<multiplayer_game_client> pThis(thisWeakPtr.lock());
                     if (pThis != nullptr)
                     {
-                        std::lock_guard<std::mutex> lock(pThis->m_clientRequestLock);
+                        // The strand is released however the commit ends, or every later commit would queue behind it forever.
+                        std::lock_guard<xsapi_mutex> lock(pThis->m_clientRequestLock);
+                        try
                         {
-                            auto eventQueue = result.payload();
+                            auto eventQueue = t.get().payload();
                             for (const auto& ev : eventQueue)
                             {
                                 pThis->m_multiplayerEventQueue.push_back(ev);
                             }
                         }
+                        catch (...)
+                        {
+                            LOG_ERROR("multiplayer_game_client::do_work commit threw an exception");
+                        }
 
                         for (const auto& processingRequest : processingQueue)
                         {
                             pThis->remove_from_processing_queue(processingRequest->identifier());
                         }
 
-                        pThis->m_pendingCommitInProgress.store(false);
+                        pThis->m_commitStrand.release();
                     }
                 });
             }
             else
             {
-                m_pendingCommitInProgress.store(false);
+                m_commitStrand.release();
             }
         }
         else
         {
-            m_pendingCommitInProgress.store(false);
+            m_commitStrand.release();
         }
     }
 
     std::vector<multiplayer_event> eventQueue;
     {
-        std::lock_guard<std::mutex> lock(m_clientRequestLock);
-        eventQueue = m_multiplayerEventQueue;
-        m_multiplayerEventQueue.clear();
+        std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
+        eventQueue.swap(m_multiplayerEventQueue);
     }
 
     return eventQueue;
@@ -363,7 +365,7 @@ multiplayer_game_client::do_work()
 bool
 multiplayer_game_client::is_pending_game_changes()
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
     if (m_pendingRequestQueue.size() > 0)
     {
         return true;
@@ -401,21 +403,23 @@ multiplayer_game_client::set_local_member_properties_to_remote_session(
         return;
     }
 
+    // Queue behind any in-flight commit rather than spinning a pool thread until it finishes.
     std::weak_ptr<multiplayer_game_client> thisWeakPtr = shared_from_this();
-    pplx::create_task([thisWeakPtr, localUser, localUserMap, localUserConnectionAddress]()
+    m_commitStrand.acquire()
+    .then([thisWeakPtr, localUser, localUserMap, localUserConnectionAddress]()
     {
         std::shared_ptr<multiplayer_game_client> pThis(thisWeakPtr.lock());
         if (pThis == nullptr) return;
 
-        bool expected = false;
-        while (!pThis->m_pendingCommitInProgress.compare_exchange_weak(expected, true))
+        auto gameSession = pThis->session();
+        if (gameSession == nullptr)
         {
-            expected = false;
-            utils::sleep(0);
+            pThis->m_commitStrand.release();
+            return;
         }
 
-        auto gameSession = pThis->session();
-        if (gameSession != nullptr)
+        pplx::task<xbox_live_result<std::shared_ptr<multiplayer_session>>> writeTask;
+        try
         {
             auto sessionToCommit = std::make_shared<multiplayer_session>(localUser->xbox_user_id(), gameSession->session_reference());
             sessionToCommit->join(web::json::value::null(), false, true, false);
@@ -428,11 +432,24 @@ multiplayer_game_client::set_local_member_properties_to_remote_session(
             {
                 sessionToCommit->set_current_user_secure_device_address_base64(localUserConnectionAddress);
             }
-            
-            pThis->m_sessionWriter->write_session(localUser->context(), sessionToCommit, multiplayer_session_write_mode::update_existing).get();
+
+            writeTask = pThis->m_sessionWriter->write_session(localUser->context(), sessionToCommit, multiplayer_session_write_mode::update_existing);
+        }
+        catch (...)
+        {
+            LOG_ERROR("multiplayer_game_client::set_local_member_properties_to_remote_session threw an exception");
+            pThis->m_commitStrand.release();
+            return;
         }
 
-        pThis->m_pendingCommitInProgress = false;
+        writeTask.then([thisWeakPtr](pplx::task<xbox_live_result<std::shared_ptr<multiplayer_session>>> t)
+        {
+            std::shared_ptr<multiplayer_game_client> pThis(thisWeakPtr.lock());
+            if (pThis != nullptr)
+            {
+                pThis->m_commitStrand.release();
+            }
+        });
     });
 }
 
@@ -658,7 +675,7 @@ multiplayer_game_client::join_game_for_all_local_members(
             joinResult.err(), 
             joinResult.err_message(),
             multiplayer_event_type::join_game_completed,
-            std::make_shared<multiplayer_event_args>()
+            make_event_args<multiplayer_event_args>()
             );
         return joinResult;
     });
@@ -742,7 +759,7 @@ multiplayer_game_client::leave_remote_session(
                     xbox_live_error_code::no_error,
                     std::string(),
                     multiplayer_event_type::leave_game_completed,
-                    std::make_shared<multiplayer_event_args>()
+                    make_event_args<multiplayer_event_args>()
                 );
 
                 pThis->remove_from_processing_queue(processingRequest->identifier());
@@ -760,7 +777,7 @@ multiplayer_game_client::add_multiplayer_event_helper(
     _In_opt_ context_t context
     )
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
 
     multiplayer_event multiplayerEvent(
         errorCode,
@@ -4,8 +4,14 @@
 
 #include "pch.h"
 #include "multiplayer_manager_internal.h"
+#if !XSAPI_U
+#include "ppltasks_extra.h"
+#else
+#include "ppltasks_extra_unix.h"
+#endif
 
 using namespace xbox::services::multiplayer;
+using namespace Concurrency::extras;
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_MULTIPLAYER_MANAGER_CPP_BEGIN
 const string_t multiplayer_lobby_client::c_transferHandlePropertyName = _T("GameSessionTransferHandle");
@@ -18,7 +24,6 @@ const std::chrono::seconds RETRY_LENGTH(1);
 const int MAX_CONNECTION_ATTEMPTS = 3;
 
 multiplayer_lobby_client::multiplayer_lobby_client() :
-    m_pendingCommitInProgress(false),
     m_updateNumber(0),
     m_joinability(joinability::none)
 {
@@ -31,7 +36,6 @@ multiplayer_lobby_client::multiplayer_lobby_client(
     ) :
     m_lobbySessionTemplateName(std::move(lobbySessionTemplateName)),
     m_multiplayerLocalUserManager(localUserManager),
-    m_pendingCommitInProgress(false),
     m_updateNumber(0),
     m_joinability(joinability::none)
 {
@@ -61,7 +65,7 @@ void multiplayer_lobby_client::deep_copy_if_updated(
     _In_ const multiplayer_lobby_client& other
     )
 {
-    std::lock_guard<std::mutex> lock(other.m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(other.m_clientRequestLock);
 
     m_joinability = other.m_joinability;
     if (other.m_sessionWriter->session() == nullptr)
@@ -128,7 +132,7 @@ multiplayer_lobby_client::update_lobby(
 const std::shared_ptr<multiplayer_session>&
 multiplayer_lobby_client::session() const
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
     return m_sessionWriter->session();
 }
 
@@ -151,7 +155,7 @@ multiplayer_lobby_client::update_lobby_session(
     _In_ const std::shared_ptr<multiplayer_session>& updatedSession
     )
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
     m_sessionWriter->update_session(updatedSession);
 }
 
@@ -161,7 +165,7 @@ multiplayer_lobby_client::update_objects(
     const std::shared_ptr<multiplayer_session>& gameSession
     )
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
     if (updatedSession == nullptr)
     {
         update_lobby(nullptr);
@@ -263,7 +267,7 @@ multiplayer_lobby_client::multiplayer_event_queue()
 void
 multiplayer_lobby_client::clear_pending_queue()
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
     while (!m_pendingRequestQueue.empty())
     {
         m_pendingRequestQueue.pop();
@@ -319,7 +323,7 @@ multiplayer_lobby_client::add_local_user(
     _In_ const xbox::services::multiplayer::multiplayer_session_reference& sessionRef
     )
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
 
     if (user == nullptr) return xbox_live_result<void>(xbox_live_error_code::invalid_argument, "Invalid user argument passed");
 
@@ -379,7 +383,7 @@ multiplayer_lobby_client::remove_local_user(
     _In_ xbox_live_user_t user
     )
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
 
     if (user == nullptr) return xbox_live_result<void>(xbox_live_error_code::invalid_argument, "Invalid user argument passed");
 
@@ -397,7 +401,7 @@ multiplayer_lobby_client::remove_local_user(
 void
 multiplayer_lobby_client::remove_all_local_users()
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
 
     if (m_multiplayerLocalUserManager == nullptr) return;
 
@@ -423,7 +427,7 @@ multiplayer_lobby_client::set_local_member_properties(
     _In_opt_ context_t context
     )
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
 
     if (user == nullptr) return xbox_live_result<void>(xbox_live_error_code::invalid_argument, "Invalid user argument passed");
 
@@ -444,7 +448,7 @@ multiplayer_lobby_client::delete_local_member_properties(
     _In_opt_ context_t context
     )
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
 
     if (user == nullptr) return xbox_live_result<void>(xbox_live_error_code::invalid_argument, "Invalid user argument passed");
 
@@ -465,7 +469,7 @@ multiplayer_lobby_client::set_local_member_connection_address(
     _In_opt_ context_t context
     )
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
 
     if (user == nullptr) return xbox_live_result<void>(xbox_live_error_code::invalid_argument, "Invalid user argument passed");
 
@@ -499,8 +503,7 @@ xbox_live_result<void> multiplayer_lobby_client::set_joinability(
 std::vector<multiplayer_event>
 multiplayer_lobby_client::do_work()
 {
-    bool expected = false;
-    if (m_pendingCommitInProgress.compare_exchange_strong(expected, true))
+    if (m_commitStrand.try_acquire())
     {
         if (m_pendingRequestQueue.size() > 0)
         {
@@ -511,7 +514,7 @@ multiplayer_lobby_client::do_work()
             bool doneProcessing = false;
             do
             {
-                std::lock_guard<std::mutex> lock(m_clientRequestLock);
+                std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
                 {
                     auto pendingRequest = m_pendingRequestQueue.front();
                     processingQueue.push_back(pendingRequest);
@@ -585,45 +588,50 @@ multiplayer_lobby_client::do_work()
                 std::weak_ptr<multiplayer_lobby_client> thisWeakPtr = shared_from_this();
 
                 create_task(asyncOp)
-                .then([thisWeakPtr, processingQueue](xbox_live_result<std::vector<multiplayer_event>> result)
+                .then([thisWeakPtr, processingQueue](pplx::task<xbox_live_result<std::vector<multiplayer_event>>> t)
                 {
                     std::shared_ptr<multiplayer_lobby_client> pThis(thisWeakPtr.lock());
                     if (pThis != nullptr)
                     {
-                        std::lock_guard<std::mutex> lock(pThis->m_clientRequestLock);
+                        // The strand is released however the commit ends, or every later commit would queue behind it forever.
+                        std::lock_guard<xsapi_mutex> lock(pThis->m_clientRequestLock);
+                        try
                         {
-                            auto eventQueue = result.payload();
+                            auto eventQueue = t.get().payload();
                             for (const auto& ev : eventQueue)
                             {
                                 pThis->m_multiplayerEventQueue.push_back(ev);
                             }
                         }
+                        catch (...)
+                        {
+                            LOG_ERROR("multiplayer_lobby_client::do_work commit threw an exception");
+                        }
 
                         for (const auto& processingRequest : processingQueue)
                         {
                             pThis->remove_from_processing_queue(processingRequest->identifier());
                         }
 
-                        pThis->m_pendingCommitInProgress.store(false);
+                        pThis->m_commitStrand.release();
                     }
                 });
             }
             else
             {
-                m_pendingCommitInProgress.store(false);
+                m_commitStrand.release();
             }
         }
         else
         {
-            m_pendingCommitInProgress.store(false);
+            m_commitStrand.release();
         }
     }
 
     std::vector<multiplayer_event> eventQueue;
     {
-        std::lock_guard<std::mutex> lock(m_clientRequestLock);
-        eventQueue = m_multiplayerEventQueue;
-        m_multiplayerEventQueue.clear();
+        std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
+        eventQueue.swap(m_multiplayerEventQueue);
     }
 
     return eventQueue;
@@ -632,7 +640,7 @@ multiplayer_lobby_client::do_work()
 bool
 multiplayer_lobby_client::is_pending_lobby_changes()
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
     if (m_pendingRequestQueue.size() > 0 || is_pending_lobby_local_user_changes())
     {
         return true;
@@ -745,7 +753,12 @@ multiplayer_lobby_client::commit_lobby_changes_helper(
     auto sessionRefToCommit = lobbySession->session_reference();
 
     uint32_t count = 0;
-    bool removeStaleUsers = false;
+    std::atomic<bool> removeStaleUsers(false);
+    bool isGameInProgress = game_session() != nullptr;
+    auto processingQueue = get_processing_queue();
+
+    // Build every local user's write up front so users joining or leaving together go out as one batch
+    std::vector<std::pair<std::shared_ptr<multiplayer_local_user>, std::shared_ptr<multiplayer_session>>> localUserWrites;
     auto xboxLiveContextMap = m_multiplayerLocalUserManager->get_local_user_map();
     for(auto xboxLiveContext : xboxLiveContextMap)
     {
@@ -812,98 +825,131 @@ multiplayer_lobby_client::commit_lobby_changes_helper(
                 break;
             }
 
-            bool isGameInProgress = game_session() != nullptr;
-
             // Update any pending local user or lobby session properties.
-            auto processingQueue = get_processing_queue();
             for(auto& request : processingQueue)
             {
                 request->append_pending_changes(lobbySessionToCommit, localUser, isGameInProgress);
             }
 
-            std::weak_ptr<multiplayer_lobby_client> thisWeakPtr = shared_from_this();
-            pplx::task<xbox_live_result<std::shared_ptr<multiplayer_session>>> writeSessionOp;
+            localUserWrites.push_back(std::make_pair(localUser, lobbySessionToCommit));
+        }   // end if
+    }   // end for
 
-            if (localUser->lobby_handle_id().empty())
-            {
-                writeSessionOp = m_sessionWriter->write_session(localUser->context(), lobbySessionToCommit, multiplayer_session_write_mode::update_or_create_new);
-            }
-            else
+    // If the lobby doesn't exist on the service yet, the first write creates it (or resolves the handle)
+    // and everyone else joins the result. Otherwise all writes are independent and go out together.
+    size_t firstBatchSize = (session() == nullptr) ? 1 : localUserWrites.size();
+    xbox_live_result<std::vector<multiplayer_event>> commitResult;
+    size_t writeIndex = 0;
+    while (writeIndex < localUserWrites.size() && !commitResult.err())
+    {
+        size_t batchEnd = (writeIndex == 0) ? __min(firstBatchSize, localUserWrites.size()) : localUserWrites.size();
+        std::vector<pplx::task<xbox_live_result<std::vector<multiplayer_event>>>> writeTasks;
+        for (; writeIndex < batchEnd; ++writeIndex)
+        {
+            writeTasks.push_back(write_local_user_lobby_session(
+                localUserWrites[writeIndex].first,
+                localUserWrites[writeIndex].second,
+                processingQueue,
+                removeStaleUsers
+                ));
+        }
+
+        // Each write reports its own user_added/user_removed event; the first failure becomes the commit result.
+        for (auto& writeTask : writeTasks)
+        {
+            auto writeResult = writeTask.get();
+            if (writeResult.err() && !commitResult.err())
             {
-                writeSessionOp = m_sessionWriter->write_session_by_handle(localUser->context(), lobbySessionToCommit, multiplayer_session_write_mode::update_or_create_new, localUser->lobby_handle_id());
-                localUser->set_lobby_handle_id(string_t());
+                commitResult = writeResult;
             }
+        }
+    }
 
-            auto writeSessionTask = pplx::create_task(writeSessionOp)
-            .then([thisWeakPtr, localUser, sessionRefToCommit, processingQueue, &removeStaleUsers](xbox_live_result<std::shared_ptr<multiplayer_session>> sessionResult)
-            {
-                std::shared_ptr<multiplayer_lobby_client> pThis(thisWeakPtr.lock());
-                RETURN_CPP_IF(pThis == nullptr, std::vector<multiplayer_event>, xbox_live_error_code::generic_error, "multiplayer_lobby_client class was destroyed.");
+    if (removeStaleUsers)
+    {
+        remove_stale_xbox_live_context_from_map();
+    }
 
-                pThis->user_state_changed(sessionResult.err(), sessionResult.err_message(), localUser->lobby_state(), localUser->xbox_user_id());
-                pThis->handle_lobby_change_events(sessionResult.err(), sessionResult.err_message(), localUser, processingQueue);
-                
-                if (sessionResult.err())
-                {
-                    pThis->join_lobby_completed(sessionResult.err(), sessionResult.err_message(), string_t());
-                    return xbox_live_result<std::vector<multiplayer_event>>(sessionResult.err(), sessionResult.err_message());
-                }
+    return commitResult;
+}
 
-                if (localUser->lobby_state() == multiplayer_local_user_lobby_state::add ||
-                    localUser->lobby_state() == multiplayer_local_user_lobby_state::join)
-                {
-                    auto updatedSession = sessionResult.payload();
-                    pThis->update_session(updatedSession);
-                    auto lobbyState = localUser->lobby_state();
-                    localUser->set_lobby_state(multiplayer_local_user_lobby_state::in_session);
+pplx::task<xbox_live_result<std::vector<multiplayer_event>>>
+multiplayer_lobby_client::write_local_user_lobby_session(
+    _In_ std::shared_ptr<multiplayer_local_user> localUser,
+    _In_ std::shared_ptr<multiplayer_session> lobbySessionToCommit,
+    _In_ std::vector<std::shared_ptr<multiplayer_client_pending_request>> processingQueue,
+    _Inout_ std::atomic<bool>& removeStaleUsers
+    )
+{
+    std::weak_ptr<multiplayer_lobby_client> thisWeakPtr = shared_from_this();
+    pplx::task<xbox_live_result<std::shared_ptr<multiplayer_session>>> writeSessionOp;
 
-                    if (lobbyState == multiplayer_local_user_lobby_state::join)
-                    {
-                        pThis->handle_join_lobby_completed(sessionResult.err(), sessionResult.err_message());
-                    }
+    if (localUser->lobby_handle_id().empty())
+    {
+        writeSessionOp = m_sessionWriter->write_session(localUser->context(), lobbySessionToCommit, multiplayer_session_write_mode::update_or_create_new);
+    }
+    else
+    {
+        writeSessionOp = m_sessionWriter->write_session_by_handle(localUser->context(), lobbySessionToCommit, multiplayer_session_write_mode::update_or_create_new, localUser->lobby_handle_id());
+        localUser->set_lobby_handle_id(string_t());
+    }
 
-                    auto setActivityResult = localUser->context()->multiplayer_service().set_activity(updatedSession->session_reference()).get();
-                    if (setActivityResult.err())
-                    {
-                        return xbox_live_result<std::vector<multiplayer_event>>(setActivityResult.err(), setActivityResult.err_message());
-                    }
+    // removeStaleUsers outlives the task since commit_lobby_changes_helper waits on every write.
+    return pplx::create_task(writeSessionOp)
+    .then([thisWeakPtr, localUser, processingQueue, &removeStaleUsers](xbox_live_result<std::shared_ptr<multiplayer_session>> sessionResult)
+    {
+        std::shared_ptr<multiplayer_lobby_client> pThis(thisWeakPtr.lock());
+        RETURN_CPP_IF(pThis == nullptr, std::vector<multiplayer_event>, xbox_live_error_code::generic_error, "multiplayer_lobby_client class was destroyed.");
 
-                    if (lobbyState == multiplayer_local_user_lobby_state::add &&
-                        pThis->should_update_host_token(localUser, updatedSession))
-                    {
-                        updatedSession->set_host_device_token(updatedSession->current_user()->device_token());
-                        auto writeHostTokenResult = pThis->m_sessionWriter->write_session(localUser->context(), updatedSession, multiplayer_session_write_mode::update_existing).get();
-                        if (writeHostTokenResult.err())
-                        {
-                            return xbox_live_result<std::vector<multiplayer_event>>(writeHostTokenResult.err(), writeHostTokenResult.err_message());
-                        }
-                    }
-                }
-                else if (localUser->lobby_state() == multiplayer_local_user_lobby_state::leave)
-                {
-                    removeStaleUsers = true;
+        pThis->user_state_changed(sessionResult.err(), sessionResult.err_message(), localUser->lobby_state(), localUser->xbox_user_id());
+        pThis->handle_lobby_change_events(sessionResult.err(), sessionResult.err_message(), localUser, processingQueue);
+        
+        if (sessionResult.err())
+        {
+            pThis->join_lobby_completed(sessionResult.err(), sessionResult.err_message(), string_t());
+            return xbox_live_result<std::vector<multiplayer_event>>(sessionResult.err(), sessionResult.err_message());
+        }
 
-                    // If you leave the session you were advertising, you don't need to clear the activity.
-                    localUser->set_lobby_state(multiplayer_local_user_lobby_state::remove);
-                }
+        if (localUser->lobby_state() == multiplayer_local_user_lobby_state::add ||
+            localUser->lobby_state() == multiplayer_local_user_lobby_state::join)
+        {
+            auto updatedSession = sessionResult.payload();
+            pThis->update_session(updatedSession);
+            auto lobbyState = localUser->lobby_state();
+            localUser->set_lobby_state(multiplayer_local_user_lobby_state::in_session);
 
-                return xbox_live_result<std::vector<multiplayer_event>>();
+            if (lobbyState == multiplayer_local_user_lobby_state::join)
+            {
+                pThis->handle_join_lobby_completed(sessionResult.err(), sessionResult.err_message());
+            }
 
-            }).get();  // write_session
+            auto setActivityResult = localUser->context()->multiplayer_service().set_activity(updatedSession->session_reference()).get();
+            if (setActivityResult.err())
+            {
+                return xbox_live_result<std::vector<multiplayer_event>>(setActivityResult.err(), setActivityResult.err_message());
+            }
 
-            if (writeSessionTask.err())
+            if (lobbyState == multiplayer_local_user_lobby_state::add &&
+                pThis->should_update_host_token(localUser, updatedSession))
             {
-                return xbox_live_result<std::vector<multiplayer_event>>(writeSessionTask.err(), writeSessionTask.err_message());
+                updatedSession->set_host_device_token(updatedSession->current_user()->device_token());
+                auto writeHostTokenResult = pThis->m_sessionWriter->write_session(localUser->context(), updatedSession, multiplayer_session_write_mode::update_existing).get();
+                if (writeHostTokenResult.err())
+                {
+                    return xbox_live_result<std::vector<multiplayer_event>>(writeHostTokenResult.err(), writeHostTokenResult.err_message());
+                }
             }
-        }   // end if
-    }   // end for
+        }
+        else if (localUser->lobby_state() == multiplayer_local_user_lobby_state::leave)
+        {
+            removeStaleUsers = true;
 
-    if (removeStaleUsers)
-    {
-        remove_stale_xbox_live_context_from_map();
-    }
+            // If you leave the session you were advertising, you don't need to clear the activity.
+            localUser->set_lobby_state(multiplayer_local_user_lobby_state::remove);
+        }
 
-    return xbox_live_result<std::vector<multiplayer_event>>();
+        return xbox_live_result<std::vector<multiplayer_event>>();
+    });
 }
 
 void
@@ -940,54 +986,65 @@ multiplayer_lobby_client::create_game_from_lobby()
     std::shared_ptr<xbox_live_context_impl> primaryContext = m_multiplayerLocalUserManager->get_primary_context();
     RETURN_CPP_IF(primaryContext == nullptr, void, xbox_live_error_code::logic_error, "Call add_local_user() before joining.");
 
+    // Try to write transfer handle to the lobby as pending state
+    // If succeeded, then create the game session, set the transfer handle, and advertise the game session.
+    // If failed, wait for the property changed event.
+    create_game_from_lobby_helper(lobbySession->_Create_deep_copy(), primaryContext, 0);
+
+    return xbox_live_result<void>();
+}
+
+pplx::task<xbox_live_result<void>>
+multiplayer_lobby_client::create_game_from_lobby_helper(
+    _In_ std::shared_ptr<multiplayer_session> sessionToCommit,
+    _In_ std::shared_ptr<xbox_live_context_impl> primaryContext,
+    _In_ int attempts
+    )
+{
+    string_t jsonValue;
+    jsonValue = _T("pending~") + primaryContext->xbox_live_user_id();
+    sessionToCommit->set_session_custom_property_json(multiplayer_lobby_client::c_transferHandlePropertyName, web::json::value::string(jsonValue));
+
     std::weak_ptr<multiplayer_lobby_client> thisWeakPtr = shared_from_this();
-    pplx::create_task([thisWeakPtr, lobbySession, primaryContext]()
+    return m_sessionWriter->commit_synchronized_changes(sessionToCommit)
+    .then([thisWeakPtr, primaryContext, attempts](xbox_live_result<std::shared_ptr<multiplayer_session>> commitResult) -> pplx::task<xbox_live_result<void>>
     {
         std::shared_ptr<multiplayer_lobby_client> pThis(thisWeakPtr.lock());
-        RETURN_CPP_IF(pThis == nullptr, void, xbox_live_error_code::generic_error, "multiplayer_lobby_client class was destroyed.");
+        RETURN_TASK_CPP_IF(pThis == nullptr, void, "multiplayer_lobby_client class was destroyed.");
 
-        // Try to write transfer handle to the lobby as pending state
-        // If succeeded, then create the game session, set the transfer handle, and advertise the game session.
-        // If failed, wait for the property changed event.
+        auto gameClient = pThis->game_client();
+        RETURN_TASK_CPP_IF(gameClient == nullptr, void, "multiplayer_game_client class was destroyed.");
 
-        int attempts = 0;
-        xbox_live_result<std::shared_ptr<multiplayer_session>> commitResult;
-        auto sessionToCommitCopy  = lobbySession->_Create_deep_copy();
-        while (attempts < MAX_CONNECTION_ATTEMPTS)
+        if (commitResult.err() == xbox_live_error_condition::http_412_precondition_failed)
         {
-            string_t jsonValue;
-            jsonValue = _T("pending~") + primaryContext->xbox_live_user_id();
-            sessionToCommitCopy->set_session_custom_property_json(multiplayer_lobby_client::c_transferHandlePropertyName, web::json::value::string(jsonValue));
-
-            commitResult = pThis->m_sessionWriter->commit_synchronized_changes(sessionToCommitCopy).get();
-            auto gameClient = pThis->game_client();
-            RETURN_CPP_IF(gameClient == nullptr, void, xbox_live_error_code::generic_error, "multiplayer_game_client class was destroyed.");
+            if (pThis->is_transfer_handle_state(_T("completed")) || pThis->is_transfer_handle_state(_T("pending")))
+            {
+                return pplx::task_from_result(gameClient->join_game_from_lobby_helper());
+            }
 
-            if (commitResult.err() == xbox_live_error_condition::http_412_precondition_failed)
+            if (attempts + 1 < MAX_CONNECTION_ATTEMPTS)
             {
-                if (pThis->is_transfer_handle_state(_T("completed")) || pThis->is_transfer_handle_state(_T("pending")))
+                // Reschedule on a timer instead of parking a pool thread for the retry interval.
+                auto latestSession = commitResult.payload();
+                return create_delayed_task(
+                    RETRY_LENGTH,
+                    [thisWeakPtr, latestSession, primaryContext, attempts]() -> pplx::task<xbox_live_result<void>>
                 {
-                    return gameClient->join_game_from_lobby_helper();
-                }
-                else
-                {
-                    attempts++;
-                    sessionToCommitCopy = commitResult.payload();
-                    std::this_thread::sleep_for(RETRY_LENGTH);
-                    continue;
-                }
+                    std::shared_ptr<multiplayer_lobby_client> pThis(thisWeakPtr.lock());
+                    RETURN_TASK_CPP_IF(pThis == nullptr, void, "multiplayer_lobby_client class was destroyed.");
+
+                    return pThis->create_game_from_lobby_helper(latestSession, primaryContext, attempts + 1);
+                });
             }
 
-            auto sessionName = utils::create_guid(true);
-            RETURN_EXCEPTION_FREE_XBOX_LIVE_RESULT(gameClient->join_game_helper(sessionName), void);
+            pThis->update_session(commitResult.payload());
+            pThis->join_lobby_completed(commitResult.err(), commitResult.err_message(), string_t());
+            return pplx::task_from_result(xbox_live_result<void>(commitResult.err(), commitResult.err_message()));
         }
 
-        pThis->update_session(sessionToCommitCopy);
-        pThis->join_lobby_completed(commitResult.err(), commitResult.err_message(), string_t());
-        return xbox_live_result<void>(commitResult.err(), commitResult.err_message());
+        auto sessionName = utils::create_guid(true);
+        return pplx::task_from_result(gameClient->join_game_helper(sessionName));
     });
-
-    return xbox_live_result<void>();
 }
 
 void
@@ -999,55 +1056,98 @@ multiplayer_lobby_client::advertise_game_session()
         return;
     }
 
+    // Queue behind any in-flight lobby commit rather than spinning a pool thread until it finishes.
     std::weak_ptr<multiplayer_lobby_client> thisWeakPtr = shared_from_this();
-    pplx::create_task([thisWeakPtr, primaryContext]()
+    m_commitStrand.acquire()
+    .then([thisWeakPtr, primaryContext]()
     {
         std::shared_ptr<multiplayer_lobby_client> pThis(thisWeakPtr.lock());
         if (pThis == nullptr) return;
 
-        bool expected = false;
-        while (!pThis->m_pendingCommitInProgress.compare_exchange_strong(expected, true))
+        auto lobbySession = pThis->session();
+        if (pThis->game_session() == nullptr)
         {
-            expected = false;
-            utils::sleep(0);
+            pThis->m_commitStrand.release();
+            return;
         }
 
-        auto lobbySession = pThis->session();
-        if (pThis->game_session() == nullptr) return;
+        if (lobbySession != nullptr)
+        {
+            pThis->m_commitStrand.release();
+            pThis->advertise_game_session_helper(lobbySession, primaryContext);
+            return;
+        }
 
         // If the advertising fails, we simply eat the error as it isn't actionable for the title.
-        if (lobbySession == nullptr)
+        if (pThis->m_multiplayerLocalUserManager->get_local_user_map().size() == 0)
         {
-            if (pThis->m_multiplayerLocalUserManager->get_local_user_map().size() == 0)
-            {
-                return;
-            }
+            pThis->m_commitStrand.release();
+            return;
+        }
 
+        pplx::task<xbox_live_result<std::vector<multiplayer_event>>> joinLobbyTask;
+        try
+        {
             pThis->m_multiplayerLocalUserManager->change_all_local_user_lobby_state(multiplayer_local_user_lobby_state::add);
-            auto joinLobbyResult = pThis->commit_pending_lobby_changes(false).get();
+            joinLobbyTask = pThis->commit_pending_lobby_changes(false);
+        }
+        catch (...)
+        {
+            LOG_ERROR("multiplayer_lobby_client::advertise_game_session threw an exception");
+            pThis->m_commitStrand.release();
+            return;
+        }
+
+        joinLobbyTask.then([thisWeakPtr, primaryContext](pplx::task<xbox_live_result<std::vector<multiplayer_event>>> t)
+        {
+            std::shared_ptr<multiplayer_lobby_client> pThis(thisWeakPtr.lock());
+            if (pThis == nullptr) return;
+
+            // Release before anything that can throw; a faulted commit is reported as a failed join.
+            pThis->m_commitStrand.release();
+            xbox_live_result<std::vector<multiplayer_event>> joinLobbyResult;
+            try
+            {
+                joinLobbyResult = t.get();
+            }
+            catch (...)
+            {
+                joinLobbyResult = xbox_live_result<std::vector<multiplayer_event>>(utils::convert_exception_to_xbox_live_error_code(), "Failed to join the lobby.");
+            }
 
-            pThis->m_pendingCommitInProgress = false;
             pThis->join_lobby_completed(joinLobbyResult.err(), joinLobbyResult.err_message(), string_t());
             if (joinLobbyResult.err())
             {
                 return;
             }
 
-            lobbySession = pThis->session();
-        }
-        else
-        {
-            pThis->m_pendingCommitInProgress = false;
-        }
+            pThis->advertise_game_session_helper(pThis->session(), primaryContext);
+        });
+    });
+}
 
-        auto lobbyProperties = lobbySession->session_properties()->session_custom_properties_json();
-        if (!lobbyProperties.has_field(c_transferHandlePropertyName) ||
-            (pThis->is_transfer_handle_state(_T("pending")) && pThis->get_transfer_handle() == primaryContext->xbox_live_user_id()))
+void
+multiplayer_lobby_client::advertise_game_session_helper(
+    _In_ std::shared_ptr<multiplayer_session> lobbySession,
+    _In_ std::shared_ptr<xbox_live_context_impl> primaryContext
+    )
+{
+    if (lobbySession == nullptr) return;
+
+    auto lobbyProperties = lobbySession->session_properties()->session_custom_properties_json();
+    if (!lobbyProperties.has_field(c_transferHandlePropertyName) ||
+        (is_transfer_handle_state(_T("pending")) && get_transfer_handle() == primaryContext->xbox_live_user_id()))
+    {
+        auto gameSession = game_session();
+        if (gameSession == nullptr) return;
+
+        std::weak_ptr<multiplayer_lobby_client> thisWeakPtr = shared_from_this();
+        primaryContext->multiplayer_service().set_transfer_handle(gameSession->session_reference(), lobbySession->session_reference())
+        .then([thisWeakPtr, lobbySession, primaryContext](xbox_live_result<string_t> result)
         {
-            auto gameSession = pThis->game_session();
-            if (gameSession == nullptr) return;
+            std::shared_ptr<multiplayer_lobby_client> pThis(thisWeakPtr.lock());
+            if (pThis == nullptr) return;
 
-            auto result = primaryContext->multiplayer_service().set_transfer_handle(gameSession->session_reference(), lobbySession->session_reference()).get();
             if (!result.err())
             {
                 auto handleId = result.payload();
@@ -1069,8 +1169,8 @@ multiplayer_lobby_client::advertise_game_session()
                 // By MPSD design, if the game session doesn't exist on transfer handle creation, it throws a 403.
                 pThis->clear_game_session_from_lobby();
             }
-        }
-    });
+        });
+    }
 }
 
 void
@@ -1233,13 +1333,13 @@ multiplayer_lobby_client::user_state_changed(
     if (localUserLobbyState == multiplayer_local_user_lobby_state::add)
     {
         eventType = multiplayer_event_type::user_added;
-        std::shared_ptr<user_added_event_args> userAddedEventArgs = std::make_shared<user_added_event_args>(xboxUserId);
+        std::shared_ptr<user_added_event_args> userAddedEventArgs = make_event_args<user_added_event_args>(xboxUserId);
         eventArgs = std::dynamic_pointer_cast<user_added_event_args>(userAddedEventArgs);
     }
     else if (localUserLobbyState == multiplayer_local_user_lobby_state::leave)
     {
         eventType = multiplayer_event_type::user_removed;
-        std::shared_ptr<user_removed_event_args> userRemovedEventArgs = std::make_shared<user_removed_event_args>(xboxUserId);
+        std::shared_ptr<user_removed_event_args> userRemovedEventArgs = make_event_args<user_removed_event_args>(xboxUserId);
         eventArgs = std::dynamic_pointer_cast<user_removed_event_args>(userRemovedEventArgs);
     }
     else
@@ -1273,7 +1373,7 @@ multiplayer_lobby_client::handle_lobby_change_events(
                     errorCode,
                     errorMessage,
                     multiplayer_event_type::local_member_connection_address_write_completed,
-                    std::make_shared<multiplayer_event_args>(),
+                    make_event_args<multiplayer_event_args>(),
                     request->context()
                     );
 
@@ -1287,7 +1387,7 @@ multiplayer_lobby_client::handle_lobby_change_events(
                     errorCode,
                     errorMessage,
                     multiplayer_event_type::local_member_property_write_completed,
-                    std::make_shared<multiplayer_event_args>(),
+                    make_event_args<multiplayer_event_args>(),
                     request->context()
                     );
 
@@ -1300,7 +1400,7 @@ multiplayer_lobby_client::handle_lobby_change_events(
     auto eventQueue = m_sessionWriter->handle_events(processingQueue, errorCode, errorMessage, multiplayer_session_type::lobby_session);
     if (eventQueue.size() > 0)
     {
-        std::lock_guard<std::mutex> lock(m_clientRequestLock);
+        std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
         for (auto& ev : eventQueue)
         {
             m_multiplayerEventQueue.push_back(ev);
@@ -1370,7 +1470,7 @@ multiplayer_lobby_client::join_lobby_completed(
     _In_ const string_t& invitedXboxUserId
     )
 {
-    std::shared_ptr<join_lobby_completed_event_args> joinLobbyEventArgs = std::make_shared<join_lobby_completed_event_args>(
+    std::shared_ptr<join_lobby_completed_event_args> joinLobbyEventArgs = make_event_args<join_lobby_completed_event_args>(
         invitedXboxUserId
         );
 
@@ -1389,7 +1489,7 @@ multiplayer_lobby_client::handle_game_session_ready_event(
 {
     auto lobbyTournamentsServer = lobbySession->tournaments_server();
     auto localStartTime = utility::datetime::utc_now() + utility::datetime::from_seconds(lobbyTournamentsServer.next_game_start_time() - lobbySession->date_of_session());
-    auto gameSessionReadyEventArgs = std::make_shared<tournament_game_session_ready_event_args>(
+    auto gameSessionReadyEventArgs = make_event_args<tournament_game_session_ready_event_args>(
         localStartTime
         );
 
@@ -1416,7 +1516,7 @@ multiplayer_lobby_client::add_multiplayer_event_helper(
     _In_opt_ context_t context
     )
 {
-    std::lock_guard<std::mutex> lock(m_clientRequestLock);
+    std::lock_guard<xsapi_mutex> lock(m_clientRequestLock);
 
     multiplayer_event multiplayerEvent(
         errorCode,
@@ -33,7 +33,7 @@ multiplayer_local_user_manager::~multiplayer_local_user_manager()
 std::map<string_t, std::shared_ptr<multiplayer_local_user>>
 multiplayer_local_user_manager::get_local_user_map()
 {
-    std::lock_guard<std::mutex> lock(m_lock.get());
+    std::lock_guard<xsapi_mutex> lock(m_lock.get());
     return m_localUserRequestMap;
 }
 
@@ -47,7 +47,7 @@ multiplayer_local_user_manager::get_context(
         return nullptr;
     }
 
-    std::lock_guard<std::mutex> lock(m_lock.get());
+    std::lock_guard<xsapi_mutex> lock(m_lock.get());
 
     auto iter = m_localUserRequestMap.find(xboxUserId);
     if (iter != m_localUserRequestMap.end())
@@ -67,7 +67,7 @@ multiplayer_local_user_manager::get_local_user(
         return nullptr;
     }
 
-    std::lock_guard<std::mutex> lock(m_lock.get());
+    std::lock_guard<xsapi_mutex> lock(m_lock.get());
     return get_local_user_helper(user);
 }
 
@@ -76,7 +76,7 @@ multiplayer_local_user_manager::get_local_user(
     _In_ const string_t& xboxUserId
     )
 {
-    std::lock_guard<std::mutex> lock(m_lock.get());
+    std::lock_guard<xsapi_mutex> lock(m_lock.get());
     return get_local_user_helper(xboxUserId);
 }
 
@@ -115,7 +115,7 @@ multiplayer_local_user_manager::get_local_user_helper(
 std::shared_ptr<xbox_live_context_impl>
 multiplayer_local_user_manager::get_primary_context()
 {
-    std::lock_guard<std::mutex> lock(m_lock.get());
+    std::lock_guard<xsapi_mutex> lock(m_lock.get());
     return m_primaryXboxLiveContext;
 }
 
@@ -124,7 +124,7 @@ multiplayer_local_user_manager::change_all_local_user_lobby_state(
     _In_ multiplayer_local_user_lobby_state state
     )
 {
-    std::lock_guard<std::mutex> lock(m_lock.get());
+    std::lock_guard<xsapi_mutex> lock(m_lock.get());
 
     for(const auto& user : m_localUserRequestMap)
     {
@@ -141,7 +141,7 @@ multiplayer_local_user_manager::change_all_local_user_game_state(
     _In_ multiplayer_local_user_game_state state
     )
 {
-    std::lock_guard<std::mutex> lock(m_lock.get());
+    std::lock_guard<xsapi_mutex> lock(m_lock.get());
 
     for(const auto& user : m_localUserRequestMap)
     {
@@ -158,7 +158,7 @@ multiplayer_local_user_manager::is_local_user_game_state(
     _In_ multiplayer_local_user_game_state state
     )
 {
-    std::lock_guard<std::mutex> lock(m_lock.get());
+    std::lock_guard<xsapi_mutex> lock(m_lock.get());
 
     for(const auto& user : m_localUserRequestMap)
     {
@@ -210,7 +210,7 @@ multiplayer_local_user_manager::add_user_to_xbox_live_context_to_map(
 void
 multiplayer_local_user_manager::remove_stale_local_users_from_map()
 {
-    std::lock_guard<std::mutex> lock(m_lock.get());
+    std::lock_guard<xsapi_mutex> lock(m_lock.get());
 
     bool swtichPrimaryXboxLiveContext = false;
     for(auto iter = m_localUserRequestMap.begin(); iter != m_localUserRequestMap.end(); )
@@ -344,7 +344,7 @@ multiplayer_local_user_manager::add_multiplayer_session_changed_handler(
     _In_ std::function<void(const multiplayer_session_change_event_args&)> handler
     )
 {
-    std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
 
     function_context context = -1;
     if (handler != nullptr)
@@ -361,7 +361,7 @@ multiplayer_local_user_manager::remove_multiplayer_session_changed_handler(
     _In_ function_context context
     )
 {
-    std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
     m_sessionChangeEventHandler.erase(context);
 }
 
@@ -372,7 +372,7 @@ multiplayer_local_user_manager::on_session_changed(
 {
     std::unordered_map<uint32_t, std::function<void(const multiplayer_session_change_event_args&)>> sessionChangeEventHandlerCopy;
     {
-        std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+        std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
         sessionChangeEventHandlerCopy = m_sessionChangeEventHandler;
     }
 
@@ -398,7 +398,7 @@ multiplayer_local_user_manager::add_multiplayer_subscription_lost_handler(
     _In_ std::function<void()> handler
     )
 {
-    std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
 
     function_context context = -1;
     if (handler != nullptr)
@@ -415,7 +415,7 @@ multiplayer_local_user_manager::remove_multiplayer_subscription_lost_handler(
     _In_ function_context context
     )
 {
-    std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
     m_multiplayerSubscriptionLostEventHandler.erase(context);
 }
 
@@ -427,7 +427,7 @@ multiplayer_local_user_manager::on_subscriptions_lost(
     {
         // Only fire this for the last user.
         // Note: This will be fired from the previous user's deactivation.
-        std::lock_guard<std::mutex> lock(m_lock.get());
+        std::lock_guard<xsapi_mutex> lock(m_lock.get());
         auto user = get_local_user_helper(xboxUserId);
         if (user == nullptr && m_localUserRequestMap.size() > 0)
         {
@@ -437,7 +437,7 @@ multiplayer_local_user_manager::on_subscriptions_lost(
 
     std::unordered_map<uint32_t, std::function<void()>> multiplayerSubscriptionLostEventHandlerCopy;
     {
-        std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+        std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
         multiplayerSubscriptionLostEventHandlerCopy = m_multiplayerSubscriptionLostEventHandler;
     }
 
@@ -463,7 +463,7 @@ multiplayer_local_user_manager::add_rta_resync_handler(
     _In_ std::function<void()> handler
     )
 {
-    std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
 
     function_context context = -1;
     if (handler != nullptr)
@@ -480,7 +480,7 @@ multiplayer_local_user_manager::remove_rta_resync_handler(
     _In_ function_context context
     )
 {
-    std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
     m_rtaResyncEventHandler.erase(context);
 }
 
@@ -489,7 +489,7 @@ multiplayer_local_user_manager::on_resync_message_received()
 {
     std::unordered_map<uint32_t, std::function<void()>> rtaResyncEventHandlerCopy;
     {
-        std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+        std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
         rtaResyncEventHandlerCopy = m_rtaResyncEventHandler;
     }
 
@@ -5,6 +5,7 @@
 #include "xsapi/multiplayer.h"
 #include "xsapi/multiplayer_manager.h"
 #include "multiplayer_manager_internal.h"
+#include "flight_recorder.h"
 
 #if defined __cplusplus_winrt
 using namespace Platform;
@@ -25,7 +26,7 @@ std::shared_ptr<multiplayer_manager>
 multiplayer_manager::get_singleton_instance()
 {
     auto xsapiSingleton = get_xsapi_singleton();
-    std::lock_guard<std::mutex> guard(xsapiSingleton->m_singletonLock);
+    std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_singletonLock);
     if (xsapiSingleton->m_multiplayerManagerInstance == nullptr)
     {
         xsapiSingleton->m_multiplayerManagerInstance = std::shared_ptr<multiplayer_manager>(new multiplayer_manager());
@@ -81,14 +82,7 @@ multiplayer_manager::do_work()
         m_isDirty = false;
 
         // To handle the scenario of returning InvitedXuid info in the join_lobby_completed event
-        std::vector<multiplayer_event> eventQueue; 
-        if (m_multiplayerClientManager->event_queue().size() > 0)
-        {
-            eventQueue = m_multiplayerClientManager->event_queue();
-            m_multiplayerClientManager->clear_event_queue();
-        }
-
-        return eventQueue;
+        return m_multiplayerClientManager->take_event_queue();
     }
 
     std::vector<multiplayer_event> eventQueue;
@@ -114,6 +108,10 @@ multiplayer_manager::do_work()
     }
     catch(...){}
 
+    if (!eventQueue.empty())
+    {
+        flight_recorder::get_flight_recorder_singleton()->record(flight_record_type::multiplayer_manager_events, 0, 0, static_cast<uint32_t>(eventQueue.size()));
+    }
     return eventQueue;
 }
 
@@ -266,6 +264,19 @@ multiplayer_manager::find_match(
     RETURN_EXCEPTION_FREE_XBOX_LIVE_RESULT(m_multiplayerClientManager->find_match(hopperName, attributes, timeout), void);
 }
 
+xbox_live_result<void>
+multiplayer_manager::find_match(
+    _In_ const string_t& hopperName,
+    _In_ const web::json::value& attributes,
+    _In_ const std::chrono::seconds& timeout,
+    _In_ const xbox::services::matchmaking::match_ticket_retry_policy& retryPolicy
+    )
+{
+    RETURN_CPP_IF(m_multiplayerClientManager == nullptr, void, xbox_live_error_code::logic_error, "Call multiplayer_manager::initialize() first.");
+    auto retryPolicyCopy = std::make_shared<xbox::services::matchmaking::match_ticket_retry_policy>(retryPolicy);
+    RETURN_EXCEPTION_FREE_XBOX_LIVE_RESULT(m_multiplayerClientManager->find_match(hopperName, attributes, timeout, retryPolicyCopy), void);
+}
+
 void
 multiplayer_manager::cancel_match()
 {
@@ -297,6 +308,17 @@ multiplayer_manager::estimated_match_wait_time() const
     return std::chrono::seconds(0);
 }
 
+std::chrono::seconds
+multiplayer_manager::cumulative_match_wait_time() const
+{
+    if (m_multiplayerClientManager != nullptr && m_multiplayerClientManager->match_client() != nullptr)
+    {
+        return m_multiplayerClientManager->match_client()->cumulative_match_wait_time();
+    }
+
+    return std::chrono::seconds(0);
+}
+
 void
 multiplayer_manager::set_quality_of_service_measurements(
     _In_ std::shared_ptr<std::vector<multiplayer_quality_of_service_measurements>> measurements
@@ -2,16 +2,19 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #pragma once
+#include <atomic>
 #include <mutex>
 #include <set>
 #include "pplx/pplxtasks.h"
 #include "xsapi/multiplayer.h"
 #include "xsapi/multiplayer_manager.h"
 #include "xsapi/social.h"
+#include "xsapi/social_manager.h"
 #include "xsapi/real_time_activity.h"
 #include "system_internal.h"
 #include "user_context.h"
 #include "xbox_live_context_impl.h"
+#include "Matchmaking/matchmaking_internal.h"
 
 namespace xbox { namespace services { 
     class xbox_live_context_impl;
@@ -142,6 +145,119 @@ private:
 };
 
 
+// Serializes session commits issued by a client. Instead of spinning on a flag, callers
+// that find a commit in progress queue up and are resumed when the owner releases the strand.
+class multiplayer_commit_strand
+{
+public:
+    multiplayer_commit_strand();
+
+    // Takes the strand only if it is free. Never waits, so it is safe to call from do_work().
+    bool try_acquire();
+
+    // Returns a task that completes once the caller owns the strand.
+    pplx::task<void> acquire();
+
+    // Hands the strand to the next queued caller, or frees it if nobody is waiting.
+    void release();
+
+    bool is_busy() const;
+    size_t waiter_count() const;
+
+private:
+    mutable xsapi_mutex m_lock XSAPI_LOCK_SITE("multiplayer_commit_strand::m_lock");
+    bool m_isBusy;
+    std::queue<pplx::task_completion_event<void>> m_waiters;
+};
+
+
+// Recycles the small blocks behind multiplayer event args. Busy lobbies raise a steady stream of
+// member and session property events, so blocks are kept on per size class free lists instead of
+// going back to the heap. A free list is a fixed row of slots that blocks are swapped in and out of
+// atomically, so allocating and freeing never take a lock. The pool lives as long as the process,
+// so args that a title keeps alive past cleanup can still be returned safely.
+class multiplayer_event_args_pool
+{
+public:
+    // Never freed, and fetched without the singleton lock since every event args allocation needs it
+    static multiplayer_event_args_pool* get_singleton_instance();
+
+    multiplayer_event_args_pool();
+    ~multiplayer_event_args_pool();
+
+    void* allocate(_In_ size_t size);
+    void deallocate(_In_ void* block, _In_ size_t size);
+
+    // Allocations served from a free list, and allocations that had to go to the heap
+    uint64_t recycled_count() const;
+    uint64_t heap_allocation_count() const;
+
+private:
+    static size_t size_class(_In_ size_t size);
+
+    static const size_t SIZE_CLASS_GRANULARITY;
+    static const size_t SIZE_CLASS_COUNT;
+    static const size_t MAX_FREE_BLOCKS_PER_SIZE_CLASS;
+
+    // SIZE_CLASS_COUNT rows of MAX_FREE_BLOCKS_PER_SIZE_CLASS slots; an empty slot holds nullptr
+    std::unique_ptr<std::atomic<void*>[]> m_freeSlots;
+
+    // Blocks parked in each row. Only a hint for skipping empty or full rows; the slots are the truth.
+    std::unique_ptr<std::atomic<int32_t>[]> m_freeCounts;
+    std::atomic<uint64_t> m_recycledCount;
+    std::atomic<uint64_t> m_heapAllocationCount;
+};
+
+template<typename T>
+class multiplayer_event_args_allocator
+{
+public:
+    typedef T value_type;
+
+    template<typename U>
+    struct rebind
+    {
+        typedef multiplayer_event_args_allocator<U> other;
+    };
+
+    multiplayer_event_args_allocator() :
+        m_pool(multiplayer_event_args_pool::get_singleton_instance())
+    {
+    }
+
+    template<typename U>
+    multiplayer_event_args_allocator(_In_ const multiplayer_event_args_allocator<U>& other) :
+        m_pool(other.m_pool)
+    {
+    }
+
+    T* allocate(_In_ size_t count)
+    {
+        return static_cast<T*>(m_pool->allocate(count * sizeof(T)));
+    }
+
+    void deallocate(_In_ T* block, _In_ size_t count)
+    {
+        m_pool->deallocate(block, count * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(_In_ const multiplayer_event_args_allocator<U>& other) const { return m_pool == other.m_pool; }
+
+    template<typename U>
+    bool operator!=(_In_ const multiplayer_event_args_allocator<U>& other) const { return m_pool != other.m_pool; }
+
+    multiplayer_event_args_pool* m_pool;
+};
+
+// Drop-in replacement for std::make_shared for event args; the object and its control block come from the pool.
+template<typename T, typename... Args>
+std::shared_ptr<T> make_event_args(Args&&... args)
+{
+    return std::allocate_shared<T>(multiplayer_event_args_allocator<T>(), std::forward<Args>(args)...);
+}
+
+
 class multiplayer_session_writer : public std::enable_shared_from_this<multiplayer_session_writer>
 {
 public:
@@ -238,13 +354,13 @@ private:
     // resync
     bool m_isTaskInProgress;
     function_context m_handleResyncEventCounter;
-    xbox::services::system::xbox_live_mutex m_resyncLock;
+    xbox::services::system::xbox_live_mutex m_resyncLock XSAPI_LOCK_SITE("multiplayer_session_writer::m_resyncLock");
 
-    xbox::services::system::xbox_live_mutex m_stateLock;
+    xbox::services::system::xbox_live_mutex m_stateLock XSAPI_LOCK_SITE("multiplayer_session_writer::m_stateLock");
     function_context m_sessionUpdateEventHandlerCounter;
     std::unordered_map<uint32_t, std::function<void(const std::shared_ptr<xbox::services::multiplayer::multiplayer_session>)>> m_sessionUpdateEventHandler;
 
-    std::mutex m_synchronizeWriteWithTapLock;
+    xsapi_mutex m_synchronizeWriteWithTapLock XSAPI_LOCK_SITE("multiplayer_session_writer::m_synchronizeWriteWithTapLock");
     uint64_t m_tapChangeNumber;
     bool m_isTapReceived;
     uint64_t m_numOfWritesInProgress;
@@ -364,8 +480,8 @@ private:
         _In_opt_ context_t context = nullptr
         );
 
-    mutable std::mutex m_clientRequestLock;
-    std::atomic<bool> m_pendingCommitInProgress;
+    mutable xsapi_mutex m_clientRequestLock XSAPI_LOCK_SITE("multiplayer_game_client::m_clientRequestLock");
+    multiplayer_commit_strand m_commitStrand;
     string_t m_gameSessionTemplateName;
     uint64_t m_updateNumber;
     std::shared_ptr<multiplayer_session_writer> m_sessionWriter;
@@ -552,17 +668,35 @@ private:
         _In_ std::shared_ptr<xbox::services::multiplayer::multiplayer_session> lobbySessionToCommit
         );
 
+    pplx::task<xbox_live_result<std::vector<multiplayer_event>>> write_local_user_lobby_session(
+        _In_ std::shared_ptr<multiplayer_local_user> localUser,
+        _In_ std::shared_ptr<xbox::services::multiplayer::multiplayer_session> lobbySessionToCommit,
+        _In_ std::vector<std::shared_ptr<multiplayer_client_pending_request>> processingQueue,
+        _Inout_ std::atomic<bool>& removeStaleUsers
+        );
+
+    pplx::task<xbox_live_result<void>> create_game_from_lobby_helper(
+        _In_ std::shared_ptr<xbox::services::multiplayer::multiplayer_session> sessionToCommit,
+        _In_ std::shared_ptr<xbox_live_context_impl> primaryContext,
+        _In_ int attempts
+        );
+
+    void advertise_game_session_helper(
+        _In_ std::shared_ptr<xbox::services::multiplayer::multiplayer_session> lobbySession,
+        _In_ std::shared_ptr<xbox_live_context_impl> primaryContext
+        );
+
     std::shared_ptr<multiplayer_lobby_session> convert_to_multiplayer_lobby(
         _In_ const  std::shared_ptr<xbox::services::multiplayer::multiplayer_session>& sessionToConvert,
         _In_ const  std::shared_ptr<xbox::services::multiplayer::multiplayer_session>& gameSession
         );
 
     string_t m_lobbySessionTemplateName;
-    std::atomic<bool> m_pendingCommitInProgress;
+    multiplayer_commit_strand m_commitStrand;
 
     uint64_t m_updateNumber;
     xbox::services::multiplayer::manager::joinability m_joinability;
-    mutable std::mutex m_clientRequestLock;
+    mutable xsapi_mutex m_clientRequestLock XSAPI_LOCK_SITE("multiplayer_lobby_client::m_clientRequestLock");
     std::queue<std::shared_ptr<multiplayer_client_pending_request>> m_pendingRequestQueue;
     std::vector<multiplayer_event> m_multiplayerEventQueue;
     std::shared_ptr<multiplayer_session_writer> m_sessionWriter;
@@ -594,11 +728,14 @@ public:
     std::shared_ptr<multiplayer_game_client> game_client();
     std::shared_ptr<multiplayer_match_client> match_client();
 
-    std::vector<multiplayer_event> multiplayer_event_queue() const;
+    const std::vector<multiplayer_event>& multiplayer_event_queue() const;
+
+    // Hands the queued events to the caller and leaves the queue empty
+    std::vector<multiplayer_event> take_multiplayer_event_queue();
 
     void clear_multiplayer_event_queue();
     void add_to_multiplayer_event_queue(_In_ multiplayer_event multiplayerEvent);
-    void add_to_multiplayer_event_queue(_In_ std::vector<multiplayer_event> multiplayerEventQueue);
+    void add_to_multiplayer_event_queue(_In_ std::vector<multiplayer_event>&& multiplayerEventQueue);
 
     std::shared_ptr<xbox::services::multiplayer::multiplayer_session> get_session(_In_ xbox::services::multiplayer::multiplayer_session_reference sessionRef);
     void update_session(_In_ xbox::services::multiplayer::multiplayer_session_reference sessionRef, _In_ std::shared_ptr<xbox::services::multiplayer::multiplayer_session> session);
@@ -610,7 +747,8 @@ public:
     xbox_live_result<void> find_match(
         _In_ const string_t& hopperName,
         _In_ const web::json::value& attributes,
-        _In_ const std::chrono::seconds& timeout
+        _In_ const std::chrono::seconds& timeout,
+        _In_ std::shared_ptr<xbox::services::matchmaking::match_ticket_retry_policy> retryPolicy = nullptr
         );
 
     void set_auto_fill_members_during_matchmaking(_In_ bool autoFillMembers);
@@ -652,7 +790,7 @@ private:
 
     bool m_autoFillMembers;
     std::vector<multiplayer_event> m_multiplayerEventQueue;
-    mutable std::mutex m_clientRequestLock;
+    mutable xsapi_mutex m_clientRequestLock XSAPI_LOCK_SITE("multiplayer_client_pending_reader::m_clientRequestLock");
     std::shared_ptr<multiplayer_lobby_client> m_lobbyClient;
     std::shared_ptr<multiplayer_game_client> m_gameClient;
     std::shared_ptr<xbox::services::multiplayer::manager::multiplayer_match_client> m_matchClient;
@@ -728,7 +866,7 @@ public:
 
     ~multiplayer_local_user_manager();
 
-    xbox::services::system::xbox_live_mutex m_lock;
+    xbox::services::system::xbox_live_mutex m_lock XSAPI_LOCK_SITE("multiplayer_local_user_manager::m_lock");
     std::shared_ptr<xbox_live_context_impl> get_primary_context();
 
     void change_all_local_user_lobby_state(_In_ multiplayer_local_user_lobby_state state);
@@ -780,7 +918,7 @@ private:
 
     void on_resync_message_received();
 
-    xbox::services::system::xbox_live_mutex m_subscriptionLock;
+    xbox::services::system::xbox_live_mutex m_subscriptionLock XSAPI_LOCK_SITE("multiplayer_local_user_manager::m_subscriptionLock");
     function_context m_sessionChangeEventHandlerCounter;
     function_context m_multiplayerSubscriptionLostEventHandlerCounter;
     function_context m_rtaResyncEventHandlerCounter;
@@ -792,6 +930,78 @@ private:
     std::shared_ptr<xbox_live_context_impl> m_primaryXboxLiveContext;
 };
 
+// Keeps the activities of a local user's social group so repeated queries are answered locally.
+// The index is seeded with one social group query and afterwards only re-queries users that
+// Social Manager reports as having changed presence.
+// Returns the members of socialGroup in the local user's social graph, or an error if Social Manager can't tell
+typedef std::function<xbox_live_result<std::vector<string_t>>(
+    _In_ const string_t& localXboxUserId,
+    _In_ const string_t& socialGroup
+    )> social_group_member_resolver;
+
+class multiplayer_activity_index : public std::enable_shared_from_this<multiplayer_activity_index>
+{
+public:
+    // Group members are looked up in Social Manager unless a groupMemberResolver is given
+    multiplayer_activity_index(
+        _In_ const xbox::services::multiplayer::multiplayer_service& multiplayerService,
+        _In_ const string_t& serviceConfigurationId,
+        _In_ const string_t& localXboxUserId,
+        _In_ const string_t& socialGroup,
+        _In_ social_group_member_resolver groupMemberResolver = nullptr
+        );
+
+    ~multiplayer_activity_index();
+
+    // A titleId of 0 or an empty sessionTemplateName matches every activity.
+    pplx::task<xbox_live_result<std::vector<xbox::services::multiplayer::multiplayer_activity_details>>> get_activities(
+        _In_ uint32_t titleId,
+        _In_ const string_t& sessionTemplateName
+        );
+
+    void on_social_events(
+        _In_ const std::vector<xbox::services::social::manager::social_event>& socialEvents
+        );
+
+    uint32_t service_call_count() const;
+
+private:
+    pplx::task<xbox_live_result<void>> update_index();
+    pplx::task<xbox_live_result<void>> seed_index();
+    pplx::task<xbox_live_result<void>> refresh_changed_users(_In_ const std::vector<string_t>& changedUsers);
+
+    std::vector<xbox::services::multiplayer::multiplayer_activity_details> query(
+        _In_ uint32_t titleId,
+        _In_ const string_t& sessionTemplateName
+        ) const;
+
+    void register_social_event_handler();
+    void update_group_members(_In_ const xbox_live_result<std::vector<string_t>>& groupMembers);
+    void clear();
+
+    static const std::chrono::seconds MAX_INDEX_AGE;
+    static const std::chrono::seconds MAX_SOCIAL_EVENT_GAP;
+
+    mutable xsapi_mutex m_lock XSAPI_LOCK_SITE("multiplayer_activity_index::m_lock");
+    xbox::services::multiplayer::multiplayer_service m_multiplayerService;
+    string_t m_serviceConfigurationId;
+    string_t m_localXboxUserId;
+    string_t m_socialGroup;
+    social_group_member_resolver m_groupMemberResolver;
+
+    bool m_isSeeded;
+    bool m_isTrackingGroup;
+    bool m_updateInProgress;
+    pplx::task<xbox_live_result<void>> m_pendingUpdate;
+    std::chrono::steady_clock::time_point m_lastSeedTime;
+    std::chrono::steady_clock::time_point m_lastSocialEventsTime;
+    std::vector<xbox::services::multiplayer::multiplayer_activity_details> m_activities;
+    std::set<string_t> m_changedUsers;
+    std::set<string_t> m_groupMembers;
+    function_context m_socialEventContext;
+    std::atomic<uint32_t> m_serviceCallCount;
+};
+
 class multiplayer_client_manager : public std::enable_shared_from_this<multiplayer_client_manager>
 {
 public:
@@ -849,7 +1059,9 @@ public:
 
     pplx::task<xbox_live_result<std::vector<xbox::services::multiplayer::multiplayer_activity_details>>> get_activities_for_social_group(
         _In_ xbox_live_user_t user,
-        _In_ const string_t& socialGroup
+        _In_ const string_t& socialGroup,
+        _In_ uint32_t titleId = 0,
+        _In_ const string_t& sessionTemplateName = string_t()
         );
 
     xbox_live_result<void> invite_friends(
@@ -895,7 +1107,8 @@ public:
     xbox_live_result<void> find_match(
         _In_ const string_t& hopperName,
         _In_ const web::json::value& attributes,
-        _In_ const std::chrono::seconds& timeout
+        _In_ const std::chrono::seconds& timeout,
+        _In_ std::shared_ptr<xbox::services::matchmaking::match_ticket_retry_policy> retryPolicy = nullptr
         );
 
     void set_auto_fill_members_during_matchmaking(_In_ bool autoFillMembers);
@@ -904,8 +1117,7 @@ public:
         _In_ const xbox::services::multiplayer::multiplayer_session_change_event_args& args
     );
 
-    std::vector<multiplayer_event> event_queue() const;
-    void clear_event_queue();
+    std::vector<multiplayer_event> take_event_queue();
 
     void on_multiplayer_subscriptions_lost();
 
@@ -1003,8 +1215,8 @@ private:
         _In_ std::string errorMessage = std::string()
         );
 
-    mutable std::mutex m_clientRequestLock;
-    std::mutex m_synchronizeWriteWithTapLock;
+    mutable xsapi_mutex m_clientRequestLock XSAPI_LOCK_SITE("multiplayer_client_manager::m_clientRequestLock");
+    xsapi_mutex m_synchronizeWriteWithTapLock XSAPI_LOCK_SITE("multiplayer_client_manager::m_synchronizeWriteWithTapLock");
     std::atomic<bool> m_subscriptionsLostFired;
 
     bool m_autoFillMembers;
@@ -1020,6 +1232,48 @@ private:
     std::shared_ptr<multiplayer_local_user_manager> m_multiplayerLocalUserManager;
     std::shared_ptr<multiplayer_client_pending_reader> m_lastPendingRead;
     std::shared_ptr<multiplayer_client_pending_reader> m_latestPendingRead;
+    std::map<string_t, std::shared_ptr<multiplayer_activity_index>> m_activityIndexes;
+};
+
+// Runs the match client's next session fetch at a set time, independent of how often do_work() is called.
+// At most one fetch is pending: arming again replaces it and cancel() drops it, e.g. when a shoulder tap
+// delivered the session first.
+class multiplayer_match_fetch_timer : public std::enable_shared_from_this<multiplayer_match_fetch_timer>
+{
+public:
+    typedef std::function<utility::datetime()> clock_function;
+    typedef std::function<void(std::chrono::milliseconds delay, std::function<void()> callback)> schedule_function;
+
+    multiplayer_match_fetch_timer();
+
+    // Does nothing if already armed for dueTime, so callers can re-arm on every state check
+    void arm(
+        _In_ const utility::datetime& dueTime,
+        _In_ std::function<void()> onDue
+        );
+
+    void cancel();
+
+    bool is_armed() const;
+
+    utility::datetime now() const;
+
+    // Only used for unit tests: replaces utc_now() and create_delayed_task with a simulated clock
+    void _Set_clock(
+        _In_ clock_function clock,
+        _In_ schedule_function schedule
+        );
+
+private:
+    void on_due(_In_ uint64_t generation);
+
+    mutable xsapi_mutex m_lock XSAPI_LOCK_SITE("multiplayer_match_fetch_timer::m_lock");
+    clock_function m_clock;
+    schedule_function m_schedule;
+    uint64_t m_generation;
+    bool m_isArmed;
+    utility::datetime m_dueTime;
+    std::function<void()> m_onDue;
 };
 
 class multiplayer_match_client : public std::enable_shared_from_this<multiplayer_match_client>
@@ -1038,12 +1292,17 @@ public:
 
     std::chrono::seconds estimated_match_wait_time() const;
 
+    // Time spent searching across every ticket submitted for the current or last find_match()
+    std::chrono::seconds cumulative_match_wait_time() const;
+
+    // A null retryPolicy keeps the single ticket behavior: expiry ends the search
     xbox_live_result<void> find_match(
         _In_ const string_t& hopperName,
         _In_ const web::json::value& attributes,
         _In_ const std::chrono::seconds& timeout,
         _In_ std::shared_ptr<xbox::services::multiplayer::multiplayer_session> session,
-        _In_ bool preserveSession = false
+        _In_ bool preserveSession = false,
+        _In_ std::shared_ptr<xbox::services::matchmaking::match_ticket_retry_policy> retryPolicy = nullptr
         );
 
     xbox_live_result<void> find_match(
@@ -1083,10 +1342,28 @@ public:
 
     void disable_next_timer(bool value);
 
+    // Only used for unit tests: drives the fetch timer and the ticket deadline from a simulated clock
+    void _Set_clock(
+        _In_ multiplayer_match_fetch_timer::clock_function clock,
+        _In_ multiplayer_match_fetch_timer::schedule_function schedule
+        );
+
     bool m_disableNextTimer;
 
 private:
-    void check_next_timer();
+    void arm_next_timer();
+    void set_next_fetch_time(
+        _In_ const utility::datetime& nextFetchTime,
+        _In_ const utility::datetime& ticketDeadline
+        );
+    void retry_fetch_later();
+    void handle_ticket_fetch_failed(
+        _In_ std::error_code errorCode,
+        _In_ std::string errorMessage
+        );
+    void fetch_on_timer();
+    void submit_match_ticket(_In_ std::shared_ptr<xbox_live_context_impl> primaryContext);
+    bool resubmit_expired_ticket();
     void process_ticket_response();
     void handle_session_joined();
     void get_latest_session();
@@ -1102,15 +1379,21 @@ private:
         _In_ std::shared_ptr<xbox::services::multiplayer::multiplayer_session> session
         );
 
-    xbox::services::system::xbox_live_mutex m_lock;
-    xbox::services::system::xbox_live_mutex m_getSessionLock;
+    xbox::services::system::xbox_live_mutex m_lock XSAPI_LOCK_SITE("multiplayer_match_client::m_lock");
+    xbox::services::system::xbox_live_mutex m_getSessionLock XSAPI_LOCK_SITE("multiplayer_match_client::m_getSessionLock");
+    // Guards m_nextTimerToFetchSession and m_ticketDeadline, which ticket, fetch and timer threads all write
+    xbox::services::system::xbox_live_mutex m_fetchScheduleLock XSAPI_LOCK_SITE("multiplayer_match_client::m_fetchScheduleLock");
     utility::datetime m_nextTimerToFetchSession;
+    utility::datetime m_ticketDeadline;
+    std::shared_ptr<multiplayer_match_fetch_timer> m_fetchTimer;
     string_t m_hopperName;
     web::json::value m_attributes;
     std::chrono::seconds m_timeout;
+    std::shared_ptr<xbox::services::matchmaking::match_ticket_retry_policy> m_retryPolicy;
+    std::shared_ptr<xbox::services::matchmaking::match_ticket_lifecycle> m_ticketLifecycle;
     bool m_preservingMatchmakingSession;
     std::atomic<xbox::services::multiplayer::manager::match_status> m_matchStatus;
-    mutable std::mutex m_multiplayerEventQueueLock;
+    mutable xsapi_mutex m_multiplayerEventQueueLock XSAPI_LOCK_SITE("multiplayer_match_client::m_multiplayerEventQueueLock");
     std::vector<multiplayer_event> m_multiplayerEventQueue;
     xbox::services::matchmaking::create_match_ticket_response m_matchTicketResponse;
     xbox::services::multiplayer::multiplayer_session_reference m_matchTicketSessionRef;
@@ -1119,6 +1402,11 @@ private:
 
     pplx::task<void> m_getSessionTask;
     pplx::task<xbox_live_result<std::shared_ptr<xbox::services::multiplayer::multiplayer_session>>> m_joinTargetSessionTask;
+
+    static const std::chrono::seconds TICKET_TIMEOUT_GRACE;
+    static const std::chrono::seconds TICKET_STATUS_RETRY_DELAY;
+    static const std::chrono::seconds SESSION_FETCH_RETRY_DELAY;
+    static const std::chrono::seconds NON_HOST_SEARCH_TIMEOUT;
 };
 
 class multiplayer_manager_utils
@@ -20,13 +20,22 @@ using namespace Windows::Xbox::Networking;
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_MULTIPLAYER_MANAGER_CPP_BEGIN
 
+// The service can be a few seconds late marking a timed out ticket, so it only counts as failed after this
+const std::chrono::seconds multiplayer_match_client::TICKET_TIMEOUT_GRACE = std::chrono::seconds(5);
+const std::chrono::seconds multiplayer_match_client::TICKET_STATUS_RETRY_DELAY = std::chrono::seconds(1);
+// Nothing else re-arms the timer after a failed, skipped or unchanged fetch, so without this matchmaking could stall
+const std::chrono::seconds multiplayer_match_client::SESSION_FETCH_RETRY_DELAY = std::chrono::seconds(5);
+// A client that didn't create the ticket doesn't know its timeout
+const std::chrono::seconds multiplayer_match_client::NON_HOST_SEARCH_TIMEOUT = std::chrono::seconds(120);
+
 multiplayer_match_client::multiplayer_match_client(
     _In_ std::shared_ptr<multiplayer_local_user_manager> localUserManager
     ) :
     m_multiplayerLocalUserManager(localUserManager),
     m_matchStatus(match_status::none),
     m_disableNextTimer(false),
-    m_preservingMatchmakingSession(false)
+    m_preservingMatchmakingSession(false),
+    m_fetchTimer(std::make_shared<multiplayer_match_fetch_timer>())
 {
     m_getSessionTask = pplx::create_task([]{});
 }
@@ -36,7 +45,7 @@ multiplayer_match_client::deep_copy_if_updated(
     _In_ const multiplayer_match_client& other
     )
 {
-    std::lock_guard<std::mutex> lock(m_lock.get());
+    std::lock_guard<xsapi_mutex> lock(m_lock.get());
     if (other.m_matchSession == nullptr)
     {
         m_matchSession = nullptr;
@@ -65,7 +74,7 @@ multiplayer_match_client::do_work()
 
         case match_status::searching:
         {
-            check_next_timer();
+            // Nothing to do here. The fetch timer armed when the ticket was created fetches the ticket session.
             break;
         }
 
@@ -108,9 +117,8 @@ multiplayer_match_client::do_work()
 
     std::vector<multiplayer_event> eventQueue;
     {
-        std::lock_guard<std::mutex> lock(m_multiplayerEventQueueLock);
-        eventQueue = m_multiplayerEventQueue;
-        m_multiplayerEventQueue.clear();
+        std::lock_guard<xsapi_mutex> lock(m_multiplayerEventQueueLock);
+        eventQueue.swap(m_multiplayerEventQueue);
     }
 
     return eventQueue;
@@ -120,41 +128,164 @@ void
 multiplayer_match_client::disable_next_timer(bool value)
 {
     m_disableNextTimer = value;
+
+    // A timer that fired while disabled did nothing, so pick up where it left off
+    if (!value && m_matchStatus != match_status::none)
+    {
+        arm_next_timer();
+    }
+}
+
+void
+multiplayer_match_client::_Set_clock(
+    _In_ multiplayer_match_fetch_timer::clock_function clock,
+    _In_ multiplayer_match_fetch_timer::schedule_function schedule
+    )
+{
+    m_fetchTimer->_Set_clock(std::move(clock), std::move(schedule));
+}
+
+void
+multiplayer_match_client::arm_next_timer()
+{
+    utility::datetime dueTime;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_fetchScheduleLock.get());
+        dueTime = m_nextTimerToFetchSession;
+    }
+
+    std::weak_ptr<multiplayer_match_client> thisWeakPtr = shared_from_this();
+    m_fetchTimer->arm(dueTime, [thisWeakPtr]()
+    {
+        std::shared_ptr<multiplayer_match_client> pThis(thisWeakPtr.lock());
+        if (pThis != nullptr)
+        {
+            pThis->fetch_on_timer();
+        }
+    });
+}
+
+void
+multiplayer_match_client::set_next_fetch_time(
+    _In_ const utility::datetime& nextFetchTime,
+    _In_ const utility::datetime& ticketDeadline
+    )
+{
+    {
+        std::lock_guard<xsapi_mutex> lock(m_fetchScheduleLock.get());
+        m_nextTimerToFetchSession = nextFetchTime;
+        m_ticketDeadline = ticketDeadline;
+    }
+    arm_next_timer();
+}
+
+void
+multiplayer_match_client::retry_fetch_later()
+{
+    auto status = static_cast<enum match_status>(m_matchStatus);
+    if (status != match_status::searching &&
+        status != match_status::waiting_for_remote_clients_to_join &&
+        status != match_status::waiting_for_remote_clients_to_upload_qos &&
+        status != match_status::measuring)
+    {
+        return;
+    }
+
+    auto now = m_fetchTimer->now();
+    auto retryTime = now + utility::datetime::from_seconds(static_cast<unsigned int>(SESSION_FETCH_RETRY_DELAY.count()));
+    {
+        std::lock_guard<xsapi_mutex> lock(m_fetchScheduleLock.get());
+
+        // Still look at the ticket once its deadline comes, so a search can't outlive it
+        if (status == match_status::searching &&
+            now.to_interval() < m_ticketDeadline.to_interval() &&
+            m_ticketDeadline.to_interval() < retryTime.to_interval())
+        {
+            retryTime = m_ticketDeadline;
+        }
+        m_nextTimerToFetchSession = retryTime;
+    }
+    arm_next_timer();
+}
+
+void
+multiplayer_match_client::handle_ticket_fetch_failed(
+    _In_ std::error_code errorCode,
+    _In_ std::string errorMessage
+    )
+{
+    if (m_matchStatus != match_status::searching) return;
+
+    utility::datetime ticketDeadline;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_fetchScheduleLock.get());
+        ticketDeadline = m_ticketDeadline;
+    }
+
+    if (m_fetchTimer->now().to_interval() < ticketDeadline.to_interval())
+    {
+        retry_fetch_later();
+        return;
+    }
+
+    // The ticket has timed out and its status can't be read, so the search is over
+    xbox::services::multiplayer::manager::match_status expected = match_status::searching;
+    if (m_matchStatus.compare_exchange_strong(expected, match_status::failed))
+    {
+        handle_find_match_completed(errorCode, std::move(errorMessage));
+    }
 }
 
 void
-multiplayer_match_client::check_next_timer()
+multiplayer_match_client::fetch_on_timer()
 {
     if (m_disableNextTimer) return;     // Only used for Unit tests
 
-    int64_t delta = m_nextTimerToFetchSession.to_interval() - utility::datetime::utc_now().to_interval();
-    if ( delta < 0)
+    if (m_matchStatus == match_status::searching)
     {
-        if (m_matchStatus == match_status::searching)
+        std::lock_guard<xsapi_mutex> lock(m_getSessionLock.get());
+        std::shared_ptr<xbox_live_context_impl> primaryContext = m_multiplayerLocalUserManager->get_primary_context();
+        if (primaryContext == nullptr || !m_getSessionTask.is_done())
         {
-            std::shared_ptr<xbox_live_context_impl> primaryContext = m_multiplayerLocalUserManager->get_primary_context();
-            if (primaryContext == nullptr) return;
-            if (!m_getSessionTask.is_done()) return;
-
-            // Fetch ticket session
-            std::weak_ptr<multiplayer_match_client> thisWeakPtr = shared_from_this();
-            m_getSessionTask = primaryContext->multiplayer_service().get_current_session(m_matchTicketSessionRef)
-            .then([thisWeakPtr](xbox_live_result<std::shared_ptr<multiplayer_session>> sessionResult)
+            retry_fetch_later();
+            return;
+        }
+
+        // Fetch ticket session
+        std::weak_ptr<multiplayer_match_client> thisWeakPtr = shared_from_this();
+        m_getSessionTask = primaryContext->multiplayer_service().get_current_session(m_matchTicketSessionRef)
+        .then([thisWeakPtr](pplx::task<xbox_live_result<std::shared_ptr<multiplayer_session>>> t)
+        {
+            std::shared_ptr<multiplayer_match_client> pThis(thisWeakPtr.lock());
+            if (pThis == nullptr) return;
+
+            try
             {
-                if (!sessionResult.err())
+                auto sessionResult = t.get();
+                if (sessionResult.err())
                 {
-                    std::shared_ptr<multiplayer_match_client> pThis(thisWeakPtr.lock());
-                    if (pThis != nullptr)
-                    {
-                        pThis->handle_match_status_changed(sessionResult.payload());
-                    }
+                    pThis->handle_ticket_fetch_failed(sessionResult.err(), sessionResult.err_message());
+                    return;
                 }
-            });
-        }
-        else
-        {
-            get_latest_session();
-        }
+
+                pThis->handle_match_status_changed(sessionResult.payload());
+            }
+            catch (const std::exception& e)
+            {
+                pThis->handle_ticket_fetch_failed(xbox_live_error_code::generic_error, e.what());
+                return;
+            }
+
+            // A session that hasn't reached the next check yet leaves nothing armed
+            if (pThis->m_matchStatus == match_status::searching && !pThis->m_fetchTimer->is_armed())
+            {
+                pThis->retry_fetch_later();
+            }
+        });
+    }
+    else
+    {
+        get_latest_session();
     }
 }
 
@@ -179,7 +310,7 @@ multiplayer_match_client::handle_qos_measurements()
     {
         m_matchStatus = match_status::measuring;
 
-        std::shared_ptr<perform_qos_measurements_event_args> performQosEventArgs = std::make_shared<perform_qos_measurements_event_args>(addressDeviceTokenMap);
+        std::shared_ptr<perform_qos_measurements_event_args> performQosEventArgs = make_event_args<perform_qos_measurements_event_args>(addressDeviceTokenMap);
         multiplayer_event multiplayerEvent(
             xbox_live_error_code::no_error,
             std::string(),
@@ -188,14 +319,14 @@ multiplayer_match_client::handle_qos_measurements()
             multiplayer_session_type::game_session
             );
 
-        std::lock_guard<std::mutex> lock(m_multiplayerEventQueueLock);
+        std::lock_guard<xsapi_mutex> lock(m_multiplayerEventQueueLock);
         m_multiplayerEventQueue.push_back(multiplayerEvent);
     }
     else
     {
         // If clients fail to join, the stage advances to "measuring".
         // Wait until memberInitialization either succeeds or fails.
-        check_next_timer();
+        arm_next_timer();
     }
 }
 
@@ -205,6 +336,13 @@ multiplayer_match_client::handle_find_match_completed(
     _In_ std::string errorMessage
     )
 {
+    // The search is over one way or another, so there is nothing left to fetch
+    m_fetchTimer->cancel();
+    if (m_ticketLifecycle != nullptr)
+    {
+        m_ticketLifecycle->on_ticket_finished(m_fetchTimer->now());
+    }
+
     multiplayer_measurement_failure failure = multiplayer_measurement_failure::unknown;
 
     auto matchSession = session();
@@ -213,7 +351,7 @@ multiplayer_match_client::handle_find_match_completed(
         failure = matchSession->current_user()->initialization_failure_cause();
     }
 
-    std::shared_ptr<find_match_completed_event_args> findMatchEventArgs = std::make_shared<find_match_completed_event_args>(
+    std::shared_ptr<find_match_completed_event_args> findMatchEventArgs = make_event_args<find_match_completed_event_args>(
         m_matchStatus,
         failure
         );
@@ -226,7 +364,7 @@ multiplayer_match_client::handle_find_match_completed(
         multiplayer_session_type::game_session
         );
 
-    std::lock_guard<std::mutex> lock(m_multiplayerEventQueueLock);
+    std::lock_guard<xsapi_mutex> lock(m_multiplayerEventQueueLock);
     m_multiplayerEventQueue.push_back(multiplayerEvent);
 }
 
@@ -235,6 +373,9 @@ multiplayer_match_client::handle_match_status_changed(
     _In_ std::shared_ptr<multiplayer_session> matchSession
     )
 {
+    // Until the ticket is created, a fetched session still describes the previous one
+    if (m_matchStatus == match_status::submitting_match_ticket) return;
+
     matchmaking_status status = matchSession->matchmaking_server().status();
     switch (status)
     {
@@ -244,14 +385,32 @@ multiplayer_match_client::handle_match_status_changed(
             if (m_matchStatus.compare_exchange_strong(expected, match_status::searching, std::memory_order_release))
             {
                 // Wait for status to change on ticket session or fetch after 2 mins.
-                m_nextTimerToFetchSession = utility::datetime::utc_now() + utility::datetime::from_seconds(120);
+                auto searchTimeout = m_fetchTimer->now() + utility::datetime::from_seconds(static_cast<unsigned int>(NON_HOST_SEARCH_TIMEOUT.count()));
+                set_next_fetch_time(searchTimeout, searchTimeout);
             }
             else 
             {
                 if (m_disableNextTimer) return;     // Only used for Unit tests
 
-                int64_t delta = m_nextTimerToFetchSession.to_interval() - utility::datetime::utc_now().to_interval();
-                if ( delta < 0)
+                auto now = m_fetchTimer->now();
+                utility::datetime nextTimerToFetchSession;
+                utility::datetime ticketDeadline;
+                {
+                    std::lock_guard<xsapi_mutex> lock(m_fetchScheduleLock.get());
+                    nextTimerToFetchSession = m_nextTimerToFetchSession;
+                    ticketDeadline = m_ticketDeadline;
+                }
+
+                if (now.to_interval() < ticketDeadline.to_interval())
+                {
+                    if (now.to_interval() >= nextTimerToFetchSession.to_interval())
+                    {
+                        // Past the ticket's timeout but the service hasn't marked it yet, so look again shortly
+                        auto retryTime = now + utility::datetime::from_seconds(static_cast<unsigned int>(TICKET_STATUS_RETRY_DELAY.count()));
+                        set_next_fetch_time(retryTime.to_interval() < ticketDeadline.to_interval() ? retryTime : ticketDeadline, ticketDeadline);
+                    }
+                }
+                else
                 {
                     // Delete the match ticket and let the title know that it failed.
                     if (!m_hopperName.empty() && !m_matchTicketResponse.match_ticket_id().empty())
@@ -267,6 +426,8 @@ multiplayer_match_client::handle_match_status_changed(
                         );
                     }
 
+                    if (resubmit_expired_ticket()) return;
+
                     m_matchStatus = match_status::failed;
                     handle_find_match_completed(xbox_live_error_code::generic_error, "Matchmaking request failed.");
                 }
@@ -275,6 +436,8 @@ multiplayer_match_client::handle_match_status_changed(
         }
         case matchmaking_status::expired:
         {
+            if (resubmit_expired_ticket()) break;
+
             m_matchStatus = match_status::expired;
             handle_find_match_completed(xbox_live_error_code::generic_error, "Matchmaking request expired.");
             break;
@@ -307,7 +470,7 @@ multiplayer_match_client::handle_initialization_state_changed(
         {
             case multiplayer_initialization_stage::joining:
             {
-                check_next_timer();
+                arm_next_timer();
                 break;
             }
 
@@ -316,7 +479,7 @@ multiplayer_match_client::handle_initialization_state_changed(
                 if (m_matchStatus == match_status::waiting_for_remote_clients_to_upload_qos ||
                     m_matchStatus == match_status::measuring)
                 {
-                    check_next_timer();
+                    arm_next_timer();
                 }
                 else if (m_matchStatus == match_status::waiting_for_remote_clients_to_join)
                 {
@@ -356,7 +519,7 @@ multiplayer_match_client::find_match(
     _In_ bool preserveSession
     )
 {
-    return find_match(m_hopperName, m_attributes, m_timeout, session, preserveSession);
+    return find_match(m_hopperName, m_attributes, m_timeout, session, preserveSession, m_retryPolicy);
 }
 
 xbox_live_result<void>
@@ -365,7 +528,8 @@ multiplayer_match_client::find_match(
     _In_ const web::json::value& attributes,
     _In_ const std::chrono::seconds& timeout,
     _In_ std::shared_ptr<multiplayer_session> session,
-    _In_ bool preserveSession
+    _In_ bool preserveSession,
+    _In_ std::shared_ptr<match_ticket_retry_policy> retryPolicy
     )
 {
     std::shared_ptr<xbox_live_context_impl> primaryContext = m_multiplayerLocalUserManager->get_primary_context();
@@ -394,38 +558,103 @@ multiplayer_match_client::find_match(
     m_timeout = timeout;
     m_preservingMatchmakingSession = preserveSession;
     m_matchTicketSessionRef = session->session_reference();
+    m_retryPolicy = retryPolicy;
+    m_ticketLifecycle = retryPolicy == nullptr ? nullptr : std::make_shared<match_ticket_lifecycle>(*retryPolicy, attributes, timeout);
+
+    submit_match_ticket(primaryContext);
+    return xbox_live_result<void>();
+}
+
+void
+multiplayer_match_client::submit_match_ticket(
+    _In_ std::shared_ptr<xbox_live_context_impl> primaryContext
+    )
+{
+    auto ticketLifecycle = m_ticketLifecycle;
+    auto ticketSessionRef = m_matchTicketSessionRef;
+    auto hopperName = m_hopperName;
+    auto preserveSession = m_preservingMatchmakingSession ? preserve_session_mode::always : preserve_session_mode::never;
+    auto matchmakingService = primaryContext->matchmaking_service();
+
+    pplx::task<std::chrono::seconds> timeoutTask = ticketLifecycle == nullptr ?
+        pplx::task_from_result(m_timeout) :
+        ticketLifecycle->choose_ticket_timeout(matchmakingService, ticketSessionRef.service_configuration_id(), hopperName);
+    web::json::value attributes = ticketLifecycle == nullptr ? m_attributes : ticketLifecycle->attributes();
 
     std::weak_ptr<multiplayer_match_client> thisWeakPtr = shared_from_this();
-    primaryContext->matchmaking_service().create_match_ticket(
-        session->session_reference(),
-        session->session_reference().service_configuration_id(),
-        hopperName,
-        timeout,
-        preserveSession ? preserve_session_mode::always : preserve_session_mode::never,
-        attributes
-        )
-    .then([thisWeakPtr, timeout](xbox_live_result<create_match_ticket_response> result)
-    {
-        std::shared_ptr<multiplayer_match_client> pThis(thisWeakPtr.lock());
-        if (pThis != nullptr)
+    timeoutTask.then([thisWeakPtr, matchmakingService, ticketSessionRef, hopperName, preserveSession, attributes](std::chrono::seconds timeout)
+    {
+        auto service = matchmakingService;
+        return service.create_match_ticket(
+            ticketSessionRef,
+            ticketSessionRef.service_configuration_id(),
+            hopperName,
+            timeout,
+            preserveSession,
+            attributes
+            )
+        .then([thisWeakPtr, service, hopperName, timeout](xbox_live_result<create_match_ticket_response> result)
         {
-            if (!result.err())
+            std::shared_ptr<multiplayer_match_client> pThis(thisWeakPtr.lock());
+            if (pThis == nullptr)
             {
-                pThis->m_matchTicketResponse = result.payload();
-                pThis->m_matchStatus = match_status::searching;
-                pThis->m_nextTimerToFetchSession = utility::datetime::utc_now() 
-                    + utility::datetime::from_seconds(static_cast<int32_t>(timeout.count()))
-                    + utility::datetime::from_seconds(5);   // some extra delay to be safe
+                return;
             }
-            else
+
+            if (result.err())
             {
                 pThis->m_matchStatus = match_status::failed;
                 pThis->handle_find_match_completed(result.err(), result.err_message());
+                return;
             }
-        }
+
+            pThis->m_matchTicketResponse = result.payload();
+            xbox::services::multiplayer::manager::match_status expected = match_status::submitting_match_ticket;
+            if (!pThis->m_matchStatus.compare_exchange_strong(expected, match_status::searching, std::memory_order_release))
+            {
+                // cancel_match() came in while a replacement ticket was on its way, so don't leave it orphaned
+                auto deleteService = service;
+                deleteService.delete_match_ticket(
+                    xbox::services::xbox_live_app_config::get_app_config_singleton()->scid(),
+                    hopperName,
+                    result.payload().match_ticket_id()
+                    );
+                pThis->m_matchStatus = match_status::canceled;
+                pThis->handle_find_match_completed(xbox_live_error_code::generic_error, "Matchmaking request was canceled.");
+                return;
+            }
+
+            if (pThis->m_ticketLifecycle != nullptr)
+            {
+                pThis->m_ticketLifecycle->on_ticket_submitted(pThis->m_fetchTimer->now());
+            }
+
+            // Look at the ticket as soon as it times out rather than waiting out the grace period, since
+            // the service has usually marked it expired by then
+            auto ticketTimeout = pThis->m_fetchTimer->now()
+                + utility::datetime::from_seconds(static_cast<int32_t>(timeout.count()));
+            pThis->set_next_fetch_time(
+                ticketTimeout,
+                ticketTimeout + utility::datetime::from_seconds(static_cast<int32_t>(TICKET_TIMEOUT_GRACE.count()))
+                );
+        });
     });
+}
 
-    return xbox_live_result<void>();
+bool
+multiplayer_match_client::resubmit_expired_ticket()
+{
+    if (m_ticketLifecycle == nullptr) return false;
+
+    std::shared_ptr<xbox_live_context_impl> primaryContext = m_multiplayerLocalUserManager->get_primary_context();
+    if (primaryContext == nullptr) return false;
+
+    if (!m_ticketLifecycle->on_ticket_expired(m_fetchTimer->now())) return false;
+
+    m_fetchTimer->cancel();
+    m_matchStatus = match_status::submitting_match_ticket;
+    submit_match_ticket(primaryContext);
+    return true;
 }
 
 void
@@ -477,6 +706,18 @@ multiplayer_match_client::estimated_match_wait_time() const
     return m_matchTicketResponse.estimated_wait_time(); 
 }
 
+std::chrono::seconds
+multiplayer_match_client::cumulative_match_wait_time() const
+{
+    auto ticketLifecycle = m_ticketLifecycle;
+    if (ticketLifecycle == nullptr)
+    {
+        return std::chrono::seconds(0);
+    }
+
+    return ticketLifecycle->cumulative_wait_time(m_fetchTimer->now());
+}
+
 void
 multiplayer_match_client::on_session_changed(
     _In_ const multiplayer_session_change_event_args& args
@@ -487,6 +728,8 @@ multiplayer_match_client::on_session_changed(
         multiplayer_manager_utils::do_session_references_match(matchSession->session_reference(), args.session_reference()) &&
         args.change_number() > matchSession->change_number())
     {
+        // The tap beat the timer; the fetched session brings its own next timer
+        m_fetchTimer->cancel();
         get_latest_session();
     }
 }
@@ -496,24 +739,39 @@ multiplayer_match_client::update_session(
     _In_ std::shared_ptr<multiplayer_session> session
     )
 {
-    std::lock_guard<std::mutex> lock(m_lock.get());
-
-    if (m_matchSession == nullptr || session == nullptr)
+    bool isNextTimerChanged = false;
     {
-        m_matchSession = session;
+        std::lock_guard<xsapi_mutex> lock(m_lock.get());
+
+        if (m_matchSession == nullptr || session == nullptr)
+        {
+            m_matchSession = session;
+        }
+        else if(multiplayer_manager_utils::do_sessions_match(m_matchSession, session) &&
+            session->change_number() > m_matchSession->change_number())
+        {
+            m_matchSession = session;
+            std::lock_guard<xsapi_mutex> scheduleLock(m_fetchScheduleLock.get());
+            m_nextTimerToFetchSession = m_fetchTimer->now() + utility::datetime::from_seconds(session->date_of_next_timer() - session->date_of_session());
+            isNextTimerChanged = true;
+        }
     }
-    else if(multiplayer_manager_utils::do_sessions_match(m_matchSession, session) &&
-        session->change_number() > m_matchSession->change_number())
+
+    // While waiting on remote clients, the session's next timer is when it's worth fetching again
+    auto status = static_cast<enum match_status>(m_matchStatus);
+    if (isNextTimerChanged &&
+        (status == match_status::waiting_for_remote_clients_to_join ||
+         status == match_status::waiting_for_remote_clients_to_upload_qos ||
+         status == match_status::measuring))
     {
-        m_matchSession = session;
-        m_nextTimerToFetchSession = utility::datetime::utc_now() + utility::datetime::from_seconds(session->date_of_next_timer() - session->date_of_session());
+        arm_next_timer();
     }
 }
 
 std::shared_ptr<multiplayer_session> 
 multiplayer_match_client::session()
 {
-    std::lock_guard<std::mutex> lock(m_lock.get());
+    std::lock_guard<xsapi_mutex> lock(m_lock.get());
     return m_matchSession;
 }
 
@@ -553,6 +811,11 @@ multiplayer_match_client::handle_match_found(
     }
 
     m_matchStatus = match_status::found;
+    m_fetchTimer->cancel();
+    if (m_ticketLifecycle != nullptr)
+    {
+        m_ticketLifecycle->on_ticket_finished(m_fetchTimer->now());
+    }
     auto targetSessionRef = currentSession->matchmaking_server().target_session_ref();
     auto targetGameSession = std::make_shared<multiplayer_session>(
         primaryXboxLiveContext->xbox_live_user_id(),
@@ -624,25 +887,42 @@ multiplayer_match_client::join_session_helper(
 void
 multiplayer_match_client::get_latest_session()
 {
-    std::lock_guard<std::mutex> lock(m_getSessionLock.get());
-    if (session() == nullptr) return;
+    std::lock_guard<xsapi_mutex> lock(m_getSessionLock.get());
+    auto matchSession = session();
+    if (matchSession == nullptr) return;
 
+    // The caller may have cancelled the timer for this fetch, so anything that skips it has to re-arm
     std::shared_ptr<xbox_live_context_impl> primaryContext = m_multiplayerLocalUserManager->get_primary_context();
-    if (primaryContext == nullptr) return;
-    if (!m_getSessionTask.is_done()) return;
+    if (primaryContext == nullptr || !m_getSessionTask.is_done())
+    {
+        retry_fetch_later();
+        return;
+    }
 
     std::weak_ptr<multiplayer_match_client> thisWeakPtr = shared_from_this();
-    m_getSessionTask = primaryContext->multiplayer_service().get_current_session(session()->session_reference())
-    .then([thisWeakPtr](xbox_live_result<std::shared_ptr<multiplayer_session>> sessionResult)
+    m_getSessionTask = primaryContext->multiplayer_service().get_current_session(matchSession->session_reference())
+    .then([thisWeakPtr](pplx::task<xbox_live_result<std::shared_ptr<multiplayer_session>>> t)
     {
-        if (!sessionResult.err())
+        std::shared_ptr<multiplayer_match_client> pThis(thisWeakPtr.lock());
+        if (pThis == nullptr) return;
+
+        try
         {
-            std::shared_ptr<multiplayer_match_client> pThis(thisWeakPtr.lock());
-            if (pThis != nullptr)
+            auto sessionResult = t.get();
+            if (!sessionResult.err())
             {
                 pThis->update_session(sessionResult.payload());
             }
         }
+        catch (const std::exception&)
+        {
+        }
+
+        // A failed fetch, or one that found the same change number, doesn't arm the next timer
+        if (!pThis->m_fetchTimer->is_armed())
+        {
+            pThis->retry_fetch_later();
+        }
     });
 }
 
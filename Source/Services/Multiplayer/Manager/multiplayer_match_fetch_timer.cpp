@@ -0,0 +1,126 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+
+#include "pch.h"
+#include "multiplayer_manager_internal.h"
+#if !XSAPI_U
+#include "ppltasks_extra.h"
+#else
+#include "ppltasks_extra_unix.h"
+#endif
+
+using namespace Concurrency::extras;
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MULTIPLAYER_MANAGER_CPP_BEGIN
+
+multiplayer_match_fetch_timer::multiplayer_match_fetch_timer() :
+    m_clock([]() { return utility::datetime::utc_now(); }),
+    m_schedule([](std::chrono::milliseconds delay, std::function<void()> callback)
+    {
+        create_delayed_task(delay, callback);
+    }),
+    m_generation(0),
+    m_isArmed(false)
+{
+}
+
+void
+multiplayer_match_fetch_timer::arm(
+    _In_ const utility::datetime& dueTime,
+    _In_ std::function<void()> onDue
+    )
+{
+    uint64_t generation;
+    std::chrono::milliseconds delay;
+    schedule_function schedule;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        if (m_isArmed && m_dueTime == dueTime)
+        {
+            return;
+        }
+
+        generation = ++m_generation;
+        m_isArmed = true;
+        m_dueTime = dueTime;
+        m_onDue = std::move(onDue);
+
+        // datetime intervals are in 100ns ticks
+        int64_t ticks = dueTime.to_interval() - m_clock().to_interval();
+        delay = std::chrono::milliseconds(__max(ticks / 10000, static_cast<int64_t>(0)));
+        schedule = m_schedule;
+    }
+
+    // A timer replaced before it fires finds a newer generation and does nothing
+    std::weak_ptr<multiplayer_match_fetch_timer> thisWeakPtr = shared_from_this();
+    schedule(delay, [thisWeakPtr, generation]()
+    {
+        std::shared_ptr<multiplayer_match_fetch_timer> pThis(thisWeakPtr.lock());
+        if (pThis != nullptr)
+        {
+            pThis->on_due(generation);
+        }
+    });
+}
+
+void
+multiplayer_match_fetch_timer::cancel()
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    ++m_generation;
+    m_isArmed = false;
+    m_onDue = nullptr;
+}
+
+bool
+multiplayer_match_fetch_timer::is_armed() const
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    return m_isArmed;
+}
+
+utility::datetime
+multiplayer_match_fetch_timer::now() const
+{
+    clock_function clock;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        clock = m_clock;
+    }
+    return clock();
+}
+
+void
+multiplayer_match_fetch_timer::_Set_clock(
+    _In_ clock_function clock,
+    _In_ schedule_function schedule
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    m_clock = std::move(clock);
+    m_schedule = std::move(schedule);
+}
+
+void
+multiplayer_match_fetch_timer::on_due(
+    _In_ uint64_t generation
+    )
+{
+    std::function<void()> onDue;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        if (!m_isArmed || generation != m_generation)
+        {
+            return;
+        }
+
+        m_isArmed = false;
+        onDue.swap(m_onDue);
+    }
+
+    // Called without the lock, since the fetch usually arms the next timer
+    onDue();
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_MULTIPLAYER_MANAGER_CPP_END
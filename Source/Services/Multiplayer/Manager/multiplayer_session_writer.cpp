@@ -84,7 +84,7 @@ multiplayer_session_writer::add_multiplayer_session_updated_handler(
     _In_ std::function<void(const std::shared_ptr<multiplayer_session>& )> handler
     )
 {
-    std::lock_guard<std::mutex> lock(m_stateLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_stateLock.get());
 
     function_context context = -1;
     if (handler != nullptr)
@@ -108,7 +108,7 @@ multiplayer_session_writer::on_session_updated(
     _In_ const std::shared_ptr<multiplayer_session>& updatedSession
     )
 {
-    std::lock_guard<std::mutex> lock(m_stateLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_stateLock.get());
 
     for (const auto& handler : m_sessionUpdateEventHandler)
     {
@@ -219,7 +219,7 @@ multiplayer_session_writer::commit_pending_synchronized_changes(
         std::vector<multiplayer_event> eventQueue;
         if (pThis != nullptr)
         {
-            std::lock_guard<std::mutex> lock(pThis->m_stateLock.get());
+            std::lock_guard<xsapi_mutex> lock(pThis->m_stateLock.get());
             eventQueue = pThis->handle_events(processingQueue, sessionResult.err(), sessionResult.err_message(), sessionType);
         }
         return xbox_live_result<std::vector<multiplayer_event>>(eventQueue, sessionResult.err(), sessionResult.err_message());
@@ -257,7 +257,7 @@ multiplayer_session_writer::commit_pending_changes(
         std::vector<multiplayer_event> eventQueue;
         if (pThis != nullptr)
         {
-            std::lock_guard<std::mutex> lock(pThis->m_stateLock.get());
+            std::lock_guard<xsapi_mutex> lock(pThis->m_stateLock.get());
             eventQueue = pThis->handle_events(processingQueue, sessionResult.err(), sessionResult.err_message(), sessionType);
         }
         return xbox_live_result<std::vector<multiplayer_event>>(eventQueue, sessionResult.err(), sessionResult.err_message());
@@ -317,7 +317,7 @@ multiplayer_session_writer::write_session_helper(
     _In_ bool updateLatest
     )
 {
-    std::lock_guard<std::mutex> guard(m_synchronizeWriteWithTapLock);
+    std::lock_guard<xsapi_mutex> guard(m_synchronizeWriteWithTapLock);
 
     xbox_live_result<std::shared_ptr<multiplayer_session>> xboxLiveResult = sessionResult;
     if (!xboxLiveResult.err() || xboxLiveResult.err() == xbox_live_error_condition::http_412_precondition_failed)
@@ -348,7 +348,7 @@ multiplayer_session_writer::on_session_changed(
     _In_ const multiplayer_session_change_event_args& args
     )
 {
-    std::lock_guard<std::mutex> guard(m_synchronizeWriteWithTapLock);
+    std::lock_guard<xsapi_mutex> guard(m_synchronizeWriteWithTapLock);
 
     multiplayer_session_reference sessionRef = args.session_reference();
     uint64_t argsChangeNumber = args.change_number();
@@ -398,7 +398,7 @@ void
 multiplayer_session_writer::resync()
 {
 #if UWP_API || TV_API || UNIT_TEST_SERVICES
-    std::lock_guard<std::mutex> lock(m_resyncLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_resyncLock.get());
 
     auto cachedSession = session();
     if (cachedSession != nullptr && !m_isTaskInProgress && m_handleResyncEventCounter > 0)
@@ -417,7 +417,7 @@ multiplayer_session_writer::resync()
             std::shared_ptr<multiplayer_session_writer> pThis(thisWeakPtr.lock());
             if (pThis != nullptr)
             {
-                std::lock_guard<std::mutex> lock(pThis->m_resyncLock.get());
+                std::lock_guard<xsapi_mutex> lock(pThis->m_resyncLock.get());
                 pThis->m_isTaskInProgress = false;
 
                 // Call resync from another task to avoid m_resyncLock from deadlocking.
@@ -491,7 +491,7 @@ multiplayer_session_writer::handle_events(
                 errorCode,
                 errorMessage,
                 multiplayer_event_type::joinability_state_changed,
-                std::make_shared<multiplayer_event_args>(),
+                make_event_args<multiplayer_event_args>(),
                 sessionType,
                 request->context()
                 );
@@ -509,7 +509,7 @@ multiplayer_session_writer::handle_events(
                     errorCode,
                     errorMessage,
                     multiplayer_event_type::session_property_write_completed,
-                    std::make_shared<multiplayer_event_args>(),
+                    make_event_args<multiplayer_event_args>(),
                     sessionType,
                     request->context()
                     );
@@ -524,7 +524,7 @@ multiplayer_session_writer::handle_events(
                 errorCode,
                 errorMessage,
                 multiplayer_event_type::synchronized_host_write_completed,
-                std::make_shared<multiplayer_event_args>(),
+                make_event_args<multiplayer_event_args>(),
                 sessionType,
                 request->context()
                 );
@@ -542,7 +542,7 @@ multiplayer_session_writer::handle_events(
                     errorCode,
                     errorMessage,
                     multiplayer_event_type::session_synchronized_property_write_completed,
-                    std::make_shared<multiplayer_event_args>(),
+                    make_event_args<multiplayer_event_args>(),
                     sessionType,
                     request->context()
                     );
@@ -382,7 +382,7 @@ private:
     web::json::value m_servers;
     uint32_t m_memberRequestIndex;
     bool m_bLeaveSession;
-    xbox::services::system::xbox_live_mutex m_lock;
+    xbox::services::system::xbox_live_mutex m_lock XSAPI_LOCK_SITE("multiplayer_session_request::m_lock");
     bool m_writeClosed;
     bool m_closed;
     bool m_writeLocked;
@@ -478,8 +478,8 @@ private:
     function_context m_multiplayerSubscriptionLostEventHandlerCounter;
 
     bool m_subscriptionEnabled;
-    xbox::services::system::xbox_live_mutex m_subscriptionEnabledLock;
-    xbox::services::system::xbox_live_mutex m_subscriptionLock;
+    xbox::services::system::xbox_live_mutex m_subscriptionEnabledLock XSAPI_LOCK_SITE("multiplayer_service_impl::m_subscriptionEnabledLock");
+    xbox::services::system::xbox_live_mutex m_subscriptionLock XSAPI_LOCK_SITE("multiplayer_service_impl::m_subscriptionLock");
     function_context m_multiplayerJoinabilityChangeCounter;
 };
 
@@ -30,7 +30,7 @@ multiplayer_service_impl::~multiplayer_service_impl()
 task<xbox_live_result<string_t>>
 multiplayer_service_impl::ensure_multiplayer_subscription()
 {
-    std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
 
     RETURN_TASK_CPP_INVALIDARGUMENT_IF(m_realTimeActivityService == nullptr, string_t, "real_time_activity_service not initialized");
 
@@ -85,7 +85,7 @@ multiplayer_service_impl::multiplayer_session_changed(
 {
     std::unordered_map<uint32_t, std::function<void(const multiplayer_session_change_event_args&)>> sessionChangeCopy;
     {
-        std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+        std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
         sessionChangeCopy = m_sessionChangeEventHandler;
     }
 
@@ -111,13 +111,13 @@ void
 multiplayer_service_impl::multiplayer_subscription_lost()
 {
     {
-        std::lock_guard<std::mutex> lock(m_subscriptionEnabledLock.get());
+        std::lock_guard<xsapi_mutex> lock(m_subscriptionEnabledLock.get());
         m_subscriptionEnabled = false;
     }
 
     std::unordered_map<uint32_t, std::function<void()>> multiplayerSubscriptionLostCopy;
     {
-        std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+        std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
 
         if (m_subscription)
         {
@@ -155,7 +155,7 @@ multiplayer_service_impl::multiplayer_subscription_lost()
 std::error_code
 multiplayer_service_impl::enable_multiplayer_subscriptions()
 {
-    std::lock_guard<std::mutex> lock(m_subscriptionEnabledLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_subscriptionEnabledLock.get());
     if (m_realTimeActivityService == nullptr || m_subscriptionEnabled) 
     {
         return xbox_live_error_code::logic_error;
@@ -169,7 +169,7 @@ multiplayer_service_impl::enable_multiplayer_subscriptions()
 bool
 multiplayer_service_impl::subscriptions_enabled()
 {
-    std::lock_guard<std::mutex> lock(m_subscriptionEnabledLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_subscriptionEnabledLock.get());
     return m_subscriptionEnabled;
 }
 
@@ -179,13 +179,13 @@ multiplayer_service_impl::disable_multiplayer_subscriptions()
     if (m_realTimeActivityService == nullptr) return;
 
     {
-        std::lock_guard<std::mutex> lock(m_subscriptionEnabledLock.get());
+        std::lock_guard<xsapi_mutex> lock(m_subscriptionEnabledLock.get());
         m_subscriptionEnabled = false;
     }
 
     std::shared_ptr<multiplayer_subscription> subscription;
     {
-        std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+        std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
         subscription = m_subscription;
     }
 
@@ -196,7 +196,7 @@ multiplayer_service_impl::disable_multiplayer_subscriptions()
             );
 
         {
-            std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+            std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
             m_subscription = nullptr;
         }
     }
@@ -211,7 +211,7 @@ multiplayer_service_impl::add_multiplayer_session_changed_handler(
     _In_ std::function<void(const multiplayer_session_change_event_args&)> handler
     )
 {
-    std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
 
     function_context context = -1;
     if (m_realTimeActivityService != nullptr && handler != nullptr)
@@ -228,7 +228,7 @@ multiplayer_service_impl::remove_multiplayer_session_changed_handler(
     _In_ function_context context
     )
 {
-    std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
     if (m_realTimeActivityService == nullptr) return;
 
     m_sessionChangeEventHandler.erase(context);
@@ -239,7 +239,7 @@ multiplayer_service_impl::add_multiplayer_subscription_lost_handler(
     _In_ std::function<void()> handler
     )
 {
-    std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
 
     function_context context = -1;
     if (m_realTimeActivityService != nullptr && handler != nullptr)
@@ -256,7 +256,7 @@ multiplayer_service_impl::remove_multiplayer_subscription_lost_handler(
     _In_ function_context context
     )
 {
-    std::lock_guard<std::mutex> lock(m_subscriptionLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_subscriptionLock.get());
     if (m_realTimeActivityService == nullptr) return;
     
     m_multiplayerSubscriptionLostEventHandler.erase(context);
@@ -23,7 +23,7 @@ void multiplayer_session_request::deep_copy_from(
     )
 {
     xbox::services::system::xbox_live_mutex& lock = const_cast<multiplayer_session_request&>(other).m_lock;
-    std::lock_guard<std::mutex> guard(lock.get());
+    std::lock_guard<xsapi_mutex> guard(lock.get());
 
     m_sessionReference = other.m_sessionReference;
     m_sessionConstants = other.m_sessionConstants == nullptr ? nullptr : other.m_sessionConstants;
@@ -120,7 +120,7 @@ multiplayer_session_request::add_member_request(
     _In_ bool initializedRequested
     )
 {
-    std::lock_guard<std::mutex> lock(m_lock.get());
+    std::lock_guard<xsapi_mutex> lock(m_lock.get());
     stringstream_t memberId;
     string_t meString = isMe ? _T("me") : _T("reserve_");
     memberId << meString;
@@ -703,7 +703,7 @@ web::json::value
 multiplayer_session_request::serialize()
 {
     web::json::value serializedObject = web::json::value::object();
-    std::lock_guard<std::mutex> lock(m_lock.get()); 
+    std::lock_guard<xsapi_mutex> lock(m_lock.get()); 
 
     if (m_sessionConstants != nullptr)
     {
@@ -242,8 +242,8 @@ private:
     void device_presence_changed(_In_ const device_presence_change_event_args& eventArgs);
     void title_presence_changed(_In_ const title_presence_change_event_args& eventArgs);
 
-    xbox::services::system::xbox_live_mutex m_titlePresenceChangeHandlerLock;
-    xbox::services::system::xbox_live_mutex m_devicePresenceChangeHandlerLock;
+    xbox::services::system::xbox_live_mutex m_titlePresenceChangeHandlerLock XSAPI_LOCK_SITE("presence_service_impl::m_titlePresenceChangeHandlerLock");
+    xbox::services::system::xbox_live_mutex m_devicePresenceChangeHandlerLock XSAPI_LOCK_SITE("presence_service_impl::m_devicePresenceChangeHandlerLock");
 
     std::shared_ptr<xbox::services::user_context> m_userContext;
     std::shared_ptr<xbox::services::xbox_live_context_settings> m_xboxLiveContextSettings;
@@ -280,7 +280,7 @@ public:
 private:
     void start_timer(_In_ std::weak_ptr<presence_writer> thisWeakPtr);
 
-    xbox::services::system::xbox_live_mutex m_lock;
+    xbox::services::system::xbox_live_mutex m_lock XSAPI_LOCK_SITE("presence_writer::m_lock");
     bool m_writerInProgress;
     std::unordered_map<string_t, std::shared_ptr<presence_service_impl>> m_presenceServices;
     int m_heartBeatDelayInMins;
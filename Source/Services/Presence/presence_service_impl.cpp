@@ -39,7 +39,7 @@ presence_service_impl::add_device_presence_changed_handler(
     _In_ std::function<void(const device_presence_change_event_args&)> handler
     )
 {
-    std::lock_guard<std::mutex> lock(m_devicePresenceChangeHandlerLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_devicePresenceChangeHandlerLock.get());
 
     function_context context = -1;
     if (handler != nullptr)
@@ -56,7 +56,7 @@ presence_service_impl::remove_device_presence_changed_handler(
     _In_ function_context context
     )
 {
-    std::lock_guard<std::mutex> lock(m_devicePresenceChangeHandlerLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_devicePresenceChangeHandlerLock.get());
 
     m_devicePresenceChangeHandler.erase(context);
 }
@@ -149,7 +149,7 @@ presence_service_impl::add_title_presence_changed_handler(
     _In_ std::function<void(const title_presence_change_event_args&)> handler
     )
 {
-    std::lock_guard<std::mutex> lock(m_titlePresenceChangeHandlerLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_titlePresenceChangeHandlerLock.get());
 
     function_context context = -1;
     if (handler != nullptr)
@@ -166,7 +166,7 @@ presence_service_impl::remove_title_presence_changed_handler(
     _In_ function_context context
     )
 {
-    std::lock_guard<std::mutex> lock(m_titlePresenceChangeHandlerLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_titlePresenceChangeHandlerLock.get());
 
     m_titlePresenceChangeHandler.erase(context);
 }
@@ -179,7 +179,7 @@ presence_service_impl::device_presence_changed(
     std::unordered_map<function_context, std::function<void(const device_presence_change_event_args&)>> devicePresenceChangedHandlersCopy;
 
     {
-        std::lock_guard<std::mutex> lock(m_devicePresenceChangeHandlerLock.get());
+        std::lock_guard<xsapi_mutex> lock(m_devicePresenceChangeHandlerLock.get());
         devicePresenceChangedHandlersCopy = m_devicePresenceChangeHandler;
     }
 
@@ -208,7 +208,7 @@ presence_service_impl::title_presence_changed(
     std::unordered_map<function_context, std::function<void(const title_presence_change_event_args&)>> titlePresenceChangedHandlersCopy;
 
     {
-        std::lock_guard<std::mutex> lock(m_titlePresenceChangeHandlerLock.get());
+        std::lock_guard<xsapi_mutex> lock(m_titlePresenceChangeHandlerLock.get());
         titlePresenceChangedHandlersCopy = m_titlePresenceChangeHandler;
     }
 
@@ -78,7 +78,7 @@ presence_writer::start_writer(
     bool startWriter = false;
 
     {
-        std::lock_guard<std::mutex> guard(m_lock.get());
+        std::lock_guard<xsapi_mutex> guard(m_lock.get());
         if (!m_writerInProgress)
         {
             m_writerInProgress = true;
@@ -133,7 +133,7 @@ presence_writer::stop_writer(
     _In_ const string_t& xboxLiveUserId
     )
 {
-    std::lock_guard<std::mutex> guard(m_lock.get());
+    std::lock_guard<xsapi_mutex> guard(m_lock.get());
     if (m_writerInProgress)
     {
         auto presenceService = m_presenceServices.find(xboxLiveUserId);
@@ -184,7 +184,7 @@ presence_writer::set_active_in_title()
     {
         LOG_INFO("Start presence writing.");
 
-        std::lock_guard<std::mutex> guard(m_lock.get());
+        std::lock_guard<xsapi_mutex> guard(m_lock.get());
 
         std::vector<pplx::task<xbox_live_result<uint32_t>>> writeTasks;
         for (auto& presencePair : m_presenceServices)
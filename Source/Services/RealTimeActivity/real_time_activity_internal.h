@@ -34,4 +34,54 @@ private:
     std::unordered_map <string_t, real_time_activity_service_factory_counter> m_xuidToRTAMap;
 };
 
+// A subscription's held back event while conflation is on
+struct real_time_activity_conflated_event_state
+{
+    real_time_activity_conflated_event_state() : hasPendingEvent(false), isDeliveryScheduled(false) {}
+
+    web::json::value pendingEvent;
+    bool hasPendingEvent;
+    bool isDeliveryScheduled;
+    chrono_clock_t::time_point lastDeliveryTime;
+};
+
+// Conflation and sharding state of a real_time_activity_service. It lives here rather than in the service so the
+// public class layout doesn't change. Created the first time a service turns either on or is opened as a shard,
+// removed when the service is destroyed, and guarded by the service's m_lock.
+struct real_time_activity_service_state
+{
+    real_time_activity_service_state() :
+        conflationInterval(std::chrono::milliseconds::zero()),
+        maxSubscriptionsPerConnection(0),
+        maxConnections(1),
+        isShard(false),
+        reportedConnectionState(real_time_activity_connection_state::disconnected)
+    {
+    }
+
+    // Zero when conflation is off
+    std::chrono::milliseconds conflationInterval;
+    std::map<uint32_t, real_time_activity_conflated_event_state> conflatedEvents;
+
+    // Events dropped by conflation, keyed by subscription guid
+    std::unordered_map<string_t, uint64_t> conflatedEventCounts;
+
+    // Zero when sharding is off. Shard 0 is the service's own connection, shard N is shards[N - 1].
+    uint32_t maxSubscriptionsPerConnection;
+    uint32_t maxConnections;
+    std::vector<std::shared_ptr<real_time_activity_service>> shards;
+    std::map<size_t, size_t> shardRing;
+    std::unordered_map<string_t, size_t> subscriptionShards;
+    bool isShard;
+    std::weak_ptr<real_time_activity_service> shardOwner;
+
+    // What the owner's connection state handlers were last told, so each combined change is reported once
+    real_time_activity_connection_state reportedConnectionState;
+
+    // Null if the service has no state. While no service has any, this doesn't take the registry lock.
+    static std::shared_ptr<real_time_activity_service_state> get(_In_ const real_time_activity_service* service);
+    static std::shared_ptr<real_time_activity_service_state> get_or_create(_In_ const real_time_activity_service* service);
+    static void remove(_In_ const real_time_activity_service* service);
+};
+
 }}}
\ No newline at end of file
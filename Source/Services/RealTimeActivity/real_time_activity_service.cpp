@@ -9,11 +9,85 @@
 #include "web_socket_connection.h"
 #include "web_socket_connection_state.h"
 #include "web_socket_client.h"
+#include "flight_recorder.h"
 #include "utils.h"
+#include "real_time_activity_internal.h"
+#if XSAPI_U
+    #include "ppltasks_extra_unix.h"
+#else
+    #include "ppltasks_extra.h"
+#endif
+
 using namespace pplx;
+using namespace Concurrency::extras;
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_RTA_CPP_BEGIN
 
+// Enough points per connection that a handful of connections split the hash space roughly evenly
+const uint32_t real_time_activity_service::VIRTUAL_NODES_PER_SHARD = 64;
+
+static xsapi_mutex& service_state_lock()
+{
+    static xsapi_mutex s_serviceStateLock XSAPI_LOCK_SITE("real_time_activity_service_state::s_serviceStateLock");
+    return s_serviceStateLock;
+}
+
+static std::unordered_map<const real_time_activity_service*, std::shared_ptr<real_time_activity_service_state>>& service_states()
+{
+    static std::unordered_map<const real_time_activity_service*, std::shared_ptr<real_time_activity_service_state>> s_serviceStates;
+    return s_serviceStates;
+}
+
+// Lets services skip the registry lock on every change event when no service has turned anything on
+static std::atomic<size_t> s_serviceStateCount(0);
+
+std::shared_ptr<real_time_activity_service_state>
+real_time_activity_service_state::get(
+    _In_ const real_time_activity_service* service
+    )
+{
+    if (s_serviceStateCount.load() == 0)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard<xsapi_mutex> lock(service_state_lock());
+    auto state = service_states().find(service);
+    return state == service_states().end() ? nullptr : state->second;
+}
+
+std::shared_ptr<real_time_activity_service_state>
+real_time_activity_service_state::get_or_create(
+    _In_ const real_time_activity_service* service
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(service_state_lock());
+    auto& state = service_states()[service];
+    if (state == nullptr)
+    {
+        state = std::make_shared<real_time_activity_service_state>();
+        ++s_serviceStateCount;
+    }
+    return state;
+}
+
+void
+real_time_activity_service_state::remove(
+    _In_ const real_time_activity_service* service
+    )
+{
+    if (s_serviceStateCount.load() == 0)
+    {
+        return;
+    }
+
+    std::lock_guard<xsapi_mutex> lock(service_state_lock());
+    if (service_states().erase(service) > 0)
+    {
+        --s_serviceStateCount;
+    }
+}
+
 real_time_activity_service::real_time_activity_service(
     _In_ std::shared_ptr<xbox::services::user_context> userContext,
     _In_ std::shared_ptr<xbox::services::xbox_live_context_settings> xboxLiveContextSettings,
@@ -36,6 +110,8 @@ real_time_activity_service::~real_time_activity_service()
     {
         deactivate();
     }
+
+    real_time_activity_service_state::remove(this);
 }
 
 void
@@ -43,9 +119,11 @@ real_time_activity_service::activate()
 {
     std::lock_guard<std::recursive_mutex> lock(m_lock);
     int activationCount = 0;
+    auto state = real_time_activity_service_state::get(this);
+    if (state == nullptr || !state->isShard)
     {
         auto xsapiSingleton = get_xsapi_singleton();
-        std::lock_guard<std::mutex> guard(xsapiSingleton->m_rtaActivationCounterLock);
+        std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_rtaActivationCounterLock);
         if (m_webSocketConnection == nullptr)
         {
             activationCount = ++xsapiSingleton->m_rtaActiveSocketCountPerUser[m_userContext->xbox_user_id()];
@@ -71,7 +149,7 @@ real_time_activity_service::activate()
             {
 #if UNIT_TEST_SERVICES
                 auto xsapiSingleton = get_xsapi_singleton();
-                std::lock_guard<std::mutex> guard(xsapiSingleton->m_rtaActivationCounterLock);
+                std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_rtaActivationCounterLock);
                 --xsapiSingleton->m_rtaActiveSocketCountPerUser[m_userContext->xbox_user_id()];
 #endif
                 std::stringstream msg;
@@ -152,9 +230,11 @@ void
 real_time_activity_service::deactivate()
 {
     std::shared_ptr<xsapi_singleton> xsapiSingleton = get_xsapi_singleton(false);
-    if (xsapiSingleton != nullptr) // skip this if process is shutting down
+    auto state = real_time_activity_service_state::get(this);
+    bool isShard = state != nullptr && state->isShard;
+    if (xsapiSingleton != nullptr && !isShard) // skip this if process is shutting down
     {
-        std::lock_guard<std::mutex> guard(xsapiSingleton->m_rtaActivationCounterLock);
+        std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_rtaActivationCounterLock);
         auto& xuid = m_userContext->xbox_user_id();
         if (m_userContext->caller_context_type() == caller_context_type::title)
         {
@@ -195,6 +275,24 @@ real_time_activity_service::deactivate()
         LOG_ERROR("Exception on unregistering CoreApplication events!");
     }
 
+    std::vector<std::shared_ptr<real_time_activity_service>> shards;
+    if (state != nullptr)
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_lock);
+        shards.swap(state->shards);
+        state->subscriptionShards.clear();
+        state->shardRing.clear();
+        if (state->maxSubscriptionsPerConnection > 0)
+        {
+            add_shard_to_ring(*state, 0);
+        }
+    }
+
+    for (auto& shard : shards)
+    {
+        shard->deactivate();
+    }
+
     _Close_websocket();
 
     // _Close_websocket has it's own locking inside, don't include in the next lock
@@ -267,6 +365,8 @@ real_time_activity_service::remove_subscription_error_handler(
 void
 real_time_activity_service::trigger_resync_event()
 {
+    flight_recorder::get_flight_recorder_singleton()->record(flight_record_type::rta_resync, 0, static_cast<uint32_t>(reinterpret_cast<uintptr_t>(this)));
+
     std::unordered_map<function_context, std::function<void()>> resyncHandlerCopy;
     {
         std::lock_guard<std::recursive_mutex> lock(m_lock);
@@ -314,6 +414,289 @@ real_time_activity_service::remove_resync_handler(
     m_resyncHandler.erase(remove);
 }
 
+void
+real_time_activity_service::enable_event_conflation(
+    _In_ std::chrono::milliseconds minDeliveryInterval
+    )
+{
+    std::lock_guard<std::recursive_mutex> lock(m_lock);
+    auto state = real_time_activity_service_state::get_or_create(this);
+    state->conflationInterval = minDeliveryInterval;
+    for (auto& shard : state->shards)
+    {
+        shard->enable_event_conflation(minDeliveryInterval);
+    }
+}
+
+void
+real_time_activity_service::disable_event_conflation()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_lock);
+    auto state = real_time_activity_service_state::get(this);
+    if (state == nullptr)
+    {
+        return;
+    }
+
+    state->conflationInterval = std::chrono::milliseconds::zero();
+    for (auto& shard : state->shards)
+    {
+        shard->disable_event_conflation();
+    }
+}
+
+uint64_t
+real_time_activity_service::conflated_event_count(
+    _In_ const std::shared_ptr<real_time_activity_subscription>& subscription
+    )
+{
+    if (subscription == nullptr)
+    {
+        return 0;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(m_lock);
+    auto state = real_time_activity_service_state::get(this);
+    if (state == nullptr)
+    {
+        return 0;
+    }
+
+    auto shardIter = state->subscriptionShards.find(subscription->m_guid);
+    if (shardIter != state->subscriptionShards.end() && shardIter->second != 0)
+    {
+        return get_or_create_shard(*state, shardIter->second)->conflated_event_count(subscription);
+    }
+
+    auto conflatedEventCount = state->conflatedEventCounts.find(subscription->m_guid);
+    return conflatedEventCount == state->conflatedEventCounts.end() ? 0 : conflatedEventCount->second;
+}
+
+void
+real_time_activity_service::enable_connection_sharding(
+    _In_ uint32_t maxSubscriptionsPerConnection,
+    _In_ uint32_t maxConnections
+    )
+{
+    std::lock_guard<std::recursive_mutex> lock(m_lock);
+    auto state = real_time_activity_service_state::get_or_create(this);
+    state->maxSubscriptionsPerConnection = maxSubscriptionsPerConnection;
+    state->maxConnections = __max(maxConnections, static_cast<uint32_t>(1));
+    state->reportedConnectionState = m_connectionState;
+    if (state->shardRing.empty())
+    {
+        add_shard_to_ring(*state, 0);
+    }
+}
+
+size_t
+real_time_activity_service::_Connection_count()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_lock);
+    auto state = real_time_activity_service_state::get(this);
+    return state == nullptr ? 1 : state->shards.size() + 1;
+}
+
+std::shared_ptr<real_time_activity_service>
+real_time_activity_service::get_or_create_shard(
+    _In_ real_time_activity_service_state& state,
+    _In_ size_t shardIndex
+    )
+{
+    if (shardIndex == 0)
+    {
+        return shared_from_this();
+    }
+
+    if (shardIndex <= state.shards.size())
+    {
+        return state.shards[shardIndex - 1];
+    }
+
+    auto shard = std::make_shared<real_time_activity_service>(m_userContext, m_xboxLiveContextSettings, m_appConfig);
+    auto shardState = real_time_activity_service_state::get_or_create(shard.get());
+    shardState->isShard = true;
+    shardState->shardOwner = shared_from_this();
+    if (state.conflationInterval > std::chrono::milliseconds::zero())
+    {
+        shard->enable_event_conflation(state.conflationInterval);
+    }
+
+    // The title registered its handlers here, so forward what each connection reports on its own.
+    // Connection state is combined by the shard itself once it has released its lock.
+    std::weak_ptr<real_time_activity_service> thisWeakPtr = shared_from_this();
+    shard->add_resync_handler([thisWeakPtr]()
+    {
+        std::shared_ptr<real_time_activity_service> pThis(thisWeakPtr.lock());
+        if (pThis != nullptr)
+        {
+            pThis->trigger_resync_event();
+        }
+    });
+    shard->add_subscription_error_handler([thisWeakPtr](const real_time_activity_subscription_error_event_args& args)
+    {
+        std::shared_ptr<real_time_activity_service> pThis(thisWeakPtr.lock());
+        if (pThis != nullptr)
+        {
+            pThis->_Trigger_subscription_error(args);
+        }
+    });
+
+    shard->activate();
+    state.shards.push_back(shard);
+    add_shard_to_ring(state, state.shards.size());
+    LOGS_DEBUG << "real_time_activity_service: opened connection " << state.shards.size() << " for sharded subscriptions";
+    return shard;
+}
+
+void
+real_time_activity_service::add_shard_to_ring(
+    _In_ real_time_activity_service_state& state,
+    _In_ size_t shardIndex
+    )
+{
+    for (uint32_t i = 0; i < VIRTUAL_NODES_PER_SHARD; ++i)
+    {
+        stringstream_t point;
+        point << shardIndex << _T("#") << i;
+        state.shardRing[std::hash<string_t>()(point.str())] = shardIndex;
+    }
+}
+
+std::vector<size_t>
+real_time_activity_service::shard_subscription_counts(
+    _In_ real_time_activity_service_state& state
+    )
+{
+    std::vector<size_t> subscriptionCounts;
+    for (size_t i = 0; i <= state.shards.size(); ++i)
+    {
+        auto shard = get_or_create_shard(state, i);
+        std::lock_guard<std::recursive_mutex> shardLock(shard->m_lock);
+        subscriptionCounts.push_back(shard->_Subscription_Count());
+    }
+    return subscriptionCounts;
+}
+
+size_t
+real_time_activity_service::place_subscription(
+    _In_ const real_time_activity_service_state& state,
+    _In_ const string_t& resourceUri,
+    _In_ const std::vector<size_t>& subscriptionCounts
+    ) const
+{
+    // Walk the ring clockwise from the resource's hash to the first connection with room
+    size_t homeShard = 0;
+    auto point = state.shardRing.lower_bound(std::hash<string_t>()(resourceUri));
+    for (size_t step = 0; step < state.shardRing.size(); ++step, ++point)
+    {
+        if (point == state.shardRing.end())
+        {
+            point = state.shardRing.begin();
+        }
+
+        if (step == 0)
+        {
+            homeShard = point->second;
+        }
+
+        if (point->second < subscriptionCounts.size() &&
+            subscriptionCounts[point->second] < state.maxSubscriptionsPerConnection)
+        {
+            return point->second;
+        }
+    }
+
+    if (subscriptionCounts.size() < state.maxConnections)
+    {
+        return subscriptionCounts.size();
+    }
+
+    // Every connection is full; the service will report the limit for this one
+    return homeShard;
+}
+
+void
+real_time_activity_service::rebalance_shards()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_lock);
+    auto state = real_time_activity_service_state::get(this);
+    if (state == nullptr || state->maxSubscriptionsPerConnection == 0)
+    {
+        return;
+    }
+
+    // Only connected shards give theirs up; one that is still reconnecting resubmits its own when it gets there
+    std::vector<std::shared_ptr<real_time_activity_subscription>> unplaced;
+    for (size_t i = 0; i <= state->shards.size(); ++i)
+    {
+        auto shard = get_or_create_shard(*state, i);
+        std::lock_guard<std::recursive_mutex> shardLock(shard->m_lock);
+        if (shard->m_connectionState == real_time_activity_connection_state::connected)
+        {
+            unplaced.insert(unplaced.end(), shard->m_pendingSubmission.begin(), shard->m_pendingSubmission.end());
+            shard->m_pendingSubmission.clear();
+        }
+    }
+
+    auto subscriptionCounts = shard_subscription_counts(*state);
+    for (auto& subscription : unplaced)
+    {
+        size_t shardIndex = place_subscription(*state, subscription->resource_uri(), subscriptionCounts);
+        auto shard = get_or_create_shard(*state, shardIndex);
+        subscriptionCounts.resize(__max(subscriptionCounts.size(), shardIndex + 1), 0);
+        ++subscriptionCounts[shardIndex];
+        state->subscriptionShards[subscription->m_guid] = shardIndex;
+
+        std::lock_guard<std::recursive_mutex> shardLock(shard->m_lock);
+        shard->m_pendingSubmission.push_back(subscription);
+    }
+
+    for (size_t i = 0; i <= state->shards.size(); ++i)
+    {
+        auto shard = get_or_create_shard(*state, i);
+        std::lock_guard<std::recursive_mutex> shardLock(shard->m_lock);
+        if (shard->m_connectionState == real_time_activity_connection_state::connected)
+        {
+            shard->submit_subscriptions();
+        }
+    }
+}
+
+void
+real_time_activity_service::report_combined_connection_state()
+{
+    real_time_activity_connection_state combinedState;
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_lock);
+        auto state = real_time_activity_service_state::get(this);
+        if (state == nullptr)
+        {
+            return;
+        }
+
+        // Connected only once every connection is; any disconnected connection outweighs a connecting one
+        combinedState = m_connectionState;
+        for (auto& shard : state->shards)
+        {
+            std::lock_guard<std::recursive_mutex> shardLock(shard->m_lock);
+            if (shard->m_connectionState == real_time_activity_connection_state::disconnected ||
+                (shard->m_connectionState == real_time_activity_connection_state::connecting && combinedState == real_time_activity_connection_state::connected))
+            {
+                combinedState = shard->m_connectionState;
+            }
+        }
+
+        if (combinedState == state->reportedConnectionState)
+        {
+            return;
+        }
+        state->reportedConnectionState = combinedState;
+    }
+
+    trigger_connection_state_changed_event(combinedState);
+}
+
 void
 real_time_activity_service::_Trigger_subscription_error(
     real_time_activity_subscription_error_event_args args
@@ -370,6 +753,13 @@ void real_time_activity_service::clear_all_subscriptions()
         subscription->_Set_state(real_time_activity_subscription_state::closed);
     }
     m_pendingSubmission.clear();
+
+    // Any delivery still scheduled finds nothing to send
+    auto state = real_time_activity_service_state::get(this);
+    if (state != nullptr)
+    {
+        state->conflatedEvents.clear();
+    }
 }
 
 void
@@ -382,14 +772,30 @@ real_time_activity_service::on_socket_connection_state_change(
 
     if (web_socket_connection_state::activated == newState) return;
     
-    std::lock_guard<std::recursive_mutex> lock(m_lock);
+    std::shared_ptr<real_time_activity_service> shardOwner;
+    bool isShardOwner = false;
     {
+        std::lock_guard<std::recursive_mutex> lock(m_lock);
+        auto state = real_time_activity_service_state::get(this);
+        if (state != nullptr && state->isShard)
+        {
+            shardOwner = state->shardOwner.lock();
+        }
+        else if (state != nullptr && state->maxSubscriptionsPerConnection > 0)
+        {
+            // The title's handlers hear the combined state of all connections instead, reported below
+            isShardOwner = true;
+        }
+
         if (newState == web_socket_connection_state::disconnected)
         {
             m_connectionState = real_time_activity_connection_state::disconnected;
 
             clear_all_subscriptions();
-            trigger_connection_state_changed_event(real_time_activity_connection_state::disconnected);
+            if (!isShardOwner)
+            {
+                trigger_connection_state_changed_event(real_time_activity_connection_state::disconnected);
+            }
         }
 
         // On connecting, set subscriptions state accordingly.
@@ -420,17 +826,44 @@ real_time_activity_service::on_socket_connection_state_change(
             }
             m_pendingUnsubscriptions.clear();
 
-            trigger_connection_state_changed_event(real_time_activity_connection_state::connecting);
+            if (!isShardOwner)
+            {
+                trigger_connection_state_changed_event(real_time_activity_connection_state::connecting);
+            }
         }
 
         // socket reconnected, re-subscribe everything
         if (newState == web_socket_connection_state::connected)
         {
             m_connectionState = real_time_activity_connection_state::connected;
-            submit_subscriptions();
-            trigger_connection_state_changed_event(real_time_activity_connection_state::connected);
+            if (shardOwner == nullptr && !isShardOwner)
+            {
+                submit_subscriptions();
+            }
+            if (!isShardOwner)
+            {
+                trigger_connection_state_changed_event(real_time_activity_connection_state::connected);
+            }
         }
     }
+
+    // The owner locks itself before each of its connections, so this connection's lock must be released first
+    if (isShardOwner)
+    {
+        if (newState == web_socket_connection_state::connected)
+        {
+            rebalance_shards();
+        }
+        report_combined_connection_state();
+    }
+    else if (shardOwner != nullptr)
+    {
+        if (newState == web_socket_connection_state::connected)
+        {
+            shardOwner->rebalance_shards();
+        }
+        shardOwner->report_combined_connection_state();
+    }
 }
 
 void
@@ -502,16 +935,103 @@ real_time_activity_service::handle_change_event(
     {
         std::lock_guard<std::recursive_mutex> lock(m_lock);
         auto iter = m_subscriptions.find(subscriptionId);
-        if (iter != m_subscriptions.end())
+        if (iter == m_subscriptions.end())
         {
-            subscription = iter->second;
+            return;
+        }
+        subscription = iter->second;
+
+        auto state = real_time_activity_service_state::get(this);
+        if (state != nullptr && state->conflationInterval > std::chrono::milliseconds::zero())
+        {
+            auto& eventState = state->conflatedEvents[subscriptionId];
+            auto now = chrono_clock_t::now();
+            auto sinceLastDelivery = now - eventState.lastDeliveryTime;
+            if (eventState.isDeliveryScheduled || sinceLastDelivery < state->conflationInterval)
+            {
+                if (eventState.hasPendingEvent)
+                {
+                    ++state->conflatedEventCounts[subscription->m_guid];
+                }
+                eventState.pendingEvent = data;
+                eventState.hasPendingEvent = true;
+
+                if (!eventState.isDeliveryScheduled)
+                {
+                    eventState.isDeliveryScheduled = true;
+                    std::weak_ptr<real_time_activity_service> thisWeakPtr = shared_from_this();
+                    uint32_t id = static_cast<uint32_t>(subscriptionId);
+                    create_delayed_task(
+                        std::chrono::duration_cast<std::chrono::milliseconds>(state->conflationInterval - sinceLastDelivery),
+                        [thisWeakPtr, id]()
+                    {
+                        std::shared_ptr<real_time_activity_service> pThis(thisWeakPtr.lock());
+                        if (pThis != nullptr)
+                        {
+                            pThis->deliver_conflated_event(id);
+                        }
+                    });
+                }
+                return;
+            }
+
+            eventState.lastDeliveryTime = now;
+        }
+        else if (state != nullptr)
+        {
+            // Conflation was turned off while an event was held back; this one is newer, so it replaces it
+            auto stateIter = state->conflatedEvents.find(subscriptionId);
+            if (stateIter != state->conflatedEvents.end())
+            {
+                if (stateIter->second.hasPendingEvent)
+                {
+                    ++state->conflatedEventCounts[subscription->m_guid];
+                }
+                state->conflatedEvents.erase(stateIter);
+            }
         }
     }
 
-    if (subscription != nullptr)
+    subscription->on_event_received(data);
+}
+
+void
+real_time_activity_service::deliver_conflated_event(
+    _In_ uint32_t subscriptionId
+    )
+{
+    std::shared_ptr<real_time_activity_subscription> subscription;
+    web::json::value data;
     {
-        subscription->on_event_received(data);
+        std::lock_guard<std::recursive_mutex> lock(m_lock);
+        auto state = real_time_activity_service_state::get(this);
+        if (state == nullptr)
+        {
+            return;
+        }
+
+        auto stateIter = state->conflatedEvents.find(subscriptionId);
+        if (stateIter == state->conflatedEvents.end())
+        {
+            return;
+        }
+
+        auto iter = m_subscriptions.find(subscriptionId);
+        if (iter == m_subscriptions.end() || !stateIter->second.hasPendingEvent)
+        {
+            state->conflatedEvents.erase(stateIter);
+            return;
+        }
+
+        subscription = iter->second;
+        data = std::move(stateIter->second.pendingEvent);
+        stateIter->second.pendingEvent = web::json::value();
+        stateIter->second.hasPendingEvent = false;
+        stateIter->second.isDeliveryScheduled = false;
+        stateIter->second.lastDeliveryTime = chrono_clock_t::now();
     }
+
+    subscription->on_event_received(data);
 }
 
 void
@@ -613,6 +1133,17 @@ real_time_activity_service::_Add_subscription(
             );
     }
 
+    auto state = real_time_activity_service_state::get(this);
+    if (state != nullptr && state->maxSubscriptionsPerConnection > 0)
+    {
+        size_t shardIndex = place_subscription(*state, subscription->resource_uri(), shard_subscription_counts(*state));
+        state->subscriptionShards[subscription->m_guid] = shardIndex;
+        if (shardIndex != 0)
+        {
+            return get_or_create_shard(*state, shardIndex)->_Add_subscription(subscription);
+        }
+    }
+
     subscription->_Set_state(real_time_activity_subscription_state::pending_subscribe);
     m_pendingSubmission.push_back(subscription);
     if (m_connectionState == real_time_activity_connection_state::connected)
@@ -667,6 +1198,23 @@ real_time_activity_service::_Remove_subscription(
     }
 
     std::lock_guard<std::recursive_mutex> guard(m_lock);
+    auto state = real_time_activity_service_state::get(this);
+    if (state != nullptr)
+    {
+        auto shardIter = state->subscriptionShards.find(subscription->m_guid);
+        if (shardIter != state->subscriptionShards.end())
+        {
+            size_t shardIndex = shardIter->second;
+            state->subscriptionShards.erase(shardIter);
+            if (shardIndex != 0)
+            {
+                return get_or_create_shard(*state, shardIndex)->_Remove_subscription(subscription);
+            }
+        }
+
+        state->conflatedEventCounts.erase(subscription->m_guid);
+    }
+
     auto subscriptionId = subscription->subscription_id();
 
     if (subscription->state() == real_time_activity_subscription_state::subscribed)
@@ -676,6 +1224,10 @@ real_time_activity_service::_Remove_subscription(
         {
             auto subscriptionIter = iter->second;
             m_subscriptions.erase(iter);
+            if (state != nullptr)
+            {
+                state->conflatedEvents.erase(subscriptionId);
+            }
 
             int sequenceNumber = utils::interlocked_increment(m_sequenceNumber);
             subscriptionIter->_Set_state(real_time_activity_subscription_state::pending_unsubscribe);
@@ -789,7 +1341,7 @@ std::unordered_map<string_t, uint32_t>
 real_time_activity_service::_Rta_activation_map()
 {
     auto xsapiSingleton = get_xsapi_singleton();
-    std::lock_guard<std::mutex> guard(xsapiSingleton->m_rtaActivationCounterLock);
+    std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_rtaActivationCounterLock);
     return xsapiSingleton->m_rtaActiveSocketCountPerUser;
 }
 
@@ -797,7 +1349,7 @@ std::unordered_map<string_t, uint32_t>
 real_time_activity_service::_Rta_manager_activation_map()
 {
     auto xsapiSingleton = get_xsapi_singleton();
-    std::lock_guard<std::mutex> guard(xsapiSingleton->m_rtaActivationCounterLock);
+    std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_rtaActivationCounterLock);
     return xsapiSingleton->m_rtaActiveManagersByUser;
 }
 
@@ -12,7 +12,7 @@ std::shared_ptr<real_time_activity_service_factory>
 real_time_activity_service_factory::get_singleton_instance()
 {
     auto xsapiSingleton = get_xsapi_singleton();
-    std::lock_guard<std::mutex> guard(xsapiSingleton->m_singletonLock);
+    std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_singletonLock);
     if (xsapiSingleton->m_rtaFactoryInstance == nullptr)
     {
         xsapiSingleton->m_rtaFactoryInstance = std::make_shared<real_time_activity_service_factory>();
@@ -32,7 +32,7 @@ real_time_activity_service_factory::get_rta_instance(
     _In_ std::shared_ptr<xbox::services::xbox_live_app_config> appConfig
     )
 {
-    std::lock_guard<std::mutex> guard(get_xsapi_singleton()->m_singletonLock);
+    std::lock_guard<xsapi_mutex> guard(get_xsapi_singleton()->m_singletonLock);
     XSAPI_ASSERT(userContext != nullptr);
 
     auto xboxUserId = userContext->xbox_user_id();
@@ -64,7 +64,7 @@ real_time_activity_service_factory::remove_user_from_rta_map(
     _In_ std::shared_ptr<xbox::services::user_context> userContext
     )
 {
-    std::lock_guard<std::mutex> guard(get_xsapi_singleton()->m_singletonLock);
+    std::lock_guard<xsapi_mutex> guard(get_xsapi_singleton()->m_singletonLock);
     XSAPI_ASSERT(userContext != nullptr);
     auto& xuid = userContext->xbox_user_id();
     if (!xuid.empty())
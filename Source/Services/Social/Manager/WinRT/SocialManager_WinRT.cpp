@@ -23,7 +23,7 @@ SocialManager::SingletonInstance::get()
         SocialManager^ socialManager = ref new SocialManager();
 
         {
-            std::lock_guard<std::mutex> lock(xsapiSingleton->m_singletonLock);
+            std::lock_guard<xbox::services::xsapi_mutex> lock(xsapiSingleton->m_singletonLock);
             if (xsapiSingleton->m_winrt_socialManagerInstance == nullptr)
             {
                 xsapiSingleton->m_winrt_socialManagerInstance = socialManager;
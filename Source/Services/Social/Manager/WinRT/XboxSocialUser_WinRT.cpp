@@ -15,8 +15,6 @@ XboxSocialUser::XboxSocialUser(
     {
         m_cppObj = *cppObj;
         m_presenceRecord = ref new SocialManagerPresenceRecord(m_cppObj.presence_record());
-        m_titleHistory = ref new Microsoft::Xbox::Services::Social::Manager::TitleHistory(m_cppObj.title_history());
-        m_preferredColor = ref new Microsoft::Xbox::Services::Social::Manager::PreferredColor(m_cppObj.preferred_color());
     }
 }
 
@@ -29,12 +27,21 @@ XboxSocialUser::PresenceRecord::get()
 Microsoft::Xbox::Services::Social::Manager::TitleHistory^
 XboxSocialUser::TitleHistory::get()
 {
+    // Built on first read, since reading the decoration is what asks social manager to fetch it
+    if (m_titleHistory == nullptr)
+    {
+        m_titleHistory = ref new Microsoft::Xbox::Services::Social::Manager::TitleHistory(m_cppObj.title_history());
+    }
     return m_titleHistory;
 }
 
 Microsoft::Xbox::Services::Social::Manager::PreferredColor^
 XboxSocialUser::PreferredColor::get()
 {
+    if (m_preferredColor == nullptr)
+    {
+        m_preferredColor = ref new Microsoft::Xbox::Services::Social::Manager::PreferredColor(m_cppObj.preferred_color());
+    }
     return m_preferredColor;
 }
 
@@ -5,11 +5,23 @@
 #include "social_manager_internal.h"
 #include "http_call_impl.h"
 #include "xbox_system_factory.h"
+#if !XSAPI_U
+#include "ppltasks_extra.h"
+#else
+#include "ppltasks_extra_unix.h"
+#endif
 
 using namespace xbox::services;
+using namespace Concurrency::extras;
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_SOCIAL_MANAGER_CPP_BEGIN
 
+const size_t peoplehub_service::MAX_USERS_PER_BATCH_REQUEST = 100;
+const size_t peoplehub_service::MAX_CONCURRENT_BATCH_REQUESTS = 4;
+const uint32_t peoplehub_service::MAX_BATCH_REQUEST_ATTEMPTS = 3;
+// Grows with each attempt, so a throttled or struggling service isn't hit again straight away
+const std::chrono::milliseconds peoplehub_service::BATCH_REQUEST_RETRY_DELAY = std::chrono::milliseconds(500);
+
 peoplehub_service::peoplehub_service(
     _In_ std::shared_ptr<xbox::services::user_context> userContext,
     _In_ std::shared_ptr<xbox::services::xbox_live_context_settings> httpCallSettings,
@@ -24,7 +36,8 @@ peoplehub_service::peoplehub_service(
 pplx::task<xbox_live_result<std::vector<xbox_social_user>>>
 peoplehub_service::get_social_graph(
     _In_ const string_t& callerXboxUserId,
-    _In_ social_manager_extra_detail_level decorations
+    _In_ social_manager_extra_detail_level decorations,
+    _In_ bool includePresenceDetail
     )
 {
     return get_social_graph(
@@ -32,7 +45,8 @@ peoplehub_service::get_social_graph(
         decorations,
         _T("social"),
         std::vector<string_t>(),
-        false
+        false,
+        includePresenceDetail
         );
 }
 
@@ -40,7 +54,8 @@ pplx::task<xbox_live_result<std::vector<xbox_social_user>>>
 peoplehub_service::get_social_graph(
     _In_ const string_t& callerXboxUserId,
     _In_ social_manager_extra_detail_level decorations,
-    _In_ const std::vector<string_t> xboxLiveUsers
+    _In_ const std::vector<string_t> xboxLiveUsers,
+    _In_ bool includePresenceDetail
     )
 {
     return get_social_graph(
@@ -48,7 +63,8 @@ peoplehub_service::get_social_graph(
         decorations,
         _T(""),
         xboxLiveUsers,
-        true
+        true,
+        includePresenceDetail
         );
 }
 
@@ -58,7 +74,8 @@ peoplehub_service::get_social_graph(
     _In_ social_manager_extra_detail_level decorations,
     _In_ const string_t& relationshipType,
     _In_ const std::vector<string_t> xboxLiveUsers,
-    _In_ bool isBatch
+    _In_ bool isBatch,
+    _In_ bool includePresenceDetail
     )
 {
     string_t pathAndQuery = social_graph_subpath(
@@ -66,7 +83,8 @@ peoplehub_service::get_social_graph(
         decorations,
         relationshipType,
         xboxLiveUsers,
-        isBatch
+        isBatch,
+        includePresenceDetail
         );
 
     std::shared_ptr<http_call> httpCall = xbox::services::system::xbox_system_factory::get_factory()->create_http_call(
@@ -79,20 +97,16 @@ peoplehub_service::get_social_graph(
 
     if (isBatch)
     {
-        web::json::value postJSON;
-        web::json::value xuidJSON = web::json::value::array();
-        for (uint32_t i = 0; i < xboxLiveUsers.size(); ++i)
-        {
-            xuidJSON[i] = web::json::value::string(xboxLiveUsers[i]);
-        }
-
-        postJSON[_T("xuids")] = xuidJSON;
-        httpCall->set_request_body(postJSON);
+        json_writer requestWriter(16 + xboxLiveUsers.size() * 20);
+        serialize_batch_request(xboxLiveUsers, requestWriter);
+        move_request_body(httpCall, requestWriter.take_buffer());
     }
 
     auto task = httpCall->get_response_with_auth(m_userContext)
-    .then([](std::shared_ptr<http_call_response> response)
+    .then([decorations](std::shared_ptr<http_call_response> response)
     {
+        LOGS_DEBUG << "peoplehub_service: " << response->response_body_string().size() << " response bytes";
+
         std::error_code errc;
         web::json::value peopleArray = utils::extract_json_field(
             response->response_body_json(),
@@ -116,14 +130,14 @@ peoplehub_service::get_social_graph(
             false
             );
 
-        std::vector<xbox_social_user> socialUser;
-        socialUser.reserve(socialUserVec.size());
-        for (auto& user : socialUserVec)
+        // Record what was asked for so the graph knows which decorations still need a lazy fetch.
+        auto tracker = social_decoration_tracker::get_singleton_instance();
+        for (const auto& user : socialUserVec)
         {
-            socialUser.push_back(user);
+            tracker->record_fetch(user._Xbox_user_id_as_integer(), decorations);
         }
 
-        auto socialUserResult = xbox_live_result<std::vector<xbox_social_user>>(socialUser, errc);
+        auto socialUserResult = xbox_live_result<std::vector<xbox_social_user>>(socialUserVec, errc);
 
         return utils::generate_xbox_live_result<std::vector<xbox_social_user>>(
             socialUserResult,
@@ -136,12 +150,192 @@ peoplehub_service::get_social_graph(
         );
 }
 
+pplx::task<xbox_live_result<std::vector<xbox_social_user>>>
+peoplehub_service::get_social_graph_sharded(
+    _In_ const string_t& callerXboxUserId,
+    _In_ social_manager_extra_detail_level decorations,
+    _In_ const std::vector<string_t>& xboxLiveUsers,
+    _In_ bool includePresenceDetail,
+    _In_ const peoplehub_batch_chunk_handler& chunkCompleteHandler
+    )
+{
+    auto batchContext = std::make_shared<peoplehub_batch_context>();
+    batchContext->service = *this;
+    batchContext->callerXboxUserId = callerXboxUserId;
+    batchContext->decorations = decorations;
+    batchContext->includePresenceDetail = includePresenceDetail;
+    batchContext->chunkCompleteHandler = chunkCompleteHandler;
+
+    for (size_t i = 0; i < xboxLiveUsers.size(); i += MAX_USERS_PER_BATCH_REQUEST)
+    {
+        auto chunkEnd = xboxLiveUsers.begin() + __min(i + MAX_USERS_PER_BATCH_REQUEST, xboxLiveUsers.size());
+        batchContext->chunks.push_back(std::vector<string_t>(xboxLiveUsers.begin() + i, chunkEnd));
+    }
+
+    if (batchContext->chunks.empty())
+    {
+        return pplx::task_from_result(xbox_live_result<std::vector<xbox_social_user>>(std::vector<xbox_social_user>()));
+    }
+
+    batchContext->remainingChunks = batchContext->chunks.size();
+    batchContext->users.reserve(xboxLiveUsers.size());
+
+    size_t concurrentChunks = __min(MAX_CONCURRENT_BATCH_REQUESTS, batchContext->chunks.size());
+    for (size_t i = 0; i < concurrentChunks; ++i)
+    {
+        start_next_batch_chunk(batchContext);
+    }
+
+    return pplx::create_task(batchContext->tce);
+}
+
+void
+peoplehub_service::start_next_batch_chunk(
+    _In_ const std::shared_ptr<peoplehub_batch_context>& batchContext
+    )
+{
+    size_t chunkIndex;
+    {
+        std::lock_guard<xsapi_mutex> lock(batchContext->lock);
+        if (batchContext->nextChunk >= batchContext->chunks.size())
+        {
+            return;
+        }
+        chunkIndex = batchContext->nextChunk++;
+    }
+
+    fetch_batch_chunk(batchContext, chunkIndex, 1);
+}
+
+void
+peoplehub_service::fetch_batch_chunk(
+    _In_ const std::shared_ptr<peoplehub_batch_context>& batchContext,
+    _In_ size_t chunkIndex,
+    _In_ uint32_t attempt
+    )
+{
+    batchContext->service.get_social_graph(
+        batchContext->callerXboxUserId,
+        batchContext->decorations,
+        batchContext->chunks[chunkIndex],
+        batchContext->includePresenceDetail
+        )
+    .then([batchContext, chunkIndex, attempt](pplx::task<xbox_live_result<std::vector<xbox_social_user>>> chunkTask)
+    {
+        // A chunk that throws still has to be counted, or the batch never completes
+        xbox_live_result<std::vector<xbox_social_user>> chunkResult;
+        try
+        {
+            chunkResult = chunkTask.get();
+        }
+        catch (const std::exception& e)
+        {
+            chunkResult = xbox_live_result<std::vector<xbox_social_user>>(xbox_live_error_code::generic_error, e.what());
+        }
+        catch (...)
+        {
+            chunkResult = xbox_live_result<std::vector<xbox_social_user>>(xbox_live_error_code::generic_error, "peoplehub batch chunk failed");
+        }
+
+        // The http call has already retried on its own, so extra attempts come out of the same per host budget
+        if (chunkResult.err() &&
+            attempt < MAX_BATCH_REQUEST_ATTEMPTS &&
+            is_transient_error(chunkResult.err()) &&
+            http_endpoint_health_manager::get_http_endpoint_health_manager_singleton()->try_consume_retry(
+                utils::create_xboxlive_endpoint(_T("peoplehub"), batchContext->service.m_appConfig)
+                ))
+        {
+            // Only the failed chunk goes back out; the ones that succeeded are already merged
+            LOGS_DEBUG << "peoplehub_service: retrying batch chunk " << chunkIndex << " after error " << chunkResult.err();
+            create_delayed_task(
+                BATCH_REQUEST_RETRY_DELAY * attempt,
+                [batchContext, chunkIndex, attempt]()
+            {
+                fetch_batch_chunk(batchContext, chunkIndex, attempt + 1);
+            });
+            return;
+        }
+
+        bool isLastChunk;
+        {
+            std::lock_guard<xsapi_mutex> lock(batchContext->lock);
+            if (chunkResult.err())
+            {
+                batchContext->errorCode = chunkResult.err();
+                batchContext->errorMessage = chunkResult.err_message();
+            }
+            else
+            {
+                auto& chunkUsers = chunkResult.payload();
+                batchContext->users.insert(batchContext->users.end(), chunkUsers.begin(), chunkUsers.end());
+            }
+            isLastChunk = (--batchContext->remainingChunks == 0);
+
+            // Handled under the lock so the last chunk's handler can't run before an earlier chunk's
+            // handler has handed over its users
+            if (batchContext->chunkCompleteHandler != nullptr)
+            {
+                batchContext->chunkCompleteHandler(batchContext->chunks[chunkIndex], chunkResult, isLastChunk);
+            }
+        }
+
+        if (isLastChunk)
+        {
+            batchContext->tce.set(xbox_live_result<std::vector<xbox_social_user>>(
+                batchContext->users,
+                batchContext->errorCode,
+                batchContext->errorMessage
+                ));
+        }
+        else
+        {
+            start_next_batch_chunk(batchContext);
+        }
+    });
+}
+
+bool
+peoplehub_service::is_transient_error(
+    _In_ const std::error_code& errorCode
+    )
+{
+    if (errorCode.category() != xbox_services_error_code_category())
+    {
+        return false;
+    }
+
+    auto value = errorCode.value();
+    return value == static_cast<int>(xbox_live_error_code::http_status_408_request_timeout) ||
+        value == static_cast<int>(xbox_live_error_code::http_status_429_too_many_requests) ||
+        value == static_cast<int>(xbox_live_error_code::HR_ERROR_INTERNET_TIMEOUT) ||
+        (value >= static_cast<int>(xbox_live_error_code::http_status_500_internal_server_error) &&
+         value <= static_cast<int>(xbox_live_error_code::http_status_511_network_authentication_required));
+}
+
+void
+peoplehub_service::serialize_batch_request(
+    _In_ const std::vector<string_t>& xboxLiveUsers,
+    _Inout_ json_writer& writer
+    )
+{
+    writer.start_object();
+    writer.write_key(_T("xuids"));
+    writer.start_array();
+    for (const auto& xboxUserId : xboxLiveUsers)
+    {
+        writer.write_string(xboxUserId);
+    }
+    writer.end_array();
+    writer.end_object();
+}
+
 string_t peoplehub_service::social_graph_subpath(
     _In_ const string_t& xboxUserId,
     _In_ social_manager_extra_detail_level decorations,
     _In_ const string_t& relationshipType,
     _In_ const std::vector<string_t> xboxLiveUsers,
-    _In_ bool isBatch
+    _In_ bool isBatch,
+    _In_ bool includePresenceDetail
     ) const
 {
     stringstream_t source;
@@ -158,7 +352,8 @@ string_t peoplehub_service::social_graph_subpath(
         source << _T("/batch");
     }
 
-    if ((decorations | social_manager_extra_detail_level::no_extra_detail) != social_manager_extra_detail_level::no_extra_detail)
+    if ((decorations | social_manager_extra_detail_level::no_extra_detail) != social_manager_extra_detail_level::no_extra_detail ||
+        includePresenceDetail)
     {
         source << _T("/decoration/");
         std::vector<string_t> decorationList;
@@ -0,0 +1,101 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#include "social_manager_internal.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_SOCIAL_MANAGER_CPP_BEGIN
+
+social_decoration_tracker::social_decoration_tracker() :
+    m_accessedDetailLevel(static_cast<uint32_t>(social_manager_extra_detail_level::no_extra_detail))
+{
+}
+
+social_decoration_tracker*
+social_decoration_tracker::get_singleton_instance()
+{
+    // Read on every title_history() and preferred_color() call, so it takes neither the singleton lock nor a reference
+    static social_decoration_tracker s_socialDecorationTracker;
+    return &s_socialDecorationTracker;
+}
+
+void
+social_decoration_tracker::record_access(
+    _In_ const xbox_social_user& user,
+    _In_ social_manager_extra_detail_level decoration
+    )
+{
+    // Once a title reads a decoration it stays in every subsequent peoplehub query
+    m_accessedDetailLevel.fetch_or(static_cast<uint32_t>(decoration));
+
+    // Users that were fetched without the decoration get it on the next social graph refresh
+    auto xboxUserId = user._Xbox_user_id_as_integer();
+    if (xboxUserId == 0)
+    {
+        return;
+    }
+
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    auto fetchedIter = m_fetchedDecorations.find(xboxUserId);
+    if (fetchedIter == m_fetchedDecorations.end() ||
+        (fetchedIter->second & decoration) == social_manager_extra_detail_level::no_extra_detail)
+    {
+        auto& pending = m_pendingFetches[xboxUserId];
+        pending = pending | decoration;
+    }
+}
+
+void
+social_decoration_tracker::require_decorations(
+    _In_ social_manager_extra_detail_level decorations
+    )
+{
+    m_accessedDetailLevel.fetch_or(static_cast<uint32_t>(decorations));
+}
+
+void
+social_decoration_tracker::record_fetch(
+    _In_ uint64_t xboxUserId,
+    _In_ social_manager_extra_detail_level decorations
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    m_fetchedDecorations[xboxUserId] = decorations;
+}
+
+social_manager_extra_detail_level
+social_decoration_tracker::fetched_detail_level(
+    _In_ uint64_t xboxUserId
+    ) const
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    auto fetchedIter = m_fetchedDecorations.find(xboxUserId);
+    return fetchedIter != m_fetchedDecorations.end() ? fetchedIter->second : social_manager_extra_detail_level::no_extra_detail;
+}
+
+social_manager_extra_detail_level
+social_decoration_tracker::accessed_detail_level() const
+{
+    return static_cast<social_manager_extra_detail_level>(m_accessedDetailLevel.load());
+}
+
+xsapi_internal_unordered_map(uint64_t, social_manager_extra_detail_level)
+social_decoration_tracker::take_pending_fetches()
+{
+    xsapi_internal_unordered_map(uint64_t, social_manager_extra_detail_level) pendingFetches;
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    pendingFetches.swap(m_pendingFetches);
+    return pendingFetches;
+}
+
+void
+social_decoration_tracker::reset()
+{
+    // A new social manager session starts from the decorations its own title code reads
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    m_accessedDetailLevel = static_cast<uint32_t>(social_manager_extra_detail_level::no_extra_detail);
+    m_pendingFetches.clear();
+    m_fetchedDecorations.clear();
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_SOCIAL_MANAGER_CPP_END
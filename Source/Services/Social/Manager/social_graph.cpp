@@ -9,6 +9,7 @@
 #include "xbox_live_context_impl.h"
 #include "system_internal.h"
 #include "xbox_system_factory.h"
+#include "span_tracer.h"
 
 using namespace xbox::services;
 using namespace xbox::services::system;
@@ -61,8 +62,8 @@ social_graph::social_graph(
 
 social_graph::~social_graph()
 {
-    std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-    std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+    std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+    std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
     m_xboxLiveContextImpl->real_time_activity_service()->deactivate();
 
     m_perfTester.start_timer(_T("~social_graph"));
@@ -194,15 +195,20 @@ social_graph::initialize()
         }
     });
 
+    auto traceContext = span_tracer::current_context();
     return m_peoplehubService.get_social_graph(
 #if TV_API || UNIT_TEST_SERVICES || !XSAPI_CPP
         m_xboxLiveContextImpl->user()->XboxUserId->Data(),
 #else
         m_xboxLiveContextImpl->user()->xbox_user_id(),
 #endif
-        m_detailLevel
-        ).then([thisWeakPtr](xbox_live_result<std::vector<xbox_social_user>> socialUsersResult)
+        requested_detail_level(),
+        m_detailLevel != social_manager_extra_detail_level::no_extra_detail
+        ).then([thisWeakPtr, traceContext](xbox_live_result<std::vector<xbox_social_user>> socialUsersResult)
     {
+        // The presence subscriptions below are part of whatever started this graph, e.g. add_local_user
+        trace_span subscribeSpan("social_graph::subscribe_presence", traceContext);
+        trace_context_scope traceScope(subscribeSpan.context());
         try
         {
             std::shared_ptr<social_graph> pThis(thisWeakPtr.lock());
@@ -230,8 +236,8 @@ social_graph::initialize()
                         return xbox_live_result<void>(xbox_live_error_code::runtime_error, "subscription initialization failed");
                     }
 
-                    std::lock_guard<std::recursive_mutex> lock(pThis->m_socialGraphMutex);
-                    std::lock_guard<std::recursive_mutex> priorityLock(pThis->m_socialGraphPriorityMutex);
+                    std::lock_guard<xsapi_recursive_mutex> lock(pThis->m_socialGraphMutex);
+                    std::lock_guard<xsapi_recursive_mutex> priorityLock(pThis->m_socialGraphPriorityMutex);
                     pThis->m_perfTester.start_timer(_T("sub"));
                     pThis->m_socialUserSubscriptions[user.first].devicePresenceChangeSubscription = devicePresenceSubResult.payload();
                     pThis->m_socialUserSubscriptions[user.first].titlePresenceChangeSubscription = titlePresenceSubResult.payload();
@@ -239,8 +245,8 @@ social_graph::initialize()
                 }
 
 
-                std::lock_guard<std::recursive_mutex> lock(pThis->m_socialGraphMutex);
-                std::lock_guard<std::recursive_mutex> priorityLock(pThis->m_socialGraphPriorityMutex);
+                std::lock_guard<xsapi_recursive_mutex> lock(pThis->m_socialGraphMutex);
+                std::lock_guard<xsapi_recursive_mutex> priorityLock(pThis->m_socialGraphPriorityMutex);
                 pThis->m_perfTester.start_timer(_T("m_isInitialized"));
                 pThis->m_isInitialized = true;
                 pThis->m_perfTester.stop_timer(_T("m_isInitialized"));
@@ -262,11 +268,83 @@ social_graph::initialize()
     });
 }
 
+social_manager_extra_detail_level
+social_graph::requested_detail_level() const
+{
+    // Only ask peoplehub for decorations the title has actually read; the rest are fetched lazily
+    return m_detailLevel & social_decoration_tracker::get_singleton_instance()->accessed_detail_level();
+}
+
+void
+social_graph::fetch_missing_decorations(
+    _In_ const xsapi_internal_unordered_map(uint64_t, social_manager_extra_detail_level)& pendingFetches
+    )
+{
+    std::vector<string_t> usersToFetch;
+    {
+        std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+        std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+        auto& socialUserGraph = m_userBuffer.active_buffer()->socialUserGraph;
+        for (auto& pendingFetch : pendingFetches)
+        {
+            auto userIter = socialUserGraph.find(pendingFetch.first);
+            if (userIter == socialUserGraph.end() || userIter->second.socialUser == nullptr)
+            {
+                continue;
+            }
+
+            if ((pendingFetch.second & m_detailLevel) != social_manager_extra_detail_level::no_extra_detail)
+            {
+                usersToFetch.push_back(utils::uint64_to_string_t(pendingFetch.first));
+            }
+        }
+    }
+
+    if (!usersToFetch.empty())
+    {
+        LOGS_DEBUG << "social_graph: fetching missing decorations for " << usersToFetch.size() << " users";
+        m_socialGraphRefreshTimer->fire(usersToFetch);
+    }
+}
+
+void
+social_graph::fetch_missing_decorations(
+    _In_ social_manager_extra_detail_level decorations
+    )
+{
+    decorations = decorations & m_detailLevel;
+    if (decorations == social_manager_extra_detail_level::no_extra_detail)
+    {
+        return;
+    }
+
+    auto tracker = social_decoration_tracker::get_singleton_instance();
+    std::vector<string_t> usersToFetch;
+    {
+        std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+        std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+        for (auto& user : m_userBuffer.active_buffer()->socialUserGraph)
+        {
+            if (user.second.socialUser != nullptr &&
+                (tracker->fetched_detail_level(user.first) & decorations) != decorations)
+            {
+                usersToFetch.push_back(utils::uint64_to_string_t(user.first));
+            }
+        }
+    }
+
+    if (!usersToFetch.empty())
+    {
+        LOGS_DEBUG << "social_graph: fetching required decorations for " << usersToFetch.size() << " users";
+        m_socialGraphRefreshTimer->fire(usersToFetch);
+    }
+}
+
 const xsapi_internal_unordered_map(uint64_t, xbox_social_user_context)*
 social_graph::active_buffer_social_graph()
 {
-    std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-    std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+    std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+    std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
     return &m_userBuffer.active_buffer()->socialUserGraph;
 }
 
@@ -276,10 +354,10 @@ social_graph::do_event_work()
     bool hasRemainingEvent = false;
     bool hasCachedEvents = false;
     {
-        std::lock_guard<std::recursive_mutex> socialGraphStateLock(m_socialGraphStateMutex);
+        std::lock_guard<xsapi_recursive_mutex> socialGraphStateLock(m_socialGraphStateMutex);
         {
-            std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-            std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+            std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+            std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
             set_state(social_graph_state::event_processing);
 
             m_perfTester.start_timer(_T("do_event_work: event_processing"));
@@ -301,8 +379,8 @@ social_graph::do_event_work()
         }
         else if (m_isInitialized)
         {
-            std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-            std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+            std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+            std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
             m_perfTester.start_timer(_T("do_event_work: process_events"));
             set_state(social_graph_state::normal);
             hasRemainingEvent = process_events(); //effectively a coroutine here so that each event yields when it is done processing
@@ -310,8 +388,8 @@ social_graph::do_event_work()
         }
         else
         {
-            std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-            std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+            std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+            std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
 
             m_perfTester.start_timer(_T("set_state: normal"));
             set_state(social_graph_state::normal);
@@ -332,8 +410,8 @@ void social_graph::initialize_social_buffers(
 bool
 social_graph::is_initialized()
 {
-    std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-    std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+    std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+    std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
     return m_isInitialized;
 }
 
@@ -350,8 +428,8 @@ social_graph::process_cached_events()
             apply_event(evt, false);
         }
 
-        std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-        std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+        std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+        std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
         set_state(social_graph_state::normal);
     }
 }
@@ -482,13 +560,17 @@ void social_graph::apply_users_added_event(
     for (auto& user : evt.users_affected_as_string_vec())
     {
         string_t addUser(user.c_str());
-        auto userIter = inactiveBuffer->socialUserGraph.find(utils::string_t_to_uint64(addUser));
+        auto userAsInt = utils::string_t_to_uint64(addUser);
+        auto userIter = inactiveBuffer->socialUserGraph.find(userAsInt);
         if (userIter != inactiveBuffer->socialUserGraph.end())
         {
             ++userIter->second.refCount;
         }
         else
         {
+            // Placed in the graph right away so a user listed twice shares one fetch and subscription
+            inactiveBuffer->socialUserGraph[userAsInt].socialUser = nullptr;
+            inactiveBuffer->socialUserGraph[userAsInt].refCount = 1;
             usersToAdd.push_back(addUser);
         }
     }
@@ -510,13 +592,6 @@ void social_graph::apply_users_added_event(
         {
             m_socialGraphRefreshTimer->fire(usersToAdd, usersAddedStruct);
         }
-
-        for (auto& user : usersToAdd)
-        {
-            auto userAsInt = utils::string_t_to_uint64(user);
-            inactiveBuffer->socialUserGraph[userAsInt].socialUser = nullptr;
-            inactiveBuffer->socialUserGraph[userAsInt].refCount = 1;
-        }
     }
     m_perfTester.stop_timer(_T("apply_users_added_event"));
 }
@@ -706,7 +781,7 @@ void social_graph::apply_presence_changed_event(
                 continue;
             }
             auto userPresenceRecord = socialUser->presence_record();
-            if (userPresenceRecord._Compare(presenceRecord))    // TODO: potential optimization, limits the number of compares that can happen in a single event (i.e. if presence result has 100 record split it up into 10 events)
+            if (userPresenceRecord._Compare(presenceRecord))    // the number of compares per event is bounded by the graph's max users affected per event
             {
                 auto socialUserGraphUser = inactiveBuffer->socialUserGraph.at(presenceRecord._Xbox_user_id()).socialUser;
                 if (socialUserGraphUser == nullptr)
@@ -786,8 +861,8 @@ social_graph::setup_rta_subscriptions(
     _In_ bool shouldReinitialize
     )
 {
-    std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-    std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+    std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+    std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
     m_perfTester.start_timer(_T("setup_rta_subscriptions"));
     m_xboxLiveContextImpl->real_time_activity_service()->activate();
     auto socialRelationshipChangeResult = m_xboxLiveContextImpl->social_service().subscribe_to_social_relationship_change(
@@ -883,8 +958,8 @@ social_graph::setup_device_and_presence_subscriptions_helper(
         }
 
 
-        std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-        std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+        std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+        std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
 
         m_perfTester.start_timer(_T("setup_device_and_presence_subscriptions"));
         m_socialUserSubscriptions[xuid].devicePresenceChangeSubscription = devicePresenceSubResult.payload();
@@ -926,8 +1001,8 @@ social_graph::unsubscribe_users(
         }
         for (auto& user : users)
         {
-            std::lock_guard<std::recursive_mutex> lock(pThis->m_socialGraphMutex);
-            std::lock_guard<std::recursive_mutex> priorityLock(pThis->m_socialGraphPriorityMutex);
+            std::lock_guard<xsapi_recursive_mutex> lock(pThis->m_socialGraphMutex);
+            std::lock_guard<xsapi_recursive_mutex> priorityLock(pThis->m_socialGraphPriorityMutex);
             pThis->m_perfTester.start_timer(_T("unsubscribe_users"));
             auto subscriptions = pThis->m_socialUserSubscriptions[user];
             pThis->m_xboxLiveContextImpl->presence_service().unsubscribe_from_device_presence_change(subscriptions.devicePresenceChangeSubscription);
@@ -965,10 +1040,10 @@ social_graph::refresh_graph()
 {
     std::vector<uint64_t> userRefreshList;
     {
-        std::lock_guard<std::recursive_mutex> socialGraphStateLock(m_socialGraphStateMutex);
+        std::lock_guard<xsapi_recursive_mutex> socialGraphStateLock(m_socialGraphStateMutex);
         {
-            std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-            std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+            std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+            std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
 
             m_perfTester.start_timer(_T("refresh_graph"));
             set_state(social_graph_state::refresh);
@@ -976,8 +1051,8 @@ social_graph::refresh_graph()
         }
         refresh_graph_helper(userRefreshList);
         {
-            std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-            std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+            std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+            std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
 
             m_perfTester.start_timer(_T("refresh_graph stop"));
             set_state(social_graph_state::normal);
@@ -1002,7 +1077,8 @@ social_graph::refresh_graph()
 #else
         m_xboxLiveContextImpl->user()->xbox_user_id(),
 #endif
-        m_detailLevel
+        requested_detail_level(),
+        m_detailLevel != social_manager_extra_detail_level::no_extra_detail
     )
     .then([thisWeakPtr](xbox_live_result<std::vector<xbox_social_user>> socialListResult)
     {
@@ -1033,10 +1109,10 @@ social_graph::perform_diff(
     _In_ const xsapi_internal_unordered_map(uint64_t, xbox_social_user)& xboxSocialUsers
     )
 {
-    std::lock_guard<std::recursive_mutex> socialGraphStateLock(m_socialGraphStateMutex);
+    std::lock_guard<xsapi_recursive_mutex> socialGraphStateLock(m_socialGraphStateMutex);
     {
-        std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-        std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+        std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+        std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
         m_perfTester.start_timer(_T("set_state"));
         if (m_userBuffer.inactive_buffer() == nullptr)
         {
@@ -1113,8 +1189,8 @@ social_graph::perform_diff(
     }
 
     {
-        std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-        std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+        std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+        std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
         m_perfTester.start_timer(_T("set_state normal"));
         set_state(social_graph_state::normal);
         m_perfTester.stop_timer(_T("set_state normal"));
@@ -1134,7 +1210,7 @@ social_graph::do_work(
 {
     m_perfTester.start_timer(_T("do_work"));
     m_perfTester.start_timer(_T("do_work locktime"));
-    std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+    std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
     m_perfTester.stop_timer(_T("do_work locktime"));
     m_numEventsThisFrame = 0;
     change_struct changeStruct;
@@ -1178,31 +1254,43 @@ social_graph::social_graph_timer_callback(
     )
 {
     std::weak_ptr<social_graph> thisWeakPtr = shared_from_this();
-    return m_peoplehubService.get_social_graph(
-        m_xboxLiveContextImpl->xbox_live_user_id(),
-        m_detailLevel,
-        users
+
+    // Each chunk is merged as soon as it arrives. The completion context rides on whichever
+    // chunk finishes last so waiters only resume once every user has been applied.
+    auto usersOutstanding = std::make_shared<std::atomic<size_t>>(users.size());
+    auto chunkCompleteHandler = [thisWeakPtr, completionContext, usersOutstanding](
+        _In_ const std::vector<string_t>& chunkUsers,
+        _In_ const xbox_live_result<std::vector<xbox_social_user>>& chunkResult,
+        _In_ bool isLastChunk
         )
-    .then([thisWeakPtr, users, completionContext](xbox_live_result<std::vector<xbox_social_user>> socialListResult)
     {
         try
         {
             std::shared_ptr<social_graph> pThis(thisWeakPtr.lock());
             if (pThis)
             {
-                if (!socialListResult.err())
+                auto chunkContext = completionContext;
+                if (!isLastChunk)
+                {
+                    chunkContext = call_buffer_timer_completion_context();
+                }
+
+                // The buffer size hint is what is still to come, so the first chunk grows the user
+                // buffer once for the whole list and later chunks fit in the space it reserved
+                chunkContext.numObjects = usersOutstanding->fetch_sub(chunkUsers.size());
+                if (!chunkResult.err())
                 {
-                    pThis->m_internalEventQueue.push(internal_social_event_type::users_changed, utils::std_vector_to_xsapi_vector(socialListResult.payload()), completionContext);
+                    pThis->m_internalEventQueue.push(internal_social_event_type::users_changed, utils::std_vector_to_xsapi_vector(chunkResult.payload()), chunkContext);
                 }
                 else
                 {
                     xsapi_internal_vector(xsapi_internal_string) xsapiStrVec;
-                    for (auto user : users)
+                    for (auto user : chunkUsers)
                     {
                         xsapiStrVec.push_back(user.c_str());
                     }
-                    internal_social_event evt(internal_social_event_type::users_changed, xbox_live_result<void>(socialListResult.err(), socialListResult.err_message()), xsapiStrVec);
-                    evt.set_completion_context(completionContext);
+                    internal_social_event evt(internal_social_event_type::users_changed, xbox_live_result<void>(chunkResult.err(), chunkResult.err_message()), xsapiStrVec);
+                    evt.set_completion_context(chunkContext);
                     pThis->m_internalEventQueue.push(evt);
                 }
             }
@@ -1215,9 +1303,15 @@ social_graph::social_graph_timer_callback(
         {
             LOG_DEBUG("Unknown std::exception in initialization");
         }
+    };
 
-        return socialListResult;
-    });
+    return m_peoplehubService.get_social_graph_sharded(
+        m_xboxLiveContextImpl->xbox_live_user_id(),
+        requested_detail_level(),
+        users,
+        m_detailLevel != social_manager_extra_detail_level::no_extra_detail,
+        chunkCompleteHandler
+        );
 }
 
 void social_graph::social_graph_refresh_callback()
@@ -1339,8 +1433,8 @@ social_graph::handle_rta_connection_state_change(
 {
     bool wasDisconnected = false;
     {
-        std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-        std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+        std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+        std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
         m_perfTester.start_timer(_T("handle_rta_connection_state_change:disconnected_check"));
         wasDisconnected = m_wasDisconnected;
         m_perfTester.stop_timer(_T("handle_rta_connection_state_change:disconnected_check"));
@@ -1348,8 +1442,8 @@ social_graph::handle_rta_connection_state_change(
     if(rtaState == real_time_activity_connection_state::disconnected)
     {
         {
-            std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-            std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex); 
+            std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+            std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex); 
             m_perfTester.start_timer(_T("handle_rta_connection_state_change: disconnected received"));
             m_wasDisconnected = true;
             m_perfTester.stop_timer(_T("handle_rta_connection_state_change: disconnected received"));
@@ -1358,8 +1452,8 @@ social_graph::handle_rta_connection_state_change(
     else if (wasDisconnected)
     {
         {
-            std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-            std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+            std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+            std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
             m_perfTester.start_timer(_T("handle_rta_connection_state_change: disconnected check false"));
             m_wasDisconnected = false;
             m_perfTester.stop_timer(_T("handle_rta_connection_state_change: disconnected check false"));
@@ -1407,10 +1501,10 @@ social_graph::presence_timer_callback(
         {
             if (!presenceRecordsResult.err())
             {
-                std::lock_guard<std::recursive_mutex> socialGraphStateLock(pThis->m_socialGraphStateMutex);
+                std::lock_guard<xsapi_recursive_mutex> socialGraphStateLock(pThis->m_socialGraphStateMutex);
                 {
-                    std::lock_guard<std::recursive_mutex> lock(pThis->m_socialGraphMutex);
-                    std::lock_guard<std::recursive_mutex> priorityLock(pThis->m_socialGraphPriorityMutex);
+                    std::lock_guard<xsapi_recursive_mutex> lock(pThis->m_socialGraphMutex);
+                    std::lock_guard<xsapi_recursive_mutex> priorityLock(pThis->m_socialGraphPriorityMutex);
                     pThis->m_perfTester.start_timer(_T("social graph refresh state set"));
                     if (pThis->m_userBuffer.inactive_buffer() == nullptr)
                     {
@@ -1455,8 +1549,8 @@ social_graph::presence_timer_callback(
                     );
 
                 {
-                    std::lock_guard<std::recursive_mutex> lock(pThis->m_socialGraphMutex);
-                    std::lock_guard<std::recursive_mutex> priorityLock(pThis->m_socialGraphPriorityMutex);
+                    std::lock_guard<xsapi_recursive_mutex> lock(pThis->m_socialGraphMutex);
+                    std::lock_guard<xsapi_recursive_mutex> priorityLock(pThis->m_socialGraphPriorityMutex);
                     pThis->m_perfTester.start_timer(_T("social graph refresh state set normal"));
                     pThis->set_state(social_graph_state::normal);
                     pThis->m_perfTester.stop_timer(_T("social graph refresh state set normal"));
@@ -1473,8 +1567,8 @@ social_graph::presence_timer_callback(
 bool
 social_graph::are_events_empty()
 {
-    std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-    std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+    std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+    std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
     m_perfTester.start_timer(_T("are_events_empty"));
     auto result =  m_userBuffer.user_buffer_a().socialUserEventQueue.empty() && m_userBuffer.user_buffer_b().socialUserEventQueue.empty();
     m_perfTester.stop_timer(_T("are_events_empty"));
@@ -1503,13 +1597,13 @@ social_graph::presence_refresh_callback()
 {
     std::vector<string_t> userList;
     {
-        std::lock_guard<std::recursive_mutex> socialGraphStateLock(m_socialGraphStateMutex);
+        std::lock_guard<xsapi_recursive_mutex> socialGraphStateLock(m_socialGraphStateMutex);
 
         if (m_userBuffer.inactive_buffer() != nullptr)
         {
             {
-                std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-                std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+                std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+                std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
                 m_perfTester.start_timer(_T("presence refresh state set"));
                 set_state(social_graph_state::refresh);
                 m_perfTester.stop_timer(_T("presence refresh state set"));
@@ -1526,8 +1620,8 @@ social_graph::presence_refresh_callback()
             m_presencePollingTimer->fire(userList);
 
             {
-                std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-                std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+                std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+                std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
                 m_perfTester.start_timer(_T("presence refresh fire"));
                 set_state(social_graph_state::normal);
                 m_perfTester.stop_timer(_T("presence refresh fire"));
@@ -1546,7 +1640,7 @@ social_graph::presence_refresh_callback()
         if (pThis)
         {
             {
-                std::lock_guard<std::recursive_mutex> socialGraphStateLock(pThis->m_socialGraphStateMutex);
+                std::lock_guard<xsapi_recursive_mutex> socialGraphStateLock(pThis->m_socialGraphStateMutex);
                 if (*pThis->m_shouldCancel)
                 {
                     return;
@@ -1566,8 +1660,8 @@ social_graph::enable_rich_presence_polling(
 {
     bool isPollingRichPresence;
     {
-        std::lock_guard<std::recursive_mutex> lock(m_socialGraphMutex);
-        std::lock_guard<std::recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
+        std::lock_guard<xsapi_recursive_mutex> lock(m_socialGraphMutex);
+        std::lock_guard<xsapi_recursive_mutex> priorityLock(m_socialGraphPriorityMutex);
         isPollingRichPresence = m_isPollingRichPresence;
         m_isPollingRichPresence = shouldEnablePolling;
     }
@@ -1575,18 +1669,27 @@ social_graph::enable_rich_presence_polling(
     if (shouldEnablePolling && !isPollingRichPresence)
     {
         {
-            std::lock_guard<std::recursive_mutex> socialGraphStateLock(m_socialGraphStateMutex);
+            std::lock_guard<xsapi_recursive_mutex> socialGraphStateLock(m_socialGraphStateMutex);
             *m_shouldCancel = false;
         }
         presence_refresh_callback();
     }
     else if(!shouldEnablePolling)
     {
-        std::lock_guard<std::recursive_mutex> socialGraphStateLock(m_socialGraphStateMutex);
+        std::lock_guard<xsapi_recursive_mutex> socialGraphStateLock(m_socialGraphStateMutex);
         *m_shouldCancel = true;
     }
 }
 
+void
+social_graph::set_max_users_affected_per_event(
+    _In_ uint32_t maxUsersAffectedPerEvent
+    )
+{
+    // Only changes how later changes are split; events already queued keep their size
+    m_internalEventQueue.set_max_users_affected_per_event(maxUsersAffectedPerEvent);
+}
+
 void social_graph::clear_debug_counters()
 {
 }
@@ -1853,7 +1956,7 @@ event_queue::event_queue(
 const std::vector<social_event>&
 event_queue::social_event_list()
 {
-    std::lock_guard<std::mutex> lock(m_eventGraphMutex.get());
+    std::lock_guard<xsapi_mutex> lock(m_eventGraphMutex.get());
     m_eventState = event_state::read;
     return m_socialEventList;
 }
@@ -1878,7 +1981,7 @@ event_queue::push(
         usersAffected.push_back(affectedUser.c_str());
     }
 
-    std::lock_guard<std::mutex> lock(m_eventGraphMutex.get());
+    std::lock_guard<xsapi_mutex> lock(m_eventGraphMutex.get());
     social_event selectedEvt;
 
     selectedEvt = social_event(user, socialEventType, usersAffected, nullptr, error.err(), error.err_message());
@@ -1890,7 +1993,7 @@ event_queue::push(
 void
 event_queue::clear()
 {
-    std::lock_guard<std::mutex> lock(m_eventGraphMutex.get());
+    std::lock_guard<xsapi_mutex> lock(m_eventGraphMutex.get());
     m_socialEventList.clear();
     m_eventState = event_state::clear;
 }
@@ -1898,7 +2001,7 @@ event_queue::clear()
 bool
 event_queue::empty()
 {
-    std::lock_guard<std::mutex> lock(m_eventGraphMutex.get());
+    std::lock_guard<xsapi_mutex> lock(m_eventGraphMutex.get());
     return m_socialEventList.empty();
 }
 
@@ -9,6 +9,8 @@
 #endif
 
 #include "perf_tester.h"
+#include "flight_recorder.h"
+#include "span_tracer.h"
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_SOCIAL_MANAGER_CPP_BEGIN
 
@@ -16,7 +18,7 @@ std::shared_ptr<social_manager>
 social_manager::get_singleton_instance()
 {
     auto xsapiSingleton = get_xsapi_singleton();
-    std::lock_guard<std::mutex> lock(xsapiSingleton->m_singletonLock);
+    std::lock_guard<xsapi_mutex> lock(xsapiSingleton->m_singletonLock);
     if (xsapiSingleton->m_socialManagerInstance == nullptr)
     {
         xsapiSingleton->m_socialManagerInstance = std::shared_ptr<social_manager>(new social_manager());
@@ -25,6 +27,29 @@ social_manager::get_singleton_instance()
     return xsapiSingleton->m_socialManagerInstance;
 }
 
+// Kept out of social_manager so the public class layout doesn't change. There is only one social_manager,
+// and the setting is read and written under its m_socialMangerLock.
+static uint32_t& max_users_affected_per_event_setting()
+{
+    static uint32_t s_maxUsersAffectedPerEvent = internal_event_queue::DEFAULT_MAX_USERS_AFFECTED_PER_EVENT;
+    return s_maxUsersAffectedPerEvent;
+}
+
+// The decorations a presence filter reads when it decides whether a user belongs in the group
+static social_manager_extra_detail_level decorations_read_by_filter(
+    _In_ presence_filter presenceFilter
+    )
+{
+    switch (presenceFilter)
+    {
+    case presence_filter::all_title:
+    case presence_filter::title_offline:
+        return social_manager_extra_detail_level::title_history_level;
+    default:
+        return social_manager_extra_detail_level::no_extra_detail;
+    }
+}
+
 social_manager::social_manager()
 {
 }
@@ -63,9 +88,17 @@ social_manager::create_social_user_group_from_filters(
     m_userToViewMap[ownerUserId].push_back(viewHash);
     m_xboxSocialUserGroups[viewHash] = socialGroup;
 
+    // Register what the filter reads now so queries include it, rather than waiting for the first filter pass to read it
+    auto filterDecorations = decorations_read_by_filter(presenceFilterLevel);
+    if (filterDecorations != social_manager_extra_detail_level::no_extra_detail)
+    {
+        social_decoration_tracker::get_singleton_instance()->require_decorations(filterDecorations);
+    }
+
     if (m_localGraphs[ownerUserId]->is_initialized())
     {
-        
+        // Users already in the graph that were fetched without it are refreshed and join the group as they arrive
+        m_localGraphs[ownerUserId]->fetch_missing_decorations(filterDecorations);
         m_xboxSocialUserGroups[viewHash]->initialize_filter_list(
             *m_localGraphs[ownerUserId]->active_buffer_social_graph()
             );
@@ -93,10 +126,6 @@ social_manager::create_social_user_group_from_list(
     {
         return xbox_live_result<std::shared_ptr<xbox_social_user_group>>(xbox_live_error_code::invalid_argument, "xboxUserIdList cannot be empty");
     }
-    else if (xboxUserIdList.size() > MAX_USERS_FROM_LIST)
-    {
-        return xbox_live_result<std::shared_ptr<xbox_social_user_group>>(xbox_live_error_code::invalid_argument, "xboxUserIdList has a limit of 100 users");
-    }
 
     std::lock_guard<std::mutex> lock(m_socialMangerLock);
     string_t ownerUserId = user_context::get_user_id(user);
@@ -265,9 +294,14 @@ social_manager::add_local_user(
                 }
             }
             ));
+        newGraph->set_max_users_affected_per_event(max_users_affected_per_event_setting());
+
+        // Ends once the graph is loaded, so the span covers every call made on the way
+        auto addLocalUserSpan = std::make_shared<trace_span>("social_manager::add_local_user");
+        trace_context_scope traceScope(addLocalUserSpan->context());
 
         newGraph->initialize()
-        .then([thisWeakPtr, user, userString](xbox_live_result<void> result)
+        .then([thisWeakPtr, user, userString, addLocalUserSpan](xbox_live_result<void> result)
         {
             std::shared_ptr<social_manager> pThis(thisWeakPtr.lock());
             if (pThis)
@@ -300,6 +334,11 @@ social_manager::add_local_user(
                                 auto currentView = pThis->m_xboxSocialUserGroups[view];
                                 if (currentView->social_user_group_type() == social_user_group_type::filter_type)
                                 {
+                                    // The initial query may have gone out before this group registered its decorations
+                                    pThis->m_localGraphs[userString]->fetch_missing_decorations(
+                                        decorations_read_by_filter(currentView->presence_filter_of_group())
+                                        );
+
                                     std::weak_ptr<social_manager> socialManagerWeakPtr = pThis;
                                     currentView->initialize_filter_list(
                                         *pThis->m_localGraphs[userString]->active_buffer_social_graph()
@@ -330,6 +369,7 @@ social_manager::add_local_user(
                         );
                 }
             }
+            addLocalUserSpan->end();
         });
 
         m_localGraphs[userString] = newGraph;
@@ -375,6 +415,12 @@ social_manager::remove_local_user(
 
     m_userToViewMap.erase(xboxUserId);
 
+    // Decorations read in this session shouldn't carry over into the next one
+    if (m_localGraphs.empty())
+    {
+        social_decoration_tracker::get_singleton_instance()->reset();
+    }
+
     std::vector<xbox_live_user_t> userList;
     uint32_t i;
     for (i = 0; i < m_localUserList.size(); ++i)
@@ -403,11 +449,18 @@ social_manager::do_work()
     xsapiSingleton->m_perfTester->start_timer(_T("do_work: eventqueue clear"));
     m_eventQueue.clear();
     xsapiSingleton->m_perfTester->stop_timer(_T("do_work: eventqueue clear"));
+
+    // Each event is folded into the union once, so a view refilters every affected user once
+    // per do_work no matter how many events the change was split into
+    social_event_users_union usersAffected;
+    usersAffected.add_events(socialEvents);
     for (auto& graph : m_localGraphs)
     {
+        size_t firstGraphEventIndex = socialEvents.size();
         xsapiSingleton->m_perfTester->start_timer(_T("do_work: social_graph do_work"));
         auto graphData = graph.second->do_work(socialEvents);
         xsapiSingleton->m_perfTester->stop_timer(_T("do_work: social_graph do_work"));
+        usersAffected.add_events(socialEvents, firstGraphEventIndex);
         const auto& userViewList = m_userToViewMap[graph.first];
         for (auto& viewHash : userViewList)
         {
@@ -415,17 +468,148 @@ social_manager::do_work()
             if(graphData.socialUsers != nullptr)
             {
                 xsapiSingleton->m_perfTester->start_timer(_T("do_work: update_view"));
-                view->update_view(*graphData.socialUsers, socialEvents);
+                view->update_view(*graphData.socialUsers, usersAffected);
                 xsapiSingleton->m_perfTester->stop_timer(_T("do_work: update_view"));
             }
         }
     }
 
+    // Decorations read by the title since the last frame are fetched for the users that are missing them
+    auto pendingFetches = social_decoration_tracker::get_singleton_instance()->take_pending_fetches();
+    if (!pendingFetches.empty())
+    {
+        for (auto& graph : m_localGraphs)
+        {
+            graph.second->fetch_missing_decorations(pendingFetches);
+        }
+    }
+
+    if (!socialEvents.empty())
+    {
+        flight_recorder::get_flight_recorder_singleton()->record(flight_record_type::social_manager_events, 0, 0, static_cast<uint32_t>(socialEvents.size()));
+    }
+    social_event_handler_registry::get_singleton_instance()->dispatch(socialEvents);
+
     xsapiSingleton->m_perfTester->stop_timer(_T("do_work"));
     xsapiSingleton->m_perfTester->clear();
     return socialEvents;
 }
 
+xbox_live_result<std::vector<string_t>>
+social_manager::_Social_group_members(
+    _In_ const string_t& localXboxUserId,
+    _In_ const string_t& socialGroup
+    )
+{
+    bool favoritesOnly = utils::str_icmp(socialGroup, _T("favorites")) == 0;
+    if (!favoritesOnly &&
+        utils::str_icmp(socialGroup, _T("people")) != 0 &&
+        utils::str_icmp(socialGroup, _T("friends")) != 0)
+    {
+        return xbox_live_result<std::vector<string_t>>(xbox_live_error_code::invalid_argument, "Only the people and favorites social groups can be resolved from the social graph");
+    }
+
+    std::lock_guard<std::mutex> lock(m_socialMangerLock);
+    auto graphIter = m_localGraphs.find(localXboxUserId);
+    if (graphIter == m_localGraphs.end() || !graphIter->second->is_initialized())
+    {
+        return xbox_live_result<std::vector<string_t>>(xbox_live_error_code::logic_error, "Local user has no loaded social graph");
+    }
+
+    std::vector<string_t> members;
+    for (const auto& user : *graphIter->second->active_buffer_social_graph())
+    {
+        if (user.second.socialUser != nullptr && (!favoritesOnly || user.second.socialUser->is_favorite()))
+        {
+            members.push_back(user.second.socialUser->xbox_user_id());
+        }
+    }
+
+    return xbox_live_result<std::vector<string_t>>(members);
+}
+
+function_context
+social_manager::_Add_social_event_handler(
+    _In_ std::function<void(const std::vector<social_event>&)> handler
+    )
+{
+    return social_event_handler_registry::get_singleton_instance()->add_handler(std::move(handler));
+}
+
+void
+social_manager::_Remove_social_event_handler(
+    _In_ function_context context
+    )
+{
+    social_event_handler_registry::get_singleton_instance()->remove_handler(context);
+}
+
+social_event_handler_registry::social_event_handler_registry() :
+    m_handlerCounter(0)
+{
+}
+
+std::shared_ptr<social_event_handler_registry>
+social_event_handler_registry::get_singleton_instance()
+{
+    auto xsapiSingleton = get_xsapi_singleton();
+    std::lock_guard<xsapi_mutex> lock(xsapiSingleton->m_singletonLock);
+    if (xsapiSingleton->m_socialEventHandlerRegistry == nullptr)
+    {
+        xsapiSingleton->m_socialEventHandlerRegistry = std::make_shared<social_event_handler_registry>();
+    }
+    return xsapiSingleton->m_socialEventHandlerRegistry;
+}
+
+function_context
+social_event_handler_registry::add_handler(
+    _In_ std::function<void(const std::vector<social_event>&)> handler
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    function_context context = -1;
+    if (handler != nullptr)
+    {
+        context = ++m_handlerCounter;
+        m_handlers[context] = std::move(handler);
+    }
+
+    return context;
+}
+
+void
+social_event_handler_registry::remove_handler(
+    _In_ function_context context
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    m_handlers.erase(context);
+}
+
+void
+social_event_handler_registry::dispatch(
+    _In_ const std::vector<social_event>& socialEvents
+    )
+{
+    std::unordered_map<function_context, std::function<void(const std::vector<social_event>&)>> handlers;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        handlers = m_handlers;
+    }
+
+    for (auto& handler : handlers)
+    {
+        try
+        {
+            handler.second(socialEvents);
+        }
+        catch (...)
+        {
+            LOG_ERROR("social_manager: exception in social event handler");
+        }
+    }
+}
+
 const std::vector<xbox_live_user_t>&
 social_manager::local_users() const
 {
@@ -449,11 +633,6 @@ xbox_live_result<void> social_manager::update_social_user_group(
         return xbox_live_result<void>(xbox_live_error_code::invalid_argument, "Users can only be added to user groups of user_list_type");
     }
 
-    if (users.size() > MAX_USERS_FROM_LIST)
-    {
-        return xbox_live_result<void>(xbox_live_error_code::invalid_argument, "users cannot be larger than 100 users");
-    }
-
     auto diffUsers = socialGroup->_Update_users_in_group(users);
 
     auto localUser = socialGroup->local_user();
@@ -505,6 +684,33 @@ social_manager::set_rich_presence_polling_status(
     return xbox_live_result<void>();
 }
 
+xbox_live_result<void>
+social_manager::set_max_users_affected_per_event(
+    _In_ uint32_t maxUsersAffectedPerEvent
+    )
+{
+    if (maxUsersAffectedPerEvent == 0)
+    {
+        return xbox_live_result<void>(xbox_live_error_code::invalid_argument, "maxUsersAffectedPerEvent must be greater than 0");
+    }
+
+    std::lock_guard<std::mutex> lock(m_socialMangerLock);
+    max_users_affected_per_event_setting() = maxUsersAffectedPerEvent;
+    for (auto& graph : m_localGraphs)
+    {
+        graph.second->set_max_users_affected_per_event(maxUsersAffectedPerEvent);
+    }
+
+    return xbox_live_result<void>();
+}
+
+uint32_t
+social_manager::max_users_affected_per_event() const
+{
+    std::lock_guard<std::mutex> lock(m_socialMangerLock);
+    return max_users_affected_per_event_setting();
+}
+
 void social_manager::_Log_state()
 {
     LOGS_DEBUG << "[SM] State: m_xboxSocialUserGroups: " << m_xboxSocialUserGroups.size()
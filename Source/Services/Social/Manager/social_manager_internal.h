@@ -15,6 +15,7 @@
 #include "xsapi/mem.h"
 #include "perf_tester.h"
 #include "call_buffer_timer.h"
+#include "json_writer.h"
 
 typedef unsigned char byte;
 
@@ -141,19 +142,54 @@ struct change_struct
     const xsapi_internal_unordered_map(uint64_t, xbox_social_user_context)* socialUsers;
 };
 
+/// <summary>
+/// The users touched by a batch of social events, each user listed once per kind of change.
+/// Built once per do_work so views refilter over the union instead of walking every event.
+/// </summary>
+class social_event_users_union
+{
+public:
+    void add_events(
+        _In_ const std::vector<social_event>& socialEvents,
+        _In_ size_t firstEventIndex = 0
+        );
+
+    std::vector<xbox_user_id_container> refilteredUsers;
+    std::vector<xbox_user_id_container> addedUsers;
+    std::vector<xbox_user_id_container> removedUsers;
+
+private:
+    static void add_users(
+        _In_ const std::vector<xbox_user_id_container>& users,
+        _Inout_ std::vector<xbox_user_id_container>& userList,
+        _Inout_ xsapi_internal_unordered_map(uint64_t, bool)& seenUsers
+        );
+
+    xsapi_internal_unordered_map(uint64_t, bool) m_refilteredSeen;
+    xsapi_internal_unordered_map(uint64_t, bool) m_addedSeen;
+    xsapi_internal_unordered_map(uint64_t, bool) m_removedSeen;
+};
+
 class internal_event_queue
 {
 public:
+    static const uint32_t DEFAULT_MAX_USERS_AFFECTED_PER_EVENT = 10;
+
+    internal_event_queue() : m_maxUsersAffectedPerEvent(DEFAULT_MAX_USERS_AFFECTED_PER_EVENT) {}
+
     template<typename T, typename U>
     void push(_In_ internal_social_event_type socialEventType, _In_ const std::vector<T, U> userList, _In_ const call_buffer_timer_completion_context& completionContext = call_buffer_timer_completion_context())
     {
-        std::lock_guard<std::mutex> lock(m_eventMutex.get());
-        std::lock_guard<std::mutex> priorityLock(m_eventPriorityMutex.get());
-        auto numGroupsofUsers = userList.size() / MAX_USERS_AFFECTED_PER_EVENT + 1;
-        for (uint32_t i = 0; i < numGroupsofUsers; ++i)
+        std::lock_guard<xsapi_mutex> lock(m_eventMutex.get());
+        std::lock_guard<xsapi_mutex> priorityLock(m_eventPriorityMutex.get());
+        size_t maxUsersAffectedPerEvent = m_maxUsersAffectedPerEvent;
+
+        // An empty list still produces one event so the completion context is delivered
+        size_t numGroupsofUsers = __max((userList.size() + maxUsersAffectedPerEvent - 1) / maxUsersAffectedPerEvent, static_cast<size_t>(1));
+        for (size_t i = 0; i < numGroupsofUsers; ++i)
         {
-            auto endLoc = __min((i + 1) * MAX_USERS_AFFECTED_PER_EVENT, userList.size());
-            std::vector<T, U> usersAffected(userList.begin() + i * MAX_USERS_AFFECTED_PER_EVENT, userList.begin() + endLoc);
+            auto endLoc = __min((i + 1) * maxUsersAffectedPerEvent, userList.size());
+            std::vector<T, U> usersAffected(userList.begin() + i * maxUsersAffectedPerEvent, userList.begin() + endLoc);
             auto evt = internal_social_event(socialEventType, usersAffected);
             if (i == 0 && !completionContext.isNull)
             {
@@ -165,15 +201,15 @@ public:
 
     void push(_In_ const internal_social_event& socialEvent)
     {
-        std::lock_guard<std::mutex> lock(m_eventMutex.get());
-        std::lock_guard<std::mutex> priorityLock(m_eventPriorityMutex.get());
+        std::lock_guard<xsapi_mutex> lock(m_eventMutex.get());
+        std::lock_guard<xsapi_mutex> priorityLock(m_eventPriorityMutex.get());
         m_eventQueue.push_back(socialEvent);
     }
 
     internal_social_event pop()
     {
-        std::lock_guard<std::mutex> lock(m_eventMutex.get());
-        std::lock_guard<std::mutex> priorityLock(m_eventPriorityMutex.get());
+        std::lock_guard<xsapi_mutex> lock(m_eventMutex.get());
+        std::lock_guard<xsapi_mutex> priorityLock(m_eventPriorityMutex.get());
         internal_social_event evt = m_eventQueue.front();
         m_eventQueue.pop_front();
         return evt;
@@ -181,8 +217,8 @@ public:
 
     size_t size()
     {
-        std::lock_guard<std::mutex> lock(m_eventMutex.get());
-        std::lock_guard<std::mutex> priorityLock(m_eventPriorityMutex.get());
+        std::lock_guard<xsapi_mutex> lock(m_eventMutex.get());
+        std::lock_guard<xsapi_mutex> priorityLock(m_eventPriorityMutex.get());
         return m_eventQueue.size();
     }
 
@@ -190,19 +226,25 @@ public:
     {
         if (!isPriority)
         {
-            std::lock_guard<std::mutex> lock(m_eventMutex.get());
+            std::lock_guard<xsapi_mutex> lock(m_eventMutex.get());
         }
-        std::lock_guard<std::mutex> priorityLock(m_eventPriorityMutex.get());
+        std::lock_guard<xsapi_mutex> priorityLock(m_eventPriorityMutex.get());
         return m_eventQueue.empty();
     }
 
-private:
-    static const uint32_t MAX_USERS_AFFECTED_PER_EVENT = 10;
+    void set_max_users_affected_per_event(_In_ uint32_t maxUsersAffectedPerEvent)
+    {
+        std::lock_guard<xsapi_mutex> lock(m_eventMutex.get());
+        std::lock_guard<xsapi_mutex> priorityLock(m_eventPriorityMutex.get());
+        m_maxUsersAffectedPerEvent = __max(maxUsersAffectedPerEvent, 1u);
+    }
 
+private:
+    uint32_t m_maxUsersAffectedPerEvent;
     bool m_useLock;
     xsapi_internal_dequeue(internal_social_event) m_eventQueue;
-    xbox::services::system::xbox_live_mutex m_eventMutex;
-    xbox::services::system::xbox_live_mutex m_eventPriorityMutex;
+    xbox::services::system::xbox_live_mutex m_eventMutex XSAPI_LOCK_SITE("internal_event_queue::m_eventMutex");
+    xbox::services::system::xbox_live_mutex m_eventPriorityMutex XSAPI_LOCK_SITE("internal_event_queue::m_eventPriorityMutex");
 };
 
 struct user_buffer
@@ -295,11 +337,90 @@ private:
     uint32_t m_lastKnownSize;
     xbox_live_user_t m_user;
     std::vector<xbox::services::social::manager::social_event> m_socialEventList;
-    xbox::services::system::xbox_live_mutex m_eventGraphMutex;
+    xbox::services::system::xbox_live_mutex m_eventGraphMutex XSAPI_LOCK_SITE("event_queue::m_eventGraphMutex");
 
     static social_event_type convert_internal_social_event_type_to_social_event_type(_In_ internal_social_event_type socialEventType);
 };
 
+/// <summary>
+/// Internal listeners handed the events of every social_manager::do_work call, including calls
+/// that produce none, so a listener can tell whether do_work is being pumped.
+/// Kept out of social_manager so the layout of the public class doesn't change.
+/// </summary>
+class social_event_handler_registry
+{
+public:
+    social_event_handler_registry();
+
+    static std::shared_ptr<social_event_handler_registry> get_singleton_instance();
+
+    function_context add_handler(_In_ std::function<void(const std::vector<social_event>&)> handler);
+
+    void remove_handler(_In_ function_context context);
+
+    void dispatch(_In_ const std::vector<social_event>& socialEvents);
+
+private:
+    xsapi_mutex m_lock XSAPI_LOCK_SITE("social_event_handler_registry::m_lock");
+    function_context m_handlerCounter;
+    std::unordered_map<function_context, std::function<void(const std::vector<social_event>&)>> m_handlers;
+};
+
+/// <summary>
+/// Records which extra detail decorations title code actually reads from xbox_social_user.
+/// Peoplehub queries only request those, and users read before their decorations were
+/// fetched are queued so the owning graph can fetch them lazily.
+/// There is one tracker per process, shared by every local user's social graph, and it is
+/// reset when the last local user is removed from social manager.
+/// </summary>
+class social_decoration_tracker
+{
+public:
+    social_decoration_tracker();
+
+    static social_decoration_tracker* get_singleton_instance();
+
+    void record_access(
+        _In_ const xbox_social_user& user,
+        _In_ social_manager_extra_detail_level decoration
+        );
+
+    /// <summary>
+    /// Adds decorations to every later query before anything has read them, e.g. the title
+    /// history a presence filter checks.
+    /// </summary>
+    void require_decorations(_In_ social_manager_extra_detail_level decorations);
+
+    void record_fetch(
+        _In_ uint64_t xboxUserId,
+        _In_ social_manager_extra_detail_level decorations
+        );
+
+    social_manager_extra_detail_level fetched_detail_level(_In_ uint64_t xboxUserId) const;
+
+    social_manager_extra_detail_level accessed_detail_level() const;
+
+    xsapi_internal_unordered_map(uint64_t, social_manager_extra_detail_level) take_pending_fetches();
+
+    void reset();
+
+private:
+    std::atomic<uint32_t> m_accessedDetailLevel;
+    mutable xsapi_mutex m_lock XSAPI_LOCK_SITE("social_decoration_tracker::m_lock");
+    xsapi_internal_unordered_map(uint64_t, social_manager_extra_detail_level) m_pendingFetches;
+
+    // Kept here rather than on xbox_social_user so the public class layout doesn't change
+    xsapi_internal_unordered_map(uint64_t, social_manager_extra_detail_level) m_fetchedDecorations;
+};
+
+typedef std::function<void(
+    _In_ const std::vector<string_t>& chunkUsers,
+    _In_ const xbox_live_result<std::vector<xbox_social_user>>& chunkResult,
+    _In_ bool isLastChunk
+    )> peoplehub_batch_chunk_handler;
+
+struct peoplehub_batch_context;
+
 class peoplehub_service
 {
 public:
@@ -313,13 +434,28 @@ public:
 
     pplx::task<xbox_live_result<std::vector<xbox::services::social::manager::xbox_social_user>>> get_social_graph(
         _In_ const string_t& callerXboxUserId,
-        _In_ social_manager_extra_detail_level decorations
+        _In_ social_manager_extra_detail_level decorations,
+        _In_ bool includePresenceDetail = false
         );
 
     pplx::task<xbox_live_result<std::vector<xbox::services::social::manager::xbox_social_user>>> get_social_graph(
         _In_ const string_t& callerXboxUserId,
         _In_ social_manager_extra_detail_level decorations,
-        _In_ const std::vector<string_t> xboxLiveUsers
+        _In_ const std::vector<string_t> xboxLiveUsers,
+        _In_ bool includePresenceDetail = false
+        );
+
+    /// Splits the batch into chunks of at most MAX_USERS_PER_BATCH_REQUEST users, keeps up to
+    /// MAX_CONCURRENT_BATCH_REQUESTS of them in flight and retries only the chunks that fail with a
+    /// transient error, drawing on the peoplehub endpoint's retry budget.
+    /// chunkCompleteHandler is invoked as each chunk finishes, one at a time, and the call that is
+    /// told it is the last chunk comes after every other; the returned task holds the merged result.
+    pplx::task<xbox_live_result<std::vector<xbox::services::social::manager::xbox_social_user>>> get_social_graph_sharded(
+        _In_ const string_t& callerXboxUserId,
+        _In_ social_manager_extra_detail_level decorations,
+        _In_ const std::vector<string_t>& xboxLiveUsers,
+        _In_ bool includePresenceDetail,
+        _In_ const peoplehub_batch_chunk_handler& chunkCompleteHandler = nullptr
         );
 
     pplx::task<xbox_live_result<std::vector<xbox::services::social::manager::xbox_social_user>>> get_suggested_friends(
@@ -327,13 +463,20 @@ public:
         _In_ social_manager_extra_detail_level decorations
         );
 
+    /// Writes the {"xuids":[...]} body of a batch social graph request
+    static void serialize_batch_request(
+        _In_ const std::vector<string_t>& xboxLiveUsers,
+        _Inout_ xbox::services::json_writer& writer
+        );
+
 private:
     pplx::task<xbox_live_result<std::vector<xbox::services::social::manager::xbox_social_user>>> get_social_graph(
         _In_ const string_t& callerXboxUserId,
         _In_ social_manager_extra_detail_level decorations,
         _In_ const string_t& relationshipType,
         _In_ const std::vector<string_t> xboxLiveUsers,
-        _In_ bool isBatch
+        _In_ bool isBatch,
+        _In_ bool includePresenceDetail
         );
 
     string_t social_graph_subpath(
@@ -341,14 +484,51 @@ private:
         _In_ social_manager_extra_detail_level decorations,
         _In_ const string_t& relationshipType,
         _In_ const std::vector<string_t> xboxLiveUsers,
-        _In_ bool isBatch
+        _In_ bool isBatch,
+        _In_ bool includePresenceDetail
         ) const;
 
+    static void start_next_batch_chunk(_In_ const std::shared_ptr<peoplehub_batch_context>& batchContext);
+
+    static void fetch_batch_chunk(
+        _In_ const std::shared_ptr<peoplehub_batch_context>& batchContext,
+        _In_ size_t chunkIndex,
+        _In_ uint32_t attempt
+        );
+
+    // Timeouts, throttling and 5xx; anything else fails the same way when it is sent again
+    static bool is_transient_error(_In_ const std::error_code& errorCode);
+
+    static const size_t MAX_USERS_PER_BATCH_REQUEST;
+    static const size_t MAX_CONCURRENT_BATCH_REQUESTS;
+    static const uint32_t MAX_BATCH_REQUEST_ATTEMPTS;
+    static const std::chrono::milliseconds BATCH_REQUEST_RETRY_DELAY;
+
     std::shared_ptr<xbox::services::user_context> m_userContext;
     std::shared_ptr<xbox::services::xbox_live_context_settings> m_httpCallSettings;
     std::shared_ptr<xbox::services::xbox_live_app_config> m_appConfig;
 };
 
+struct peoplehub_batch_context
+{
+    peoplehub_batch_context() : nextChunk(0), remainingChunks(0) {}
+
+    peoplehub_service service;
+    string_t callerXboxUserId;
+    social_manager_extra_detail_level decorations;
+    bool includePresenceDetail;
+    peoplehub_batch_chunk_handler chunkCompleteHandler;
+    std::vector<std::vector<string_t>> chunks;
+
+    xsapi_mutex lock XSAPI_LOCK_SITE("peoplehub_batch_context::lock");
+    size_t nextChunk;
+    size_t remainingChunks;
+    std::vector<xbox_social_user> users;
+    std::error_code errorCode;
+    std::string errorMessage;
+    pplx::task_completion_event<xbox_live_result<std::vector<xbox_social_user>>> tce;
+};
+
 class social_graph_snapshot
 {
 public:
@@ -393,6 +573,16 @@ public:
     
     void enable_rich_presence_polling(_In_ bool shouldEnablePolling);
 
+    void set_max_users_affected_per_event(_In_ uint32_t maxUsersAffectedPerEvent);
+
+    void fetch_missing_decorations(
+        _In_ const xsapi_internal_unordered_map(uint64_t, social_manager_extra_detail_level)& pendingFetches
+        );
+
+    void fetch_missing_decorations(
+        _In_ social_manager_extra_detail_level decorations
+        );
+
     const xsapi_internal_unordered_map(uint64_t, xbox_social_user_context)* active_buffer_social_graph();
 
 protected:
@@ -490,6 +680,8 @@ protected:
 
     void refresh_graph_helper(std::vector<uint64_t>& userRefreshList);
 
+    social_manager_extra_detail_level requested_detail_level() const;
+
 
     bool m_isInitialized;
     bool m_wasDisconnected;
@@ -521,9 +713,9 @@ protected:
     std::function<void()> m_graphDestructionCompleteCallback;
     std::function<void(_In_ xbox::services::real_time_activity::real_time_activity_connection_state state)> m_stateRTAFunction;
     xsapi_internal_unordered_map(uint64_t, xbox_social_user_subscriptions) m_socialUserSubscriptions;
-    std::recursive_mutex m_socialGraphMutex;
-    std::recursive_mutex m_socialGraphPriorityMutex;
-    std::recursive_mutex m_socialGraphStateMutex;
+    xsapi_recursive_mutex m_socialGraphMutex XSAPI_LOCK_SITE("social_graph::m_socialGraphMutex");
+    xsapi_recursive_mutex m_socialGraphPriorityMutex XSAPI_LOCK_SITE("social_graph::m_socialGraphPriorityMutex");
+    xsapi_recursive_mutex m_socialGraphStateMutex XSAPI_LOCK_SITE("social_graph::m_socialGraphStateMutex");
     xbox::services::perf_tester m_perfTester;
     event_queue m_socialEventQueue;
     internal_event_queue m_internalEventQueue;
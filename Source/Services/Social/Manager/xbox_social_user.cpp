@@ -114,12 +114,14 @@ void xbox_social_user::_Set_is_followed_by_caller(
 const xbox::services::social::manager::title_history&
 xbox_social_user::title_history() const
 {
+    social_decoration_tracker::get_singleton_instance()->record_access(*this, social_manager_extra_detail_level::title_history_level);
     return m_titleHistory;
 }
 
 const preferred_color&
 xbox_social_user::preferred_color() const
 {
+    social_decoration_tracker::get_singleton_instance()->record_access(*this, social_manager_extra_detail_level::preferred_color_level);
     return m_preferredColor;
 }
 
@@ -94,7 +94,7 @@ xbox_social_user_group::tracking_users()
 
 void xbox_social_user_group::update_view(
     _In_ const xsapi_internal_unordered_map(uint64_t, xbox_social_user_context)& snapshotList,
-    _In_ const std::vector<social_event>& socialEvents
+    _In_ const social_event_users_union& usersAffected
     )
 {
     std::lock_guard<std::mutex> lock(m_groupMutex);
@@ -102,7 +102,7 @@ void xbox_social_user_group::update_view(
     {
         filter_list(
             snapshotList,
-            socialEvents
+            usersAffected
             );
     }
     else if (m_userGroupType == social_user_group_type::user_list_type)
@@ -217,32 +217,12 @@ xbox_social_user_group::remove_users(
 void
 xbox_social_user_group::filter_list(
     _In_ const xsapi_internal_unordered_map(uint64_t, xbox_social_user_context)& snapshotList,
-    _In_ const std::vector<social_event>& socialEvents
+    _In_ const social_event_users_union& usersAffected
     )
 {
-    std::vector<xbox_user_id_container> refilterList;
-    std::vector<xbox_user_id_container> addedList;
-    std::vector<xbox_user_id_container> removeList;
     std::vector<xbox_removal_struct> removalStructList;
 
-    for (auto& evt : socialEvents)
-    {
-        switch (evt.event_type())
-        {
-        case social_event_type::presence_changed:
-        case social_event_type::profiles_changed:
-        case social_event_type::social_relationships_changed:
-            refilterList.insert(refilterList.end(), evt.users_affected().begin(), evt.users_affected().end());
-            break;
-        case social_event_type::users_added_to_social_graph:
-            addedList.insert(addedList.end(), evt.users_affected().begin(), evt.users_affected().end());
-            break;
-        case social_event_type::users_removed_from_social_graph:
-            removeList.insert(removeList.end(), evt.users_affected().begin(), evt.users_affected().end());
-            break;
-        }
-    }
-    for (auto& userStr : refilterList)
+    for (auto& userStr : usersAffected.refilteredUsers)
     {
         uint64_t userInt = utils::string_t_to_uint64(userStr.xbox_user_id());
         auto userPair = snapshotList.find(userInt);
@@ -296,7 +276,7 @@ xbox_social_user_group::filter_list(
         }
     }
     
-    for (auto& userStr : addedList)
+    for (auto& userStr : usersAffected.addedUsers)
     {
         uint64_t userInt = utils::string_t_to_uint64(userStr.xbox_user_id());
         auto userPair = snapshotList.find(userInt);
@@ -328,7 +308,7 @@ xbox_social_user_group::filter_list(
         }
     }
 
-    for (auto& userStr : removeList)
+    for (auto& userStr : usersAffected.removedUsers)
     {
         uint64_t userInt = utils::string_t_to_uint64(userStr.xbox_user_id());
         xbox_removal_struct xboxRemovalStruct;
@@ -368,10 +348,14 @@ xbox_social_user_group::_Update_users_in_group(
     _In_ const std::vector<string_t>& userList
     )
 {
-    xsapi_internal_unordered_map(uint64_t, uint32_t) changeMap;
-    xsapi_internal_vector(uint64_t) userIdList;
-    userIdList.reserve(userList.size());
+    // Lists can hold thousands of users, so membership is checked through maps rather than nested scans
+    xsapi_internal_unordered_map(uint64_t, bool) currentUsers;
+    for (auto userInt : m_userUpdateListInt)
+    {
+        currentUsers[userInt] = true;
+    }
 
+    xsapi_internal_unordered_map(uint64_t, bool) requestedUsers;
     user_group_status_change changeGroups;
     for (auto& user : userList)
     {
@@ -383,63 +367,47 @@ xbox_social_user_group::_Update_users_in_group(
             continue;
         }
 
-        userIdList.push_back(id);
-        bool userFound = false;
-        for (auto userInt : m_userUpdateListInt)
-        {
-            if (userInt == id)
-            {
-                userFound = true;
-                break;
-            }
-        }
-        if (userFound)
+        requestedUsers[id] = true;
+        if (currentUsers.find(id) != currentUsers.end())
         {
             continue;
         }
 
+        currentUsers[id] = true;
         changeGroups.addGroup.push_back(user);
         m_userUpdateListInt.push_back(id);
 
         m_userUpdateListString.push_back(user.c_str());
     }
 
-    std::vector<uint64_t> userCompareList(m_userUpdateListInt);
-    for (auto updateUser : userCompareList)
+    std::vector<uint64_t> remainingUsersInt;
+    remainingUsersInt.reserve(m_userUpdateListInt.size());
+    for (auto updateUser : m_userUpdateListInt)
     {
-        bool wasFound = false;
-        for (auto userId : userIdList)
+        if (requestedUsers.find(updateUser) != requestedUsers.end())
         {
-            if (userId == updateUser)
-            {
-                wasFound = true;
-            }
+            remainingUsersInt.push_back(updateUser);
         }
-
-        if (!wasFound)
+        else
         {
             changeGroups.removeGroup.push_back(updateUser);
-            
-            for (std::vector<uint64_t>::iterator i = m_userUpdateListInt.begin(); i != m_userUpdateListInt.end(); ++i)
-            {
-                if (*i == updateUser)
-                {
-                    m_userUpdateListInt.erase(i);
-                    break;
-                }
-            }
+        }
+    }
 
-            for (auto i = m_userUpdateListString.begin(); i != m_userUpdateListString.end(); ++i)
+    if (!changeGroups.removeGroup.empty())
+    {
+        std::vector<xbox_user_id_container> remainingUsersString;
+        remainingUsersString.reserve(remainingUsersInt.size());
+        for (auto& updateUser : m_userUpdateListString)
+        {
+            if (requestedUsers.find(utils::string_t_to_uint64(updateUser.xbox_user_id())) != requestedUsers.end())
             {
-                stringstream_t str;
-                str << updateUser;
-                if (utils::str_icmp(i->xbox_user_id(), str.str()) == 0)
-                {
-                    m_userUpdateListString.erase(i);
-                    break;
-                }
+                remainingUsersString.push_back(updateUser);
             }
         }
+
+        m_userUpdateListInt = std::move(remainingUsersInt);
+        m_userUpdateListString = std::move(remainingUsersString);
     }
 
     if (!changeGroups.addGroup.empty() || !changeGroups.removeGroup.empty())
@@ -494,10 +462,11 @@ xbox_social_user_group::get_presence_filter_result(
         return user->presence_record().user_state() == user_presence_state::offline;
     case presence_filter::all_online:
         return user->presence_record().user_state() == user_presence_state::online;
+    // Title history is registered when the group is created, so the filter reads it without the tracking accessor
     case presence_filter::all_title:
-        return user->title_history().has_user_played();
+        return user->m_titleHistory.has_user_played();
     case presence_filter::title_offline:
-        return user->presence_record().user_state() == user_presence_state::offline && user->title_history().has_user_played();
+        return user->presence_record().user_state() == user_presence_state::offline && user->m_titleHistory.has_user_played();
     case presence_filter::title_online:
         return user->presence_record().is_user_playing_title(m_titleId);
     default:
@@ -526,4 +495,46 @@ xbox_social_user_group::get_users_from_xbox_user_ids(
     return returnVec;
 }
 
+void
+social_event_users_union::add_events(
+    _In_ const std::vector<social_event>& socialEvents,
+    _In_ size_t firstEventIndex
+    )
+{
+    for (size_t i = firstEventIndex; i < socialEvents.size(); ++i)
+    {
+        auto& evt = socialEvents[i];
+        switch (evt.event_type())
+        {
+        case social_event_type::presence_changed:
+        case social_event_type::profiles_changed:
+        case social_event_type::social_relationships_changed:
+            add_users(evt.users_affected(), refilteredUsers, m_refilteredSeen);
+            break;
+        case social_event_type::users_added_to_social_graph:
+            add_users(evt.users_affected(), addedUsers, m_addedSeen);
+            break;
+        case social_event_type::users_removed_from_social_graph:
+            add_users(evt.users_affected(), removedUsers, m_removedSeen);
+            break;
+        }
+    }
+}
+
+void
+social_event_users_union::add_users(
+    _In_ const std::vector<xbox_user_id_container>& users,
+    _Inout_ std::vector<xbox_user_id_container>& userList,
+    _Inout_ xsapi_internal_unordered_map(uint64_t, bool)& seenUsers
+    )
+{
+    for (auto& user : users)
+    {
+        if (seenUsers.insert(std::make_pair(utils::string_t_to_uint64(user.xbox_user_id()), true)).second)
+        {
+            userList.push_back(user);
+        }
+    }
+}
+
 NAMESPACE_MICROSOFT_XBOX_SERVICES_SOCIAL_MANAGER_CPP_END
\ No newline at end of file
@@ -6,6 +6,8 @@
 #include "utils.h"
 #include "user_context.h"
 #include "xbox_system_factory.h"
+#include "http_call_impl.h"
+#include "json_writer.h"
 
 using namespace pplx;
 
@@ -83,11 +85,25 @@ profile_service::get_user_profiles(
         );
     httpCall->set_xbox_contract_version_header_value(_T("2"));
 
-    web::json::value request;
-    request[_T("userIds")] = utils::serialize_vector<string_t>(utils::json_string_serializer, xboxUserIds);
-    request[_T("settings")] = SETTINGS_SERIALIZED;
+    json_writer request(64 + xboxUserIds.size() * 24);
+    request.start_object();
+    request.write_key(_T("settings"));
+    request.start_array();
+    for (const auto& setting : SETTINGS_ARRAY)
+    {
+        request.write_string(setting);
+    }
+    request.end_array();
+    request.write_key(_T("userIds"));
+    request.start_array();
+    for (const auto& xboxUserId : xboxUserIds)
+    {
+        request.write_string(xboxUserId);
+    }
+    request.end_array();
+    request.end_object();
 
-    httpCall->set_request_body(request.serialize());
+    move_request_body(httpCall, request.take_buffer());
 
     auto task = httpCall->get_response_with_auth(m_userContext)
     .then([](std::shared_ptr<http_call_response> response) 
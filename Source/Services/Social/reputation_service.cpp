@@ -7,6 +7,7 @@
 #include "utils.h"
 #include "xbox_system_factory.h"
 #include "social_internal.h"
+#include "write_behind_journal.h"
 
 using namespace pplx;
 
@@ -55,9 +56,16 @@ reputation_service::submit_batch_reputation_feedback(
     RETURN_TASK_CPP_INVALIDARGUMENT_IF(err, void, "Invalid reputation_feedback_item");
     httpCall->set_request_body(request.serialize());
 
+    string_t journalKey = write_behind_journal::get_write_behind_journal_singleton()->record(
+        m_userContext->xbox_user_id(),
+        xbox_live_api::submit_batch_reputation_feedback,
+        httpCall
+        );
+
     auto task = httpCall->get_response_with_auth(m_userContext, http_call_response_body_type::string_body)
-    .then([](std::shared_ptr<http_call_response> response)
+    .then([journalKey](std::shared_ptr<http_call_response> response)
     {
+        write_behind_journal::get_write_behind_journal_singleton()->complete(journalKey, response);
         return xbox_live_result<void>(response->err_code(), response->err_message());
     });
 
@@ -106,9 +114,16 @@ reputation_service::submit_reputation_feedback(
     web::json::value request = reputationFeedbackRequest.serialize_feedback_request();
     httpCall->set_request_body(request.serialize());
 
+    string_t journalKey = write_behind_journal::get_write_behind_journal_singleton()->record(
+        m_userContext->xbox_user_id(),
+        xbox_live_api::submit_reputation_feedback,
+        httpCall
+        );
+
     auto task = httpCall->get_response_with_auth(m_userContext, http_call_response_body_type::string_body)
-    .then([](std::shared_ptr<http_call_response> response)
+    .then([journalKey](std::shared_ptr<http_call_response> response)
     {
+        write_behind_journal::get_write_behind_journal_singleton()->complete(journalKey, response);
         return xbox_live_result<void>(response->err_code(), response->err_message());
     });
 
@@ -103,7 +103,7 @@ private:
     std::shared_ptr<xbox::services::xbox_live_app_config> m_appConfig;
     std::unordered_map<uint32_t, std::function<void(const social_relationship_change_event_args&)>> m_socialRelationshipChangeHandler;
     function_context m_socialRelationshipChangeHandlerCounter;
-    xbox::services::system::xbox_live_mutex m_socialRelationshipChangeHandlerLock;
+    xbox::services::system::xbox_live_mutex m_socialRelationshipChangeHandlerLock XSAPI_LOCK_SITE("social_service_impl::m_socialRelationshipChangeHandlerLock");
     std::shared_ptr<xbox::services::real_time_activity::real_time_activity_service> m_realTimeActivityService;
 };
 
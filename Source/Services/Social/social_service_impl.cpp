@@ -77,7 +77,7 @@ social_service_impl::add_social_relationship_changed_handler(
     _In_ std::function<void(social_relationship_change_event_args)> handler
     )
 {
-    std::lock_guard<std::mutex> lock(m_socialRelationshipChangeHandlerLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_socialRelationshipChangeHandlerLock.get());
 
     function_context context = -1;
     if (handler != nullptr)
@@ -94,7 +94,7 @@ social_service_impl::remove_social_relationship_changed_handler(
     _In_ function_context context
     )
 {
-    std::lock_guard<std::mutex> lock(m_socialRelationshipChangeHandlerLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_socialRelationshipChangeHandlerLock.get());
 
     m_socialRelationshipChangeHandler.erase(context);
 }
@@ -106,7 +106,7 @@ social_service_impl::social_relationship_changed(
 {
     std::unordered_map<uint32_t, std::function<void(const social_relationship_change_event_args&)>> socialRelationshipChangedHandlersCopy;
     {
-        std::lock_guard<std::mutex> lock(m_socialRelationshipChangeHandlerLock.get());
+        std::lock_guard<xsapi_mutex> lock(m_socialRelationshipChangeHandlerLock.get());
         socialRelationshipChangedHandlersCopy = m_socialRelationshipChangeHandler;
     }
 
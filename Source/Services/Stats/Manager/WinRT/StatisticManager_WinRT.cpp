@@ -19,7 +19,7 @@ StatisticManager::SingletonInstance::get()
     {
         StatisticManager^ statisticManager = ref new StatisticManager();
         {
-            std::lock_guard<std::mutex> lock(xsapiSingleton->m_singletonLock);
+            std::lock_guard<xbox::services::xsapi_mutex> lock(xsapiSingleton->m_singletonLock);
             if (xsapiSingleton->m_winrt_statisticManagerInstance == nullptr)
             {
                 xsapiSingleton->m_winrt_statisticManagerInstance = statisticManager;
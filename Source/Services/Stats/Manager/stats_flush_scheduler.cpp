@@ -0,0 +1,242 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#include "stats_manager_internal.h"
+#if XSAPI_U
+    #include "ppltasks_extra_unix.h"
+#else
+    #include "ppltasks_extra.h"
+#endif
+
+using namespace Concurrency::extras;
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_STAT_MANAGER_CPP_BEGIN
+
+// One per split-screen player, so four local users flush in a single burst and any more wait their turn
+const size_t stats_flush_scheduler::MAX_CONCURRENT_FLUSHES = 4;
+const std::chrono::milliseconds stats_flush_scheduler::INITIAL_BACKOFF = std::chrono::seconds(2);
+const std::chrono::milliseconds stats_flush_scheduler::MAX_BACKOFF = std::chrono::seconds(60);
+
+stats_flush_scheduler::stats_flush_scheduler(
+    _In_ std::function<pplx::task<xbox_live_result<void>>(const string_t& xboxUserId)> flushHandler,
+    _In_ size_t maxConcurrentFlushes,
+    _In_ std::chrono::milliseconds initialBackoff
+    ) :
+    m_flushHandler(std::move(flushHandler)),
+    m_maxConcurrentFlushes(__max(maxConcurrentFlushes, static_cast<size_t>(1))),
+    m_initialBackoff(initialBackoff),
+    m_backoff(std::chrono::milliseconds::zero()),
+    m_backoffTimerScheduled(false)
+{
+}
+
+void
+stats_flush_scheduler::request_flush(
+    _In_ const std::vector<string_t>& xboxUserIds
+    )
+{
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        auto now = chrono_clock_t::now();
+        for (const auto& xboxUserId : xboxUserIds)
+        {
+            // A queued flush sends whatever the document holds when it starts, so one per user is enough
+            if (!is_queued(xboxUserId))
+            {
+                queued_flush flush;
+                flush.xboxUserId = xboxUserId;
+                flush.requestedTime = now;
+                m_queue.push_back(flush);
+            }
+        }
+    }
+
+    start_flushes();
+}
+
+void
+stats_flush_scheduler::remove_user(
+    _In_ const string_t& xboxUserId
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    m_queue.erase(
+        std::remove_if(m_queue.begin(), m_queue.end(), [&xboxUserId](const queued_flush& flush)
+        {
+            return flush.xboxUserId == xboxUserId;
+        }),
+        m_queue.end());
+}
+
+void
+stats_flush_scheduler::request_final_flush(
+    _In_ const string_t& xboxUserId,
+    _In_ std::function<pplx::task<xbox_live_result<void>>()> flushHandler,
+    _In_ std::function<void(const xbox_live_result<void>&)> onComplete
+    )
+{
+    remove_user(xboxUserId);
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        queued_flush flush;
+        flush.xboxUserId = xboxUserId;
+        flush.requestedTime = chrono_clock_t::now();
+        flush.flushHandler = std::move(flushHandler);
+        flush.onComplete = std::move(onComplete);
+        m_queue.push_back(std::move(flush));
+    }
+
+    start_flushes();
+}
+
+stats_flush_scheduler_stats
+stats_flush_scheduler::stats()
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    return m_stats;
+}
+
+void
+stats_flush_scheduler::start_flushes()
+{
+    std::vector<queued_flush> flushesToStart;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        auto now = chrono_clock_t::now();
+        if (now < m_backoffUntil)
+        {
+            if (!m_queue.empty() && !m_backoffTimerScheduled)
+            {
+                m_backoffTimerScheduled = true;
+                std::weak_ptr<stats_flush_scheduler> thisWeakPtr = shared_from_this();
+                create_delayed_task(
+                    std::chrono::duration_cast<std::chrono::milliseconds>(m_backoffUntil - now),
+                    [thisWeakPtr]()
+                {
+                    std::shared_ptr<stats_flush_scheduler> pThis(thisWeakPtr.lock());
+                    if (pThis != nullptr)
+                    {
+                        {
+                            std::lock_guard<xsapi_mutex> lock(pThis->m_lock);
+                            pThis->m_backoffTimerScheduled = false;
+                        }
+                        pThis->start_flushes();
+                    }
+                });
+            }
+            return;
+        }
+
+        // Skip past users with a flush in flight; theirs start once it completes, keeping each user's writes in order
+        for (auto flush = m_queue.begin(); flush != m_queue.end() && m_inFlight.size() < m_maxConcurrentFlushes;)
+        {
+            if (is_in_flight(flush->xboxUserId))
+            {
+                ++flush;
+                continue;
+            }
+
+            m_inFlight.push_back(flush->xboxUserId);
+            flushesToStart.push_back(*flush);
+            flush = m_queue.erase(flush);
+        }
+
+        m_stats.flushesStarted += flushesToStart.size();
+        m_stats.peakConcurrentFlushes = __max(m_stats.peakConcurrentFlushes, m_inFlight.size());
+    }
+
+    std::weak_ptr<stats_flush_scheduler> thisWeakPtr = shared_from_this();
+    for (const auto& flush : flushesToStart)
+    {
+        auto flushTask = flush.flushHandler != nullptr ? flush.flushHandler() : m_flushHandler(flush.xboxUserId);
+        flushTask.then([thisWeakPtr, flush](pplx::task<xbox_live_result<void>> flushTask)
+        {
+            xbox_live_result<void> result;
+            try
+            {
+                result = flushTask.get();
+            }
+            catch (...)
+            {
+                result = xbox_live_result<void>(xbox_live_error_code::runtime_error, "Stats flush failed");
+            }
+
+            std::shared_ptr<stats_flush_scheduler> pThis(thisWeakPtr.lock());
+            if (pThis != nullptr)
+            {
+                pThis->on_flush_complete(flush, result);
+            }
+        });
+    }
+}
+
+void
+stats_flush_scheduler::on_flush_complete(
+    _In_ const queued_flush& flush,
+    _In_ const xbox_live_result<void>& result
+    )
+{
+    bool isFinished = false;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        m_inFlight.erase(std::remove(m_inFlight.begin(), m_inFlight.end(), flush.xboxUserId), m_inFlight.end());
+
+        if (result.err() == xbox_live_error_code::http_status_429_too_many_requests)
+        {
+            // The service is pacing this title, not this user, so every user waits and this one goes first afterwards
+            m_backoff = m_backoff == std::chrono::milliseconds::zero() ?
+                m_initialBackoff :
+                __min(m_backoff * 2, MAX_BACKOFF);
+            m_backoffUntil = chrono_clock_t::now() + m_backoff;
+            ++m_stats.throttledFlushes;
+            LOGS_DEBUG << "stats_flush_scheduler: throttled, backing off all users for " << m_backoff.count() << "ms";
+
+            if (!is_queued(flush.xboxUserId))
+            {
+                m_queue.insert(m_queue.begin(), flush);
+            }
+        }
+        else
+        {
+            if (!result.err())
+            {
+                m_backoff = std::chrono::milliseconds::zero();
+            }
+
+            auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(chrono_clock_t::now() - flush.requestedTime);
+            ++m_stats.flushesCompleted;
+            m_stats.totalFlushLatency += latency;
+            m_stats.maxFlushLatency = __max(m_stats.maxFlushLatency, latency);
+            isFinished = true;
+        }
+    }
+
+    if (isFinished && flush.onComplete != nullptr)
+    {
+        flush.onComplete(result);
+    }
+
+    start_flushes();
+}
+
+bool
+stats_flush_scheduler::is_queued(
+    _In_ const string_t& xboxUserId
+    ) const
+{
+    return std::any_of(m_queue.begin(), m_queue.end(), [&xboxUserId](const queued_flush& flush)
+    {
+        return flush.xboxUserId == xboxUserId;
+    });
+}
+
+bool
+stats_flush_scheduler::is_in_flight(
+    _In_ const string_t& xboxUserId
+    ) const
+{
+    return std::find(m_inFlight.begin(), m_inFlight.end(), xboxUserId) != m_inFlight.end();
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_STAT_MANAGER_CPP_END
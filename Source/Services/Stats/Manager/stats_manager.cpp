@@ -17,7 +17,7 @@ std::shared_ptr<stats_manager>
 stats_manager::get_singleton_instance()
 {
     auto xsapiSingleton = get_xsapi_singleton();
-    std::lock_guard<std::mutex> guard(xsapiSingleton->m_singletonLock);
+    std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_singletonLock);
     if (xsapiSingleton->m_statsManagerInstance == nullptr)
     {
         xsapiSingleton->m_statsManagerInstance = std::make_shared<stats_manager>();
@@ -7,6 +7,7 @@
 #include "xsapi/services.h"
 #include "xsapi/system.h"
 #include "xbox_live_context_impl.h"
+#include "write_behind_journal.h"
 
 #if XSAPI_U
     #include "ppltasks_extra_unix.h"
@@ -48,13 +49,24 @@ stats_manager_impl::initialize()
 {
     std::weak_ptr<stats_manager_impl> thisWeakPtr = shared_from_this();
 
+    m_flushScheduler = std::make_shared<stats_flush_scheduler>(
+        [thisWeakPtr](const string_t& userXuid)
+        {
+            std::shared_ptr<stats_manager_impl> pThis(thisWeakPtr.lock());
+            if (pThis == nullptr)
+            {
+                return pplx::task_from_result(xbox_live_result<void>());
+            }
+            return pThis->flush_user(userXuid);
+        });
+
     m_statNormalPriTimer = std::make_shared<call_buffer_timer>(
         [thisWeakPtr](std::vector<string_t> eventArgs, const call_buffer_timer_completion_context&)
         {
             std::shared_ptr<stats_manager_impl> pThis(thisWeakPtr.lock());
             if (pThis != nullptr && !eventArgs.empty())
             {
-                pThis->request_flush_to_service_callback(eventArgs[0]);
+                pThis->m_flushScheduler->request_flush(eventArgs);
             }
         },
         TIME_PER_CALL_SEC);
@@ -65,7 +77,7 @@ stats_manager_impl::initialize()
             std::shared_ptr<stats_manager_impl> pThis(thisWeakPtr.lock());
             if (pThis != nullptr && !eventArgs.empty())
             {
-                pThis->request_flush_to_service_callback(eventArgs[0]);
+                pThis->m_flushScheduler->request_flush(eventArgs);
             }
         },
         TIME_PER_CALL_SEC);
@@ -138,14 +150,19 @@ void stats_manager_impl::start_background_flush_timer(_In_ std::weak_ptr<stats_m
 void
 stats_manager_impl::handle_background_flush_timer_trigger()
 {
-    std::lock_guard<std::mutex> guard(m_statsServiceMutex);
-    for (auto& user : m_users)
+    std::vector<string_t> dirtyUsers;
     {
-        if (user.second.statValueDocument.is_dirty())
+        std::lock_guard<xsapi_mutex> guard(m_statsServiceMutex);
+        for (auto& user : m_users)
         {
-            flush_to_service(user.second);
+            if (user.second.statValueDocument.is_dirty())
+            {
+                dirtyUsers.push_back(user.first);
+            }
         }
     }
+
+    m_flushScheduler->request_flush(dirtyUsers);
 }
 
 xbox_live_result<void>
@@ -153,7 +170,7 @@ stats_manager_impl::add_local_user(
     _In_ const xbox_live_user_t& user
     )
 {
-    std::lock_guard<std::mutex> guard(m_statsServiceMutex);
+    std::lock_guard<xsapi_mutex> guard(m_statsServiceMutex);
     string_t userStr = user_context::get_user_id(user);
     auto userIter = m_users.find(userStr);
     if (userIter != m_users.end())
@@ -171,9 +188,20 @@ stats_manager_impl::add_local_user(
         );
 
     m_users[userStr] = stats_user_context(stats_value_document(), xboxLiveContextImpl, simplifiedStatsService, user);
+
+    // Writes a previous run left in the journal go out first, so the document read back already includes them
+    auto getStatsValueDocument = [simplifiedStatsService]()
+    {
+        return simplifiedStatsService.get_stats_value_document();
+    };
+
+    auto journal = write_behind_journal::get_write_behind_journal_singleton();
+    auto statsValueDocTask = journal->has_pending_writes(userStr) ?
+        journal->replay(xboxLiveContextImpl->user_context(), xboxLiveContextImpl->settings()).then(getStatsValueDocument) :
+        getStatsValueDocument();
+
     std::weak_ptr<stats_manager_impl> thisWeak = shared_from_this();
-    simplifiedStatsService.get_stats_value_document()
-    .then([thisWeak, user, xboxLiveContextImpl, simplifiedStatsService, userStr](xbox_live_result<stats_value_document> statsValueDocResult)
+    statsValueDocTask.then([thisWeak, user, xboxLiveContextImpl, simplifiedStatsService, userStr](xbox_live_result<stats_value_document> statsValueDocResult)
     {
         std::shared_ptr<stats_manager_impl> pThis(thisWeak.lock());
         if (pThis == nullptr)
@@ -181,7 +209,7 @@ stats_manager_impl::add_local_user(
             return;
         }
 
-        std::lock_guard<std::mutex> guard(pThis->m_statsServiceMutex);
+        std::lock_guard<xsapi_mutex> guard(pThis->m_statsServiceMutex);
         if (!statsValueDocResult.err())
         {
             auto userStatContext = pThis->m_users.find(userStr);
@@ -211,22 +239,44 @@ stats_manager_impl::remove_local_user(
     _In_ const xbox_live_user_t& user
 )
 {
-    std::lock_guard<std::mutex> guard(m_statsServiceMutex);
     string_t userStr = user_context::get_user_id(user);
-    auto userIter = m_users.find(userStr);
-    if (userIter == m_users.end())
+    stats_value_document userSVD;
+    simplified_stats_service simplifiedStatsService;
     {
-        return xbox_live_result<void>(xbox_live_error_code::invalid_argument, "User not found in local map");
+        std::lock_guard<xsapi_mutex> guard(m_statsServiceMutex);
+        auto userIter = m_users.find(userStr);
+        if (userIter == m_users.end())
+        {
+            return xbox_live_result<void>(xbox_live_error_code::invalid_argument, "User not found in local map");
+        }
+
+        userSVD = userIter->second.statValueDocument;
+        userSVD.do_work();  // before removing the user apply all users
+        simplifiedStatsService = userIter->second.simplifiedStatsService;
+        if (!userSVD.is_dirty())
+        {
+            m_statEventList.push_back(stat_event(stat_event_type::local_user_removed, user, xbox_live_result<void>()));
+            m_users.erase(userIter);
+        }
     }
 
-    auto statsUserContext = userIter->second;
-    auto userSVD = statsUserContext.statValueDocument;
-    userSVD.do_work();  // before removing the user apply all users
-    if (userSVD.is_dirty())
+    // Called without m_statsServiceMutex, since starting a flush can call back into flush_user
+    if (!userSVD.is_dirty())
     {
-        std::weak_ptr<stats_manager_impl> thisWeak = shared_from_this();
-        userIter->second.simplifiedStatsService.update_stats_value_document(userSVD)
-        .then([thisWeak, userSVD, user, userStr](xbox_live_result<void> updateSVDResult)
+        m_flushScheduler->remove_user(userStr);
+        return xbox_live_result<void>();
+    }
+
+    // The last write goes through the scheduler like any other, so it lands after the user's earlier
+    // flushes and waits out a throttle the service asked for
+    std::weak_ptr<stats_manager_impl> thisWeak = shared_from_this();
+    m_flushScheduler->request_final_flush(
+        userStr,
+        [simplifiedStatsService, userSVD]() mutable
+        {
+            return simplifiedStatsService.update_stats_value_document(userSVD);
+        },
+        [thisWeak, user, userStr](const xbox_live_result<void>& updateSVDResult)
         {
             std::shared_ptr<stats_manager_impl> pThis(thisWeak.lock());
             if (pThis == nullptr)
@@ -234,7 +284,7 @@ stats_manager_impl::remove_local_user(
                 return;
             }
 
-            std::lock_guard<std::mutex> guard(pThis->m_statsServiceMutex);
+            std::lock_guard<xsapi_mutex> guard(pThis->m_statsServiceMutex);
             auto statsUserContextIter = pThis->m_users.find(userStr);
             if (statsUserContextIter == pThis->m_users.end())
             {
@@ -242,14 +292,8 @@ stats_manager_impl::remove_local_user(
             }
 
             pThis->m_statEventList.push_back(stat_event(stat_event_type::local_user_removed, user, updateSVDResult));
-            pThis->m_users.erase(userStr);
+            pThis->m_users.erase(statsUserContextIter);
         });
-    }
-    else
-    {
-        m_statEventList.push_back(stat_event(stat_event_type::local_user_removed, user, xbox_live_result<void>()));
-        m_users.erase(userIter);
-    }
 
     return xbox_live_result<void>();
 }
@@ -260,7 +304,7 @@ stats_manager_impl::request_flush_to_service(
     _In_ bool isHighPriority
     )
 {
-    std::lock_guard<std::mutex> guard(m_statsServiceMutex);
+    std::lock_guard<xsapi_mutex> guard(m_statsServiceMutex);
     string_t userStr = user_context::get_user_id(user);
     auto userIter = m_users.find(userStr);
     if (userIter == m_users.end())
@@ -283,7 +327,7 @@ stats_manager_impl::request_flush_to_service(
     return xbox_live_result<void>();
 }
 
-void
+pplx::task<xbox_live_result<void>>
 stats_manager_impl::flush_to_service(
     _In_ stats_user_context& statsUserContext
 )
@@ -292,7 +336,7 @@ stats_manager_impl::flush_to_service(
     if (statsUserContext.xboxLiveUser == nullptr)
     {
         LOG_DEBUG("flush_to_service: user is null");
-        return;
+        return pplx::task_from_result(xbox_live_result<void>(xbox_live_error_code::invalid_argument, "User is null"));
     }
 
     auto userStr = user_context::get_user_id(statsUserContext.xboxLiveUser);
@@ -301,43 +345,44 @@ stats_manager_impl::flush_to_service(
 
     if (svd.get_svd_state() != svd_state::loaded)   // if not loaded, try and get the SVD from the service
     {
-        statsUserContext.simplifiedStatsService.get_stats_value_document()
+        return statsUserContext.simplifiedStatsService.get_stats_value_document()
         .then([thisWeak, userStr](xbox_live_result<stats_value_document> svdResult)
         {
             std::shared_ptr<stats_manager_impl> pThis(thisWeak.lock());
             if (pThis == nullptr)
             {
-                return;
+                return pplx::task_from_result(xbox_live_result<void>());
             }
 
-            std::lock_guard<std::mutex> guard(pThis->m_statsServiceMutex);
+            std::lock_guard<xsapi_mutex> guard(pThis->m_statsServiceMutex);
 
             auto userIter = pThis->m_users.find(userStr);
             if (userIter == pThis->m_users.end())
             {
                 LOG_DEBUG("flush_to_service: User not found");
-                return;
+                return pplx::task_from_result(xbox_live_result<void>());
             }
 
             if (!svdResult.err())
             {
                 auto& svdFromService = svdResult.payload();
                 userIter->second.statValueDocument.merge_stat_value_documents(svdFromService);
-                pThis->update_stats_value_document(userIter->second);
+                return pThis->update_stats_value_document(userIter->second);
             }
             else
             {
                 LOGS_ERROR << "flush_to_service: Could not get stats doc.  Error " << svdResult.err();
+                return pplx::task_from_result(xbox_live_result<void>(svdResult.err(), svdResult.err_message()));
             }
         });
     }
     else
     {
-        update_stats_value_document(statsUserContext);
+        return update_stats_value_document(statsUserContext);
     }
 
 }
-void
+pplx::task<xbox_live_result<void>>
 stats_manager_impl::update_stats_value_document(_In_ stats_user_context& statsUserContext)
 {
     std::weak_ptr<stats_manager_impl> thisWeak = shared_from_this();
@@ -345,25 +390,25 @@ stats_manager_impl::update_stats_value_document(_In_ stats_user_context& statsUs
     if (user == nullptr)
     {
         LOG_WARN("User disappeared");
-        return;
+        return pplx::task_from_result(xbox_live_result<void>(xbox_live_error_code::invalid_argument, "User is null"));
     }
 
     auto userStr = user_context::get_user_id(user);
 
-    statsUserContext.simplifiedStatsService.update_stats_value_document(statsUserContext.statValueDocument)
+    return statsUserContext.simplifiedStatsService.update_stats_value_document(statsUserContext.statValueDocument)
     .then([thisWeak, user, userStr](xbox_live_result<void> updateSVDResult)
     {
         std::shared_ptr<stats_manager_impl> pThis(thisWeak.lock());
         if (pThis == nullptr)
         {
-            return;
+            return updateSVDResult;
         }
 
-        std::lock_guard<std::mutex> guard(pThis->m_statsServiceMutex);
+        std::lock_guard<xsapi_mutex> guard(pThis->m_statsServiceMutex);
         auto statsUserContextIter = pThis->m_users.find(userStr);
         if (statsUserContextIter == pThis->m_users.end())
         {
-            return;
+            return updateSVDResult;
         }
 
         if (updateSVDResult.err())
@@ -372,29 +417,32 @@ stats_manager_impl::update_stats_value_document(_In_ stats_user_context& statsUs
         }
 
         pThis->m_statEventList.push_back(stat_event(stat_event_type::stat_update_complete, user, updateSVDResult));
+        return updateSVDResult;
     });
 }
 
-void
-stats_manager_impl::request_flush_to_service_callback(
+pplx::task<xbox_live_result<void>>
+stats_manager_impl::flush_user(
     _In_ const string_t& userXuid
     )
 {
-    std::lock_guard<std::mutex> guard(m_statsServiceMutex);
+    std::lock_guard<xsapi_mutex> guard(m_statsServiceMutex);
     auto userIter = m_users.find(userXuid);
-    if (userIter != m_users.end())
+    if (userIter == m_users.end())
     {
-        userIter->second.statValueDocument.do_work();
-        flush_to_service(
-            userIter->second
-            );
+        return pplx::task_from_result(xbox_live_result<void>());
     }
+
+    userIter->second.statValueDocument.do_work();
+    return flush_to_service(
+        userIter->second
+        );
 }
 
 std::vector<stat_event>
 stats_manager_impl::do_work()
 {
-    std::lock_guard<std::mutex> guard(m_statsServiceMutex);
+    std::lock_guard<xsapi_mutex> guard(m_statsServiceMutex);
     auto copyList = m_statEventList;
     for (auto& statUserContext : m_users)
     {
@@ -412,7 +460,7 @@ stats_manager_impl::set_stat(
     _In_ double value
     )
 {
-    std::lock_guard<std::mutex> guard(m_statsServiceMutex);
+    std::lock_guard<xsapi_mutex> guard(m_statsServiceMutex);
     string_t userStr = user_context::get_user_id(user);
     auto userIter = m_users.find(userStr);
     if (userIter == m_users.end())
@@ -430,7 +478,7 @@ stats_manager_impl::set_stat(
     _In_ const char_t* value
 )
 {
-    std::lock_guard<std::mutex> guard(m_statsServiceMutex);
+    std::lock_guard<xsapi_mutex> guard(m_statsServiceMutex);
     string_t userStr = user_context::get_user_id(user);
     auto userIter = m_users.find(userStr);
     if (userIter == m_users.end())
@@ -448,7 +496,7 @@ stats_manager_impl::get_stat(
     _In_ const string_t& name
     )
 {
-    std::lock_guard<std::mutex> guard(m_statsServiceMutex);
+    std::lock_guard<xsapi_mutex> guard(m_statsServiceMutex);
     string_t userStr = user_context::get_user_id(user);
     auto userIter = m_users.find(userStr);
     if (userIter == m_users.end())
@@ -465,7 +513,7 @@ stats_manager_impl::get_stat_names(
     _Inout_ std::vector<string_t>& statNameList
     )
 {
-    std::lock_guard<std::mutex> guard(m_statsServiceMutex);
+    std::lock_guard<xsapi_mutex> guard(m_statsServiceMutex);
     string_t userStr = user_context::get_user_id(user);
     auto userIter = m_users.find(userStr);
     if (userIter == m_users.end())
@@ -484,7 +532,7 @@ stats_manager_impl::delete_stat(
     _In_ const string_t& name
     )
 {
-    std::lock_guard<std::mutex> guard(m_statsServiceMutex);
+    std::lock_guard<xsapi_mutex> guard(m_statsServiceMutex);
     string_t userStr = user_context::get_user_id(user);
     auto userIter = m_users.find(userStr);
     if (userIter == m_users.end())
@@ -497,7 +545,7 @@ stats_manager_impl::delete_stat(
 
 xbox_live_result<void> stats_manager_impl::get_leaderboard(const xbox_live_user_t& user, const string_t& statName, leaderboard::leaderboard_query query)
 {
-    std::lock_guard<std::mutex> guard(m_statsServiceMutex);
+    std::lock_guard<xsapi_mutex> guard(m_statsServiceMutex);
     string_t userStr = user_context::get_user_id(user);
     auto userIter = m_users.find(userStr);
     if (userIter == m_users.end())
@@ -543,7 +591,7 @@ xbox_live_result<void> stats_manager_impl::get_leaderboard(const xbox_live_user_
 
 xbox_live_result<void> stats_manager_impl::get_social_leaderboard(const xbox_live_user_t& user, const string_t& statName, const string_t& socialGroup, leaderboard::leaderboard_query query)
 {
-    std::lock_guard<std::mutex> guard(m_statsServiceMutex);
+    std::lock_guard<xsapi_mutex> guard(m_statsServiceMutex);
     string_t userStr = user_context::get_user_id(user);
     auto userIter = m_users.find(userStr);
     if (userIter == m_users.end())
@@ -601,7 +649,7 @@ void stats_manager_impl::add_leaderboard_result(
     _In_ const xbox_live_result<leaderboard::leaderboard_result>& result
 )
 {
-    std::lock_guard<std::mutex> guard(m_statsServiceMutex);
+    std::lock_guard<xsapi_mutex> guard(m_statsServiceMutex);
     string_t userStr = user_context::get_user_id(user);
     auto userIter = m_users.find(userStr);
     if (userIter == m_users.end())
@@ -11,6 +11,7 @@
 #include <iostream>
 #include "xsapi/mem.h"
 #include "call_buffer_timer.h"
+#include "json_writer.h"
 
 namespace xbox { namespace services { namespace stats { namespace manager { 
 
@@ -83,7 +84,13 @@ public:
 
     void set_revision_from_clock();
 
-    web::json::value serialize();
+    web::json::value serialize(_In_ const utility::datetime& timestamp);
+
+    // Writes the same JSON as serialize() without building a web::json::value tree
+    void serialize(
+        _In_ const utility::datetime& timestamp,
+        _Inout_ json_writer& writer
+        ) const;
     
     bool is_dirty() const;
 
@@ -130,7 +137,7 @@ public:
         _In_ stats_value_document& statsDocToPost
         );
 
-    pplx::task<xbox_live_result<stats_value_document>> get_stats_value_document();
+    pplx::task<xbox_live_result<stats_value_document>> get_stats_value_document() const;
 
 private:
     string_t pathandquery_simplified_stats_subpath(
@@ -166,6 +173,93 @@ struct stats_user_context
     simplified_stats_service simplifiedStatsService;
 };
 
+struct stats_flush_scheduler_stats
+{
+    stats_flush_scheduler_stats() :
+        flushesStarted(0),
+        flushesCompleted(0),
+        throttledFlushes(0),
+        peakConcurrentFlushes(0),
+        totalFlushLatency(std::chrono::milliseconds::zero()),
+        maxFlushLatency(std::chrono::milliseconds::zero())
+    {
+    }
+
+    uint64_t flushesStarted;
+    uint64_t flushesCompleted;
+    uint64_t throttledFlushes;
+    size_t peakConcurrentFlushes;
+
+    // Measured from the flush being requested to the service answering it
+    std::chrono::milliseconds totalFlushLatency;
+    std::chrono::milliseconds maxFlushLatency;
+};
+
+/// internal class
+/// Flushes every local user's stats value document through one queue. Users whose flushes were requested
+/// in the same window go out together, at most maxConcurrentFlushes at a time. A user never has two flushes
+/// in flight, so their documents reach the service in order; asking again while one is in flight queues
+/// one more flush behind it. A 429 from any user's flush holds back all users with a shared exponential backoff.
+class stats_flush_scheduler : public std::enable_shared_from_this<stats_flush_scheduler>
+{
+public:
+    stats_flush_scheduler(
+        _In_ std::function<pplx::task<xbox_live_result<void>>(const string_t& xboxUserId)> flushHandler,
+        _In_ size_t maxConcurrentFlushes = MAX_CONCURRENT_FLUSHES,
+        _In_ std::chrono::milliseconds initialBackoff = INITIAL_BACKOFF
+        );
+
+    void request_flush(_In_ const std::vector<string_t>& xboxUserIds);
+
+    // Drops any flush still queued for the user. One already in flight completes normally.
+    void remove_user(_In_ const string_t& xboxUserId);
+
+    // Replaces the user's queued flushes with a last one that sends through flushHandler instead, behind any
+    // flush of theirs in flight and under the shared backoff. onComplete gets its result once it isn't throttled.
+    void request_final_flush(
+        _In_ const string_t& xboxUserId,
+        _In_ std::function<pplx::task<xbox_live_result<void>>()> flushHandler,
+        _In_ std::function<void(const xbox_live_result<void>&)> onComplete
+        );
+
+    stats_flush_scheduler_stats stats();
+
+    static const size_t MAX_CONCURRENT_FLUSHES;
+    static const std::chrono::milliseconds INITIAL_BACKOFF;
+    static const std::chrono::milliseconds MAX_BACKOFF;
+
+private:
+    struct queued_flush
+    {
+        string_t xboxUserId;
+        chrono_clock_t::time_point requestedTime;
+        std::function<pplx::task<xbox_live_result<void>>()> flushHandler;
+        std::function<void(const xbox_live_result<void>&)> onComplete;
+    };
+
+    void start_flushes();
+
+    void on_flush_complete(
+        _In_ const queued_flush& flush,
+        _In_ const xbox_live_result<void>& result
+        );
+
+    bool is_queued(_In_ const string_t& xboxUserId) const;
+    bool is_in_flight(_In_ const string_t& xboxUserId) const;
+
+    std::function<pplx::task<xbox_live_result<void>>(const string_t& xboxUserId)> m_flushHandler;
+    const size_t m_maxConcurrentFlushes;
+    const std::chrono::milliseconds m_initialBackoff;
+
+    xsapi_mutex m_lock XSAPI_LOCK_SITE("stats_flush_scheduler::m_lock");
+    std::vector<queued_flush> m_queue;
+    std::vector<string_t> m_inFlight;
+    std::chrono::milliseconds m_backoff;
+    chrono_clock_t::time_point m_backoffUntil;
+    bool m_backoffTimerScheduled;
+    stats_flush_scheduler_stats m_stats;
+};
+
 class stats_manager_impl : public std::enable_shared_from_this<stats_manager_impl>
 {
 public:
@@ -235,13 +329,13 @@ public:
     );
 
 private:
-    void flush_to_service(
+    pplx::task<xbox_live_result<void>> flush_to_service(
         _In_ stats_user_context& statsUserContext
         );
 
-    void update_stats_value_document(_In_ stats_user_context& statsUserContext);
+    pplx::task<xbox_live_result<void>> update_stats_value_document(_In_ stats_user_context& statsUserContext);
 
-    void request_flush_to_service_callback(_In_ const string_t& userXuid);
+    pplx::task<xbox_live_result<void>> flush_user(_In_ const string_t& userXuid);
 
     void start_background_flush_timer(_In_ std::weak_ptr<stats_manager_impl> thisWeakPtr);
     void stop_timer();
@@ -261,7 +355,8 @@ private:
     std::unordered_map<string_t, stats_user_context> m_users;
     std::shared_ptr<xbox::services::call_buffer_timer> m_statNormalPriTimer;
     std::shared_ptr<xbox::services::call_buffer_timer> m_statHighPriTimer;
-    std::mutex m_statsServiceMutex;
+    std::shared_ptr<stats_flush_scheduler> m_flushScheduler;
+    xsapi_mutex m_statsServiceMutex XSAPI_LOCK_SITE("stats_manager_impl::m_statsServiceMutex");
 };
 
 }}}}
\ No newline at end of file
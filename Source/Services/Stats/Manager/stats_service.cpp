@@ -7,6 +7,7 @@
 #include "http_call_impl.h"
 #include "user_context.h"
 #include "xbox_system_factory.h"
+#include "write_behind_journal.h"
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_STAT_MANAGER_CPP_BEGIN
 
@@ -46,11 +47,22 @@ simplified_stats_service::update_stats_value_document(
         xbox_live_api::update_stats_value_document
         );
 
-    httpCall->set_request_body(statsDocToPost.serialize());
+    json_writer requestWriter;
+    statsDocToPost.serialize(utility::datetime::utc_now(), requestWriter);
+    move_request_body(httpCall, requestWriter.take_buffer());
+
+    // Each document carries every stat, so only the newest one for this user needs replaying
+    string_t journalKey = write_behind_journal::get_write_behind_journal_singleton()->record(
+        m_userContext->xbox_user_id(),
+        xbox_live_api::update_stats_value_document,
+        httpCall,
+        true
+        );
 
     auto task = httpCall->get_response_with_auth(m_userContext, http_call_response_body_type::json_body)
-    .then([](std::shared_ptr<http_call_response> response)
+    .then([journalKey](std::shared_ptr<http_call_response> response)
     {
+        write_behind_journal::get_write_behind_journal_singleton()->complete(journalKey, response);
         return xbox_live_result<void>(response->err_code(), response->err_message());
     });
 
@@ -60,7 +72,7 @@ simplified_stats_service::update_stats_value_document(
 }
 
 pplx::task<xbox_live_result<stats_value_document>>
-simplified_stats_service::get_stats_value_document()
+simplified_stats_service::get_stats_value_document() const
 {
     string_t pathAndQuery = pathandquery_simplified_stats_subpath(
         m_userContext->xbox_user_id(),
@@ -192,18 +192,29 @@ stats_value_document::merge_stat_value_documents(
     m_state = svd_state::loaded;
 }
 
+static const char_t* SVD_SCHEMA = _T("http://stats.xboxlive.com/2017-1/schema#");
+
+static string_t svd_timestamp(
+    _In_ const utility::datetime& timestamp
+    )
+{
+#if TV_API
+    return utils::datetime_to_string(timestamp);
+#else
+    return timestamp.to_string(utility::datetime::ISO_8601);
+#endif
+}
+
 web::json::value
-stats_value_document::serialize()
+stats_value_document::serialize(
+    _In_ const utility::datetime& timestamp
+    )
 {
     web::json::value requestJSON;
-    requestJSON[_T("$schema")] = web::json::value::string(_T("http://stats.xboxlive.com/2017-1/schema#"));
+    requestJSON[_T("$schema")] = web::json::value::string(SVD_SCHEMA);
     requestJSON[_T("revision")] = web::json::value::number(m_revision);
     requestJSON[_T("previousRevision")] = web::json::value::number(m_previousRevision);
-#if TV_API
-    requestJSON[_T("timestamp")] = web::json::value(utils::datetime_to_string(utility::datetime::utc_now()));
-#else
-    requestJSON[_T("timestamp")] = web::json::value(utility::datetime::utc_now().to_string(utility::datetime::ISO_8601));
-#endif
+    requestJSON[_T("timestamp")] = web::json::value(svd_timestamp(timestamp));
     auto& statsField = requestJSON[_T("stats")];
 
     auto& titleField = statsField[_T("title")];
@@ -216,6 +227,62 @@ stats_value_document::serialize()
     return requestJSON;
 }
 
+void
+stats_value_document::serialize(
+    _In_ const utility::datetime& timestamp,
+    _Inout_ json_writer& writer
+    ) const
+{
+    // web::json::value sorts object keys, so write them sorted to match its output
+    std::vector<const string_t*> statNames;
+    statNames.reserve(m_statisticDocument.size());
+    for (const auto& stat : m_statisticDocument)
+    {
+        statNames.push_back(&stat.first);
+    }
+    std::sort(statNames.begin(), statNames.end(), [](const string_t* lhs, const string_t* rhs) { return *lhs < *rhs; });
+
+    writer.start_object();
+    writer.write_key(_T("$schema"));
+    writer.write_string(SVD_SCHEMA);
+    writer.write_key(_T("previousRevision"));
+    writer.write_number(m_previousRevision);
+    writer.write_key(_T("revision"));
+    writer.write_number(m_revision);
+    writer.write_key(_T("stats"));
+    writer.start_object();
+    writer.write_key(_T("title"));
+    writer.start_object();
+    for (const auto* statName : statNames)
+    {
+        const stat_value& stat = m_statisticDocument.at(*statName);
+        writer.write_key(*statName);
+        if (stat.m_dataType == stat_data_type::number)
+        {
+            writer.start_object();
+            writer.write_key(_T("value"));
+            writer.write_number(stat.m_statData.numberType);
+            writer.end_object();
+        }
+        else if (stat.m_dataType == stat_data_type::string)
+        {
+            writer.start_object();
+            writer.write_key(_T("value"));
+            writer.write_string(stat.m_statData.stringType);
+            writer.end_object();
+        }
+        else
+        {
+            writer.write_null();
+        }
+    }
+    writer.end_object();
+    writer.end_object();
+    writer.write_key(_T("timestamp"));
+    writer.write_string(svd_timestamp(timestamp));
+    writer.end_object();
+}
+
 xbox_live_result<stats_value_document>
 stats_value_document::_Deserialize(
     _In_ const web::json::value& data
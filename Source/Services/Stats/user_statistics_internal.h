@@ -31,7 +31,7 @@ public:
 private:
     void statistic_changed(_In_ const statistic_change_event_args& eventArgs);
 
-    xbox::services::system::xbox_live_mutex m_statisticHandlerLock;
+    xbox::services::system::xbox_live_mutex m_statisticHandlerLock XSAPI_LOCK_SITE("user_statistics_service_impl::m_statisticHandlerLock");
     std::shared_ptr<xbox::services::real_time_activity::real_time_activity_service> m_realTimeActivityService;
     std::unordered_map<function_context, std::function<void(const statistic_change_event_args&)>> m_statisticChangeHandler;
     function_context m_statisticChangeHandlerCounter;
@@ -25,7 +25,7 @@ user_statistics_service_impl::add_statistic_changed_handler(
     _In_ std::function<void(const statistic_change_event_args&)> handler
     )
 {
-    std::lock_guard<std::mutex> lock(m_statisticHandlerLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_statisticHandlerLock.get());
 
     function_context context = -1;
     if (handler != nullptr)
@@ -42,7 +42,7 @@ user_statistics_service_impl::remove_statistic_changed_handler(
     _In_ function_context context
     )
 {
-    std::lock_guard<std::mutex> lock(m_statisticHandlerLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_statisticHandlerLock.get());
     m_statisticChangeHandler.erase(context);
 }
 
@@ -53,7 +53,7 @@ user_statistics_service_impl::statistic_changed(
 {
     std::unordered_map<function_context, std::function<void(const statistic_change_event_args&)>> statisticChangeHandlerCopy;
     {
-        std::lock_guard<std::mutex> lock(m_statisticHandlerLock.get());
+        std::lock_guard<xsapi_mutex> lock(m_statisticHandlerLock.get());
         statisticChangeHandlerCopy = m_statisticChangeHandler;
     }
 
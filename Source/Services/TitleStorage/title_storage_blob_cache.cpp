@@ -0,0 +1,453 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#include "utils.h"
+#include "title_storage_internal.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_TITLE_STORAGE_CPP_BEGIN
+
+static const string_t INDEX_FILE_NAME = _T("blobcache.json");
+static const string_t TEMP_FILE_SUFFIX = _T(".tmp");
+
+void
+title_storage_delete_file(
+    _In_ const string_t& filePath
+    )
+{
+#if XSAPI_U
+    std::remove(filePath.c_str());
+#else
+    DeleteFile(filePath.c_str());
+#endif
+}
+
+bool
+title_storage_write_file_atomically(
+    _In_ const string_t& filePath,
+    _In_reads_bytes_(size) const char* data,
+    _In_ size_t size
+    )
+{
+    string_t tempFilePath = filePath + TEMP_FILE_SUFFIX;
+    {
+        std::ofstream out(tempFilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            return false;
+        }
+
+        out.write(data, size);
+        if (!out)
+        {
+            out.close();
+            title_storage_delete_file(tempFilePath);
+            return false;
+        }
+    }
+
+#if XSAPI_U
+    bool renamed = std::rename(tempFilePath.c_str(), filePath.c_str()) == 0;
+#else
+    bool renamed = MoveFileEx(tempFilePath.c_str(), filePath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#endif
+    if (!renamed)
+    {
+        title_storage_delete_file(tempFilePath);
+    }
+    return renamed;
+}
+
+struct title_storage_enabled_cache
+{
+    std::weak_ptr<xbox::services::user_context> userContext;
+    std::shared_ptr<title_storage_blob_cache> cache;
+};
+
+static xsapi_mutex& caches_lock()
+{
+    static xsapi_mutex s_cachesLock XSAPI_LOCK_SITE("title_storage_blob_cache::s_cachesLock");
+    return s_cachesLock;
+}
+
+// Weak, so a directory's cache goes away once no service has it enabled
+static std::unordered_map<string_t, std::weak_ptr<title_storage_blob_cache>>& caches_by_directory()
+{
+    static std::unordered_map<string_t, std::weak_ptr<title_storage_blob_cache>> s_caches;
+    return s_caches;
+}
+
+static std::unordered_map<const xbox::services::user_context*, title_storage_enabled_cache>& enabled_caches()
+{
+    static std::unordered_map<const xbox::services::user_context*, title_storage_enabled_cache> s_enabledCaches;
+    return s_enabledCaches;
+}
+
+std::shared_ptr<title_storage_blob_cache>
+title_storage_blob_cache::get_cache(
+    _In_ const string_t& cacheDirectory,
+    _In_ uint64_t maxCacheSizeInBytes
+    )
+{
+    auto& caches = caches_by_directory();
+
+    string_t directory = cacheDirectory;
+    while (directory.size() > 1 && (directory.back() == _T('/') || directory.back() == _T('\\')))
+    {
+        directory.pop_back();
+    }
+
+    std::lock_guard<xsapi_mutex> lock(caches_lock());
+    auto cache = caches[directory].lock();
+    if (cache != nullptr)
+    {
+        cache->set_max_cache_size(maxCacheSizeInBytes);
+        return cache;
+    }
+
+    cache = std::make_shared<title_storage_blob_cache>(directory, maxCacheSizeInBytes);
+    caches[directory] = cache;
+    return cache;
+}
+
+void
+title_storage_blob_cache::set_enabled_cache(
+    _In_ const std::shared_ptr<xbox::services::user_context>& userContext,
+    _In_ std::shared_ptr<title_storage_blob_cache> cache
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(caches_lock());
+    auto& enabled = enabled_caches();
+    for (auto entry = enabled.begin(); entry != enabled.end();)
+    {
+        // Services whose user context is gone can't download any more, so their entries go too
+        if (entry->second.userContext.expired() || entry->first == userContext.get())
+        {
+            entry = enabled.erase(entry);
+        }
+        else
+        {
+            ++entry;
+        }
+    }
+
+    if (cache != nullptr)
+    {
+        title_storage_enabled_cache& entry = enabled[userContext.get()];
+        entry.userContext = userContext;
+        entry.cache = std::move(cache);
+    }
+}
+
+std::shared_ptr<title_storage_blob_cache>
+title_storage_blob_cache::enabled_cache(
+    _In_ const std::shared_ptr<xbox::services::user_context>& userContext
+    )
+{
+    if (userContext == nullptr)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard<xsapi_mutex> lock(caches_lock());
+    auto& enabled = enabled_caches();
+    auto entry = enabled.find(userContext.get());
+    if (entry == enabled.end() || entry->second.userContext.lock() != userContext)
+    {
+        return nullptr;
+    }
+    return entry->second.cache;
+}
+
+title_storage_blob_cache::title_storage_blob_cache(
+    _In_ string_t cacheDirectory,
+    _In_ uint64_t maxCacheSizeInBytes
+    ) :
+    m_cacheDirectory(std::move(cacheDirectory)),
+    m_maxCacheSize(maxCacheSizeInBytes),
+    m_cacheSize(0),
+    m_useCounter(0),
+    m_bytesDownloaded(0),
+    m_bytesServedFromCache(0)
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    load_index();
+}
+
+string_t
+title_storage_blob_cache::cached_e_tag(
+    _In_ const string_t& cacheKey
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    auto entry = m_entries.find(cacheKey);
+    return entry == m_entries.end() ? string_t() : entry->second.eTag;
+}
+
+bool
+title_storage_blob_cache::read(
+    _In_ const string_t& cacheKey,
+    _Inout_ std::vector<unsigned char>& blobBuffer
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    auto entry = m_entries.find(cacheKey);
+    if (entry == m_entries.end())
+    {
+        return false;
+    }
+
+    std::ifstream in(file_path(entry->second.fileName), std::ios::in | std::ios::binary);
+    if (!in)
+    {
+        remove_entry(cacheKey);
+        save_index();
+        return false;
+    }
+
+    in.seekg(0, std::ios::end);
+    auto fileSize = static_cast<size_t>(in.tellg());
+    if (fileSize != entry->second.size)
+    {
+        in.close();
+        remove_entry(cacheKey);
+        save_index();
+        return false;
+    }
+
+    // One sized read straight into the caller's buffer
+    blobBuffer.resize(fileSize);
+    in.seekg(0, std::ios::beg);
+    if (fileSize > 0)
+    {
+        in.read(reinterpret_cast<char*>(&blobBuffer[0]), fileSize);
+    }
+
+    entry->second.lastUsed = ++m_useCounter;
+    m_bytesServedFromCache += fileSize;
+    return true;
+}
+
+void
+title_storage_blob_cache::write(
+    _In_ const string_t& cacheKey,
+    _In_ const string_t& eTag,
+    _In_ const std::vector<unsigned char>& blobBuffer
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    if (eTag.empty() || blobBuffer.size() > m_maxCacheSize)
+    {
+        return;
+    }
+
+    remove_entry(cacheKey);
+
+    // Two keys hashing to the same file name can't both be cached
+    string_t fileName = file_name_for_key(cacheKey);
+    for (const auto& entry : m_entries)
+    {
+        if (entry.second.fileName == fileName)
+        {
+            string_t collidingKey = entry.first;
+            remove_entry(collidingKey);
+            break;
+        }
+    }
+
+    evict_to_fit(blobBuffer.size());
+
+    const char* data = blobBuffer.empty() ? "" : reinterpret_cast<const char*>(&blobBuffer[0]);
+    if (!title_storage_write_file_atomically(file_path(fileName), data, blobBuffer.size()))
+    {
+        LOGS_ERROR << "title_storage_blob_cache: failed to write " << file_path(fileName);
+        save_index();
+        return;
+    }
+
+    cache_entry entry;
+    entry.fileName = fileName;
+    entry.eTag = eTag;
+    entry.size = blobBuffer.size();
+    entry.lastUsed = ++m_useCounter;
+    m_entries[cacheKey] = entry;
+    m_cacheSize += entry.size;
+
+    save_index();
+}
+
+void
+title_storage_blob_cache::set_max_cache_size(
+    _In_ uint64_t maxCacheSizeInBytes
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    m_maxCacheSize = maxCacheSizeInBytes;
+    if (m_cacheSize > m_maxCacheSize)
+    {
+        evict_to_fit(0);
+        save_index();
+    }
+}
+
+void
+title_storage_blob_cache::record_bytes_downloaded(
+    _In_ uint64_t bytesDownloaded
+    )
+{
+    m_bytesDownloaded += bytesDownloaded;
+}
+
+uint64_t
+title_storage_blob_cache::bytes_downloaded() const
+{
+    return m_bytesDownloaded;
+}
+
+uint64_t
+title_storage_blob_cache::bytes_served_from_cache() const
+{
+    return m_bytesServedFromCache;
+}
+
+void
+title_storage_blob_cache::load_index()
+{
+    std::ifstream in(file_path(INDEX_FILE_NAME), std::ios::in | std::ios::binary);
+    if (!in)
+    {
+        return;
+    }
+
+    std::string indexData((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::error_code errc;
+    web::json::value indexJson;
+    try
+    {
+        indexJson = web::json::value::parse(utility::conversions::to_string_t(indexData));
+    }
+    catch (const web::json::json_exception&)
+    {
+        LOGS_ERROR << "title_storage_blob_cache: ignoring unreadable index";
+        return;
+    }
+
+    web::json::value entriesJson = utils::extract_json_field(indexJson, _T("entries"), errc, false);
+    if (!entriesJson.is_array())
+    {
+        return;
+    }
+
+    for (const auto& entryJson : entriesJson.as_array())
+    {
+        string_t cacheKey = utils::extract_json_string(entryJson, _T("key"), errc, true);
+        cache_entry entry;
+        entry.fileName = utils::extract_json_string(entryJson, _T("file"), errc, true);
+        entry.eTag = utils::extract_json_string(entryJson, _T("etag"), errc, true);
+        entry.size = utils::extract_json_uint52(entryJson, _T("size"), errc, true);
+        entry.lastUsed = utils::extract_json_uint52(entryJson, _T("lastUsed"), errc, true);
+        if (errc)
+        {
+            break;
+        }
+
+        m_entries[cacheKey] = entry;
+        m_cacheSize += entry.size;
+        m_useCounter = __max(m_useCounter, entry.lastUsed);
+    }
+}
+
+void
+title_storage_blob_cache::save_index()
+{
+    web::json::value entriesJson = web::json::value::array();
+    uint32_t index = 0;
+    for (const auto& entry : m_entries)
+    {
+        web::json::value entryJson;
+        entryJson[_T("key")] = web::json::value::string(entry.first);
+        entryJson[_T("file")] = web::json::value::string(entry.second.fileName);
+        entryJson[_T("etag")] = web::json::value::string(entry.second.eTag);
+        entryJson[_T("size")] = web::json::value::number(entry.second.size);
+        entryJson[_T("lastUsed")] = web::json::value::number(entry.second.lastUsed);
+        entriesJson[index++] = entryJson;
+    }
+
+    web::json::value indexJson;
+    indexJson[_T("entries")] = entriesJson;
+
+    std::string indexData = utility::conversions::to_utf8string(indexJson.serialize());
+    if (!title_storage_write_file_atomically(file_path(INDEX_FILE_NAME), indexData.c_str(), indexData.size()))
+    {
+        LOGS_ERROR << "title_storage_blob_cache: failed to write index";
+    }
+}
+
+void
+title_storage_blob_cache::remove_entry(
+    _In_ const string_t& cacheKey
+    )
+{
+    auto entry = m_entries.find(cacheKey);
+    if (entry == m_entries.end())
+    {
+        return;
+    }
+
+    title_storage_delete_file(file_path(entry->second.fileName));
+    m_cacheSize -= __min(m_cacheSize, entry->second.size);
+    m_entries.erase(entry);
+}
+
+void
+title_storage_blob_cache::evict_to_fit(
+    _In_ uint64_t bytesNeeded
+    )
+{
+    while (!m_entries.empty() && m_cacheSize + bytesNeeded > m_maxCacheSize)
+    {
+        auto leastRecentlyUsed = m_entries.begin();
+        for (auto entry = m_entries.begin(); entry != m_entries.end(); ++entry)
+        {
+            if (entry->second.lastUsed < leastRecentlyUsed->second.lastUsed)
+            {
+                leastRecentlyUsed = entry;
+            }
+        }
+
+        string_t evictedKey = leastRecentlyUsed->first;
+        LOGS_DEBUG << "title_storage_blob_cache: evicting " << evictedKey;
+        remove_entry(evictedKey);
+    }
+}
+
+string_t
+title_storage_blob_cache::file_path(
+    _In_ const string_t& fileName
+    ) const
+{
+    if (m_cacheDirectory.empty())
+    {
+        return fileName;
+    }
+
+    auto lastChar = m_cacheDirectory[m_cacheDirectory.size() - 1];
+    if (lastChar == _T('/') || lastChar == _T('\\'))
+    {
+        return m_cacheDirectory + fileName;
+    }
+
+    return m_cacheDirectory + _T("/") + fileName;
+}
+
+string_t
+title_storage_blob_cache::file_name_for_key(
+    _In_ const string_t& cacheKey
+    )
+{
+    stringstream_t fileName;
+    fileName << std::hex << std::hash<string_t>()(cacheKey) << _T(".blob");
+    return fileName.str();
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_TITLE_STORAGE_CPP_END
@@ -0,0 +1,226 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+#include "xsapi/title_storage.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_TITLE_STORAGE_CPP_BEGIN
+
+// Writes to a temp file and renames it into place, so readers see either the old or the new contents
+bool title_storage_write_file_atomically(
+    _In_ const string_t& filePath,
+    _In_reads_bytes_(size) const char* data,
+    _In_ size_t size
+    );
+
+void title_storage_delete_file(_In_ const string_t& filePath);
+
+// On-disk cache of downloaded blobs. Entries are keyed by the blob's download path, which already
+// encodes the storage type, SCID, owner, blob path and type, and are revalidated with the blob's ETag.
+// Files are written to a temp name and renamed into place, so a crash never leaves a torn blob behind.
+class title_storage_blob_cache
+{
+public:
+    // Services that cache into the same directory share one cache, so they never overwrite each
+    // other's index or evict each other's files behind their backs
+    static std::shared_ptr<title_storage_blob_cache> get_cache(
+        _In_ const string_t& cacheDirectory,
+        _In_ uint64_t maxCacheSizeInBytes
+        );
+
+    // The cache a service's downloads go through, if it enabled one. Tracked here by user context rather
+    // than on the public title_storage_service so its layout stays unchanged; copies of a service share it.
+    static void set_enabled_cache(
+        _In_ const std::shared_ptr<xbox::services::user_context>& userContext,
+        _In_ std::shared_ptr<title_storage_blob_cache> cache
+        );
+
+    static std::shared_ptr<title_storage_blob_cache> enabled_cache(_In_ const std::shared_ptr<xbox::services::user_context>& userContext);
+
+    title_storage_blob_cache(
+        _In_ string_t cacheDirectory,
+        _In_ uint64_t maxCacheSizeInBytes
+        );
+
+    // ETag of the cached copy, or an empty string if the blob isn't cached
+    string_t cached_e_tag(_In_ const string_t& cacheKey);
+
+    // Reads the cached copy into blobBuffer. Returns false if it has gone missing on disk.
+    bool read(
+        _In_ const string_t& cacheKey,
+        _Inout_ std::vector<unsigned char>& blobBuffer
+        );
+
+    void write(
+        _In_ const string_t& cacheKey,
+        _In_ const string_t& eTag,
+        _In_ const std::vector<unsigned char>& blobBuffer
+        );
+
+    // Evicts least recently used blobs if the cache no longer fits
+    void set_max_cache_size(_In_ uint64_t maxCacheSizeInBytes);
+
+    void record_bytes_downloaded(_In_ uint64_t bytesDownloaded);
+    uint64_t bytes_downloaded() const;
+    uint64_t bytes_served_from_cache() const;
+
+private:
+    struct cache_entry
+    {
+        string_t fileName;
+        string_t eTag;
+        uint64_t size;
+        uint64_t lastUsed;
+    };
+
+    void load_index();
+    void save_index();
+    void remove_entry(_In_ const string_t& cacheKey);
+    void evict_to_fit(_In_ uint64_t bytesNeeded);
+    string_t file_path(_In_ const string_t& fileName) const;
+
+    static string_t file_name_for_key(_In_ const string_t& cacheKey);
+
+    xsapi_mutex m_lock XSAPI_LOCK_SITE("title_storage_blob_cache::m_lock");
+    string_t m_cacheDirectory;
+    uint64_t m_maxCacheSize;
+    uint64_t m_cacheSize;
+    uint64_t m_useCounter;
+    std::unordered_map<string_t, cache_entry> m_entries;
+    std::atomic<uint64_t> m_bytesDownloaded;
+    std::atomic<uint64_t> m_bytesServedFromCache;
+};
+
+// Reads an upload one block ahead of the block being sent. Preparing the next block overlaps the
+// network wait for the current one, and the block after the current one tells us whether the current
+// one is final, so the blob length never has to be known up front.
+class title_storage_upload_pipeline
+{
+public:
+    title_storage_upload_pipeline(
+        _In_ std::function<size_t(unsigned char* buffer, size_t bufferSize)> blobSource,
+        _In_ uint32_t preferredBlockSize,
+        _In_ bool isBinaryData
+        );
+
+    // Waits for a read still in flight, e.g. when the upload failed part way
+    ~title_storage_upload_pipeline();
+
+    // Moves the next block into block. Returns false once the source is exhausted.
+    bool next_block(
+        _Inout_ std::vector<unsigned char>& block,
+        _Out_ bool& isFinalBlock
+        );
+
+    // Resizes blocks read from now on to the throughput the last send achieved
+    void record_block_sent(
+        _In_ size_t blockSize,
+        _In_ std::chrono::milliseconds elapsed
+        );
+
+    uint32_t block_size() const;
+    uint64_t bytes_read() const;
+
+    static uint32_t adapt_block_size(
+        _In_ uint32_t currentBlockSize,
+        _In_ size_t bytesSent,
+        _In_ std::chrono::milliseconds elapsed
+        );
+
+    static const std::chrono::milliseconds TARGET_BLOCK_DURATION;
+
+private:
+    void start_read();
+    std::vector<unsigned char> read_block(_In_ uint32_t blockSize);
+
+    std::function<size_t(unsigned char* buffer, size_t bufferSize)> m_blobSource;
+    bool m_isBinaryData;
+    bool m_started;
+    std::atomic<uint32_t> m_blockSize;
+    std::atomic<uint64_t> m_bytesRead;
+    std::vector<unsigned char> m_readyBlock;
+    pplx::task<std::vector<unsigned char>> m_pendingRead;
+};
+
+// What a blob looked like remotely as of the last sync_blobs() call, keyed by blob path
+struct title_storage_manifest_entry
+{
+    string_t eTag;
+    uint64_t length;
+    utility::datetime clientTimestamp;
+};
+
+class title_storage_sync_manifest
+{
+public:
+    static title_storage_sync_manifest load(_In_ const string_t& filePath);
+    bool save(_In_ const string_t& filePath) const;
+
+    // True if the remote blob differs from the manifest entry, or has no entry
+    bool has_changed(_In_ const title_storage_blob_metadata& remoteBlob) const;
+
+    const title_storage_manifest_entry* find(_In_ const string_t& blobPath) const;
+    void update(_In_ const title_storage_blob_metadata& blob);
+    void remove(_In_ const string_t& blobPath);
+    std::vector<string_t> blob_paths() const;
+
+private:
+    std::unordered_map<string_t, title_storage_manifest_entry> m_entries;
+};
+
+// A blob to move in one direction or the other
+struct title_storage_sync_transfer
+{
+    bool isUpload;
+    int32_t priority;
+    title_storage_blob_metadata blobMetadata;
+    std::shared_ptr<std::vector<unsigned char>> blobBuffer;
+    title_storage_e_tag_match_condition etagMatchCondition;
+};
+
+// One sync_blobs() call. Listing pages and transfers are chained as continuations rather than
+// waited on, so no thread pool thread is held while a request is in flight.
+class title_storage_sync_operation : public std::enable_shared_from_this<title_storage_sync_operation>
+{
+public:
+    title_storage_sync_operation(
+        _In_ title_storage_service titleStorageService,
+        _In_ title_storage_sync_request syncRequest
+        );
+
+    pplx::task<xbox_live_result<title_storage_sync_result>> run();
+
+private:
+    pplx::task<xbox_live_result<void>> list_remaining_blobs(
+        _In_ xbox_live_result<title_storage_blob_metadata_result> metadataResult
+        );
+
+    void plan_transfers();
+
+    // Starts the highest priority transfer left and chains the next one onto it; done when none are left
+    pplx::task<void> run_transfers();
+
+    void record_upload(
+        _In_ const title_storage_sync_transfer& transfer,
+        _In_ const xbox_live_result<title_storage_blob_metadata>& uploadResult
+        );
+
+    void record_download(
+        _In_ const title_storage_sync_transfer& transfer,
+        _In_ const xbox_live_result<title_storage_blob_result>& downloadResult
+        );
+
+    xbox_live_result<title_storage_sync_result> commit();
+
+    title_storage_service m_titleStorageService;
+    title_storage_sync_request m_syncRequest;
+    std::chrono::steady_clock::time_point m_startTime;
+    title_storage_sync_manifest m_manifest;
+    std::vector<title_storage_blob_metadata> m_remoteBlobs;
+    std::vector<title_storage_sync_transfer> m_transfers;
+    std::atomic<size_t> m_nextTransfer;
+    xsapi_mutex m_resultLock XSAPI_LOCK_SITE("title_storage_sync_operation::m_resultLock");
+    title_storage_sync_result m_syncResult;
+};
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_TITLE_STORAGE_CPP_END
@@ -2,7 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include "pch.h"
-#include "xsapi/title_storage.h"
+#include "title_storage_internal.h"
 #include "user_context.h"
 #include "xbox_system_factory.h"
 #include "utils.h"
@@ -36,6 +36,32 @@ title_storage_service::title_storage_service(
 {
 }
 
+xbox_live_result<void>
+title_storage_service::enable_blob_cache(
+    _In_ const string_t& cacheDirectory,
+    _In_ uint64_t maxCacheSizeInBytes
+    )
+{
+    RETURN_CPP_IF(cacheDirectory.empty(), void, xbox_live_error_code::invalid_argument, "Cache directory is empty");
+    RETURN_CPP_IF(maxCacheSizeInBytes == 0, void, xbox_live_error_code::invalid_argument, "Max cache size is 0");
+    RETURN_CPP_IF(m_userContext == nullptr, void, xbox_live_error_code::logic_error, "title_storage_service is not initialized");
+
+    title_storage_blob_cache::set_enabled_cache(m_userContext, title_storage_blob_cache::get_cache(cacheDirectory, maxCacheSizeInBytes));
+    return xbox_live_result<void>();
+}
+
+void
+title_storage_service::disable_blob_cache()
+{
+    title_storage_blob_cache::set_enabled_cache(m_userContext, nullptr);
+}
+
+std::shared_ptr<title_storage_blob_cache>
+title_storage_service::_Blob_cache() const
+{
+    return title_storage_blob_cache::enabled_cache(m_userContext);
+}
+
 pplx::task<xbox_live_result<title_storage_quota>>
 title_storage_service::get_quota(
     _In_ string_t serviceConfigurationId,
@@ -372,7 +398,8 @@ title_storage_service::download_blob(
     auto sharedXboxLiveContextSettings = m_xboxLiveContextSettings;
     auto sharedUserContext = m_userContext;
     auto sharedAppConfig = m_appConfig;
-    auto task = pplx::create_task([sharedXboxLiveContextSettings, sharedUserContext, sharedAppConfig, blobMetadata, blobBuffer, etagMatchCondition, selectQuery, preferredDownloadBlockSize]()
+    auto blobCache = title_storage_blob_cache::enabled_cache(m_userContext);
+    auto task = pplx::create_task([sharedXboxLiveContextSettings, sharedUserContext, sharedAppConfig, blobCache, blobMetadata, blobBuffer, etagMatchCondition, selectQuery, preferredDownloadBlockSize]()
     {
         title_storage_blob_metadata resultBlobMetadata(
             blobMetadata
@@ -390,6 +417,11 @@ title_storage_service::download_blob(
         if(subpathAndQueryResult.err()) return xbox_live_result<title_storage_blob_result>(subpathAndQueryResult.err(), subpathAndQueryResult.err_message());
 
         string_t subpathAndQuery = subpathAndQueryResult.payload();
+
+        // Only downloads without a caller supplied match condition go through the cache
+        bool useBlobCache = blobCache != nullptr && etagMatchCondition == title_storage_e_tag_match_condition::not_used;
+        string_t cachedETag = useBlobCache ? blobCache->cached_e_tag(subpathAndQuery) : string_t();
+
         blobBuffer->clear();
         while (isDownloading)
         {
@@ -404,10 +436,11 @@ title_storage_service::download_blob(
             httpCall->set_content_type_header_value(CONTENT_TYPE_HEADER_VALUE);
             httpCall->set_long_http_call(true);
 
+            bool revalidateCachedBlob = !cachedETag.empty() && startByte == 0;
             set_e_tag_header(
                 httpCall,
-                blobMetadata.e_tag(),
-                etagMatchCondition
+                revalidateCachedBlob ? cachedETag : blobMetadata.e_tag(),
+                revalidateCachedBlob ? title_storage_e_tag_match_condition::if_not_match : etagMatchCondition
                 );
 
             if (isBinaryData)
@@ -420,9 +453,16 @@ title_storage_service::download_blob(
             }
 
             std::error_code errc = xbox_live_error_code::no_error;
+            bool isNotModified = false;
             httpCall->get_response_with_auth(sharedUserContext, http_call_response_body_type::vector_body)
-            .then([&errc, blobBuffer, &startByte, isBinaryData, preferredDownloadBlockSize, &isDownloading, &resultBlobMetadata](std::shared_ptr<http_call_response> response)
+            .then([&errc, &isNotModified, revalidateCachedBlob, blobCache, blobBuffer, &startByte, isBinaryData, preferredDownloadBlockSize, &isDownloading, &resultBlobMetadata](std::shared_ptr<http_call_response> response)
             {
+                if (revalidateCachedBlob && response->http_status() == 304)
+                {
+                    isNotModified = true;
+                    return;
+                }
+
                 errc = response->err_code();
                 if (!response->err_code())
                 {
@@ -435,6 +475,10 @@ title_storage_service::download_blob(
                     }
 
                     startByte += static_cast<uint32_t>(responseByteLength);
+                    if (blobCache != nullptr)
+                    {
+                        blobCache->record_bytes_downloaded(responseByteLength);
+                    }
 
                     if (!isBinaryData || responseByteLength < preferredDownloadBlockSize)
                     {
@@ -447,10 +491,33 @@ title_storage_service::download_blob(
                 }
             }).wait();
 
+            if (isNotModified)
+            {
+                if (blobCache->read(subpathAndQuery, *blobBuffer))
+                {
+                    resultBlobMetadata._Set_e_tag_and_length(
+                        cachedETag,
+                        blobBuffer->size()
+                        );
+                    LOGS_DEBUG << "title_storage: served " << blobBuffer->size() << " bytes from cache, " << blobCache->bytes_downloaded() << " bytes downloaded this launch";
+                    break;
+                }
+
+                // The cached copy went missing on disk; download it again
+                cachedETag.clear();
+                continue;
+            }
+
             if (errc)
             {
                 return xbox_live_result<title_storage_blob_result>(errc, "Download failed");
             }
+
+            if (!isDownloading && useBlobCache)
+            {
+                blobCache->write(subpathAndQuery, resultBlobMetadata.e_tag(), *blobBuffer);
+                LOGS_DEBUG << "title_storage: downloaded " << blobBuffer->size() << " bytes, " << blobCache->bytes_downloaded() << " bytes downloaded this launch";
+            }
         }
 
         return xbox_live_result<title_storage_blob_result>(
@@ -477,7 +544,35 @@ title_storage_service::upload_blob(
 { 
     RETURN_TASK_CPP_INVALIDARGUMENT_IF(blobBuffer == nullptr, title_storage_blob_metadata, "Blob buffer is null");
     RETURN_TASK_CPP_INVALIDARGUMENT_IF(blobBuffer->empty(), title_storage_blob_metadata, "Blob buffer is empty");
-    
+
+    auto offset = std::make_shared<size_t>(0);
+    return upload_blob(
+        std::move(blobMetadata),
+        [blobBuffer, offset](unsigned char* buffer, size_t bufferSize)
+        {
+            size_t count = __min(bufferSize, blobBuffer->size() - *offset);
+            if (count > 0)
+            {
+                memcpy(buffer, &(blobBuffer->at(*offset)), count);
+                *offset += count;
+            }
+            return count;
+        },
+        etagMatchCondition,
+        preferredUploadBlockSize
+        );
+}
+
+pplx::task<xbox_live_result<title_storage_blob_metadata>>
+title_storage_service::upload_blob(
+    _In_ title_storage_blob_metadata blobMetadata,
+    _In_ std::function<size_t(unsigned char* buffer, size_t bufferSize)> blobSource,
+    _In_ title_storage_e_tag_match_condition etagMatchCondition,
+    _In_ uint32_t preferredUploadBlockSize
+    )
+{
+    RETURN_TASK_CPP_INVALIDARGUMENT_IF(blobSource == nullptr, title_storage_blob_metadata, "Blob source is null");
+
     preferredUploadBlockSize = preferredUploadBlockSize < MIN_UPLOAD_BLOCK_SIZE ? MIN_UPLOAD_BLOCK_SIZE : preferredUploadBlockSize;
     preferredUploadBlockSize = preferredUploadBlockSize > MAX_UPLOAD_BLOCK_SIZE ? MAX_UPLOAD_BLOCK_SIZE : preferredUploadBlockSize;
 
@@ -485,51 +580,30 @@ title_storage_service::upload_blob(
     auto sharedUserContext = m_userContext;
     auto appConfig = m_appConfig;
 
-    auto task = pplx::create_task([sharedXboxLiveContextSettings, sharedUserContext, appConfig, blobMetadata, blobBuffer, preferredUploadBlockSize, etagMatchCondition]()
+    auto task = pplx::create_task([sharedXboxLiveContextSettings, sharedUserContext, appConfig, blobMetadata, blobSource, preferredUploadBlockSize, etagMatchCondition]()
     {
         title_storage_blob_metadata resultBlobMetadata(
             blobMetadata
             );
 
         bool isBinaryData = resultBlobMetadata.blob_type() == title_storage_blob_type::binary;
+        title_storage_upload_pipeline pipeline(
+            blobSource,
+            preferredUploadBlockSize,
+            isBinaryData
+            );
+
+        std::vector<uint8_t> dataChunk;
         bool isFinalBlock = false;
+        string_t continuationToken;
 
-        std::vector<uint8_t> dataChunk(0);
-        auto blobBufferSize = static_cast<uint32_t>(blobBuffer->size());
-        if (!isBinaryData)
+        if (!pipeline.next_block(dataChunk, isFinalBlock))
         {
-            dataChunk.resize(blobBufferSize);
+            return xbox_live_result<title_storage_blob_metadata>(xbox_live_error_code::invalid_argument, "Blob buffer is empty");
         }
 
-        size_t start = 0;
-        size_t count = 0;
-        string_t continuationToken;
-
-        while (start < blobBufferSize)
+        while (true)
         {
-            if (isBinaryData)
-            {
-                count = blobBufferSize - start;
-
-                if (count > preferredUploadBlockSize)
-                {
-                    count = preferredUploadBlockSize;
-                }
-                dataChunk.resize(count);
-
-                memcpy(&dataChunk[0], &(blobBuffer->at(start)), count);
-                
-                start += count;
-                isFinalBlock = start == blobBufferSize;
-            }
-            else
-            {
-                dataChunk = *blobBuffer;
-                count = static_cast<uint32_t>(dataChunk.size());
-                start = static_cast<uint32_t>(dataChunk.size());
-                isFinalBlock = true;
-            }
-
             xbox_live_result<string_t> subpathAndQueryResult = title_storage_upload_blob_subpath(
                 resultBlobMetadata,
                 continuationToken,
@@ -558,9 +632,12 @@ title_storage_service::upload_blob(
 
             httpCall->set_request_body(dataChunk);
 
+            // The pipeline is already reading the block after next while this one is in flight
+            auto sendStartTime = std::chrono::steady_clock::now();
+            uint64_t blobLength = pipeline.bytes_read();
             std::error_code errc = xbox_live_error_code::no_error;
             httpCall->get_response_with_auth(sharedUserContext)
-            .then([&errc, isFinalBlock, &continuationToken, &resultBlobMetadata, blobBufferSize](std::shared_ptr<http_call_response> response)
+            .then([&errc, isFinalBlock, &continuationToken, &resultBlobMetadata, blobLength](std::shared_ptr<http_call_response> response)
             {
                 errc = response->err_code();
                 auto responseJson = response->response_body_json();
@@ -574,7 +651,7 @@ title_storage_service::upload_blob(
                 {
                     resultBlobMetadata._Set_e_tag_and_length(
                         response->e_tag(),
-                        blobBufferSize
+                        blobLength
                         );
                 }
             }).wait();
@@ -583,6 +660,17 @@ title_storage_service::upload_blob(
             {
                 return xbox_live_result<title_storage_blob_metadata>(errc, "Upload failed");
             }
+
+            if (isFinalBlock)
+            {
+                break;
+            }
+
+            pipeline.record_block_sent(
+                dataChunk.size(),
+                std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - sendStartTime)
+                );
+            pipeline.next_block(dataChunk, isFinalBlock);
         }
 
         return xbox_live_result<title_storage_blob_metadata>(resultBlobMetadata, xbox_live_error_code::no_error, "");
@@ -0,0 +1,553 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#include "utils.h"
+#include "title_storage_internal.h"
+
+using namespace pplx;
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_TITLE_STORAGE_CPP_BEGIN
+
+// Enough to hide per-request latency on a folder of small blobs without flooding the service
+const uint32_t title_storage_sync_request::DEFAULT_MAX_CONCURRENT_TRANSFERS = 8;
+
+title_storage_sync_request::title_storage_sync_request(
+    _In_ string_t serviceConfigurationId,
+    _In_ title_storage_type storageType,
+    _In_ string_t blobPath,
+    _In_ string_t xboxUserId,
+    _In_ string_t manifestFilePath
+    ) :
+    m_serviceConfigurationId(std::move(serviceConfigurationId)),
+    m_storageType(storageType),
+    m_blobPath(std::move(blobPath)),
+    m_xboxUserId(std::move(xboxUserId)),
+    m_manifestFilePath(std::move(manifestFilePath)),
+    m_maxConcurrentTransfers(DEFAULT_MAX_CONCURRENT_TRANSFERS)
+{
+}
+
+void
+title_storage_sync_request::add_upload(
+    _In_ title_storage_blob_metadata blobMetadata,
+    _In_ std::shared_ptr<std::vector<unsigned char>> blobBuffer
+    )
+{
+    m_uploads.push_back(title_storage_blob_result(std::move(blobBuffer), std::move(blobMetadata)));
+}
+
+void
+title_storage_sync_request::set_blob_priority(
+    _In_ const string_t& blobPath,
+    _In_ int32_t priority
+    )
+{
+    m_blobPriorities[blobPath] = priority;
+}
+
+void
+title_storage_sync_request::set_max_concurrent_transfers(
+    _In_ uint32_t maxConcurrentTransfers
+    )
+{
+    m_maxConcurrentTransfers = __max(maxConcurrentTransfers, 1);
+}
+
+const string_t&
+title_storage_sync_request::service_configuration_id() const
+{
+    return m_serviceConfigurationId;
+}
+
+title_storage_type
+title_storage_sync_request::storage_type() const
+{
+    return m_storageType;
+}
+
+const string_t&
+title_storage_sync_request::blob_path() const
+{
+    return m_blobPath;
+}
+
+const string_t&
+title_storage_sync_request::xbox_user_id() const
+{
+    return m_xboxUserId;
+}
+
+const string_t&
+title_storage_sync_request::manifest_file_path() const
+{
+    return m_manifestFilePath;
+}
+
+uint32_t
+title_storage_sync_request::max_concurrent_transfers() const
+{
+    return m_maxConcurrentTransfers;
+}
+
+const std::vector<title_storage_blob_result>&
+title_storage_sync_request::_Uploads() const
+{
+    return m_uploads;
+}
+
+int32_t
+title_storage_sync_request::_Blob_priority(
+    _In_ const string_t& blobPath
+    ) const
+{
+    auto priority = m_blobPriorities.find(blobPath);
+    return priority == m_blobPriorities.end() ? 0 : priority->second;
+}
+
+title_storage_sync_result::title_storage_sync_result() :
+    m_unchangedBlobCount(0),
+    m_syncDuration(0)
+{
+}
+
+const std::vector<title_storage_blob_result>&
+title_storage_sync_result::downloaded_blobs() const
+{
+    return m_downloadedBlobs;
+}
+
+const std::vector<title_storage_blob_metadata>&
+title_storage_sync_result::uploaded_blobs() const
+{
+    return m_uploadedBlobs;
+}
+
+const std::vector<string_t>&
+title_storage_sync_result::conflicted_blob_paths() const
+{
+    return m_conflictedBlobPaths;
+}
+
+const std::vector<string_t>&
+title_storage_sync_result::removed_blob_paths() const
+{
+    return m_removedBlobPaths;
+}
+
+const std::vector<string_t>&
+title_storage_sync_result::failed_blob_paths() const
+{
+    return m_failedBlobPaths;
+}
+
+uint32_t
+title_storage_sync_result::unchanged_blob_count() const
+{
+    return m_unchangedBlobCount;
+}
+
+std::chrono::milliseconds
+title_storage_sync_result::sync_duration() const
+{
+    return m_syncDuration;
+}
+
+title_storage_sync_manifest
+title_storage_sync_manifest::load(
+    _In_ const string_t& filePath
+    )
+{
+    title_storage_sync_manifest manifest;
+    std::ifstream in(filePath, std::ios::in | std::ios::binary);
+    if (!in)
+    {
+        return manifest;
+    }
+
+    std::string manifestData((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    web::json::value manifestJson;
+    try
+    {
+        manifestJson = web::json::value::parse(utility::conversions::to_string_t(manifestData));
+    }
+    catch (const web::json::json_exception&)
+    {
+        // Treat every blob as changed; the next save replaces the unreadable manifest
+        LOGS_ERROR << "title_storage_sync_manifest: ignoring unreadable manifest " << filePath;
+        return manifest;
+    }
+
+    std::error_code errc;
+    web::json::value blobsJson = utils::extract_json_field(manifestJson, _T("blobs"), errc, false);
+    if (!blobsJson.is_array())
+    {
+        return manifest;
+    }
+
+    for (const auto& blobJson : blobsJson.as_array())
+    {
+        string_t blobPath = utils::extract_json_string(blobJson, _T("path"), errc, true);
+        title_storage_manifest_entry entry;
+        entry.eTag = utils::extract_json_string(blobJson, _T("etag"), errc, true);
+        entry.length = utils::extract_json_uint52(blobJson, _T("size"), errc, true);
+        entry.clientTimestamp = utils::extract_json_time(blobJson, _T("clientFileTime"), errc, false);
+        if (errc)
+        {
+            break;
+        }
+
+        manifest.m_entries[blobPath] = entry;
+    }
+
+    return manifest;
+}
+
+bool
+title_storage_sync_manifest::save(
+    _In_ const string_t& filePath
+    ) const
+{
+    web::json::value blobsJson = web::json::value::array();
+    uint32_t index = 0;
+    for (const auto& entry : m_entries)
+    {
+        web::json::value blobJson;
+        blobJson[_T("path")] = web::json::value::string(entry.first);
+        blobJson[_T("etag")] = web::json::value::string(entry.second.eTag);
+        blobJson[_T("size")] = web::json::value::number(entry.second.length);
+        if (entry.second.clientTimestamp.is_initialized())
+        {
+            blobJson[_T("clientFileTime")] = web::json::value::string(entry.second.clientTimestamp.to_string(utility::datetime::ISO_8601));
+        }
+        blobsJson[index++] = blobJson;
+    }
+
+    web::json::value manifestJson;
+    manifestJson[_T("blobs")] = blobsJson;
+
+    std::string manifestData = utility::conversions::to_utf8string(manifestJson.serialize());
+    return title_storage_write_file_atomically(filePath, manifestData.c_str(), manifestData.size());
+}
+
+bool
+title_storage_sync_manifest::has_changed(
+    _In_ const title_storage_blob_metadata& remoteBlob
+    ) const
+{
+    const title_storage_manifest_entry* entry = find(remoteBlob.blob_path());
+    return entry == nullptr ||
+        entry->eTag != remoteBlob.e_tag() ||
+        entry->length != remoteBlob.length() ||
+        entry->clientTimestamp.to_interval() != remoteBlob.client_timestamp().to_interval();
+}
+
+const title_storage_manifest_entry*
+title_storage_sync_manifest::find(
+    _In_ const string_t& blobPath
+    ) const
+{
+    auto entry = m_entries.find(blobPath);
+    return entry == m_entries.end() ? nullptr : &entry->second;
+}
+
+void
+title_storage_sync_manifest::update(
+    _In_ const title_storage_blob_metadata& blob
+    )
+{
+    title_storage_manifest_entry& entry = m_entries[blob.blob_path()];
+    entry.eTag = blob.e_tag();
+    entry.length = blob.length();
+    entry.clientTimestamp = blob.client_timestamp();
+}
+
+void
+title_storage_sync_manifest::remove(
+    _In_ const string_t& blobPath
+    )
+{
+    m_entries.erase(blobPath);
+}
+
+std::vector<string_t>
+title_storage_sync_manifest::blob_paths() const
+{
+    std::vector<string_t> blobPaths;
+    blobPaths.reserve(m_entries.size());
+    for (const auto& entry : m_entries)
+    {
+        blobPaths.push_back(entry.first);
+    }
+    return blobPaths;
+}
+
+title_storage_sync_operation::title_storage_sync_operation(
+    _In_ title_storage_service titleStorageService,
+    _In_ title_storage_sync_request syncRequest
+    ) :
+    m_titleStorageService(std::move(titleStorageService)),
+    m_syncRequest(std::move(syncRequest)),
+    m_startTime(std::chrono::steady_clock::now()),
+    m_nextTransfer(0)
+{
+}
+
+pplx::task<xbox_live_result<title_storage_sync_result>>
+title_storage_sync_operation::run()
+{
+    std::shared_ptr<title_storage_sync_operation> pThis(shared_from_this());
+    return m_titleStorageService.get_blob_metadata(
+        m_syncRequest.service_configuration_id(),
+        m_syncRequest.storage_type(),
+        m_syncRequest.blob_path(),
+        m_syncRequest.xbox_user_id()
+        )
+    .then([pThis](xbox_live_result<title_storage_blob_metadata_result> metadataResult)
+    {
+        return pThis->list_remaining_blobs(std::move(metadataResult));
+    })
+    .then([pThis](xbox_live_result<void> listResult)
+    {
+        if (listResult.err())
+        {
+            return pplx::task_from_result(xbox_live_result<title_storage_sync_result>(listResult.err(), listResult.err_message()));
+        }
+
+        pThis->plan_transfers();
+
+        // Each chain takes the highest priority transfer left, so at most max_concurrent_transfers() are in flight
+        size_t chainCount = __min(static_cast<size_t>(pThis->m_syncRequest.max_concurrent_transfers()), pThis->m_transfers.size());
+        std::vector<pplx::task<void>> transferChains;
+        for (size_t i = 0; i < chainCount; ++i)
+        {
+            transferChains.push_back(pThis->run_transfers());
+        }
+
+        return pplx::when_all(transferChains.begin(), transferChains.end())
+        .then([pThis]()
+        {
+            return pThis->commit();
+        });
+    });
+}
+
+pplx::task<xbox_live_result<void>>
+title_storage_sync_operation::list_remaining_blobs(
+    _In_ xbox_live_result<title_storage_blob_metadata_result> metadataResult
+    )
+{
+    if (metadataResult.err())
+    {
+        return pplx::task_from_result(xbox_live_result<void>(metadataResult.err(), metadataResult.err_message()));
+    }
+
+    auto& page = metadataResult.payload();
+    m_remoteBlobs.insert(m_remoteBlobs.end(), page.items().begin(), page.items().end());
+    if (!page.has_next())
+    {
+        return pplx::task_from_result(xbox_live_result<void>());
+    }
+
+    std::shared_ptr<title_storage_sync_operation> pThis(shared_from_this());
+    return page.get_next(0)
+    .then([pThis](xbox_live_result<title_storage_blob_metadata_result> nextResult)
+    {
+        return pThis->list_remaining_blobs(std::move(nextResult));
+    });
+}
+
+void
+title_storage_sync_operation::plan_transfers()
+{
+    m_manifest = title_storage_sync_manifest::load(m_syncRequest.manifest_file_path());
+
+    std::unordered_map<string_t, const title_storage_blob_metadata*> remoteBlobsByPath;
+    for (const auto& remoteBlob : m_remoteBlobs)
+    {
+        remoteBlobsByPath[remoteBlob.blob_path()] = &remoteBlob;
+    }
+
+    std::set<string_t> uploadPaths;
+    for (const auto& upload : m_syncRequest._Uploads())
+    {
+        const string_t& blobPath = upload.blob_metadata().blob_path();
+        auto remoteBlob = remoteBlobsByPath.find(blobPath);
+        title_storage_sync_transfer transfer;
+        transfer.isUpload = true;
+        transfer.priority = m_syncRequest._Blob_priority(blobPath);
+        transfer.blobMetadata = upload.blob_metadata();
+        transfer.blobBuffer = upload.blob_buffer();
+        transfer.etagMatchCondition = title_storage_e_tag_match_condition::not_used;
+
+        if (remoteBlob != remoteBlobsByPath.end())
+        {
+            if (m_manifest.has_changed(*remoteBlob->second))
+            {
+                // Someone else changed the blob; leave the title to merge the downloaded version
+                m_syncResult.m_conflictedBlobPaths.push_back(blobPath);
+                continue;
+            }
+
+            // Fail the upload rather than overwrite a change made after the listing
+            transfer.blobMetadata._Set_e_tag_and_length(remoteBlob->second->e_tag(), transfer.blobBuffer->size());
+            transfer.etagMatchCondition = title_storage_e_tag_match_condition::if_match;
+        }
+
+        uploadPaths.insert(blobPath);
+        m_transfers.push_back(std::move(transfer));
+    }
+
+    for (const auto& remoteBlob : m_remoteBlobs)
+    {
+        if (uploadPaths.find(remoteBlob.blob_path()) != uploadPaths.end())
+        {
+            continue;
+        }
+
+        if (!m_manifest.has_changed(remoteBlob))
+        {
+            ++m_syncResult.m_unchangedBlobCount;
+            continue;
+        }
+
+        title_storage_sync_transfer transfer;
+        transfer.isUpload = false;
+        transfer.priority = m_syncRequest._Blob_priority(remoteBlob.blob_path());
+        transfer.blobMetadata = remoteBlob;
+        transfer.blobBuffer = std::make_shared<std::vector<unsigned char>>();
+        transfer.etagMatchCondition = title_storage_e_tag_match_condition::not_used;
+        m_transfers.push_back(std::move(transfer));
+    }
+
+    for (const auto& blobPath : m_manifest.blob_paths())
+    {
+        if (remoteBlobsByPath.find(blobPath) == remoteBlobsByPath.end() &&
+            uploadPaths.find(blobPath) == uploadPaths.end())
+        {
+            m_syncResult.m_removedBlobPaths.push_back(blobPath);
+            m_manifest.remove(blobPath);
+        }
+    }
+
+    std::stable_sort(m_transfers.begin(), m_transfers.end(), [](const title_storage_sync_transfer& lhs, const title_storage_sync_transfer& rhs)
+    {
+        return lhs.priority > rhs.priority;
+    });
+}
+
+pplx::task<void>
+title_storage_sync_operation::run_transfers()
+{
+    size_t index = m_nextTransfer++;
+    if (index >= m_transfers.size())
+    {
+        return pplx::task_from_result();
+    }
+
+    std::shared_ptr<title_storage_sync_operation> pThis(shared_from_this());
+    const title_storage_sync_transfer& transfer = m_transfers[index];
+    if (transfer.isUpload)
+    {
+        return m_titleStorageService.upload_blob(
+            transfer.blobMetadata,
+            transfer.blobBuffer,
+            transfer.etagMatchCondition
+            )
+        .then([pThis, index](xbox_live_result<title_storage_blob_metadata> uploadResult)
+        {
+            pThis->record_upload(pThis->m_transfers[index], uploadResult);
+            return pThis->run_transfers();
+        });
+    }
+
+    return m_titleStorageService.download_blob(
+        transfer.blobMetadata,
+        transfer.blobBuffer,
+        transfer.etagMatchCondition
+        )
+    .then([pThis, index](xbox_live_result<title_storage_blob_result> downloadResult)
+    {
+        pThis->record_download(pThis->m_transfers[index], downloadResult);
+        return pThis->run_transfers();
+    });
+}
+
+void
+title_storage_sync_operation::record_upload(
+    _In_ const title_storage_sync_transfer& transfer,
+    _In_ const xbox_live_result<title_storage_blob_metadata>& uploadResult
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_resultLock);
+    if (uploadResult.err())
+    {
+        LOGS_ERROR << "title_storage: sync upload of " << transfer.blobMetadata.blob_path() << " failed: " << uploadResult.err_message();
+        m_syncResult.m_failedBlobPaths.push_back(transfer.blobMetadata.blob_path());
+        return;
+    }
+
+    m_syncResult.m_uploadedBlobs.push_back(uploadResult.payload());
+    m_manifest.update(uploadResult.payload());
+}
+
+void
+title_storage_sync_operation::record_download(
+    _In_ const title_storage_sync_transfer& transfer,
+    _In_ const xbox_live_result<title_storage_blob_result>& downloadResult
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_resultLock);
+    if (downloadResult.err())
+    {
+        LOGS_ERROR << "title_storage: sync download of " << transfer.blobMetadata.blob_path() << " failed: " << downloadResult.err_message();
+        m_syncResult.m_failedBlobPaths.push_back(transfer.blobMetadata.blob_path());
+        return;
+    }
+
+    // Record the version actually downloaded, which may be newer than the listing
+    title_storage_blob_metadata downloadedBlob = transfer.blobMetadata;
+    const auto& resultMetadata = downloadResult.payload().blob_metadata();
+    if (!resultMetadata.e_tag().empty())
+    {
+        downloadedBlob._Set_e_tag_and_length(resultMetadata.e_tag(), resultMetadata.length());
+    }
+
+    m_syncResult.m_downloadedBlobs.push_back(downloadResult.payload());
+    m_manifest.update(downloadedBlob);
+}
+
+xbox_live_result<title_storage_sync_result>
+title_storage_sync_operation::commit()
+{
+    bool manifestSaved = m_manifest.save(m_syncRequest.manifest_file_path());
+    m_syncResult.m_syncDuration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_startTime);
+
+    LOGS_INFO << "title_storage: synced " << m_remoteBlobs.size() << " blobs in " << m_syncResult.m_syncDuration.count() << "ms: "
+        << m_syncResult.m_downloadedBlobs.size() << " downloaded, "
+        << m_syncResult.m_uploadedBlobs.size() << " uploaded, "
+        << m_syncResult.m_unchangedBlobCount << " unchanged, "
+        << m_syncResult.m_failedBlobPaths.size() << " failed";
+
+    if (!manifestSaved)
+    {
+        return xbox_live_result<title_storage_sync_result>(m_syncResult, xbox_live_error_code::runtime_error, "Failed to write sync manifest");
+    }
+    return xbox_live_result<title_storage_sync_result>(m_syncResult);
+}
+
+pplx::task<xbox_live_result<title_storage_sync_result>>
+title_storage_service::sync_blobs(
+    _In_ const title_storage_sync_request& syncRequest
+    )
+{
+    RETURN_TASK_CPP_INVALIDARGUMENT_IF_STRING_EMPTY(syncRequest.service_configuration_id(), title_storage_sync_result, "Service configuration id is empty");
+    RETURN_TASK_CPP_INVALIDARGUMENT_IF_STRING_EMPTY(syncRequest.manifest_file_path(), title_storage_sync_result, "Manifest file path is empty");
+
+    auto syncOperation = std::make_shared<title_storage_sync_operation>(*this, syncRequest);
+    return utils::create_exception_free_task<title_storage_sync_result>(
+        syncOperation->run()
+        );
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_TITLE_STORAGE_CPP_END
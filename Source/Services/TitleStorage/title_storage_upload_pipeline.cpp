@@ -0,0 +1,174 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#include "utils.h"
+#include "title_storage_internal.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_TITLE_STORAGE_CPP_BEGIN
+
+// Long enough that per-request overhead is small next to the transfer, short enough that a timed out block is cheap to resend
+const std::chrono::milliseconds title_storage_upload_pipeline::TARGET_BLOCK_DURATION = std::chrono::milliseconds(2000);
+
+title_storage_upload_pipeline::title_storage_upload_pipeline(
+    _In_ std::function<size_t(unsigned char* buffer, size_t bufferSize)> blobSource,
+    _In_ uint32_t preferredBlockSize,
+    _In_ bool isBinaryData
+    ) :
+    m_blobSource(std::move(blobSource)),
+    m_isBinaryData(isBinaryData),
+    m_started(false),
+    m_blockSize(preferredBlockSize),
+    m_bytesRead(0),
+    m_pendingRead(pplx::task_from_result(std::vector<unsigned char>()))
+{
+}
+
+title_storage_upload_pipeline::~title_storage_upload_pipeline()
+{
+    try
+    {
+        m_pendingRead.wait();
+    }
+    catch (...)
+    {
+    }
+}
+
+bool
+title_storage_upload_pipeline::next_block(
+    _Inout_ std::vector<unsigned char>& block,
+    _Out_ bool& isFinalBlock
+    )
+{
+    isFinalBlock = false;
+    if (!m_started)
+    {
+        m_started = true;
+        m_readyBlock = read_block(m_blockSize);
+        if (m_isBinaryData && !m_readyBlock.empty())
+        {
+            start_read();
+        }
+    }
+
+    if (m_readyBlock.empty())
+    {
+        return false;
+    }
+
+    // Usually done by now; it was read while the previous block was being sent
+    std::vector<unsigned char> followingBlock = m_pendingRead.get();
+    block.swap(m_readyBlock);
+    m_readyBlock = std::move(followingBlock);
+
+    isFinalBlock = m_readyBlock.empty();
+    if (!isFinalBlock)
+    {
+        start_read();
+    }
+    return true;
+}
+
+void
+title_storage_upload_pipeline::record_block_sent(
+    _In_ size_t blockSize,
+    _In_ std::chrono::milliseconds elapsed
+    )
+{
+    if (!m_isBinaryData)
+    {
+        return;
+    }
+
+    uint32_t newBlockSize = adapt_block_size(m_blockSize, blockSize, elapsed);
+    if (newBlockSize != m_blockSize)
+    {
+        LOGS_DEBUG << "title_storage: upload block size " << m_blockSize.load() << " -> " << newBlockSize << " after " << blockSize << " bytes in " << elapsed.count() << "ms";
+        m_blockSize = newBlockSize;
+    }
+}
+
+uint32_t
+title_storage_upload_pipeline::block_size() const
+{
+    return m_blockSize;
+}
+
+uint64_t
+title_storage_upload_pipeline::bytes_read() const
+{
+    return m_bytesRead;
+}
+
+uint32_t
+title_storage_upload_pipeline::adapt_block_size(
+    _In_ uint32_t currentBlockSize,
+    _In_ size_t bytesSent,
+    _In_ std::chrono::milliseconds elapsed
+    )
+{
+    // A partial final block says nothing about throughput at the current size
+    if (bytesSent < currentBlockSize)
+    {
+        return currentBlockSize;
+    }
+
+    uint64_t idealBlockSize = elapsed.count() <= 0 ?
+        static_cast<uint64_t>(currentBlockSize) * 2 :
+        static_cast<uint64_t>(bytesSent) * TARGET_BLOCK_DURATION.count() / elapsed.count();
+
+    // Move at most a factor of two per block so one noisy measurement can't swing the size across the whole range
+    idealBlockSize = __min(idealBlockSize, static_cast<uint64_t>(currentBlockSize) * 2);
+    idealBlockSize = __max(idealBlockSize, static_cast<uint64_t>(currentBlockSize) / 2);
+    idealBlockSize = __min(idealBlockSize, static_cast<uint64_t>(title_storage_service::MAX_UPLOAD_BLOCK_SIZE));
+    idealBlockSize = __max(idealBlockSize, static_cast<uint64_t>(title_storage_service::MIN_UPLOAD_BLOCK_SIZE));
+
+    // Keep blocks a whole number of the minimum block size
+    idealBlockSize -= idealBlockSize % title_storage_service::MIN_UPLOAD_BLOCK_SIZE;
+    return static_cast<uint32_t>(idealBlockSize);
+}
+
+void
+title_storage_upload_pipeline::start_read()
+{
+    uint32_t blockSize = m_blockSize;
+    m_pendingRead = pplx::create_task([this, blockSize]()
+    {
+        return read_block(blockSize);
+    });
+}
+
+std::vector<unsigned char>
+title_storage_upload_pipeline::read_block(
+    _In_ uint32_t blockSize
+    )
+{
+    std::vector<unsigned char> block(blockSize);
+    size_t blockLength = 0;
+    while (true)
+    {
+        if (blockLength == block.size())
+        {
+            // Non-binary blobs are sent in one request, so keep reading until the source ends
+            if (m_isBinaryData)
+            {
+                break;
+            }
+            block.resize(block.size() * 2);
+        }
+
+        size_t bytesRead = m_blobSource(&block[blockLength], block.size() - blockLength);
+        if (bytesRead == 0)
+        {
+            break;
+        }
+        blockLength += __min(bytesRead, block.size() - blockLength);
+    }
+
+    block.resize(blockLength);
+    m_bytesRead += blockLength;
+    return block;
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_TITLE_STORAGE_CPP_END
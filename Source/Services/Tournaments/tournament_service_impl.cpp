@@ -27,7 +27,7 @@ tournament_service_impl::add_tournament_changed_handler(
     _In_ std::function<void(const tournament_change_event_args&)> handler
 )
 {
-    std::lock_guard<std::mutex> lock(m_tournamentHandlerLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_tournamentHandlerLock.get());
 
     function_context context = -1;
     if (handler != nullptr)
@@ -44,7 +44,7 @@ tournament_service_impl::remove_tournament_changed_handler(
     _In_ function_context context
 )
 {
-    std::lock_guard<std::mutex> lock(m_tournamentHandlerLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_tournamentHandlerLock.get());
     m_tournamentChangeHandler.erase(context);
 }
 
@@ -55,7 +55,7 @@ tournament_service_impl::tournament_changed(
 {
     std::unordered_map<function_context, std::function<void(const tournament_change_event_args&)>> tournamentChangeHandlerCopy;
     {
-        std::lock_guard<std::mutex> lock(m_tournamentHandlerLock.get());
+        std::lock_guard<xsapi_mutex> lock(m_tournamentHandlerLock.get());
         tournamentChangeHandlerCopy = m_tournamentChangeHandler;
     }
 
@@ -131,7 +131,7 @@ tournament_service_impl::add_team_changed_handler(
     _In_ std::function<void(const team_change_event_args&)> handler
 )
 {
-    std::lock_guard<std::mutex> lock(m_teamHandlerLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_teamHandlerLock.get());
 
     function_context context = -1;
     if (handler != nullptr)
@@ -148,7 +148,7 @@ tournament_service_impl::remove_team_changed_handler(
     _In_ function_context context
 )
 {
-    std::lock_guard<std::mutex> lock(m_teamHandlerLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_teamHandlerLock.get());
     m_teamChangeHandler.erase(context);
 }
 
@@ -159,7 +159,7 @@ tournament_service_impl::team_changed(
 {
     std::unordered_map<function_context, std::function<void(const team_change_event_args&)>> teamChangeHandlerCopy;
     {
-        std::lock_guard<std::mutex> lock(m_teamHandlerLock.get());
+        std::lock_guard<xsapi_mutex> lock(m_teamHandlerLock.get());
         teamChangeHandlerCopy = m_teamChangeHandler;
     }
 
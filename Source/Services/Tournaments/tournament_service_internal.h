@@ -47,11 +47,11 @@ private:
     void tournament_changed(_In_ const tournament_change_event_args& eventArgs);
     void team_changed(_In_ const team_change_event_args& eventArgs);
 
-    xbox::services::system::xbox_live_mutex m_tournamentHandlerLock;
+    xbox::services::system::xbox_live_mutex m_tournamentHandlerLock XSAPI_LOCK_SITE("tournament_service_impl::m_tournamentHandlerLock");
     std::unordered_map<function_context, std::function<void(const tournament_change_event_args&)>> m_tournamentChangeHandler;
     function_context m_tournamentChangeHandlerCounter;
 
-    xbox::services::system::xbox_live_mutex m_teamHandlerLock;
+    xbox::services::system::xbox_live_mutex m_teamHandlerLock XSAPI_LOCK_SITE("tournament_service_impl::m_teamHandlerLock");
     std::unordered_map<function_context, std::function<void(const team_change_event_args&)>> m_teamChangeHandler;
     function_context m_teamChangeHandlerCounter;
 
@@ -130,7 +130,7 @@ protected:
 private:
     log_output_level_setting m_levelSetting;
     log_level m_logLevel;
-    mutable std::mutex m_mutex;
+    mutable xsapi_mutex m_mutex XSAPI_LOCK_SITE("log_output::m_mutex");
 };
 
 class logger
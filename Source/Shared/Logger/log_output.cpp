@@ -17,7 +17,7 @@ void log_output::add_log(_In_ const log_entry& entry)
 {
     std::string msg = format_log(entry);
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        std::lock_guard<xsapi_mutex> lock(m_mutex);
         write(msg);
     }
 }
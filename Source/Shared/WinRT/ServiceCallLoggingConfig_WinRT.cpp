@@ -15,7 +15,7 @@ ServiceCallLoggingConfig::SingletonInstance::get()
     {
         ServiceCallLoggingConfig^ serviceCallLoggingConfig = ref new ServiceCallLoggingConfig();
         {
-            std::lock_guard<std::mutex> guard(xsapiSingleton->m_singletonLock);
+            std::lock_guard<xbox::services::xsapi_mutex> guard(xsapiSingleton->m_singletonLock);
             if (xsapiSingleton->m_winrt_serviceCallLoggingConfigInstance == nullptr)
             {
                 xsapiSingleton->m_winrt_serviceCallLoggingConfigInstance = serviceCallLoggingConfig;
@@ -21,7 +21,7 @@ NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_BEGIN
 xbox_live_result<void> local_config::read()
 {
 #if UWP_API
-    std::lock_guard<std::mutex> guard(m_jsonConfigLock);
+    std::lock_guard<xsapi_mutex> guard(m_jsonConfigLock);
     if (m_jsonConfig.size() > 0)
     {
         return xbox_live_result<void>();
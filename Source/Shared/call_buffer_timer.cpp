@@ -36,7 +36,7 @@ call_buffer_timer::call_buffer_timer(
 void
 call_buffer_timer::fire()
 {
-    std::lock_guard<std::mutex> lock(m_timerLock);
+    std::lock_guard<xsapi_mutex> lock(m_timerLock);
     fire_helper();
 }
 
@@ -46,7 +46,7 @@ call_buffer_timer::fire(
     _In_ const call_buffer_timer_completion_context& usersAddedStruct
 )
 {
-    std::lock_guard<std::mutex> lock(m_timerLock);
+    std::lock_guard<xsapi_mutex> lock(m_timerLock);
 
     if (xboxUserIds.empty())
     {
@@ -76,7 +76,7 @@ call_buffer_timer::fire(
             return;
         }
 
-        std::lock_guard<std::mutex> lock(pThis->m_timerLock);
+        std::lock_guard<xsapi_mutex> lock(pThis->m_timerLock);
         pThis->fire_helper(usersAddedStruct);
     });
 }
@@ -105,7 +105,7 @@ call_buffer_timer::fire_helper(
             if (pThis != nullptr)
             {
                 {
-                    std::lock_guard<std::mutex> lock(pThis->m_timerLock);
+                    std::lock_guard<xsapi_mutex> lock(pThis->m_timerLock);
                     pThis->m_isTaskInProgress = false;
                 }
 
@@ -113,7 +113,7 @@ call_buffer_timer::fire_helper(
                 pThis->m_fCallback(usersToCall, usersAddedStruct);
 
                 {
-                    std::lock_guard<std::mutex> lock(pThis->m_timerLock);
+                    std::lock_guard<xsapi_mutex> lock(pThis->m_timerLock);
                     if (pThis->m_queuedTask)
                     {
                         pThis->m_queuedTask = false;
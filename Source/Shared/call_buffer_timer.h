@@ -43,7 +43,7 @@ private:
     std::vector<string_t> m_usersToCall;
     std::unordered_map<string_t, bool> m_usersToCallMap;    // duplicating data to make lookup faster. SHould be a better way to do this
     std::function<void(const std::vector<string_t>&, const call_buffer_timer_completion_context&)> m_fCallback;
-    std::mutex m_timerLock;
+    xsapi_mutex m_timerLock XSAPI_LOCK_SITE("call_buffer_timer::m_timerLock");
 };
 
 } }
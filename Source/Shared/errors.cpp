@@ -53,6 +53,7 @@ std::string xbox_services_error_code_category_impl::message(_In_ int errorCode)
 
         case xbox_live_error_code::invalid_config: return "invalid_config";
         case xbox_live_error_code::unsupported: return "unsupported";
+        case xbox_live_error_code::http_endpoint_circuit_open: return "http_endpoint_circuit_open";
 
         case xbox_live_error_code::HR_ERROR_INTERNET_TIMEOUT: return "ERROR_INTERNET_TIMEOUT";
         case xbox_live_error_code::AM_E_XASD_UNEXPECTED: return "AM_E_XASD_UNEXPECTED";
@@ -364,6 +365,7 @@ bool xbox_services_error_condition_category_impl::equivalent(
         case xbox_live_error_code::HR_INET_E_REDIRECT_FAILED:
         case xbox_live_error_code::HR_INET_E_REDIRECT_TO_DIR:
         case xbox_live_error_code::HR_ERROR_NETWORK_UNREACHABLE:
+        case xbox_live_error_code::http_endpoint_circuit_open:
             return (condition == xbox_live_error_condition::network);
 
         case xbox_live_error_code::out_of_range:
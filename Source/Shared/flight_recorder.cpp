@@ -0,0 +1,205 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#include "flight_recorder.h"
+#include "utils.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_BEGIN
+
+// 96KB of records, a few minutes of a busy title's service calls. A power of two so the slot is a mask.
+const size_t flight_recorder::CAPACITY = 4096;
+const uint32_t flight_recorder::DUMP_MAGIC = 0x52464c58; // "XLFR"
+const uint32_t flight_recorder::DUMP_VERSION = 1;
+
+// Read by the terminate handler, which must not take the singleton lock
+static std::atomic<flight_recorder*> s_crashDumpRecorder(nullptr);
+static std::terminate_handler s_previousTerminateHandler = nullptr;
+
+struct flight_recorder_dump_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t recordCount;
+};
+
+static FILE*
+open_dump_file(
+    _In_ const string_t& filePath
+    )
+{
+#if XSAPI_U
+    return fopen(filePath.c_str(), "wb");
+#else
+    FILE* file = nullptr;
+    _wfopen_s(&file, filePath.c_str(), L"wb");
+    return file;
+#endif
+}
+
+flight_recorder*
+flight_recorder::get_flight_recorder_singleton()
+{
+    // Called on every HTTP call and event batch, so it takes neither the singleton lock nor a reference.
+    // Never freed, so threads still recording while the process exits don't write into a destroyed buffer.
+    static flight_recorder* s_flightRecorder = new flight_recorder();
+    return s_flightRecorder;
+}
+
+flight_recorder::flight_recorder() :
+    m_slots(new flight_record_slot[CAPACITY]),
+    m_nextIndex(0)
+{
+}
+
+flight_recorder::~flight_recorder()
+{
+    flight_recorder* expected = this;
+    s_crashDumpRecorder.compare_exchange_strong(expected, nullptr);
+}
+
+void
+flight_recorder::record(
+    _In_ flight_record_type type,
+    _In_ uint16_t source,
+    _In_ uint32_t id,
+    _In_ uint32_t value,
+    _In_ uint32_t duration
+    )
+{
+    uint64_t index = m_nextIndex.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = m_slots[index & (CAPACITY - 1)];
+
+    // Readers that see zero, or a sequence that changed while they copied, skip the slot
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.record.timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(chrono_clock_t::now().time_since_epoch()).count());
+    slot.record.id = id;
+    slot.record.value = value;
+    slot.record.duration = duration;
+    slot.record.type = static_cast<uint16_t>(type);
+    slot.record.source = source;
+
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+std::vector<flight_record>
+flight_recorder::snapshot() const
+{
+    uint64_t end = m_nextIndex.load(std::memory_order_acquire);
+    uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+
+    std::vector<flight_record> records;
+    records.reserve(static_cast<size_t>(end - begin));
+    for (uint64_t index = begin; index < end; ++index)
+    {
+        const auto& slot = m_slots[index & (CAPACITY - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+        {
+            continue;
+        }
+
+        flight_record record = slot.record;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == index + 1)
+        {
+            records.push_back(record);
+        }
+    }
+
+    return records;
+}
+
+uint64_t
+flight_recorder::record_count() const
+{
+    return m_nextIndex.load(std::memory_order_relaxed);
+}
+
+xbox_live_result<void>
+flight_recorder::dump(
+    _In_ const string_t& filePath
+    ) const
+{
+    auto records = snapshot();
+
+    FILE* file = open_dump_file(filePath);
+    if (file == nullptr)
+    {
+        return xbox_live_result<void>(xbox_live_error_code::runtime_error, "Unable to open the flight recorder dump file");
+    }
+
+    flight_recorder_dump_header header;
+    header.magic = DUMP_MAGIC;
+    header.version = DUMP_VERSION;
+    header.recordSize = static_cast<uint32_t>(sizeof(flight_record));
+    header.recordCount = static_cast<uint32_t>(records.size());
+
+    bool succeeded = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (succeeded && !records.empty())
+    {
+        succeeded = fwrite(records.data(), sizeof(flight_record), records.size(), file) == records.size();
+    }
+    succeeded = fclose(file) == 0 && succeeded;
+
+    if (!succeeded)
+    {
+        return xbox_live_result<void>(xbox_live_error_code::runtime_error, "Unable to write the flight recorder dump file");
+    }
+    return xbox_live_result<void>();
+}
+
+void
+flight_recorder::set_crash_dump_path(
+    _In_ const string_t& filePath
+    )
+{
+    {
+        std::lock_guard<std::mutex> lock(m_crashDumpLock);
+        m_crashDumpPath = filePath;
+    }
+
+    if (filePath.empty())
+    {
+        flight_recorder* expected = this;
+        s_crashDumpRecorder.compare_exchange_strong(expected, nullptr);
+        return;
+    }
+
+    // Installed once and chained, so a handler the title set before this still runs
+    if (s_crashDumpRecorder.exchange(this) == nullptr && s_previousTerminateHandler == nullptr)
+    {
+        s_previousTerminateHandler = std::set_terminate(&flight_recorder::on_terminate);
+    }
+}
+
+void
+flight_recorder::on_terminate()
+{
+    flight_recorder* recorder = s_crashDumpRecorder.exchange(nullptr);
+    if (recorder != nullptr)
+    {
+        // Whatever is holding the lock isn't coming back, so don't wait for it
+        string_t crashDumpPath;
+        if (recorder->m_crashDumpLock.try_lock())
+        {
+            crashDumpPath = recorder->m_crashDumpPath;
+            recorder->m_crashDumpLock.unlock();
+        }
+
+        if (!crashDumpPath.empty())
+        {
+            recorder->dump(crashDumpPath);
+        }
+    }
+
+    if (s_previousTerminateHandler != nullptr && s_previousTerminateHandler != &flight_recorder::on_terminate)
+    {
+        s_previousTerminateHandler();
+    }
+    std::abort();
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_END
@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+#include <atomic>
+#include "xsapi/types.h"
+#include "xsapi/errors.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_BEGIN
+
+enum class flight_record_type : uint16_t
+{
+    unknown,
+    http_call_started,          // source: xbox_live_api, value: attempt number
+    http_call_completed,        // source: xbox_live_api, value: http status or 0 on network error, duration: latency in us
+    web_socket_state_changed,   // value: new web_socket_connection_state, duration: old state
+    rta_resync,
+    social_manager_events,      // value: events returned by do_work
+    multiplayer_manager_events  // value: events returned by do_work
+};
+
+// One 24 byte entry. id ties together the start and completion of the same http call.
+struct flight_record
+{
+    uint64_t timestamp;
+    uint32_t id;
+    uint32_t value;
+    uint32_t duration;
+    uint16_t type;
+    uint16_t source;
+};
+
+// Always-on record of the last CAPACITY service calls and state transitions, for working out what happened
+// before an incident. Recording is lock free: writers claim a slot with one atomic increment and publish it
+// with a sequence number, so a reader can tell a finished record from one being overwritten. The dump is
+// a small header followed by the raw records, oldest first.
+class flight_recorder
+{
+public:
+    static flight_recorder* get_flight_recorder_singleton();
+
+    flight_recorder();
+    ~flight_recorder();
+
+    void record(
+        _In_ flight_record_type type,
+        _In_ uint16_t source = 0,
+        _In_ uint32_t id = 0,
+        _In_ uint32_t value = 0,
+        _In_ uint32_t duration = 0
+        );
+
+    // The records still in the buffer, oldest first. Records being written while this runs are skipped.
+    std::vector<flight_record> snapshot() const;
+
+    uint64_t record_count() const;
+
+    xbox_live_result<void> dump(_In_ const string_t& filePath) const;
+
+    // Dumps to filePath if the process terminates on an unhandled exception. An empty path turns it off.
+    void set_crash_dump_path(_In_ const string_t& filePath);
+
+    static const size_t CAPACITY;
+    static const uint32_t DUMP_MAGIC;
+    static const uint32_t DUMP_VERSION;
+
+private:
+    struct flight_record_slot
+    {
+        flight_record_slot() : sequence(0) {}
+
+        // Index of the record in the slot plus one, or zero while it is being written
+        std::atomic<uint64_t> sequence;
+        flight_record record;
+    };
+
+    static void on_terminate();
+
+    std::unique_ptr<flight_record_slot[]> m_slots;
+    std::atomic<uint64_t> m_nextIndex;
+
+    std::mutex m_crashDumpLock;
+    string_t m_crashDumpPath;
+};
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_END
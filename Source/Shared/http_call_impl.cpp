@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "http_call_impl.h"
+#include "flight_recorder.h"
 #include "utils.h"
 #include "user_context.h"
 #include "xbox_system_factory.h"
@@ -47,6 +48,21 @@ std::shared_ptr<http_call> create_xbox_live_http_call(
         );
 }
 
+void move_request_body(
+    _In_ const std::shared_ptr<http_call>& httpCall,
+    _In_ std::vector<uint8_t>&& body
+    )
+{
+    auto httpCallInternal = std::dynamic_pointer_cast<http_call_internal>(httpCall);
+    if (httpCallInternal != nullptr)
+    {
+        httpCallInternal->set_request_body(std::move(body));
+    }
+    else
+    {
+        httpCall->set_request_body(body);
+    }
+}
 
 http_call_impl::http_call_impl() :
     m_httpCallData(std::make_shared<http_call_data>(nullptr, string_t(), string_t(), string_t(), xbox_live_api::unspecified))
@@ -322,17 +338,48 @@ http_call_impl::internal_get_response(
         }
     }
 
+    auto healthManager = http_endpoint_health_manager::get_http_endpoint_health_manager_singleton();
+    if (!healthManager->try_begin_request(httpCallData->serverName))
+    {
+        return handle_circuit_open(httpCallData);
+    }
+
     set_http_timeout(httpCallData, requestStartTime);
     http_client_config config = get_config(httpCallData);
     set_user_agent(httpCallData);
     
-    auto factory = xbox_system_factory::get_factory();
-    std::shared_ptr<xbox_http_client> client = factory->create_http_client(httpCallData->serverName, config);
+    std::shared_ptr<xbox_http_client> client = http_client_pool::get_http_client_pool_singleton()->get_client(httpCallData->serverName, config);
+
+    // The call data's address pairs each attempt's start and completion in the record
+    uint32_t flightRecordId = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(httpCallData.get()));
+    flight_recorder::get_flight_recorder_singleton()->record(
+        flight_record_type::http_call_started,
+        static_cast<uint16_t>(httpCallData->xboxLiveApi),
+        flightRecordId,
+        httpCallData->iterationNumber
+        );
+
+    std::shared_ptr<trace_span> attemptSpan;
+    if (span_tracer::is_enabled())
+    {
+        attemptSpan = std::make_shared<trace_span>(
+            utility::conversions::to_utf8string(httpCallData->httpMethod + _T(" ") + httpCallData->serverName + httpCallData->pathQueryFragment.path()),
+            httpCallData->traceContext
+            );
+    }
 
-    return client->get_request(httpCallData->request)
-    .then([httpCallData, requestStartTime](pplx::task<http_response> t)
+    auto timeoutToken = http_client_pool::create_timeout_token(httpCallData->httpTimeout);
+    return client->get_request(httpCallData->request, timeoutToken)
+    .then([httpCallData, requestStartTime, flightRecordId, attemptSpan, timeoutToken](pplx::task<http_response> t)
     {
         chrono_clock_t::time_point responseReceivedTime = chrono_clock_t::now();
+        if (attemptSpan != nullptr)
+        {
+            attemptSpan->end();
+        }
+
+        // Work started from here, such as a retry after a 401, belongs to the caller's trace
+        trace_context_scope traceScope(httpCallData->traceContext);
         http_response httpResponse;
         xbox_live_error_code networkError = xbox_live_error_code::no_error;
         std::string errMessage;
@@ -347,11 +394,46 @@ http_call_impl::internal_get_response(
             errMessage = ex.what();
         }
 
+        // Report our own timeout the way the transport reports one, so it is retried the same way
+        if (networkError != xbox_live_error_code::no_error && timeoutToken.is_canceled())
+        {
+            networkError = xbox_live_error_code::HR_ERROR_INTERNET_TIMEOUT;
+            errMessage = "request timed out";
+        }
+
+        flight_recorder::get_flight_recorder_singleton()->record(
+            flight_record_type::http_call_completed,
+            static_cast<uint16_t>(httpCallData->xboxLiveApi),
+            flightRecordId,
+            networkError == xbox_live_error_code::no_error ? httpResponse.status_code() : 0,
+            static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(responseReceivedTime - requestStartTime).count())
+            );
+
+        auto healthManager = http_endpoint_health_manager::get_http_endpoint_health_manager_singleton();
+        if (http_endpoint_health_manager::is_endpoint_failure(httpResponse.status_code(), networkError))
+        {
+            healthManager->record_failure(httpCallData->serverName);
+        }
+        else
+        {
+            healthManager->record_success(httpCallData->serverName);
+        }
+
         auto httpCallResponse = get_http_call_response(httpCallData, httpResponse);
         httpCallResponse->_Set_error_info(std::make_error_code(get_xbox_live_error_code_from_http_status(httpResponse.status_code())), std::string());
         httpCallResponse->_Set_timing(requestStartTime, responseReceivedTime);
 
         auto shouldRetry = should_retry(httpCallResponse, httpCallData, networkError);
+
+        // A 401 retry is a token refresh, not more load on a struggling host, so it isn't budgeted
+        if (shouldRetry &&
+            httpResponse.status_code() != web::http::status_codes::Unauthorized &&
+            !healthManager->try_consume_retry(httpCallData->serverName))
+        {
+            LOGS_INFO << "http_call_impl: not retrying " << httpCallData->serverName << ", retry budget exhausted";
+            shouldRetry = false;
+        }
+
         if (shouldRetry)
         {
             httpCallResponse->_Route_service_call();
@@ -488,6 +570,13 @@ void http_call_impl::set_request_body(
     m_httpCallData->requestBody = http_call_request_message(value);
 }
 
+void http_call_impl::set_request_body(
+    _In_ std::vector<uint8_t>&& value
+    )
+{
+    m_httpCallData->requestBody = http_call_request_message(std::move(value));
+}
+
 void http_call_impl::set_request_body(
     _In_ const web::json::value& value
     )
@@ -800,9 +889,16 @@ http_call_impl::handle_vector_body_response(
 http_client_config http_call_impl::get_config(
     _In_ const std::shared_ptr<http_call_data>& httpCallData
     )
+{
+    return create_client_config(httpCallData->httpTimeout);
+}
+
+http_client_config http_call_impl::create_client_config(
+    _In_ std::chrono::seconds httpTimeout
+    )
 {
     http_client_config config;
-    config.set_timeout(httpCallData->httpTimeout);
+    config.set_timeout(httpTimeout);
     auto proxyUri = xbox_live_app_config::get_app_config_singleton()->_Proxy();
     if (!proxyUri.is_empty())
     {
@@ -899,6 +995,21 @@ http_call_impl::handle_fast_fail(
     return pplx::task_from_result<std::shared_ptr<http_call_response>>(httpCallResponse);
 }
 
+pplx::task<std::shared_ptr<http_call_response>>
+http_call_impl::handle_circuit_open(
+    _In_ const std::shared_ptr<http_call_data>& httpCallData
+    )
+{
+    auto httpCallResponse = get_http_call_response(httpCallData, http_response());
+
+    httpCallResponse->_Set_error_info(
+        std::make_error_code(xbox_live_error_code::http_endpoint_circuit_open),
+        "Endpoint " + utility::conversions::to_utf8string(httpCallData->serverName) + " is failing, request not sent"
+        );
+    httpCallResponse->_Route_service_call();
+    return pplx::task_from_result<std::shared_ptr<http_call_response>>(httpCallResponse);
+}
+
 void http_call_impl::set_http_timeout(
     _In_ const std::shared_ptr<http_call_data>& httpCallData,
     _In_ const chrono_clock_t::time_point& currentTime
@@ -912,20 +1023,28 @@ void http_call_impl::set_http_timeout(
     }
     else
     {
-        // For all other calls, set the timeout to be how much time left before hitting the http_timeout_window setting with a min of 5 seconds
         std::chrono::milliseconds timeElapsedSinceFirstCall = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - httpCallData->firstCallStartTime);
-        std::chrono::seconds remainingTimeBeforeTimeout = std::chrono::duration_cast<std::chrono::seconds>(httpCallData->xboxLiveContextSettings->http_timeout_window() - timeElapsedSinceFirstCall);
-        uint64_t secondsLeft = __min(DEFAULT_HTTP_TIMEOUT_SECONDS, remainingTimeBeforeTimeout.count());
-        uint64_t secondsLeftCapped = __max(MIN_HTTP_TIMEOUT_SECONDS, secondsLeft);
-        httpCallData->httpTimeout = std::chrono::seconds(secondsLeftCapped);
+        httpCallData->httpTimeout = get_http_timeout(httpCallData->xboxLiveContextSettings, timeElapsedSinceFirstCall);
     }
 }
 
+std::chrono::seconds http_call_impl::get_http_timeout(
+    _In_ const std::shared_ptr<xbox_live_context_settings>& xboxLiveContextSettings,
+    _In_ std::chrono::milliseconds timeElapsedSinceFirstCall
+    )
+{
+    // Set the timeout to be how much time left before hitting the http_timeout_window setting with a min of 5 seconds
+    std::chrono::seconds remainingTimeBeforeTimeout = std::chrono::duration_cast<std::chrono::seconds>(xboxLiveContextSettings->http_timeout_window() - timeElapsedSinceFirstCall);
+    uint64_t secondsLeft = __min(DEFAULT_HTTP_TIMEOUT_SECONDS, remainingTimeBeforeTimeout.count());
+    uint64_t secondsLeftCapped = __max(MIN_HTTP_TIMEOUT_SECONDS, secondsLeft);
+    return std::chrono::seconds(secondsLeftCapped);
+}
+
 std::shared_ptr<http_retry_after_manager>
 http_retry_after_manager::get_http_retry_after_manager_singleton()
 {
     auto xsapiSingleton = xbox::services::get_xsapi_singleton();
-    std::lock_guard<std::mutex> guard(xsapiSingleton->m_singletonLock);
+    std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_singletonLock);
     if (xsapiSingleton->m_httpRetryPolicyManagerSingleton == nullptr)
     {
         xsapiSingleton->m_httpRetryPolicyManagerSingleton = std::make_shared<http_retry_after_manager>();
@@ -939,7 +1058,7 @@ void http_retry_after_manager::set_state(
     _In_ const http_retry_after_api_state& state
     )
 {
-    std::lock_guard<std::mutex> lock(m_lock.get()); // STL is not safe for multithreaded writes
+    std::lock_guard<xsapi_mutex> lock(m_lock.get()); // STL is not safe for multithreaded writes
     m_apiStateMap[static_cast<uint32_t>(xboxLiveApi)] = state;
 }
 
@@ -947,7 +1066,7 @@ void http_retry_after_manager::clear_state(
     _In_ xbox_live_api xboxLiveApi
     )
 {
-    std::lock_guard<std::mutex> lock(m_lock.get()); // STL is not safe for multithreaded writes
+    std::lock_guard<xsapi_mutex> lock(m_lock.get()); // STL is not safe for multithreaded writes
     m_apiStateMap.erase(static_cast<uint32_t>(xboxLiveApi));
 }
 
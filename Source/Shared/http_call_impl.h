@@ -6,6 +6,7 @@
 #include "http_call_response.h"
 #include "http_client.h"
 #include "system_internal.h"
+#include "span_tracer.h"
 
 #if XSAPI_U
 #include "signature_policy.h"
@@ -129,7 +130,8 @@ struct http_call_data
         httpTimeout(std::chrono::seconds(DEFAULT_HTTP_TIMEOUT_SECONDS)),
         contentTypeHeaderValue(_T("application/json; charset=utf-8")),
         xboxContractVersionHeaderValue(_T("1")),
-        addDefaultHeaders(true)
+        addDefaultHeaders(true),
+        traceContext(span_tracer::current_context())
     {
         delayBeforeRetry = xboxLiveContextSettings->http_retry_delay();
     }
@@ -157,6 +159,9 @@ struct http_call_data
     http_call_response_body_type httpCallResponseBodyType;
     http_call_request_message requestBody;
     bool addDefaultHeaders;
+
+    // The span current when the call was created. Each attempt is a child span of it.
+    trace_context traceContext;
 };
 
 struct http_retry_after_api_state
@@ -198,6 +203,11 @@ public:
 
     virtual const http_call_request_message& request_body() const = 0;
 
+    using http_call::set_request_body;
+
+    // Takes the body over instead of copying it
+    virtual void set_request_body(_In_ std::vector<uint8_t>&& value) = 0;
+
 #if XSAPI_U
     /// <summary>
     /// Sign the request and get the response. Used for auth services.
@@ -210,6 +220,13 @@ public:
 #endif
 };
 
+// Moves a body built for the call, e.g. a json_writer's output, into it. Every call xbox_system_factory
+// creates is an http_call_internal; anything else gets a copy.
+void move_request_body(
+    _In_ const std::shared_ptr<http_call>& httpCall,
+    _In_ std::vector<uint8_t>&& body
+    );
+
 class http_retry_after_manager
 {
 public:
@@ -229,10 +246,112 @@ public:
         );
 
 private:
-    xbox::services::system::xbox_live_mutex m_lock;
+    xbox::services::system::xbox_live_mutex m_lock XSAPI_LOCK_SITE("http_retry_after_manager::m_lock");
     std::unordered_map<uint32_t, http_retry_after_api_state> m_apiStateMap;
 };
 
+enum class http_circuit_state
+{
+    // Requests flow normally
+    closed,
+
+    // Recent requests kept failing, so requests fail fast without being sent
+    open,
+
+    // The open period has passed and a single probe request decides whether to close again
+    half_open
+};
+
+struct http_endpoint_health_stats
+{
+    http_endpoint_health_stats() :
+        state(http_circuit_state::closed),
+        stateTransitionCount(0),
+        timesOpened(0),
+        fastFailCount(0),
+        retriesDenied(0)
+    {
+    }
+
+    http_circuit_state state;
+    uint32_t stateTransitionCount;
+    uint32_t timesOpened;
+    uint32_t fastFailCount;
+    uint32_t retriesDenied;
+};
+
+// Tracks the health of each endpoint (host) across all calls. During an outage every caller backing off
+// on its own still multiplies the load on the failing host, so retries are budgeted per host against
+// recent successes, and a circuit breaker stops sending to a host that keeps failing until it recovers.
+class http_endpoint_health_manager
+{
+public:
+    static std::shared_ptr<http_endpoint_health_manager> get_http_endpoint_health_manager_singleton();
+
+    http_endpoint_health_manager();
+
+    // Returns false if the request should fail fast because the endpoint's circuit is open.
+    // While half open, only one probe request at a time is let through.
+    bool try_begin_request(_In_ const string_t& endpoint);
+
+    void record_success(_In_ const string_t& endpoint);
+    void record_failure(_In_ const string_t& endpoint);
+
+    // Takes a retry from the endpoint's budget. Returns false if the endpoint is out of retries.
+    bool try_consume_retry(_In_ const string_t& endpoint);
+
+    http_endpoint_health_stats stats(_In_ const string_t& endpoint);
+
+    void set_open_duration(_In_ std::chrono::milliseconds openDuration);
+    void reset();
+
+    // Whether a response means the endpoint itself is in trouble, as opposed to a bad request
+    static bool is_endpoint_failure(
+        _In_ uint32_t httpStatus,
+        _In_ xbox_live_error_code networkError
+        );
+
+    static const uint32_t FAILURE_THRESHOLD;
+    static const std::chrono::milliseconds DEFAULT_OPEN_DURATION;
+    static const std::chrono::seconds RETRY_BUDGET_WINDOW;
+    static const uint32_t RETRY_BUDGET_PERCENT;
+    static const uint32_t MIN_RETRIES_PER_WINDOW;
+
+private:
+    struct window_bucket
+    {
+        int64_t second;
+        uint32_t successes;
+        uint32_t retries;
+    };
+
+    struct endpoint_state
+    {
+        endpoint_state();
+
+        http_endpoint_health_stats stats;
+        uint32_t consecutiveFailures;
+        bool probeInFlight;
+        chrono_clock_t::time_point openedTime;
+        std::vector<window_bucket> buckets;
+    };
+
+    window_bucket& current_bucket(
+        _In_ endpoint_state& state,
+        _In_ const chrono_clock_t::time_point& now
+        );
+
+    void transition(
+        _In_ const string_t& endpoint,
+        _In_ endpoint_state& state,
+        _In_ http_circuit_state newState
+        );
+
+    xsapi_mutex m_lock XSAPI_LOCK_SITE("http_endpoint_health_manager::m_lock");
+    std::chrono::milliseconds m_openDuration;
+    std::unordered_map<string_t, endpoint_state> m_endpoints;
+};
+
 class http_call_impl : public http_call_internal, public std::enable_shared_from_this<http_call_impl>
 {
 public:
@@ -320,6 +439,7 @@ public:
     void set_request_body(_In_ const string_t& value) override;
     void set_request_body(_In_ const web::json::value& value) override;
     void set_request_body(_In_ const std::vector<uint8_t>& value) override;
+    void set_request_body(_In_ std::vector<uint8_t>&& value) override;
     const http_call_request_message& request_body() const override;
 
     void set_content_type_header_value(_In_ const string_t& value) override;
@@ -335,6 +455,17 @@ public:
 
     web::http::http_request get_default_request() override;
 
+    // Config for an attempt with the given timeout. Attempts with equal configs share a pooled client.
+    static web::http::client::http_client_config create_client_config(
+        _In_ std::chrono::seconds httpTimeout
+        );
+
+    // Timeout for an attempt made timeElapsedSinceFirstCall after the call's first attempt
+    static std::chrono::seconds get_http_timeout(
+        _In_ const std::shared_ptr<xbox_live_context_settings>& xboxLiveContextSettings,
+        _In_ std::chrono::milliseconds timeElapsedSinceFirstCall
+        );
+
 private:
     NO_COPY_AND_ASSIGN(http_call_impl);
 
@@ -399,6 +530,10 @@ private:
         _In_ const chrono_clock_t::time_point& currentTime
         );
 
+    static pplx::task<std::shared_ptr<http_call_response>> handle_circuit_open(
+        _In_ const std::shared_ptr<http_call_data>& httpCallData
+        );
+
     static pplx::task<std::shared_ptr<http_call_response>> handle_fast_fail(
         _In_ const http_retry_after_api_state& apiState,
         _In_ const std::shared_ptr<http_call_data>& httpCallData
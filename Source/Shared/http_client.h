@@ -32,4 +32,60 @@ private:
     std::shared_ptr<web::http::client::http_client> m_client;
 };
 
+// Keeps one client per host (and proxy) so that requests after the first reuse the client's already
+// resolved, already handshaken keep-alive connection instead of paying for DNS resolution and the TLS
+// handshake again. A client is dropped once it is older than its TTL, so a host's address is resolved
+// afresh now and then even while the host is busy. Hosts that couldn't be reached during a pre-warm are remembered for NEGATIVE_TTL
+// and skipped by later pre-warms.
+class http_client_pool
+{
+public:
+    static std::shared_ptr<http_client_pool> get_http_client_pool_singleton();
+
+    http_client_pool();
+
+    std::shared_ptr<xbox_http_client> get_client(
+        _In_ const string_t& serverName,
+        _In_ const web::http::client::http_client_config& clientConfig
+        );
+
+    // Opens a connection to each host in parallel. Completes once every host has answered or failed.
+    pplx::task<void> prewarm(
+        _In_ const std::vector<string_t>& serverNames,
+        _In_ const web::http::client::http_client_config& clientConfig
+        );
+
+    // Cancels after the timeout. Pooled clients are shared by calls with different timeouts, so each
+    // request passes one of these rather than relying on the client config's timeout.
+    static pplx::cancellation_token create_timeout_token(_In_ std::chrono::milliseconds timeout);
+
+    bool is_warm(_In_ const string_t& serverName);
+    bool is_unreachable(_In_ const string_t& serverName);
+
+    void set_client_ttl(_In_ std::chrono::milliseconds clientTtl);
+    void reset();
+
+    static const std::chrono::milliseconds DEFAULT_CLIENT_TTL;
+    static const std::chrono::milliseconds NEGATIVE_TTL;
+    static const std::chrono::seconds TRANSPORT_TIMEOUT;
+
+private:
+    struct pooled_client
+    {
+        string_t serverName;
+        std::shared_ptr<xbox_http_client> client;
+        chrono_clock_t::time_point created;
+    };
+
+    static string_t client_key(
+        _In_ const string_t& serverName,
+        _In_ const web::http::client::http_client_config& clientConfig
+        );
+
+    xsapi_mutex m_lock XSAPI_LOCK_SITE("http_client_pool::m_lock");
+    std::chrono::milliseconds m_clientTtl;
+    std::unordered_map<string_t, pooled_client> m_clients;
+    std::unordered_map<string_t, chrono_clock_t::time_point> m_unreachableHosts;
+};
+
 NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_END
@@ -0,0 +1,208 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#include "http_client.h"
+#include "xbox_system_factory.h"
+#include "utils.h"
+#if !XSAPI_U
+#include "ppltasks_extra.h"
+#else
+#include "ppltasks_extra_unix.h"
+#endif
+
+using namespace Concurrency::extras;
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_BEGIN
+
+// Most platforms drop idle keep-alive connections within a couple of minutes anyway
+const std::chrono::milliseconds http_client_pool::DEFAULT_CLIENT_TTL = std::chrono::seconds(60);
+const std::chrono::milliseconds http_client_pool::NEGATIVE_TTL = std::chrono::seconds(30);
+// Callers time out each request themselves, so the transport's own timeout is only a backstop
+const std::chrono::seconds http_client_pool::TRANSPORT_TIMEOUT = std::chrono::hours(1);
+
+std::shared_ptr<http_client_pool>
+http_client_pool::get_http_client_pool_singleton()
+{
+    auto xsapiSingleton = xbox::services::get_xsapi_singleton();
+    std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_singletonLock);
+    if (xsapiSingleton->m_httpClientPoolSingleton == nullptr)
+    {
+        xsapiSingleton->m_httpClientPoolSingleton = std::make_shared<http_client_pool>();
+    }
+
+    return xsapiSingleton->m_httpClientPoolSingleton;
+}
+
+http_client_pool::http_client_pool() :
+    m_clientTtl(DEFAULT_CLIENT_TTL)
+{
+}
+
+std::shared_ptr<xbox_http_client>
+http_client_pool::get_client(
+    _In_ const string_t& serverName,
+    _In_ const web::http::client::http_client_config& clientConfig
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    auto now = chrono_clock_t::now();
+    string_t key = client_key(serverName, clientConfig);
+
+    auto pooledClient = m_clients.find(key);
+    if (pooledClient != m_clients.end() && now - pooledClient->second.created < m_clientTtl)
+    {
+        return pooledClient->second.client;
+    }
+
+    // Drop everything that has expired while we're here, so hosts that are no longer called don't pile up
+    for (auto it = m_clients.begin(); it != m_clients.end();)
+    {
+        if (now - it->second.created >= m_clientTtl)
+        {
+            it = m_clients.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    web::http::client::http_client_config transportConfig = clientConfig;
+    transportConfig.set_timeout(TRANSPORT_TIMEOUT);
+
+    pooled_client newClient;
+    newClient.serverName = serverName;
+    newClient.client = xbox::services::system::xbox_system_factory::get_factory()->create_http_client(serverName, transportConfig);
+    newClient.created = now;
+    m_clients[key] = newClient;
+    return newClient.client;
+}
+
+pplx::task<void>
+http_client_pool::prewarm(
+    _In_ const std::vector<string_t>& serverNames,
+    _In_ const web::http::client::http_client_config& clientConfig
+    )
+{
+    std::vector<pplx::task<void>> tasks;
+    for (const auto& serverName : serverNames)
+    {
+        if (is_unreachable(serverName))
+        {
+            LOGS_DEBUG << "http_client_pool: skipping pre-warm of unreachable " << serverName;
+            continue;
+        }
+
+        if (is_warm(serverName))
+        {
+            continue;
+        }
+
+        // Any response at all means the connection is up; the status code doesn't matter
+        web::http::http_request request(web::http::methods::HEAD);
+        request.set_request_uri(_T("/"));
+
+        auto startTime = chrono_clock_t::now();
+        tasks.push_back(get_client(serverName, clientConfig)->get_request(request, create_timeout_token(clientConfig.timeout()))
+        .then([serverName, startTime](pplx::task<web::http::http_response> t)
+        {
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(chrono_clock_t::now() - startTime);
+            auto pool = get_http_client_pool_singleton();
+            try
+            {
+                t.get();
+                LOGS_INFO << "http_client_pool: pre-warmed " << serverName << " in " << elapsed.count() << "ms";
+            }
+            catch (...)
+            {
+                LOGS_INFO << "http_client_pool: failed to pre-warm " << serverName << " after " << elapsed.count() << "ms";
+                std::lock_guard<xsapi_mutex> lock(pool->m_lock);
+                pool->m_unreachableHosts[serverName] = chrono_clock_t::now();
+            }
+        }));
+    }
+
+    return pplx::when_all(tasks.begin(), tasks.end());
+}
+
+bool
+http_client_pool::is_warm(
+    _In_ const string_t& serverName
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    auto now = chrono_clock_t::now();
+    for (const auto& pooledClient : m_clients)
+    {
+        if (pooledClient.second.serverName == serverName && now - pooledClient.second.created < m_clientTtl)
+        {
+            return m_unreachableHosts.find(serverName) == m_unreachableHosts.end();
+        }
+    }
+    return false;
+}
+
+bool
+http_client_pool::is_unreachable(
+    _In_ const string_t& serverName
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    auto unreachableHost = m_unreachableHosts.find(serverName);
+    if (unreachableHost == m_unreachableHosts.end())
+    {
+        return false;
+    }
+
+    if (chrono_clock_t::now() - unreachableHost->second >= NEGATIVE_TTL)
+    {
+        m_unreachableHosts.erase(unreachableHost);
+        return false;
+    }
+    return true;
+}
+
+pplx::cancellation_token
+http_client_pool::create_timeout_token(
+    _In_ std::chrono::milliseconds timeout
+    )
+{
+    pplx::cancellation_token_source timeoutSource;
+    create_delayed_task(timeout, [timeoutSource]()
+    {
+        timeoutSource.cancel();
+    });
+    return timeoutSource.get_token();
+}
+
+void
+http_client_pool::set_client_ttl(
+    _In_ std::chrono::milliseconds clientTtl
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    m_clientTtl = clientTtl;
+}
+
+void
+http_client_pool::reset()
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    m_clients.clear();
+    m_unreachableHosts.clear();
+    m_clientTtl = DEFAULT_CLIENT_TTL;
+}
+
+string_t
+http_client_pool::client_key(
+    _In_ const string_t& serverName,
+    _In_ const web::http::client::http_client_config& clientConfig
+    )
+{
+    stringstream_t key;
+    key << serverName << _T("|") << clientConfig.proxy().address().to_string();
+    return key.str();
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_END
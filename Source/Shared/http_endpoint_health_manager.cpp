@@ -0,0 +1,245 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#include "http_call_impl.h"
+#include "utils.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_BEGIN
+
+// Enough consecutive failures that a single dropped connection doesn't trip the breaker
+const uint32_t http_endpoint_health_manager::FAILURE_THRESHOLD = 5;
+const std::chrono::milliseconds http_endpoint_health_manager::DEFAULT_OPEN_DURATION = std::chrono::seconds(30);
+
+// Retries against a host are capped at 20% of its recent successes, with a small floor so a
+// title that has only just started talking to a host can still retry
+const std::chrono::seconds http_endpoint_health_manager::RETRY_BUDGET_WINDOW = std::chrono::seconds(10);
+const uint32_t http_endpoint_health_manager::RETRY_BUDGET_PERCENT = 20;
+const uint32_t http_endpoint_health_manager::MIN_RETRIES_PER_WINDOW = 10;
+
+static const char* circuit_state_name(
+    _In_ http_circuit_state state
+    )
+{
+    switch (state)
+    {
+        case http_circuit_state::open: return "open";
+        case http_circuit_state::half_open: return "half_open";
+        case http_circuit_state::closed:
+        default: return "closed";
+    }
+}
+
+std::shared_ptr<http_endpoint_health_manager>
+http_endpoint_health_manager::get_http_endpoint_health_manager_singleton()
+{
+    auto xsapiSingleton = xbox::services::get_xsapi_singleton();
+    std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_singletonLock);
+    if (xsapiSingleton->m_httpEndpointHealthManagerSingleton == nullptr)
+    {
+        xsapiSingleton->m_httpEndpointHealthManagerSingleton = std::make_shared<http_endpoint_health_manager>();
+    }
+
+    return xsapiSingleton->m_httpEndpointHealthManagerSingleton;
+}
+
+http_endpoint_health_manager::endpoint_state::endpoint_state() :
+    consecutiveFailures(0),
+    probeInFlight(false),
+    buckets(static_cast<size_t>(RETRY_BUDGET_WINDOW.count()))
+{
+    for (auto& bucket : buckets)
+    {
+        bucket.second = -1;
+        bucket.successes = 0;
+        bucket.retries = 0;
+    }
+}
+
+http_endpoint_health_manager::http_endpoint_health_manager() :
+    m_openDuration(DEFAULT_OPEN_DURATION)
+{
+}
+
+bool
+http_endpoint_health_manager::try_begin_request(
+    _In_ const string_t& endpoint
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    auto& state = m_endpoints[endpoint];
+    switch (state.stats.state)
+    {
+        case http_circuit_state::open:
+            if (chrono_clock_t::now() - state.openedTime < m_openDuration)
+            {
+                ++state.stats.fastFailCount;
+                return false;
+            }
+
+            transition(endpoint, state, http_circuit_state::half_open);
+            state.probeInFlight = true;
+            return true;
+
+        case http_circuit_state::half_open:
+            if (state.probeInFlight)
+            {
+                ++state.stats.fastFailCount;
+                return false;
+            }
+
+            state.probeInFlight = true;
+            return true;
+
+        case http_circuit_state::closed:
+        default:
+            return true;
+    }
+}
+
+void
+http_endpoint_health_manager::record_success(
+    _In_ const string_t& endpoint
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    auto& state = m_endpoints[endpoint];
+    ++current_bucket(state, chrono_clock_t::now()).successes;
+    state.consecutiveFailures = 0;
+    state.probeInFlight = false;
+    if (state.stats.state != http_circuit_state::closed)
+    {
+        transition(endpoint, state, http_circuit_state::closed);
+    }
+}
+
+void
+http_endpoint_health_manager::record_failure(
+    _In_ const string_t& endpoint
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    auto& state = m_endpoints[endpoint];
+    ++state.consecutiveFailures;
+
+    // A failed probe reopens the circuit for another full period
+    bool failedProbe = state.stats.state == http_circuit_state::half_open;
+    state.probeInFlight = false;
+    if (failedProbe || (state.stats.state == http_circuit_state::closed && state.consecutiveFailures >= FAILURE_THRESHOLD))
+    {
+        state.openedTime = chrono_clock_t::now();
+        transition(endpoint, state, http_circuit_state::open);
+    }
+}
+
+bool
+http_endpoint_health_manager::try_consume_retry(
+    _In_ const string_t& endpoint
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    auto& state = m_endpoints[endpoint];
+    auto now = chrono_clock_t::now();
+
+    // Touch the current bucket first so stale buckets are cleared before they are counted
+    window_bucket& bucket = current_bucket(state, now);
+    int64_t nowSecond = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
+    uint64_t successes = 0;
+    uint64_t retries = 0;
+    for (const auto& windowBucket : state.buckets)
+    {
+        if (windowBucket.second > nowSecond - RETRY_BUDGET_WINDOW.count())
+        {
+            successes += windowBucket.successes;
+            retries += windowBucket.retries;
+        }
+    }
+
+    uint64_t retryBudget = MIN_RETRIES_PER_WINDOW + successes * RETRY_BUDGET_PERCENT / 100;
+    if (retries >= retryBudget)
+    {
+        ++state.stats.retriesDenied;
+        LOGS_DEBUG << "http_endpoint_health_manager: retry budget exhausted for " << endpoint << " (" << retries << " retries, " << successes << " successes)";
+        return false;
+    }
+
+    ++bucket.retries;
+    return true;
+}
+
+http_endpoint_health_stats
+http_endpoint_health_manager::stats(
+    _In_ const string_t& endpoint
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    auto state = m_endpoints.find(endpoint);
+    return state == m_endpoints.end() ? http_endpoint_health_stats() : state->second.stats;
+}
+
+void
+http_endpoint_health_manager::set_open_duration(
+    _In_ std::chrono::milliseconds openDuration
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    m_openDuration = openDuration;
+}
+
+void
+http_endpoint_health_manager::reset()
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    m_endpoints.clear();
+    m_openDuration = DEFAULT_OPEN_DURATION;
+}
+
+bool
+http_endpoint_health_manager::is_endpoint_failure(
+    _In_ uint32_t httpStatus,
+    _In_ xbox_live_error_code networkError
+    )
+{
+    // 429 is the service pacing this caller, which http_retry_after_manager already handles per API
+    return networkError != xbox_live_error_code::no_error ||
+        httpStatus == web::http::status_codes::InternalError ||
+        httpStatus == web::http::status_codes::BadGateway ||
+        httpStatus == web::http::status_codes::ServiceUnavailable ||
+        httpStatus == web::http::status_codes::GatewayTimeout;
+}
+
+http_endpoint_health_manager::window_bucket&
+http_endpoint_health_manager::current_bucket(
+    _In_ endpoint_state& state,
+    _In_ const chrono_clock_t::time_point& now
+    )
+{
+    int64_t nowSecond = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
+    window_bucket& bucket = state.buckets[static_cast<size_t>(nowSecond % static_cast<int64_t>(state.buckets.size()))];
+    if (bucket.second != nowSecond)
+    {
+        bucket.second = nowSecond;
+        bucket.successes = 0;
+        bucket.retries = 0;
+    }
+    return bucket;
+}
+
+void
+http_endpoint_health_manager::transition(
+    _In_ const string_t& endpoint,
+    _In_ endpoint_state& state,
+    _In_ http_circuit_state newState
+    )
+{
+    LOGS_INFO << "http_endpoint_health_manager: circuit for " << endpoint << " " << circuit_state_name(state.stats.state) << " -> " << circuit_state_name(newState);
+
+    state.stats.state = newState;
+    ++state.stats.stateTransitionCount;
+    if (newState == http_circuit_state::open)
+    {
+        ++state.stats.timesOpened;
+    }
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_END
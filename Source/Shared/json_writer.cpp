@@ -0,0 +1,289 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#include "json_writer.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_BEGIN
+
+// Enough for most request bodies to be written without growing the buffer
+static const size_t DEFAULT_INITIAL_CAPACITY = 256;
+
+json_writer::json_writer() :
+    json_writer(DEFAULT_INITIAL_CAPACITY)
+{
+}
+
+json_writer::json_writer(
+    _In_ size_t initialCapacity
+    ) :
+    m_afterKey(false)
+{
+    m_buffer.reserve(initialCapacity);
+}
+
+void
+json_writer::start_object()
+{
+    start_value();
+    m_buffer.push_back('{');
+    m_hasValue.push_back(false);
+}
+
+void
+json_writer::end_object()
+{
+    m_hasValue.pop_back();
+    m_buffer.push_back('}');
+}
+
+void
+json_writer::start_array()
+{
+    start_value();
+    m_buffer.push_back('[');
+    m_hasValue.push_back(false);
+}
+
+void
+json_writer::end_array()
+{
+    m_hasValue.pop_back();
+    m_buffer.push_back(']');
+}
+
+void
+json_writer::write_key(
+    _In_ const char_t* key
+    )
+{
+    start_value();
+    write_escaped(key, std::char_traits<char_t>::length(key));
+    m_buffer.push_back(':');
+    m_afterKey = true;
+}
+
+void
+json_writer::write_key(
+    _In_ const string_t& key
+    )
+{
+    start_value();
+    write_escaped(key.c_str(), key.size());
+    m_buffer.push_back(':');
+    m_afterKey = true;
+}
+
+void
+json_writer::write_string(
+    _In_ const char_t* value
+    )
+{
+    start_value();
+    write_escaped(value, std::char_traits<char_t>::length(value));
+}
+
+void
+json_writer::write_string(
+    _In_ const string_t& value
+    )
+{
+    start_value();
+    write_escaped(value.c_str(), value.size());
+}
+
+void
+json_writer::write_number(
+    _In_ double value
+    )
+{
+    start_value();
+
+    // Same format web::json::value uses for doubles
+    char number[std::numeric_limits<double>::digits10 + 10];
+    snprintf(number, sizeof(number), "%.*g", std::numeric_limits<double>::digits10 + 2, value);
+    write_raw(number);
+}
+
+void
+json_writer::write_number(
+    _In_ int64_t value
+    )
+{
+    start_value();
+    char number[std::numeric_limits<int64_t>::digits10 + 3];
+    snprintf(number, sizeof(number), "%lld", static_cast<long long>(value));
+    write_raw(number);
+}
+
+void
+json_writer::write_number(
+    _In_ uint64_t value
+    )
+{
+    start_value();
+    char number[std::numeric_limits<uint64_t>::digits10 + 3];
+    snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(value));
+    write_raw(number);
+}
+
+void
+json_writer::write_bool(
+    _In_ bool value
+    )
+{
+    start_value();
+    write_raw(value ? "true" : "false");
+}
+
+void
+json_writer::write_null()
+{
+    start_value();
+    write_raw("null");
+}
+
+const std::vector<uint8_t>&
+json_writer::buffer() const
+{
+    return m_buffer;
+}
+
+void
+json_writer::reset()
+{
+    m_buffer.clear();
+    m_hasValue.clear();
+    m_afterKey = false;
+}
+
+std::vector<uint8_t>
+json_writer::take_buffer()
+{
+    std::vector<uint8_t> buffer(std::move(m_buffer));
+    reset();
+    return buffer;
+}
+
+void
+json_writer::start_value()
+{
+    if (m_afterKey)
+    {
+        m_afterKey = false;
+        return;
+    }
+
+    if (!m_hasValue.empty())
+    {
+        if (m_hasValue.back())
+        {
+            m_buffer.push_back(',');
+        }
+        m_hasValue.back() = true;
+    }
+}
+
+void
+json_writer::write_escaped(
+    _In_reads_(length) const char_t* value,
+    _In_ size_t length
+    )
+{
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+
+    m_buffer.push_back('"');
+    for (size_t i = 0; i < length; ++i)
+    {
+        uint32_t ch = static_cast<uint32_t>(value[i]);
+#ifdef _WIN32
+        ch &= 0xFFFF;
+#else
+        ch &= 0xFF;
+#endif
+        switch (ch)
+        {
+            case '"': write_raw("\\\""); break;
+            case '\\': write_raw("\\\\"); break;
+            case '\b': write_raw("\\b"); break;
+            case '\f': write_raw("\\f"); break;
+            case '\n': write_raw("\\n"); break;
+            case '\r': write_raw("\\r"); break;
+            case '\t': write_raw("\\t"); break;
+            default:
+                if (ch <= 0x1F)
+                {
+                    write_raw("\\u00");
+                    m_buffer.push_back(HEX_DIGITS[ch >> 4]);
+                    m_buffer.push_back(HEX_DIGITS[ch & 0x0F]);
+                }
+#ifdef _WIN32
+                else if (ch >= 0xD800 && ch <= 0xDBFF && i + 1 < length &&
+                    (value[i + 1] & 0xFC00) == 0xDC00)
+                {
+                    uint32_t low = static_cast<uint32_t>(value[++i]) & 0xFFFF;
+                    write_utf8(0x10000 + ((ch - 0xD800) << 10) + (low - 0xDC00));
+                }
+                else if (ch >= 0xD800 && ch <= 0xDFFF)
+                {
+                    // Unpaired surrogate; there is no UTF-8 for it
+                    write_utf8(0xFFFD);
+                }
+                else
+                {
+                    write_utf8(ch);
+                }
+#else
+                else
+                {
+                    // Already UTF-8
+                    m_buffer.push_back(static_cast<uint8_t>(ch));
+                }
+#endif
+                break;
+        }
+    }
+    m_buffer.push_back('"');
+}
+
+void
+json_writer::write_raw(
+    _In_z_ const char* value
+    )
+{
+    while (*value != '\0')
+    {
+        m_buffer.push_back(static_cast<uint8_t>(*value++));
+    }
+}
+
+void
+json_writer::write_utf8(
+    _In_ uint32_t codePoint
+    )
+{
+    if (codePoint < 0x80)
+    {
+        m_buffer.push_back(static_cast<uint8_t>(codePoint));
+    }
+    else if (codePoint < 0x800)
+    {
+        m_buffer.push_back(static_cast<uint8_t>(0xC0 | (codePoint >> 6)));
+        m_buffer.push_back(static_cast<uint8_t>(0x80 | (codePoint & 0x3F)));
+    }
+    else if (codePoint < 0x10000)
+    {
+        m_buffer.push_back(static_cast<uint8_t>(0xE0 | (codePoint >> 12)));
+        m_buffer.push_back(static_cast<uint8_t>(0x80 | ((codePoint >> 6) & 0x3F)));
+        m_buffer.push_back(static_cast<uint8_t>(0x80 | (codePoint & 0x3F)));
+    }
+    else
+    {
+        m_buffer.push_back(static_cast<uint8_t>(0xF0 | (codePoint >> 18)));
+        m_buffer.push_back(static_cast<uint8_t>(0x80 | ((codePoint >> 12) & 0x3F)));
+        m_buffer.push_back(static_cast<uint8_t>(0x80 | ((codePoint >> 6) & 0x3F)));
+        m_buffer.push_back(static_cast<uint8_t>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_END
@@ -0,0 +1,57 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+#include "xsapi/types.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_BEGIN
+
+// Writes JSON straight into a UTF-8 byte buffer, for request bodies that would otherwise be built as a
+// web::json::value tree only to be serialized and thrown away. Output matches web::json::value::serialize()
+// byte for byte, given the same values in the same order. Note that web::json::value sorts object keys,
+// so callers porting a serializer must write keys in sorted order to keep the output identical.
+class json_writer
+{
+public:
+    json_writer();
+    json_writer(_In_ size_t initialCapacity);
+
+    void start_object();
+    void end_object();
+    void start_array();
+    void end_array();
+
+    void write_key(_In_ const char_t* key);
+    void write_key(_In_ const string_t& key);
+
+    void write_string(_In_ const char_t* value);
+    void write_string(_In_ const string_t& value);
+    void write_number(_In_ double value);
+    void write_number(_In_ int64_t value);
+    void write_number(_In_ uint64_t value);
+    void write_bool(_In_ bool value);
+    void write_null();
+
+    // The JSON written so far, as UTF-8
+    const std::vector<uint8_t>& buffer() const;
+
+    // Clears the output but keeps the buffer's capacity, so one writer can serialize many requests
+    void reset();
+
+    // Moves the output out, e.g. into a request body, and leaves the writer empty
+    std::vector<uint8_t> take_buffer();
+
+private:
+    void start_value();
+    void write_escaped(_In_reads_(length) const char_t* value, _In_ size_t length);
+    void write_raw(_In_z_ const char* value);
+    void write_utf8(_In_ uint32_t codePoint);
+
+    std::vector<uint8_t> m_buffer;
+
+    // One entry per open object or array: whether it already holds a value, so the next one needs a comma
+    std::vector<bool> m_hasValue;
+    bool m_afterKey;
+};
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_END
@@ -22,7 +22,7 @@ std::shared_ptr<local_config> local_config::get_local_config_singleton()
     auto xsapiSingleton = get_xsapi_singleton();
     bool needToReadConfig = false;
     {
-        std::lock_guard<std::mutex> guard(xsapiSingleton->m_singletonLock);
+        std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_singletonLock);
         if (xsapiSingleton->m_localConfigSingleton == nullptr)
         {
             needToReadConfig = true; 
@@ -55,7 +55,7 @@ uint64_t local_config::get_uint64_from_config(
     _In_ uint64_t defaultValue
     )
 {
-    std::lock_guard<std::mutex> guard(m_jsonConfigLock);
+    std::lock_guard<xsapi_mutex> guard(m_jsonConfigLock);
     return utils::extract_json_uint52(m_jsonConfig, name.c_str(), required, defaultValue);
 }
 
@@ -65,7 +65,7 @@ string_t local_config::get_value_from_config(
     _In_ const string_t& defaultValue
     )
 {
-    std::lock_guard<std::mutex> guard(m_jsonConfigLock);
+    std::lock_guard<xsapi_mutex> guard(m_jsonConfigLock);
     return utils::extract_json_string(m_jsonConfig, name.c_str(), required, defaultValue);
 }
 
@@ -75,7 +75,7 @@ bool local_config::get_bool_from_config(
     _In_ bool defaultValue
     )
 {
-    std::lock_guard<std::mutex> guard(m_jsonConfigLock);
+    std::lock_guard<xsapi_mutex> guard(m_jsonConfigLock);
 
     std::error_code err;
     auto value = utils::extract_json_field(m_jsonConfig, name.c_str(), err, required);
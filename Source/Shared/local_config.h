@@ -72,10 +72,10 @@ protected:
     virtual xbox_live_result<void> read();
 
     web::json::value m_jsonConfig;
-    std::mutex m_jsonConfigLock;
+    xsapi_mutex m_jsonConfigLock XSAPI_LOCK_SITE("local_config::m_jsonConfigLock");
 #if XSAPI_U
     web::json::value m_jsonLocalStorage;
-    std::mutex m_jsonLocalStorageLock;
+    xsapi_mutex m_jsonLocalStorageLock XSAPI_LOCK_SITE("local_config::m_jsonLocalStorageLock");
 #endif
 #endif
 };
@@ -0,0 +1,178 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#include "lock_profiler.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_BEGIN
+
+lock_site::lock_site(
+    _In_ std::string name
+    ) :
+    m_name(std::move(name))
+{
+    reset();
+}
+
+void
+lock_site::record_acquire(
+    _In_ std::chrono::nanoseconds wait,
+    _In_ bool contended
+    )
+{
+    m_acquisitions.fetch_add(1, std::memory_order_relaxed);
+    if (!contended)
+    {
+        return;
+    }
+
+    int64_t waitNs = wait.count();
+    m_contendedAcquisitions.fetch_add(1, std::memory_order_relaxed);
+    m_totalWaitNs.fetch_add(waitNs, std::memory_order_relaxed);
+    update_max(m_maxWaitNs, waitNs);
+
+    size_t bucket = 0;
+    for (int64_t waitUs = waitNs / 1000; waitUs > 0 && bucket < lock_site_stats::WAIT_HISTOGRAM_BUCKETS - 1; waitUs >>= 1)
+    {
+        ++bucket;
+    }
+    m_waitHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+lock_site::record_release(
+    _In_ std::chrono::nanoseconds hold
+    )
+{
+    m_totalHoldNs.fetch_add(hold.count(), std::memory_order_relaxed);
+    update_max(m_maxHoldNs, hold.count());
+}
+
+lock_site_stats
+lock_site::stats() const
+{
+    lock_site_stats stats;
+    stats.name = m_name;
+    stats.acquisitions = m_acquisitions.load(std::memory_order_relaxed);
+    stats.contendedAcquisitions = m_contendedAcquisitions.load(std::memory_order_relaxed);
+    stats.totalWait = std::chrono::nanoseconds(m_totalWaitNs.load(std::memory_order_relaxed));
+    stats.maxWait = std::chrono::nanoseconds(m_maxWaitNs.load(std::memory_order_relaxed));
+    stats.totalHold = std::chrono::nanoseconds(m_totalHoldNs.load(std::memory_order_relaxed));
+    stats.maxHold = std::chrono::nanoseconds(m_maxHoldNs.load(std::memory_order_relaxed));
+    for (size_t i = 0; i < lock_site_stats::WAIT_HISTOGRAM_BUCKETS; ++i)
+    {
+        stats.waitHistogram[i] = m_waitHistogram[i].load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void
+lock_site::reset()
+{
+    m_acquisitions = 0;
+    m_contendedAcquisitions = 0;
+    m_totalWaitNs = 0;
+    m_maxWaitNs = 0;
+    m_totalHoldNs = 0;
+    m_maxHoldNs = 0;
+    for (auto& bucket : m_waitHistogram)
+    {
+        bucket = 0;
+    }
+}
+
+void
+lock_site::update_max(
+    _Inout_ std::atomic<int64_t>& max,
+    _In_ int64_t value
+    )
+{
+    int64_t current = max.load(std::memory_order_relaxed);
+    while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+lock_profiler&
+lock_profiler::get_lock_profiler_singleton()
+{
+    static lock_profiler s_lockProfiler;
+    return s_lockProfiler;
+}
+
+lock_site*
+lock_profiler::register_site(
+    _In_ const char* name
+    )
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto& site = m_sites[name];
+    if (site == nullptr)
+    {
+        site.reset(new lock_site(name));
+    }
+    return site.get();
+}
+
+std::vector<lock_site_stats>
+lock_profiler::top_contended_sites(
+    _In_ size_t count
+    )
+{
+    std::vector<lock_site_stats> sites;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (const auto& site : m_sites)
+        {
+            sites.push_back(site.second->stats());
+        }
+    }
+
+    std::sort(sites.begin(), sites.end(), [](const lock_site_stats& lhs, const lock_site_stats& rhs)
+    {
+        return lhs.totalWait > rhs.totalWait;
+    });
+
+    if (sites.size() > count)
+    {
+        sites.resize(count);
+    }
+    return sites;
+}
+
+std::string
+lock_profiler::format_report(
+    _In_ size_t count
+    )
+{
+    std::stringstream report;
+    report << "site, acquisitions, contended, total wait us, max wait us, total hold us, max hold us, wait histogram (<1us, <2us, <4us, ...)\n";
+    for (const auto& site : top_contended_sites(count))
+    {
+        report << site.name << ", "
+            << site.acquisitions << ", "
+            << site.contendedAcquisitions << ", "
+            << std::chrono::duration_cast<std::chrono::microseconds>(site.totalWait).count() << ", "
+            << std::chrono::duration_cast<std::chrono::microseconds>(site.maxWait).count() << ", "
+            << std::chrono::duration_cast<std::chrono::microseconds>(site.totalHold).count() << ", "
+            << std::chrono::duration_cast<std::chrono::microseconds>(site.maxHold).count() << ",";
+        for (auto bucket : site.waitHistogram)
+        {
+            report << " " << bucket;
+        }
+        report << "\n";
+    }
+    return report.str();
+}
+
+void
+lock_profiler::reset()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    for (auto& site : m_sites)
+    {
+        site.second->reset();
+    }
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_END
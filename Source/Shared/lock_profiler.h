@@ -0,0 +1,157 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+#include <atomic>
+#include <mutex>
+
+// Set to 1 to build every xsapi_mutex, xsapi_recursive_mutex and xbox_live_mutex as profiled_mutex. When 0
+// they are plain std::mutex and std::recursive_mutex and the profiler costs nothing. The unit test projects
+// build with it set to 1.
+#ifndef XSAPI_LOCK_PROFILING
+#define XSAPI_LOCK_PROFILING 0
+#endif
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_BEGIN
+
+// Snapshot of one lock site. A site is every mutex declared with the same name, e.g. all social graphs' m_socialGraphMutex.
+struct lock_site_stats
+{
+    static const size_t WAIT_HISTOGRAM_BUCKETS = 12;
+
+    std::string name;
+    uint64_t acquisitions;
+    uint64_t contendedAcquisitions;
+    std::chrono::nanoseconds totalWait;
+    std::chrono::nanoseconds maxWait;
+    std::chrono::nanoseconds totalHold;
+    std::chrono::nanoseconds maxHold;
+
+    // Contended waits by duration: bucket 0 is under 1us, bucket N is [2^(N-1), 2^N) us, the last is everything longer
+    uint64_t waitHistogram[WAIT_HISTOGRAM_BUCKETS];
+};
+
+class lock_site
+{
+public:
+    explicit lock_site(_In_ std::string name);
+
+    void record_acquire(_In_ std::chrono::nanoseconds wait, _In_ bool contended);
+    void record_release(_In_ std::chrono::nanoseconds hold);
+
+    lock_site_stats stats() const;
+    void reset();
+
+private:
+    static void update_max(_Inout_ std::atomic<int64_t>& max, _In_ int64_t value);
+
+    std::string m_name;
+    std::atomic<uint64_t> m_acquisitions;
+    std::atomic<uint64_t> m_contendedAcquisitions;
+    std::atomic<int64_t> m_totalWaitNs;
+    std::atomic<int64_t> m_maxWaitNs;
+    std::atomic<int64_t> m_totalHoldNs;
+    std::atomic<int64_t> m_maxHoldNs;
+    std::atomic<uint64_t> m_waitHistogram[lock_site_stats::WAIT_HISTOGRAM_BUCKETS];
+};
+
+class lock_profiler
+{
+public:
+    // Not kept on xsapi_singleton: the singleton's own locks register here while it is being constructed
+    static lock_profiler& get_lock_profiler_singleton();
+
+    // Mutexes with the same name share a site. The site lives as long as the process.
+    lock_site* register_site(_In_ const char* name);
+
+    // The sites that spent the longest waiting, longest first
+    std::vector<lock_site_stats> top_contended_sites(_In_ size_t count);
+
+    std::string format_report(_In_ size_t count);
+
+    void reset();
+
+private:
+    std::mutex m_lock;
+    std::map<std::string, std::unique_ptr<lock_site>> m_sites;
+};
+
+// Drop-in for std::mutex and std::recursive_mutex that reports to its lock_site. Hold time runs from the
+// outermost lock to the matching unlock, so a recursive mutex re-entered by its owner counts once.
+template<typename TMutex>
+class profiled_mutex
+{
+public:
+    explicit profiled_mutex(_In_ const char* siteName = "unnamed") :
+        m_site(lock_profiler::get_lock_profiler_singleton().register_site(siteName)),
+        m_depth(0)
+    {
+    }
+
+    void lock()
+    {
+        if (m_mutex.try_lock())
+        {
+            m_site->record_acquire(std::chrono::nanoseconds::zero(), false);
+        }
+        else
+        {
+            auto waitStart = std::chrono::high_resolution_clock::now();
+            m_mutex.lock();
+            m_site->record_acquire(std::chrono::high_resolution_clock::now() - waitStart, true);
+        }
+        on_acquired();
+    }
+
+    bool try_lock()
+    {
+        if (!m_mutex.try_lock())
+        {
+            return false;
+        }
+        m_site->record_acquire(std::chrono::nanoseconds::zero(), false);
+        on_acquired();
+        return true;
+    }
+
+    void unlock()
+    {
+        if (--m_depth == 0)
+        {
+            m_site->record_release(std::chrono::high_resolution_clock::now() - m_acquiredTime);
+        }
+        m_mutex.unlock();
+    }
+
+private:
+    profiled_mutex(const profiled_mutex&);
+    profiled_mutex& operator=(const profiled_mutex&);
+
+    // Only touched by the thread holding m_mutex
+    void on_acquired()
+    {
+        if (m_depth++ == 0)
+        {
+            m_acquiredTime = std::chrono::high_resolution_clock::now();
+        }
+    }
+
+    TMutex m_mutex;
+    lock_site* m_site;
+    uint32_t m_depth;
+    std::chrono::high_resolution_clock::time_point m_acquiredTime;
+};
+
+#if XSAPI_LOCK_PROFILING
+typedef profiled_mutex<std::mutex> xsapi_mutex;
+typedef profiled_mutex<std::recursive_mutex> xsapi_recursive_mutex;
+
+// Names the site of an xsapi_mutex, xsapi_recursive_mutex or xbox_live_mutex member: xsapi_mutex m_lock XSAPI_LOCK_SITE("owner::m_lock");
+#define XSAPI_LOCK_SITE(name) { name }
+#else
+typedef std::mutex xsapi_mutex;
+typedef std::recursive_mutex xsapi_recursive_mutex;
+#define XSAPI_LOCK_SITE(name)
+#endif
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_END
@@ -36,7 +36,7 @@ public:
         perf_counter counter;
         counter.totalTime = 0.0f;
 
-        std::lock_guard<std::mutex> lock(m_lock.get());
+        std::lock_guard<xsapi_mutex> lock(m_lock.get());
         counter.previousTime = std::chrono::high_resolution_clock::now();
         m_logNameToProcessTime[logName] = counter;
     #else
@@ -50,7 +50,7 @@ public:
         std::chrono::nanoseconds totalTime = std::chrono::high_resolution_clock::now() - m_logNameToProcessTime[logName].previousTime;
         float totalTimeMS = totalTime.count() / 1000000.f;
 
-        std::lock_guard<std::mutex> lock(m_lock.get());
+        std::lock_guard<xsapi_mutex> lock(m_lock.get());
         m_logNameToProcessTime[logName].totalTime = totalTimeMS;
         if (totalTimeMS > PERF_THRESHOLD_MS || shouldReportAnyways)
         {
@@ -66,7 +66,7 @@ public:
     void clear()
     {
     #if PERF_TESTING
-        std::lock_guard<std::mutex> lock(m_lock.get());
+        std::lock_guard<xsapi_mutex> lock(m_lock.get());
         m_logNameToProcessTime.clear();
     #endif
     }
@@ -84,7 +84,7 @@ public:
 private:
     string_t m_ownerName;
     std::map<string_t, perf_counter> m_logNameToProcessTime;
-    xbox::services::system::xbox_live_mutex m_lock;
+    xbox::services::system::xbox_live_mutex m_lock XSAPI_LOCK_SITE("perf_tester::m_lock");
 };
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_END
\ No newline at end of file
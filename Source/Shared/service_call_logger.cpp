@@ -11,7 +11,7 @@ NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_BEGIN
 std::shared_ptr<service_call_logger> service_call_logger::get_singleton_instance()
 {
     auto xsapiSingleton = xbox::services::get_xsapi_singleton();
-    std::lock_guard<std::mutex> guard(xsapiSingleton->m_singletonLock);
+    std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_singletonLock);
     if (xsapiSingleton->m_serviceLoggerSingleton == nullptr)
     {
         xsapiSingleton->m_serviceLoggerSingleton = std::shared_ptr<service_call_logger>(new service_call_logger());
@@ -43,7 +43,7 @@ void service_call_logger::enable()
 
 void service_call_logger::disable()
 {
-    std::lock_guard<std::mutex> lock(m_writeLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_writeLock.get());
     if (!m_isEnabled)
     {
         return;
@@ -65,7 +65,7 @@ void service_call_logger::log(_In_ const string_t& item)
 {
     if (m_isEnabled)
     {
-        std::lock_guard<std::mutex> lock(m_writeLock.get());
+        std::lock_guard<xsapi_mutex> lock(m_writeLock.get());
         if (m_firstWrite)
         {
             add_data_to_file(service_call_logger_data::get_csv_header());
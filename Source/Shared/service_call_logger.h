@@ -51,7 +51,7 @@ private:
     bool m_isEnabled;
     bool m_firstWrite;
 
-    xbox::services::system::xbox_live_mutex m_writeLock;
+    xbox::services::system::xbox_live_mutex m_writeLock XSAPI_LOCK_SITE("service_call_logger::m_writeLock");
 
 };
 
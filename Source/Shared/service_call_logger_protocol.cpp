@@ -20,7 +20,7 @@ NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_BEGIN
 std::shared_ptr<service_call_logger_protocol> service_call_logger_protocol::get_singleton_instance()
 {
     auto xsapiSingleton = xbox::services::get_xsapi_singleton();
-    std::lock_guard<std::mutex> guard(xsapiSingleton->m_serviceLoggerProtocolSingletonLock);
+    std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_serviceLoggerProtocolSingletonLock);
     if (xsapiSingleton->m_serviceLoggerProtocolSingleton == nullptr)
     {
         xsapiSingleton->m_serviceLoggerProtocolSingleton = std::shared_ptr<service_call_logger_protocol>(new service_call_logger_protocol());
@@ -0,0 +1,274 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#include "span_tracer.h"
+#include "utils.h"
+#include <random>
+#include <fstream>
+#include <thread>
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_BEGIN
+
+// Read on every span, which must not take the singleton lock just to find out tracing is off
+static std::atomic<bool> s_isTracingEnabled(false);
+static thread_local trace_context s_currentContext;
+
+static void
+append_json_string(
+    _Inout_ std::stringstream& stream,
+    _In_ const std::string& value
+    )
+{
+    stream << '"';
+    for (char c : value)
+    {
+        if (c == '"' || c == '\\')
+        {
+            stream << '\\';
+        }
+        stream << c;
+    }
+    stream << '"';
+}
+
+static void
+append_chrome_trace_event(
+    _Inout_ std::stringstream& stream,
+    _In_ const trace_span_record& span,
+    _In_ bool isBegin
+    )
+{
+    auto timestamp = isBegin ? span.startTime : span.endTime;
+    stream << "{\"name\":";
+    append_json_string(stream, span.name);
+    stream << ",\"cat\":\"xsapi\",\"ph\":\"" << (isBegin ? 'b' : 'e') << "\""
+        << ",\"id\":\"0x" << std::hex << span.traceId << std::dec << "\""
+        << ",\"ts\":" << std::chrono::duration_cast<std::chrono::microseconds>(timestamp.time_since_epoch()).count()
+        << ",\"pid\":1,\"tid\":" << (span.threadId & 0xffffffff);
+    if (isBegin)
+    {
+        stream << ",\"args\":{\"spanId\":\"0x" << std::hex << span.spanId
+            << "\",\"parentSpanId\":\"0x" << span.parentSpanId << std::dec << "\"}";
+    }
+    stream << "}";
+}
+
+void
+chrome_trace_exporter::export_span(
+    _In_ const trace_span_record& span
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    m_spans.push_back(span);
+}
+
+std::vector<trace_span_record>
+chrome_trace_exporter::spans()
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    return m_spans;
+}
+
+std::string
+chrome_trace_exporter::to_json()
+{
+    // Begin and end events sorted by time, so each trace's nested spans open and close in order
+    std::vector<std::pair<chrono_clock_t::time_point, std::pair<size_t, bool>>> events;
+    auto spanList = spans();
+    for (size_t i = 0; i < spanList.size(); ++i)
+    {
+        events.push_back(std::make_pair(spanList[i].startTime, std::make_pair(i, true)));
+        events.push_back(std::make_pair(spanList[i].endTime, std::make_pair(i, false)));
+    }
+    std::stable_sort(events.begin(), events.end(), [](
+        const std::pair<chrono_clock_t::time_point, std::pair<size_t, bool>>& lhs,
+        const std::pair<chrono_clock_t::time_point, std::pair<size_t, bool>>& rhs)
+    {
+        return lhs.first < rhs.first;
+    });
+
+    std::stringstream json;
+    json << "{\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        if (i > 0)
+        {
+            json << ",\n";
+        }
+        append_chrome_trace_event(json, spanList[events[i].second.first], events[i].second.second);
+    }
+    json << "],\"displayTimeUnit\":\"ms\"}";
+    return json.str();
+}
+
+xbox_live_result<void>
+chrome_trace_exporter::write(
+    _In_ const string_t& filePath
+    )
+{
+    std::ofstream file(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        return xbox_live_result<void>(xbox_live_error_code::runtime_error, "Could not open the trace file");
+    }
+
+    std::string json = to_json();
+    file.write(json.data(), json.size());
+    return file.good() ?
+        xbox_live_result<void>() :
+        xbox_live_result<void>(xbox_live_error_code::runtime_error, "Could not write the trace file");
+}
+
+void
+chrome_trace_exporter::clear()
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    m_spans.clear();
+}
+
+std::shared_ptr<span_tracer>
+span_tracer::get_span_tracer_singleton()
+{
+    auto xsapiSingleton = xbox::services::get_xsapi_singleton();
+    std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_singletonLock);
+    if (xsapiSingleton->m_spanTracerSingleton == nullptr)
+    {
+        xsapiSingleton->m_spanTracerSingleton = std::make_shared<span_tracer>();
+    }
+
+    return xsapiSingleton->m_spanTracerSingleton;
+}
+
+span_tracer::span_tracer()
+{
+    // Random start so ids from separate runs don't collide when their traces are loaded together
+    std::random_device random;
+    m_nextId = (static_cast<uint64_t>(random()) << 32) | random();
+}
+
+void
+span_tracer::set_exporter(
+    _In_ std::shared_ptr<trace_exporter> exporter
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    m_exporter = std::move(exporter);
+    s_isTracingEnabled = m_exporter != nullptr;
+}
+
+std::shared_ptr<trace_exporter>
+span_tracer::exporter()
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    return m_exporter;
+}
+
+bool
+span_tracer::is_enabled()
+{
+    return s_isTracingEnabled.load(std::memory_order_relaxed);
+}
+
+trace_context
+span_tracer::current_context()
+{
+    return s_currentContext;
+}
+
+void
+span_tracer::set_current_context(
+    _In_ const trace_context& context
+    )
+{
+    s_currentContext = context;
+}
+
+uint64_t
+span_tracer::new_id()
+{
+    uint64_t id = m_nextId.fetch_add(1, std::memory_order_relaxed);
+    return id != 0 ? id : m_nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+trace_context_scope::trace_context_scope(
+    _In_ const trace_context& context
+    ) :
+    m_previousContext(span_tracer::current_context())
+{
+    span_tracer::set_current_context(context);
+}
+
+trace_context_scope::~trace_context_scope()
+{
+    span_tracer::set_current_context(m_previousContext);
+}
+
+trace_span::trace_span(
+    _In_ const char* name
+    )
+{
+    if (span_tracer::is_enabled())
+    {
+        start(name, span_tracer::current_context());
+    }
+}
+
+trace_span::trace_span(
+    _In_ std::string name,
+    _In_ const trace_context& parent
+    )
+{
+    if (span_tracer::is_enabled())
+    {
+        start(std::move(name), parent);
+    }
+}
+
+trace_span::~trace_span()
+{
+    end();
+}
+
+void
+trace_span::start(
+    _In_ std::string name,
+    _In_ const trace_context& parent
+    )
+{
+    m_tracer = span_tracer::get_span_tracer_singleton();
+    m_context.spanId = m_tracer->new_id();
+    m_context.traceId = parent.is_valid() ? parent.traceId : m_context.spanId;
+
+    m_record.name = std::move(name);
+    m_record.traceId = m_context.traceId;
+    m_record.spanId = m_context.spanId;
+    m_record.parentSpanId = parent.is_valid() ? parent.spanId : 0;
+    m_record.threadId = std::hash<std::thread::id>()(std::this_thread::get_id());
+    m_record.startTime = chrono_clock_t::now();
+}
+
+const trace_context&
+trace_span::context() const
+{
+    return m_context;
+}
+
+void
+trace_span::end()
+{
+    if (m_tracer == nullptr)
+    {
+        return;
+    }
+
+    m_record.endTime = chrono_clock_t::now();
+    auto exporter = m_tracer->exporter();
+    if (exporter != nullptr)
+    {
+        exporter->export_span(m_record);
+    }
+    m_tracer = nullptr;
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_END
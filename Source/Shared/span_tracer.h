@@ -0,0 +1,129 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+#include <atomic>
+#include "xsapi/types.h"
+#include "xsapi/errors.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_BEGIN
+
+// Identifies the span work is being done for. A zero traceId means no trace.
+struct trace_context
+{
+    trace_context() : traceId(0), spanId(0) {}
+
+    bool is_valid() const { return traceId != 0; }
+
+    uint64_t traceId;
+    uint64_t spanId;
+};
+
+// A finished span as handed to a trace_exporter. parentSpanId is zero for the root of a trace.
+struct trace_span_record
+{
+    std::string name;
+    uint64_t traceId;
+    uint64_t spanId;
+    uint64_t parentSpanId;
+    uint64_t threadId;
+    chrono_clock_t::time_point startTime;
+    chrono_clock_t::time_point endTime;
+};
+
+// Receives every span as it ends, on the thread that ended it
+class trace_exporter
+{
+public:
+    virtual ~trace_exporter() {}
+    virtual void export_span(_In_ const trace_span_record& span) = 0;
+};
+
+// Keeps spans in memory and writes them in the Chrome trace event format, for chrome://tracing or Perfetto.
+// Each trace is one async track, so a call chain that hops between threads still nests under its root.
+class chrome_trace_exporter : public trace_exporter
+{
+public:
+    void export_span(_In_ const trace_span_record& span) override;
+
+    std::vector<trace_span_record> spans();
+
+    std::string to_json();
+
+    xbox_live_result<void> write(_In_ const string_t& filePath);
+
+    void clear();
+
+private:
+    xsapi_mutex m_lock XSAPI_LOCK_SITE("chrome_trace_exporter::m_lock");
+    std::vector<trace_span_record> m_spans;
+};
+
+// Starts and exports spans. The current trace context is per thread; code that continues work on another
+// thread, such as a pplx continuation, captures span_tracer::current_context() and puts it back with a
+// trace_context_scope. Nothing is recorded while no exporter is set, and a span then costs one atomic load.
+class span_tracer
+{
+public:
+    static std::shared_ptr<span_tracer> get_span_tracer_singleton();
+
+    span_tracer();
+
+    // nullptr stops tracing
+    void set_exporter(_In_ std::shared_ptr<trace_exporter> exporter);
+
+    std::shared_ptr<trace_exporter> exporter();
+
+    static bool is_enabled();
+
+    static trace_context current_context();
+
+    static void set_current_context(_In_ const trace_context& context);
+
+    uint64_t new_id();
+
+private:
+    xsapi_mutex m_lock XSAPI_LOCK_SITE("span_tracer::m_lock");
+    std::shared_ptr<trace_exporter> m_exporter;
+    std::atomic<uint64_t> m_nextId;
+};
+
+// Makes a trace context current on this thread until the scope ends
+class trace_context_scope
+{
+public:
+    explicit trace_context_scope(_In_ const trace_context& context);
+    ~trace_context_scope();
+
+private:
+    trace_context_scope(const trace_context_scope&);
+    trace_context_scope& operator=(const trace_context_scope&);
+
+    trace_context m_previousContext;
+};
+
+// A span from construction until end() or destruction, a child of the given parent or else of the thread's
+// current context. Hold one in a shared_ptr to end it in the last continuation of an async chain.
+class trace_span
+{
+public:
+    explicit trace_span(_In_ const char* name);
+    trace_span(_In_ std::string name, _In_ const trace_context& parent);
+    ~trace_span();
+
+    const trace_context& context() const;
+
+    void end();
+
+private:
+    trace_span(const trace_span&);
+    trace_span& operator=(const trace_span&);
+
+    void start(_In_ std::string name, _In_ const trace_context& parent);
+
+    std::shared_ptr<span_tracer> m_tracer;
+    trace_context m_context;
+    trace_span_record m_record;
+};
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_END
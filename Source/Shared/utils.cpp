@@ -40,7 +40,7 @@ EXTERN_C IMAGE_DOS_HEADER __ImageBase;
 static const uint64_t _msTicks = static_cast<uint64_t>(10000);
 static const uint64_t _secondTicks = 1000*_msTicks;
 
-static std::mutex s_xsapiSingletonLock;
+static xsapi_mutex s_xsapiSingletonLock XSAPI_LOCK_SITE("xsapi_singleton::s_xsapiSingletonLock");
 static std::shared_ptr<xsapi_singleton> s_xsapiSingleton;
 
 xsapi_singleton::xsapi_singleton()
@@ -82,7 +82,7 @@ void xsapi_singleton::init()
 
 xsapi_singleton::~xsapi_singleton()
 {
-    std::lock_guard<std::mutex> guard(s_xsapiSingletonLock);
+    std::lock_guard<xsapi_mutex> guard(s_xsapiSingletonLock);
     s_xsapiSingleton = nullptr;
 }
 
@@ -91,7 +91,7 @@ get_xsapi_singleton(_In_ bool createIfRequired)
 {
     if (createIfRequired && s_xsapiSingleton == nullptr)
     {
-        std::lock_guard<std::mutex> guard(s_xsapiSingletonLock);
+        std::lock_guard<xsapi_mutex> guard(s_xsapiSingletonLock);
         if (s_xsapiSingleton == nullptr)
         {
             s_xsapiSingleton = std::make_shared<xsapi_singleton>();
@@ -12,6 +12,7 @@
 #include "xsapi/xbox_live_app_config.h"
 #include "http_call_response.h"
 #include "xsapi/mem.h"
+#include "lock_profiler.h"
 
 // Forward decls
 NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_BEGIN
@@ -24,6 +25,7 @@ NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_END
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_SOCIAL_MANAGER_CPP_BEGIN
     class social_manager;
+    class social_event_handler_registry;
 NAMESPACE_MICROSOFT_XBOX_SERVICES_SOCIAL_MANAGER_CPP_END
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_STAT_MANAGER_CPP_BEGIN
@@ -47,6 +49,10 @@ NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_BEGIN
     class service_call_logger_protocol;
     class service_call_logger;
     class http_retry_after_manager;
+    class http_endpoint_health_manager;
+    class http_client_pool;
+    class write_behind_journal;
+    class span_tracer;
     class logger;
     class perf_tester;
     class initiator;
@@ -104,16 +110,16 @@ struct xsapi_singleton
 
     void init();
 
-    std::mutex m_rtaActivationCounterLock;
+    xsapi_mutex m_rtaActivationCounterLock XSAPI_LOCK_SITE("xsapi_singleton::m_rtaActivationCounterLock");
     std::unordered_map<string_t, uint32_t> m_rtaActiveSocketCountPerUser;
     std::unordered_map<string_t, uint32_t> m_rtaActiveManagersByUser;
 
-    std::mutex m_singletonLock;
-    std::mutex m_appConfigLock;
-    std::mutex m_mpsdConstantLock;
-    std::mutex m_mpsdMemberLock;
-    std::mutex m_mpsdPropertyLock;
-    std::mutex m_serviceSettingsLock;
+    xsapi_mutex m_singletonLock XSAPI_LOCK_SITE("xsapi_singleton::m_singletonLock");
+    xsapi_mutex m_appConfigLock XSAPI_LOCK_SITE("xsapi_singleton::m_appConfigLock");
+    xsapi_mutex m_mpsdConstantLock XSAPI_LOCK_SITE("xsapi_singleton::m_mpsdConstantLock");
+    xsapi_mutex m_mpsdMemberLock XSAPI_LOCK_SITE("xsapi_singleton::m_mpsdMemberLock");
+    xsapi_mutex m_mpsdPropertyLock XSAPI_LOCK_SITE("xsapi_singleton::m_mpsdPropertyLock");
+    xsapi_mutex m_serviceSettingsLock XSAPI_LOCK_SITE("xsapi_singleton::m_serviceSettingsLock");
     std::shared_ptr<xbox::services::system::xbox_live_services_settings> m_xboxServiceSettingsSingleton;
     std::shared_ptr<xbox::services::local_config> m_localConfigSingleton;
 
@@ -122,7 +128,7 @@ struct xsapi_singleton
 #endif
 
 #if TV_API || UNIT_TEST_SERVICES
-    std::mutex m_achievementServiceInitLock;
+    xsapi_mutex m_achievementServiceInitLock XSAPI_LOCK_SITE("xsapi_singleton::m_achievementServiceInitLock");
     bool m_bHasAchievementServiceInitialized;
     std::string m_eventProviderName;
     GUID m_eventPlayerSessionId;
@@ -138,12 +144,12 @@ struct xsapi_singleton
     std::shared_ptr<service_call_logging_config> m_serviceLoggingConfigSingleton;
 
     // from Shared\xbox_live_app_config.cpp
-    std::mutex m_serviceLoggerProtocolSingletonLock;
+    xsapi_mutex m_serviceLoggerProtocolSingletonLock XSAPI_LOCK_SITE("xsapi_singleton::m_serviceLoggerProtocolSingletonLock");
     std::shared_ptr<service_call_logger_protocol> m_serviceLoggerProtocolSingleton;
 
     // from Shared\utils_locales.cpp
     string_t m_locales;
-    std::mutex m_locale_lock;
+    xsapi_mutex m_locale_lock XSAPI_LOCK_SITE("xsapi_singleton::m_locale_lock");
     bool m_custom_locale_override;
 
     // from Shared\service_call_logger_data.cpp
@@ -161,6 +167,7 @@ struct xsapi_singleton
     // from Social\Manager\social_manager.cpp
     std::shared_ptr<xbox::services::social::manager::social_manager> m_socialManagerInstance;
     std::shared_ptr<xbox::services::perf_tester> m_perfTester;
+    std::shared_ptr<xbox::services::social::manager::social_event_handler_registry> m_socialEventHandlerRegistry;
 
     // from Stats\Manager\stats_manager.cpp
     std::shared_ptr<xbox::services::stats::manager::stats_manager> m_statsManagerInstance;
@@ -174,6 +181,18 @@ struct xsapi_singleton
     // from Shared\http_call_impl.cpp
     std::shared_ptr<http_retry_after_manager> m_httpRetryPolicyManagerSingleton;
 
+    // from Shared\http_endpoint_health_manager.cpp
+    std::shared_ptr<http_endpoint_health_manager> m_httpEndpointHealthManagerSingleton;
+
+    // from Shared\http_client_pool.cpp
+    std::shared_ptr<http_client_pool> m_httpClientPoolSingleton;
+
+    // from Shared\write_behind_journal.cpp
+    std::shared_ptr<write_behind_journal> m_writeBehindJournalSingleton;
+
+    // from Shared\span_tracer.cpp
+    std::shared_ptr<span_tracer> m_spanTracerSingleton;
+
     // from Services\Presence\presence_service_impl.cpp
     std::function<void(int heartBeatDelayInMins)> m_onSetPresenceFinish;
 
@@ -208,7 +227,7 @@ struct xsapi_singleton
     std::unordered_map<function_context, std::function<void(const string_t&)>> m_signInCompletedHandlers;
     function_context m_signOutCompletedHandlerIndexer;
     function_context m_signInCompletedHandlerIndexer;
-    std::mutex m_trackingUsersLock;
+    xsapi_mutex m_trackingUsersLock XSAPI_LOCK_SITE("xsapi_singleton::m_trackingUsersLock");
 #endif
 };
 
@@ -232,7 +232,7 @@ void utils::generate_locales()
 const string_t& utils::get_locales()
 {
     auto xsapiSingleton = xbox::services::get_xsapi_singleton();
-    std::lock_guard<std::mutex> guard(xsapiSingleton->m_locale_lock);
+    std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_locale_lock);
     if (xsapiSingleton->m_custom_locale_override)
     {
         return xsapiSingleton->m_locales;
@@ -7,6 +7,7 @@
 #include "user_context.h"
 #include "xbox_system_factory.h"
 #include "web_socket_connection.h"
+#include "flight_recorder.h"
 #include "utils.h"
 
 using namespace web::websockets::client;
@@ -40,7 +41,7 @@ web_socket_connection::ensure_connected()
     // As soon as this API gets called, move away from disconnected state
     set_state_helper(web_socket_connection_state::activated);
 
-    std::lock_guard<std::mutex> lock(m_stateLocker);
+    std::lock_guard<xsapi_mutex> lock(m_stateLocker);
 
     // If it's still connecting or connected return.
     if (!m_connectingTask.is_done() || m_state == web_socket_connection_state::connected) return;
@@ -143,7 +144,7 @@ web_socket_connection::ensure_connected()
 web_socket_connection_state
 web_socket_connection::state()
 {
-    std::lock_guard<std::mutex> lock(m_stateLocker);
+    std::lock_guard<xsapi_mutex> lock(m_stateLocker);
     return m_state;
 }
 
@@ -204,7 +205,7 @@ web_socket_connection::set_connection_state_change_handler(
     _In_ std::function<void(web_socket_connection_state oldState, web_socket_connection_state newState)> handler
     )
 {
-    std::lock_guard<std::mutex> lock(m_stateLocker);
+    std::lock_guard<xsapi_mutex> lock(m_stateLocker);
     m_externalStateChangeHandler = handler;
 }
 
@@ -213,7 +214,7 @@ void web_socket_connection::set_state_helper(_In_ web_socket_connection_state ne
     web_socket_connection_state oldState;
     std::function<void(web_socket_connection_state oldState, web_socket_connection_state newState)> externalStateChangeHandlerCopy;
     {
-        std::lock_guard<std::mutex> lock(m_stateLocker);
+        std::lock_guard<xsapi_mutex> lock(m_stateLocker);
         // Can only set state to activated if current state is disconnected
         if (newState == web_socket_connection_state::activated && m_state != web_socket_connection_state::disconnected)
         {
@@ -226,6 +227,16 @@ void web_socket_connection::set_state_helper(_In_ web_socket_connection_state ne
     }
 
     LOGS_DEBUG << "websocket state change: " << convert_web_socket_connection_state_to_string(oldState) << " -> " << convert_web_socket_connection_state_to_string(newState);
+    if (oldState != newState)
+    {
+        flight_recorder::get_flight_recorder_singleton()->record(
+            flight_record_type::web_socket_state_changed,
+            0,
+            static_cast<uint32_t>(reinterpret_cast<uintptr_t>(this)),
+            static_cast<uint32_t>(newState),
+            static_cast<uint32_t>(oldState)
+            );
+    }
 
     if (oldState != newState && externalStateChangeHandlerCopy)
     {
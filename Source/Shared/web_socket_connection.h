@@ -54,7 +54,7 @@ private:
     web::uri m_uri;
     string_t m_subProtocol;
 
-    std::mutex m_stateLocker;
+    xsapi_mutex m_stateLocker XSAPI_LOCK_SITE("web_socket_connection::m_stateLocker");
     web_socket_connection_state m_state;
 
     pplx::task<void> m_connectingTask;
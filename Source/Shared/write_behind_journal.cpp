@@ -0,0 +1,620 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#include "write_behind_journal.h"
+#include "http_call_impl.h"
+#include "xbox_system_factory.h"
+#include "utils.h"
+#if XSAPI_U
+#include <unistd.h>
+#include "ppltasks_extra_unix.h"
+#else
+#include <io.h>
+#include "ppltasks_extra.h"
+#endif
+
+using namespace Concurrency::extras;
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_BEGIN
+
+// Long enough to batch the writes from a burst of set_stat calls and achievement updates into one flush,
+// short enough that a crash loses at most a moment of progress
+const std::chrono::milliseconds write_behind_journal::GROUP_COMMIT_WINDOW = std::chrono::milliseconds(50);
+const string_t write_behind_journal::JOURNAL_FILE_NAME = _T("xsapi_write_journal.log");
+// Lets the service recognize a replayed write it already applied before the crash or failure
+const string_t write_behind_journal::IDEMPOTENCY_KEY_HEADER = _T("Idempotency-Key");
+
+static const string_t TEMP_FILE_SUFFIX = _T(".tmp");
+
+static FILE*
+open_journal_file(
+    _In_ const string_t& filePath,
+    _In_ bool truncate
+    )
+{
+#if XSAPI_U
+    return fopen(filePath.c_str(), truncate ? "wb" : "ab");
+#else
+    FILE* file = nullptr;
+    _wfopen_s(&file, filePath.c_str(), truncate ? L"wb" : L"ab");
+    return file;
+#endif
+}
+
+// Flushes the C runtime's buffer and then asks the OS to put the data on disk
+static bool
+sync_journal_file(
+    _In_ FILE* file
+    )
+{
+    if (fflush(file) != 0)
+    {
+        return false;
+    }
+#if XSAPI_U
+    return fsync(fileno(file)) == 0;
+#else
+    return FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file)))) != 0;
+#endif
+}
+
+std::shared_ptr<write_behind_journal>
+write_behind_journal::get_write_behind_journal_singleton()
+{
+    auto xsapiSingleton = xbox::services::get_xsapi_singleton();
+    std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_singletonLock);
+    if (xsapiSingleton->m_writeBehindJournalSingleton == nullptr)
+    {
+        xsapiSingleton->m_writeBehindJournalSingleton = std::make_shared<write_behind_journal>();
+    }
+
+    return xsapiSingleton->m_writeBehindJournalSingleton;
+}
+
+write_behind_journal::write_behind_journal() :
+    m_file(nullptr),
+    m_commitScheduled(false),
+    m_commitCount(0)
+{
+}
+
+write_behind_journal::~write_behind_journal()
+{
+    close();
+}
+
+xbox_live_result<void>
+write_behind_journal::open(
+    _In_ const string_t& journalDirectory
+    )
+{
+    RETURN_CPP_IF(journalDirectory.empty(), void, xbox_live_error_code::invalid_argument, "Journal directory is empty");
+
+    close();
+
+    string_t filePath = journalDirectory;
+    auto lastChar = filePath[filePath.size() - 1];
+    if (lastChar != _T('/') && lastChar != _T('\\'))
+    {
+        filePath += _T("/");
+    }
+    filePath += JOURNAL_FILE_NAME;
+
+    std::lock_guard<xsapi_mutex> fileLock(m_fileLock);
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    m_filePath = filePath;
+    m_writes.clear();
+    m_uncommittedLines.clear();
+    load();
+
+    // Rewrite the file with only the pending writes, which also drops a line torn by a crash
+    std::string compactedLines;
+    for (const auto& write : m_writes)
+    {
+        compactedLines += utility::conversions::to_utf8string(serialize_write(write).serialize()) + "\n";
+    }
+
+    string_t tempFilePath = m_filePath + TEMP_FILE_SUFFIX;
+    FILE* tempFile = open_journal_file(tempFilePath, true);
+    bool compacted = tempFile != nullptr &&
+        fwrite(compactedLines.data(), 1, compactedLines.size(), tempFile) == compactedLines.size() &&
+        sync_journal_file(tempFile);
+    if (tempFile != nullptr)
+    {
+        fclose(tempFile);
+    }
+
+#if XSAPI_U
+    compacted = compacted && std::rename(tempFilePath.c_str(), m_filePath.c_str()) == 0;
+#else
+    compacted = compacted && MoveFileEx(tempFilePath.c_str(), m_filePath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#endif
+
+    if (compacted)
+    {
+        m_file = open_journal_file(m_filePath, false);
+    }
+
+    if (m_file == nullptr)
+    {
+        m_writes.clear();
+        return xbox_live_result<void>(xbox_live_error_code::runtime_error, "Could not open the write journal");
+    }
+
+    LOGS_INFO << "write_behind_journal: opened with " << m_writes.size() << " pending writes";
+    return xbox_live_result<void>();
+}
+
+void
+write_behind_journal::close()
+{
+    commit();
+
+    std::lock_guard<xsapi_mutex> fileLock(m_fileLock);
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    if (m_file != nullptr)
+    {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+    m_writes.clear();
+    m_uncommittedLines.clear();
+}
+
+bool
+write_behind_journal::is_open()
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    return m_file != nullptr;
+}
+
+string_t
+write_behind_journal::record(
+    _In_ const string_t& xboxUserId,
+    _In_ xbox_live_api xboxLiveApi,
+    _In_ const std::shared_ptr<http_call>& httpCall,
+    _In_ bool supersedesEarlier
+    )
+{
+    auto httpCallInternal = std::dynamic_pointer_cast<http_call_internal>(httpCall);
+    if (httpCallInternal == nullptr || !is_open())
+    {
+        return string_t();
+    }
+
+    journal_write write;
+    write.idempotencyKey = utils::create_guid(true);
+    write.xboxUserId = xboxUserId;
+    write.xboxLiveApi = xboxLiveApi;
+    write.httpMethod = httpCall->http_method();
+    write.serverName = httpCall->server_name();
+    write.pathQueryFragment = httpCall->path_query_fragment().to_string();
+    write.contractVersion = httpCall->xbox_contract_version_header_value();
+    write.retryAllowed = httpCall->retry_allowed();
+    write.supersedesEarlier = supersedesEarlier;
+    write.inFlight = true;
+
+    const auto& requestBody = httpCallInternal->request_body();
+    if (requestBody.get_http_request_message_type() == http_request_message_type::vector_message)
+    {
+        const auto& bodyBytes = requestBody.request_message_vector();
+        write.requestBody = utility::conversions::to_string_t(std::string(bodyBytes.begin(), bodyBytes.end()));
+    }
+    else
+    {
+        write.requestBody = requestBody.request_message_string();
+    }
+
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        if (m_file == nullptr)
+        {
+            return string_t();
+        }
+        append(serialize_write(write));
+        add_write(write);
+    }
+
+    httpCall->set_custom_header(IDEMPOTENCY_KEY_HEADER, write.idempotencyKey);
+    schedule_commit();
+    return write.idempotencyKey;
+}
+
+void
+write_behind_journal::complete(
+    _In_ const string_t& idempotencyKey,
+    _In_ const std::shared_ptr<http_call_response>& response
+    )
+{
+    if (idempotencyKey.empty())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        auto write = std::find_if(m_writes.begin(), m_writes.end(), [&idempotencyKey](const journal_write& w)
+        {
+            return w.idempotencyKey == idempotencyKey;
+        });
+
+        // Already superseded by a newer document, or the journal was closed meanwhile
+        if (write == m_writes.end())
+        {
+            return;
+        }
+
+        if (should_keep_pending(response))
+        {
+            LOGS_DEBUG << "write_behind_journal: keeping " << idempotencyKey << " pending after error " << response->err_code();
+            write->inFlight = false;
+            return;
+        }
+
+        m_writes.erase(write);
+        append(serialize_ack(idempotencyKey));
+    }
+
+    schedule_commit();
+}
+
+bool
+write_behind_journal::has_pending_writes(
+    _In_ const string_t& xboxUserId
+    )
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    return std::any_of(m_writes.begin(), m_writes.end(), [&xboxUserId](const journal_write& write)
+    {
+        return write.xboxUserId == xboxUserId;
+    });
+}
+
+size_t
+write_behind_journal::pending_write_count()
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    return m_writes.size();
+}
+
+uint64_t
+write_behind_journal::commit_count()
+{
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    return m_commitCount;
+}
+
+pplx::task<void>
+write_behind_journal::replay(
+    _In_ const std::shared_ptr<xbox::services::user_context>& userContext,
+    _In_ const std::shared_ptr<xbox::services::xbox_live_context_settings>& xboxLiveContextSettings
+    )
+{
+    const string_t& xboxUserId = userContext->xbox_user_id();
+    std::vector<journal_write> writesToReplay;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        for (auto& write : m_writes)
+        {
+            // Writes this run sent itself are still in flight and will be completed by their own caller
+            if (write.xboxUserId == xboxUserId && !write.inFlight)
+            {
+                write.inFlight = true;
+                writesToReplay.push_back(write);
+            }
+        }
+    }
+
+    pplx::task<void> replayTask = writesToReplay.empty() ?
+        pplx::task_from_result() :
+        send_writes(writesToReplay, userContext, xboxLiveContextSettings);
+
+    // A replay another context already started for this user still counts, so callers that read back
+    // what the writes changed wait for those too
+    std::lock_guard<xsapi_mutex> lock(m_lock);
+    auto userReplay = m_replayTasks.find(xboxUserId);
+    if (userReplay != m_replayTasks.end() && !userReplay->second.is_done())
+    {
+        std::vector<pplx::task<void>> userReplayTasks = { userReplay->second, replayTask };
+        replayTask = pplx::when_all(userReplayTasks.begin(), userReplayTasks.end());
+    }
+    m_replayTasks[xboxUserId] = replayTask;
+    return replayTask;
+}
+
+pplx::task<void>
+write_behind_journal::send_writes(
+    _In_ const std::vector<journal_write>& writesToReplay,
+    _In_ const std::shared_ptr<xbox::services::user_context>& userContext,
+    _In_ const std::shared_ptr<xbox::services::xbox_live_context_settings>& xboxLiveContextSettings
+    )
+{
+    LOGS_INFO << "write_behind_journal: replaying " << writesToReplay.size() << " pending writes";
+
+    std::weak_ptr<write_behind_journal> thisWeakPtr = shared_from_this();
+    std::vector<pplx::task<void>> replayTasks;
+    for (const auto& write : writesToReplay)
+    {
+        std::shared_ptr<http_call> httpCall = xbox::services::system::xbox_system_factory::get_factory()->create_http_call(
+            xboxLiveContextSettings,
+            write.httpMethod,
+            write.serverName,
+            web::uri(write.pathQueryFragment),
+            write.xboxLiveApi
+            );
+
+        if (!write.contractVersion.empty())
+        {
+            httpCall->set_xbox_contract_version_header_value(write.contractVersion);
+        }
+        httpCall->set_retry_allowed(write.retryAllowed);
+        httpCall->set_request_body(write.requestBody);
+        httpCall->set_custom_header(IDEMPOTENCY_KEY_HEADER, write.idempotencyKey);
+
+        string_t idempotencyKey = write.idempotencyKey;
+        auto task = httpCall->get_response_with_auth(userContext, http_call_response_body_type::string_body)
+        .then([thisWeakPtr, idempotencyKey](pplx::task<std::shared_ptr<http_call_response>> responseTask)
+        {
+            std::shared_ptr<write_behind_journal> pThis(thisWeakPtr.lock());
+            if (pThis == nullptr)
+            {
+                return;
+            }
+
+            try
+            {
+                pThis->complete(idempotencyKey, responseTask.get());
+            }
+            catch (...)
+            {
+                // Leave it pending for the next replay
+                std::lock_guard<xsapi_mutex> lock(pThis->m_lock);
+                for (auto& write : pThis->m_writes)
+                {
+                    if (write.idempotencyKey == idempotencyKey)
+                    {
+                        write.inFlight = false;
+                    }
+                }
+            }
+        });
+        replayTasks.push_back(task);
+    }
+
+    return pplx::when_all(replayTasks.begin(), replayTasks.end());
+}
+
+void
+write_behind_journal::commit()
+{
+    std::lock_guard<xsapi_mutex> fileLock(m_fileLock);
+    std::string lines;
+    bool truncate;
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        m_commitScheduled = false;
+        if (m_file == nullptr || m_uncommittedLines.empty())
+        {
+            return;
+        }
+
+        // With nothing pending, every line in the file is a write and its ack, so the file can start over
+        truncate = m_writes.empty();
+        lines.swap(m_uncommittedLines);
+        ++m_commitCount;
+    }
+
+    if (!write_lines(truncate ? std::string() : lines, truncate))
+    {
+        LOG_ERROR("write_behind_journal: could not commit to the journal file");
+    }
+}
+
+web::json::value
+write_behind_journal::serialize_write(
+    _In_ const journal_write& write
+    )
+{
+    web::json::value line;
+    line[_T("op")] = web::json::value::string(_T("write"));
+    line[_T("key")] = web::json::value::string(write.idempotencyKey);
+    line[_T("xuid")] = web::json::value::string(write.xboxUserId);
+    line[_T("api")] = web::json::value::number(static_cast<int32_t>(write.xboxLiveApi));
+    line[_T("method")] = web::json::value::string(write.httpMethod);
+    line[_T("server")] = web::json::value::string(write.serverName);
+    line[_T("path")] = web::json::value::string(write.pathQueryFragment);
+    line[_T("contract")] = web::json::value::string(write.contractVersion);
+    line[_T("body")] = web::json::value::string(write.requestBody);
+    line[_T("retry")] = web::json::value::boolean(write.retryAllowed);
+    line[_T("supersedes")] = web::json::value::boolean(write.supersedesEarlier);
+    return line;
+}
+
+web::json::value
+write_behind_journal::serialize_ack(
+    _In_ const string_t& idempotencyKey
+    )
+{
+    web::json::value line;
+    line[_T("op")] = web::json::value::string(_T("ack"));
+    line[_T("key")] = web::json::value::string(idempotencyKey);
+    return line;
+}
+
+bool
+write_behind_journal::should_keep_pending(
+    _In_ const std::shared_ptr<http_call_response>& response
+    )
+{
+    // Anything else is an answer from the service, and sending the same write again would get the same one
+    const std::error_code& errc = response->err_code();
+    return errc == xbox_live_error_condition::network ||
+        errc == xbox_live_error_code::http_status_401_unauthorized ||
+        errc == xbox_live_error_code::http_status_429_too_many_requests ||
+        errc == xbox_live_error_code::generic_error ||
+        (errc.value() >= 500 && errc.value() < 600);
+}
+
+void
+write_behind_journal::load()
+{
+    std::ifstream in(m_filePath, std::ios::in | std::ios::binary);
+    if (!in)
+    {
+        return;
+    }
+
+    uint32_t tornLines = 0;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.empty())
+        {
+            continue;
+        }
+
+        // A proper prefix of a JSON object never parses, so a line cut short by a crash is caught here
+        std::error_code errc;
+        web::json::value lineJson = web::json::value::parse(utility::conversions::to_string_t(line), errc);
+        if (errc || !lineJson.is_object())
+        {
+            ++tornLines;
+            continue;
+        }
+        apply(lineJson);
+    }
+
+    if (tornLines > 0)
+    {
+        LOGS_INFO << "write_behind_journal: dropped " << tornLines << " incomplete lines";
+    }
+}
+
+void
+write_behind_journal::apply(
+    _In_ const web::json::value& line
+    )
+{
+    std::error_code errc;
+    string_t op = utils::extract_json_string(line, _T("op"), errc);
+    string_t idempotencyKey = utils::extract_json_string(line, _T("key"), errc);
+    if (errc || idempotencyKey.empty())
+    {
+        return;
+    }
+
+    if (op == _T("ack"))
+    {
+        m_writes.erase(
+            std::remove_if(m_writes.begin(), m_writes.end(), [&idempotencyKey](const journal_write& write)
+            {
+                return write.idempotencyKey == idempotencyKey;
+            }),
+            m_writes.end());
+        return;
+    }
+
+    journal_write write;
+    write.idempotencyKey = idempotencyKey;
+    write.xboxUserId = utils::extract_json_string(line, _T("xuid"), errc);
+    write.xboxLiveApi = static_cast<xbox_live_api>(utils::extract_json_int(line, _T("api"), errc));
+    write.httpMethod = utils::extract_json_string(line, _T("method"), errc);
+    write.serverName = utils::extract_json_string(line, _T("server"), errc);
+    write.pathQueryFragment = utils::extract_json_string(line, _T("path"), errc);
+    write.contractVersion = utils::extract_json_string(line, _T("contract"), errc);
+    write.requestBody = utils::extract_json_string(line, _T("body"), errc);
+    write.retryAllowed = utils::extract_json_bool(line, _T("retry"), errc);
+    write.supersedesEarlier = utils::extract_json_bool(line, _T("supersedes"), errc);
+    write.inFlight = false;
+    if (!errc)
+    {
+        add_write(std::move(write));
+    }
+}
+
+void
+write_behind_journal::add_write(
+    _In_ journal_write write
+    )
+{
+    if (write.supersedesEarlier)
+    {
+        const auto& xboxUserId = write.xboxUserId;
+        const auto& pathQueryFragment = write.pathQueryFragment;
+        m_writes.erase(
+            std::remove_if(m_writes.begin(), m_writes.end(), [&xboxUserId, &pathQueryFragment](const journal_write& earlier)
+            {
+                return earlier.supersedesEarlier && earlier.xboxUserId == xboxUserId && earlier.pathQueryFragment == pathQueryFragment;
+            }),
+            m_writes.end());
+    }
+    m_writes.push_back(std::move(write));
+}
+
+void
+write_behind_journal::append(
+    _In_ const web::json::value& line
+    )
+{
+    // Serialized JSON escapes newlines inside strings, so one line is always one record
+    m_uncommittedLines += utility::conversions::to_utf8string(line.serialize());
+    m_uncommittedLines += "\n";
+}
+
+void
+write_behind_journal::schedule_commit()
+{
+    {
+        std::lock_guard<xsapi_mutex> lock(m_lock);
+        if (m_commitScheduled)
+        {
+            return;
+        }
+        m_commitScheduled = true;
+    }
+
+    std::weak_ptr<write_behind_journal> thisWeakPtr = shared_from_this();
+    create_delayed_task(
+        GROUP_COMMIT_WINDOW,
+        [thisWeakPtr]()
+    {
+        std::shared_ptr<write_behind_journal> pThis(thisWeakPtr.lock());
+        if (pThis != nullptr)
+        {
+            pThis->commit();
+        }
+    });
+}
+
+bool
+write_behind_journal::write_lines(
+    _In_ const std::string& lines,
+    _In_ bool truncate
+    )
+{
+    if (truncate)
+    {
+        // The file is in append mode, so later writes land at the new end
+        fflush(m_file);
+#if XSAPI_U
+        bool truncated = ftruncate(fileno(m_file), 0) == 0;
+#else
+        bool truncated = _chsize_s(_fileno(m_file), 0) == 0;
+#endif
+        if (!truncated)
+        {
+            return false;
+        }
+    }
+
+    if (!lines.empty() && fwrite(lines.data(), 1, lines.size(), m_file) != lines.size())
+    {
+        return false;
+    }
+
+    // The one flush for everything recorded during the window
+    return sync_journal_file(m_file);
+}
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_END
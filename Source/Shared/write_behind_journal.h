@@ -0,0 +1,115 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+#include "xsapi/http_call.h"
+#include "user_context.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_BEGIN
+
+enum class xbox_live_api;
+
+// Append-only on-disk record of stats, achievement and reputation writes the service hasn't acknowledged yet.
+// Each write is journaled under an idempotency key before it is sent, and acknowledged once the service has
+// answered it. Xbox Live services don't deduplicate on the key, so a write whose answer was lost to a crash
+// may be applied twice on replay. Appends are group committed: everything recorded within GROUP_COMMIT_WINDOW
+// goes to disk with a single flush. The file is truncated once nothing is pending, and compacted down to the
+// pending writes when it is opened. A crash can only tear the last line, which no longer parses and is dropped.
+class write_behind_journal : public std::enable_shared_from_this<write_behind_journal>
+{
+public:
+    static std::shared_ptr<write_behind_journal> get_write_behind_journal_singleton();
+
+    write_behind_journal();
+    ~write_behind_journal();
+
+    // Opens the journal in journalDirectory, loading any writes a previous run left pending
+    xbox_live_result<void> open(_In_ const string_t& journalDirectory);
+
+    // Commits what has been recorded and closes the file. Pending writes stay on disk.
+    void close();
+
+    bool is_open();
+
+    // Journals httpCall's request before it is sent. Returns the write's idempotency key, or an empty
+    // string when the journal isn't open. Set supersedesEarlier for requests that carry a whole document,
+    // so that older pending writes to the same path are dropped rather than replayed over newer data.
+    string_t record(
+        _In_ const string_t& xboxUserId,
+        _In_ xbox_live_api xboxLiveApi,
+        _In_ const std::shared_ptr<http_call>& httpCall,
+        _In_ bool supersedesEarlier = false
+        );
+
+    // Acknowledges the write once the service has answered it. Failures worth retrying leave it pending.
+    void complete(
+        _In_ const string_t& idempotencyKey,
+        _In_ const std::shared_ptr<http_call_response>& response
+        );
+
+    bool has_pending_writes(_In_ const string_t& xboxUserId);
+    size_t pending_write_count();
+    uint64_t commit_count();
+
+    // Sends the user's pending writes again, oldest first. Completes once each has been answered, along with
+    // any replay for the user that is already in flight. Every xbox_live_context_impl starts one in init().
+    pplx::task<void> replay(
+        _In_ const std::shared_ptr<xbox::services::user_context>& userContext,
+        _In_ const std::shared_ptr<xbox::services::xbox_live_context_settings>& xboxLiveContextSettings
+        );
+
+    // Writes everything recorded so far to disk now instead of at the end of the window
+    void commit();
+
+    static const std::chrono::milliseconds GROUP_COMMIT_WINDOW;
+    static const string_t JOURNAL_FILE_NAME;
+    static const string_t IDEMPOTENCY_KEY_HEADER;
+
+private:
+    struct journal_write
+    {
+        string_t idempotencyKey;
+        string_t xboxUserId;
+        xbox_live_api xboxLiveApi;
+        string_t httpMethod;
+        string_t serverName;
+        string_t pathQueryFragment;
+        string_t contractVersion;
+        string_t requestBody;
+        bool retryAllowed;
+        bool supersedesEarlier;
+        bool inFlight;
+    };
+
+    static web::json::value serialize_write(_In_ const journal_write& write);
+    static web::json::value serialize_ack(_In_ const string_t& idempotencyKey);
+    static bool should_keep_pending(_In_ const std::shared_ptr<http_call_response>& response);
+
+    pplx::task<void> send_writes(
+        _In_ const std::vector<journal_write>& writesToReplay,
+        _In_ const std::shared_ptr<xbox::services::user_context>& userContext,
+        _In_ const std::shared_ptr<xbox::services::xbox_live_context_settings>& xboxLiveContextSettings
+        );
+
+    void load();
+    void apply(_In_ const web::json::value& line);
+    void add_write(_In_ journal_write write);
+    void append(_In_ const web::json::value& line);
+    void schedule_commit();
+    bool write_lines(
+        _In_ const std::string& lines,
+        _In_ bool truncate
+        );
+
+    xsapi_mutex m_lock XSAPI_LOCK_SITE("write_behind_journal::m_lock");
+    xsapi_mutex m_fileLock XSAPI_LOCK_SITE("write_behind_journal::m_fileLock");
+    string_t m_filePath;
+    FILE* m_file;
+    std::vector<journal_write> m_writes;
+    std::unordered_map<string_t, pplx::task<void>> m_replayTasks;
+    std::string m_uncommittedLines;
+    bool m_commitScheduled;
+    uint64_t m_commitCount;
+};
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_CPP_END
@@ -13,7 +13,7 @@ std::shared_ptr<xbox_live_app_config>
 xbox_live_app_config::get_app_config_singleton()
 {
     auto xsapiSingleton = xbox::services::get_xsapi_singleton();
-    std::lock_guard<std::mutex> guard(xsapiSingleton->m_appConfigLock);
+    std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_appConfigLock);
     if (xsapiSingleton->m_appConfigSingleton == nullptr)
     {
         xsapiSingleton->m_appConfigSingleton = std::shared_ptr<xbox_live_app_config>(new xbox_live_app_config());
@@ -9,6 +9,9 @@
 #include "Logger/debug_output.h"
 #endif
 #include "Logger/custom_output.h"
+#include "write_behind_journal.h"
+#include "flight_recorder.h"
+#include "span_tracer.h"
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_BEGIN
 
@@ -19,7 +22,7 @@ std::shared_ptr<xbox_live_services_settings> xbox_live_services_settings::get_si
         return nullptr;
     
     {
-        std::lock_guard<std::mutex> guard(xsapiSingleton->m_serviceSettingsLock);
+        std::lock_guard<xsapi_mutex> guard(xsapiSingleton->m_serviceSettingsLock);
         if (xsapiSingleton->m_xboxServiceSettingsSingleton == nullptr)
         {
             xsapiSingleton->m_xboxServiceSettingsSingleton = std::shared_ptr<xbox_live_services_settings>(new xbox_live_services_settings());
@@ -91,6 +94,44 @@ void xbox_live_services_settings::remove_wns_handler(_In_ function_context conte
     m_wnsHandlers.erase(context);
 }
 
+xbox_live_result<void> xbox_live_services_settings::enable_write_journal(_In_ const string_t& journalDirectory)
+{
+    return write_behind_journal::get_write_behind_journal_singleton()->open(journalDirectory);
+}
+
+void xbox_live_services_settings::disable_write_journal()
+{
+    write_behind_journal::get_write_behind_journal_singleton()->close();
+}
+
+xbox_live_result<void> xbox_live_services_settings::dump_flight_recorder(_In_ const string_t& filePath)
+{
+    return flight_recorder::get_flight_recorder_singleton()->dump(filePath);
+}
+
+void xbox_live_services_settings::set_flight_recorder_crash_dump_path(_In_ const string_t& filePath)
+{
+    flight_recorder::get_flight_recorder_singleton()->set_crash_dump_path(filePath);
+}
+
+void xbox_live_services_settings::start_span_tracing()
+{
+    span_tracer::get_span_tracer_singleton()->set_exporter(std::make_shared<chrome_trace_exporter>());
+}
+
+xbox_live_result<void> xbox_live_services_settings::stop_span_tracing(_In_ const string_t& filePath)
+{
+    auto tracer = span_tracer::get_span_tracer_singleton();
+    auto exporter = std::dynamic_pointer_cast<chrome_trace_exporter>(tracer->exporter());
+    tracer->set_exporter(nullptr);
+    if (exporter == nullptr || filePath.empty())
+    {
+        return xbox_live_result<void>();
+    }
+
+    return exporter->write(filePath);
+}
+
 xbox_services_diagnostics_trace_level xbox_live_services_settings::diagnostics_trace_level() const
 {
     return m_traceLevel;
@@ -18,7 +18,7 @@ std::shared_ptr<xbox_system_factory>
 xbox_system_factory::get_factory()
 {
     auto xsapiSingleton = get_xsapi_singleton();
-    std::lock_guard<std::mutex> hold(xsapiSingleton->m_singletonLock);
+    std::lock_guard<xsapi_mutex> hold(xsapiSingleton->m_singletonLock);
     if (xsapiSingleton->m_factoryInstance == nullptr)
     {
         xsapiSingleton->m_factoryInstance = std::make_shared<xbox_system_factory>();
@@ -31,7 +31,7 @@ void xbox_system_factory::set_factory(
     )
 {
     auto xsapiSingleton = get_xsapi_singleton();
-    std::lock_guard<std::mutex> hold(xsapiSingleton->m_singletonLock);
+    std::lock_guard<xsapi_mutex> hold(xsapiSingleton->m_singletonLock);
     xsapiSingleton->m_factoryInstance = factory;
 }
 
@@ -65,7 +65,7 @@ auth_config::auth_config(
 
 const string_t& auth_config::rps_ticket_service() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     return m_rpsTicketService;
 }
 
@@ -73,13 +73,13 @@ void auth_config::set_rps_ticket_service(
     _In_ string_t value
     )
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     m_rpsTicketService = std::move(value);
 }
 
 const string_t& auth_config::rps_ticket_policy() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     return m_rpsTicketPolicy;
 }
 
@@ -87,13 +87,13 @@ void auth_config::set_rps_ticket_policy(
     _In_ string_t value
     )
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     m_rpsTicketPolicy = std::move(value);
 }
 
 const string_t& auth_config::xbox_live_endpoint() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     return m_xboxLiveEndpoint;
 }
 
@@ -101,7 +101,7 @@ void auth_config::set_xbox_live_endpoint(
     _In_ string_t value
 )
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     m_xboxLiveEndpoint = std::move(value);
 }
 
@@ -123,13 +123,13 @@ bool auth_config::use_compact_ticket() const
 
 const string_t& auth_config::environment() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     return m_environment;
 }
 
 const string_t& auth_config::device_token_endpoint() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     return m_deviceTokenEndpoint;
 }
 
@@ -137,13 +137,13 @@ void auth_config::set_device_token_endpoint(
     _In_ string_t value
     )
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     m_deviceTokenEndpoint = std::move(value);
 }
 
 const string_t& auth_config::title_token_endpoint() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     return m_titleTokenEndpoint;
 }
 
@@ -151,13 +151,13 @@ void auth_config::set_title_token_endpoint(
     _In_ string_t value
     )
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     m_titleTokenEndpoint = std::move(value);
 }
 
 const string_t& auth_config::user_token_site_name() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     return m_userTokenSiteName;
 }
 
@@ -165,13 +165,13 @@ void auth_config::set_user_token_site_name(
     _In_ string_t value
     )
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     m_userTokenSiteName = std::move(value);
 }
 
 const string_t& auth_config::user_token_endpoint() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     return m_userTokenEndpoint;
 }
 
@@ -179,13 +179,13 @@ void auth_config::set_user_token_endpoint(
     _In_ string_t value
     )
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     m_userTokenEndpoint = std::move(value);
 }
 
 const string_t& auth_config::service_token_endpoint() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     return m_serviceTokenEndpoint;
 }
 
@@ -193,13 +193,13 @@ void auth_config::set_service_token_endpoint(
     _In_ string_t value
     )
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     m_serviceTokenEndpoint = std::move(value);
 }
 
 const string_t& auth_config::xbox_live_relying_party() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     return m_xboxLiveRelyingParty;
 }
 
@@ -207,13 +207,13 @@ void auth_config::set_xbox_live_relying_party(
     _In_ string_t value
     )
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     m_xboxLiveRelyingParty = std::move(value);
 }
 
 const string_t& auth_config::x_token_endpoint() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     return m_xTokenEndpoint;
 }
 
@@ -221,13 +221,13 @@ void auth_config::set_x_token_endpoint(
     _In_ string_t value
     )
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     m_xTokenEndpoint = std::move(value);
 }
 
 const string_t& auth_config::x_title_endpoint() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     return m_xTitleEndpoint;
 }
 
@@ -235,31 +235,31 @@ void auth_config::set_x_title_endpoint(
     _In_ string_t value
     )
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     m_xTitleEndpoint = std::move(value);
 }
 
 void auth_config::set_app_id(string_t appId)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     m_appId = std::move(appId);
 }
 
 const string_t& auth_config::app_id() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     return m_appId;
 }
 
 void auth_config::set_microsoft_account_id(string_t accountId)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     m_accountId = std::move(accountId);
 }
 
 const string_t& auth_config::microsoft_account_id() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     return m_accountId;
 }
 
@@ -275,32 +275,32 @@ uint32_t auth_config::detail_error() const
 
 void auth_config::reset()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     m_redirect.clear();
     m_detailError = 0;
 }
 
 void auth_config::set_redirect(_In_ string_t value)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     m_redirect = std::move(value);
 }
 
 const string_t& auth_config::redirect() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     return m_redirect;
 }
 
 const std::vector<token_identity_type>& auth_config::xtoken_composition() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     return m_xtokenComposition;
 }
 
 void auth_config::set_xtoken_composition(std::vector<token_identity_type> value)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<xsapi_mutex> lock(m_mutex);
     m_xtokenComposition = value;
 }
 
@@ -94,7 +94,7 @@ public:
     void reset();
 
 private:
-    mutable std::mutex m_mutex;
+    mutable xsapi_mutex m_mutex XSAPI_LOCK_SITE("auth_config::m_mutex");
     string_t m_sandbox;
     string_t m_rpsTicketService;
     string_t m_rpsTicketPolicy;
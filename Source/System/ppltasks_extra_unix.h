@@ -9,7 +9,7 @@ namespace Concurrency
     namespace extras
     {
         template <typename Func>
-        pplx::task<void> create_delayed_task(std::chrono::milliseconds delay, Func func)
+        auto create_delayed_task(std::chrono::milliseconds delay, Func func) -> decltype(pplx::create_task(func))
         {
             pplx::task_completion_event<void> tce;
             
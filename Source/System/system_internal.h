@@ -9,11 +9,19 @@ class xbox_live_mutex
 {
 public:
     xbox_live_mutex();
+#if XSAPI_LOCK_PROFILING
+    // siteName groups this mutex with others of the same name in the lock profiler. Members name their
+    // site with XSAPI_LOCK_SITE, which compiles away along with this constructor when profiling is off.
+    explicit xbox_live_mutex(_In_ const char* siteName);
+#endif
     xbox_live_mutex(_In_ const xbox_live_mutex& other);
     xbox_live_mutex operator=(_In_ const xbox_live_mutex& other);
-    std::mutex& get();
+    xsapi_mutex& get();
 private:
-    std::mutex m_xboxLiveMutex;
+#if XSAPI_LOCK_PROFILING
+    const char* m_siteName;
+#endif
+    xsapi_mutex m_xboxLiveMutex;
 };
 
 
@@ -124,7 +124,7 @@ user_impl::user_signed_in(
 {
     std::unordered_map<function_context, std::function<void(const string_t&)>> signInCompletedHandlersCopy;
     {
-        std::lock_guard<std::mutex> lock(m_lock.get());
+        std::lock_guard<xsapi_mutex> lock(m_lock.get());
 
         m_xboxUserId = std::move(xboxUserId);
         m_gamertag = std::move(gamertag);
@@ -162,7 +162,7 @@ user_impl::add_sign_in_completed_handler(
     )
 {
     auto xsapiSingleton = get_xsapi_singleton();
-    std::lock_guard<std::mutex> lock(xsapiSingleton->m_trackingUsersLock);
+    std::lock_guard<xsapi_mutex> lock(xsapiSingleton->m_trackingUsersLock);
 
     function_context context = -1;
     if (handler != nullptr)
@@ -180,7 +180,7 @@ user_impl::remove_sign_in_completed_handler(
     )
 {
     auto xsapiSingleton = get_xsapi_singleton();
-    std::lock_guard<std::mutex> lock(xsapiSingleton->m_trackingUsersLock);
+    std::lock_guard<xsapi_mutex> lock(xsapiSingleton->m_trackingUsersLock);
     xsapiSingleton->m_signInCompletedHandlers.erase(context);
 }
 
@@ -188,7 +188,7 @@ function_context
 user_impl::add_sign_out_completed_handler(_In_ std::function<void(const sign_out_completed_event_args&)> handler)
 {
     auto xsapiSingleton = get_xsapi_singleton();
-    std::lock_guard<std::mutex> lock(xsapiSingleton->m_trackingUsersLock);
+    std::lock_guard<xsapi_mutex> lock(xsapiSingleton->m_trackingUsersLock);
 
     function_context context = -1;
     if (handler != nullptr)
@@ -206,7 +206,7 @@ user_impl::remove_sign_out_completed_handler(
     )
 {
     auto xsapiSingleton = get_xsapi_singleton();
-    std::lock_guard<std::mutex> lock(xsapiSingleton->m_trackingUsersLock);
+    std::lock_guard<xsapi_mutex> lock(xsapiSingleton->m_trackingUsersLock);
     xsapiSingleton->m_signOutCompletedHandlers.erase(context);
 }
 
@@ -215,7 +215,7 @@ void user_impl::user_signed_out()
     bool isSignedIn;
     std::unordered_map<function_context, std::function<void(const sign_out_completed_event_args&)>> signOutHandlers;
     {
-        std::lock_guard<std::mutex> lock(m_lock.get());
+        std::lock_guard<xsapi_mutex> lock(m_lock.get());
         isSignedIn = m_isSignedIn;
         m_isSignedIn = false;
         signOutHandlers = get_xsapi_singleton()->m_signOutCompletedHandlers;
@@ -241,7 +241,7 @@ void user_impl::user_signed_out()
         }
 
         {
-            std::lock_guard<std::mutex> lock(m_lock.get());
+            std::lock_guard<xsapi_mutex> lock(m_lock.get());
             // Check again on isSignedIn flag, in case users signed in again in signOutHandlers callback,
             // so we don't clean up the properties. 
             if (!isSignedIn)
@@ -138,7 +138,7 @@ protected:
 
     std::shared_ptr<auth_config> m_authConfig;
     std::shared_ptr<local_config> m_localConfig;
-    xbox::services::system::xbox_live_mutex m_lock;
+    xbox::services::system::xbox_live_mutex m_lock XSAPI_LOCK_SITE("user_impl::m_lock");
 };
 
 #if UWP_API
@@ -38,7 +38,7 @@ user_impl_idp::sign_in_impl(_In_ bool showUI, _In_ bool forceRefresh)
     if (is_multi_user_application())
     {
         auto xsapiSingleton = get_xsapi_singleton();
-        std::lock_guard<std::mutex> lock(xsapiSingleton->m_trackingUsersLock);
+        std::lock_guard<xsapi_mutex> lock(xsapiSingleton->m_trackingUsersLock);
 
         if (xsapiSingleton->m_userWatcher == nullptr)
         {
@@ -578,7 +578,7 @@ user_impl_idp::user_signed_in(
         if (m_creationContext != nullptr)
         {
             auto xsapiSingleton = get_xsapi_singleton();
-            std::lock_guard<std::mutex> lock(xsapiSingleton->m_trackingUsersLock);
+            std::lock_guard<xsapi_mutex> lock(xsapiSingleton->m_trackingUsersLock);
             xsapiSingleton->m_trackingUsers[m_creationContext->NonRoamableId->Data()] = std::dynamic_pointer_cast<user_impl_idp>(shared_from_this());
         }
     }
@@ -592,7 +592,7 @@ void user_impl_idp::user_signed_out()
     if (m_creationContext != nullptr)
     {
         auto xsapiSingleton = get_xsapi_singleton();
-        std::lock_guard<std::mutex> lock(xsapiSingleton->m_trackingUsersLock);
+        std::lock_guard<xsapi_mutex> lock(xsapiSingleton->m_trackingUsersLock);
         xsapiSingleton->m_trackingUsers.erase(m_creationContext->NonRoamableId->Data());
     }
 
@@ -628,7 +628,7 @@ void user_impl_idp::on_system_user_removed(Windows::System::UserWatcher ^sender,
     std::shared_ptr<user_impl_idp> signOutUser;
     {
         auto xsapiSingleton = get_xsapi_singleton();
-        std::lock_guard<std::mutex> lock(xsapiSingleton->m_trackingUsersLock);
+        std::lock_guard<xsapi_mutex> lock(xsapiSingleton->m_trackingUsersLock);
         auto user = xsapiSingleton->m_trackingUsers.find(args->User->NonRoamableId->Data());
         if (user != xsapiSingleton->m_trackingUsers.end())
         {
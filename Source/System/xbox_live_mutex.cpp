@@ -6,6 +6,30 @@
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_BEGIN
 
+#if XSAPI_LOCK_PROFILING
+xbox_live_mutex::xbox_live_mutex() :
+    xbox_live_mutex("xbox_live_mutex")
+{
+}
+
+xbox_live_mutex::xbox_live_mutex(_In_ const char* siteName) :
+    m_siteName(siteName),
+    m_xboxLiveMutex(siteName)
+{
+}
+
+// Copies only the site name; each copy gets its own lock
+xbox_live_mutex::xbox_live_mutex(_In_ const xbox_live_mutex& other) :
+    xbox_live_mutex(other.m_siteName)
+{
+}
+
+xbox_live_mutex
+xbox_live_mutex::operator=(_In_ const xbox_live_mutex& other)
+{
+    return xbox_live_mutex(other.m_siteName);
+}
+#else
 xbox_live_mutex::xbox_live_mutex()
 {
 }
@@ -21,8 +45,9 @@ xbox_live_mutex::operator=(_In_ const xbox_live_mutex& other)
     UNREFERENCED_PARAMETER(other);
     return xbox_live_mutex();
 }
+#endif
 
-std::mutex&
+xsapi_mutex&
 xbox_live_mutex::get()
 {
     return m_xboxLiveMutex;
@@ -212,6 +212,14 @@ MockHttpCall::set_request_body(
     m_requestBody = http_call_request_message(value);
 }
 
+void
+MockHttpCall::set_request_body(
+    _In_ std::vector<BYTE>&& value
+    )
+{
+    m_requestBody = http_call_request_message(std::move(value));
+}
+
 const http_call_request_message& MockHttpCall::request_body() const
 {
     return m_requestBody;
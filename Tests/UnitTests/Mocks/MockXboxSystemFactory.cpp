@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "MockXboxSystemFactory.h"
+#include "write_behind_journal.h"
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_BEGIN
 
@@ -19,7 +20,7 @@ MockXboxSystemFactory::MockXboxSystemFactory() :
 std::shared_ptr<MockWebSocketClient>
 MockXboxSystemFactory::GetMockWebSocketClient()
 {
-    std::lock_guard<std::mutex> lock(m_websocketLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_websocketLock.get());
     if (m_mockWebSocketClients.size() == 0)
     {
         auto webSocketCient = std::make_shared<MockWebSocketClient>();
@@ -32,14 +33,14 @@ MockXboxSystemFactory::GetMockWebSocketClient()
 std::vector<std::shared_ptr<MockWebSocketClient>>
 MockXboxSystemFactory::GetMockWebSocketClients()
 {
-    std::lock_guard<std::mutex> lock(m_websocketLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_websocketLock.get());
     return m_mockWebSocketClients;
 }
 
 std::vector<std::shared_ptr<MockWebSocketClient>>
 MockXboxSystemFactory::AddMultipleMockWebSocketClients(uint32_t numberOfClients)
 {
-    std::lock_guard<std::mutex> lock(m_websocketLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_websocketLock.get());
     for (uint32_t i = 0; i < numberOfClients; ++i)
     {
         auto webSocketCient = std::make_shared<MockWebSocketClient>();
@@ -50,8 +51,8 @@ MockXboxSystemFactory::AddMultipleMockWebSocketClients(uint32_t numberOfClients)
 
 void MockXboxSystemFactory::reinit()
 {
-    std::lock_guard<std::mutex> lock(m_httpLock.get());
-    std::lock_guard<std::mutex> wsLock(m_websocketLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_httpLock.get());
+    std::lock_guard<xsapi_mutex> wsLock(m_websocketLock.get());
 
     m_websocketResponses = std::queue<WebsocketMockResponse>();
     m_httpStateResponses.clear();
@@ -62,6 +63,12 @@ void MockXboxSystemFactory::reinit()
     m_mockWebSocketClients.clear();
     m_webSocketClientCounter = 0;
     m_setupMockForHttpClient = false;
+    m_httpClientFactory = nullptr;
+
+    // Circuit state and pooled clients outlive a test, and many tests deliberately fail calls
+    xbox::services::http_endpoint_health_manager::get_http_endpoint_health_manager_singleton()->reset();
+    xbox::services::http_client_pool::get_http_client_pool_singleton()->reset();
+    xbox::services::write_behind_journal::get_write_behind_journal_singleton()->close();
 }
 
 std::shared_ptr<http_call> MockXboxSystemFactory::create_http_call(
@@ -72,7 +79,7 @@ std::shared_ptr<http_call> MockXboxSystemFactory::create_http_call(
     _In_ xbox_live_api xboxLiveApi
     )
 {
-    std::lock_guard<std::mutex> lock(m_httpLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_httpLock.get());
     if (m_setupMockForHttpClient)
     {
         return xbox_system_factory::create_http_call(xboxLiveContextSettings, httpMethod, serverName, pathQueryFragment, xboxLiveApi);
@@ -125,7 +132,7 @@ std::shared_ptr<http_call_internal> MockXboxSystemFactory::create_http_call_inte
     _In_ const web::uri& pathQueryFragment
     ) 
 {
-    std::lock_guard<std::mutex> lock(m_httpLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_httpLock.get());
     m_mockHttpCall->HttpMethod = httpMethod;
     m_mockHttpCall->ServerName = serverName;
     m_mockHttpCall->PathQueryFragment = pathQueryFragment;
@@ -137,7 +144,7 @@ void MockXboxSystemFactory::add_http_state_response(
     _In_ bool overrideStateValue
     )
 {
-    std::lock_guard<std::mutex> lock(m_httpLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_httpLock.get());
     if (overrideStateValue)
     {
         m_httpStateResponses = stateResponses;
@@ -156,7 +163,7 @@ void MockXboxSystemFactory::add_http_api_state_response(
     _In_ bool overrideStateValue
     )
 {
-    std::lock_guard<std::mutex> lock(m_httpLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_httpLock.get());
     if (overrideStateValue)
     {
         m_httpApiStateResponses = stateResponses;
@@ -175,7 +182,7 @@ void MockXboxSystemFactory::add_websocket_state_responses_to_all_clients(
     _In_ const pplx::task_completion_event<void>& websocketCompletionEvent
     )
 {
-    std::lock_guard<std::mutex> lock(m_websocketLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_websocketLock.get());
     m_websocketCompletionEvent = websocketCompletionEvent;
     m_websocketResponses = stateResponses;
     SetupNextWebsocketResponsesForAllClients();
@@ -221,8 +228,8 @@ void MockXboxSystemFactory::SetupNextWebsocketResponsesForAllClients()
 
 void MockXboxSystemFactory::clear_states()
 {
-    std::lock_guard<std::mutex> lock(m_httpLock.get());
-    std::lock_guard<std::mutex> wsLock(m_websocketLock.get());
+    std::lock_guard<xsapi_mutex> lock(m_httpLock.get());
+    std::lock_guard<xsapi_mutex> wsLock(m_websocketLock.get());
     m_httpStateResponses.clear();
     m_httpApiStateResponses.clear();
     m_websocketResponses = std::queue<WebsocketMockResponse>();
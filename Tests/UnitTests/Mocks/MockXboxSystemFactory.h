@@ -41,6 +41,10 @@ public:
         _In_ const web::http::client::http_client_config& client_config
         ) override
     { 
+        if (m_httpClientFactory)
+        {
+            return m_httpClientFactory(base_uri);
+        }
         return m_mockHttpClient; 
     }
     
@@ -101,6 +105,7 @@ public:
     void clear_states();
     void reinit();
     void setup_mock_for_http_client() { m_setupMockForHttpClient = true; }
+    void set_http_client_factory(_In_ std::function<std::shared_ptr<xbox_http_client>(const web::http::uri&)> httpClientFactory) { m_httpClientFactory = std::move(httpClientFactory); }
 
 private:
     void SetupNextWebsocketResponseForDefaultClient();
@@ -111,13 +116,14 @@ private:
     std::shared_ptr<MockUser> m_mockUser;
     std::shared_ptr<MockHttpCall> m_mockHttpCall;
     std::shared_ptr<MockHttpClient> m_mockHttpClient;
+    std::function<std::shared_ptr<xbox_http_client>(const web::http::uri&)> m_httpClientFactory;
     std::vector<std::shared_ptr<MockWebSocketClient>> m_mockWebSocketClients;
     std::shared_ptr<MockLocalConfig> m_mockLocalConfig;
     std::shared_ptr<local_config> m_localConfig;
     std::shared_ptr<MockMultiplayerSubscription> m_multiplayerSubscription;
 
-    xbox::services::system::xbox_live_mutex m_httpLock;
-    xbox::services::system::xbox_live_mutex m_websocketLock;
+    xbox::services::system::xbox_live_mutex m_httpLock XSAPI_LOCK_SITE("MockXboxSystemFactory::m_httpLock");
+    xbox::services::system::xbox_live_mutex m_websocketLock XSAPI_LOCK_SITE("MockXboxSystemFactory::m_websocketLock");
     std::chrono::milliseconds m_delayTime;
     std::unordered_map<string_t, std::shared_ptr<HttpResponseStruct>> m_httpStateResponses;
     std::unordered_map<xbox_live_api, std::shared_ptr<HttpResponseStruct>> m_httpApiStateResponses;
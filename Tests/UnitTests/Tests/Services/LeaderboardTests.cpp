@@ -619,6 +619,169 @@ public:
             E_INVALIDARG
         )
     }
+
+    // A stats 2017 page with one column of each storage type plus a second of each numeric one.
+    // Gamertags repeat every gamertagCount rows, as they would across pages of a social leaderboard.
+    static web::json::value CreateTypedLeaderboardPage(
+        _In_ uint32_t rowCount,
+        _In_ uint32_t gamertagCount
+        )
+    {
+        web::json::value page;
+        page[L"leaderboardInfo"][L"totalCount"] = web::json::value::number(rowCount);
+        const wchar_t* columnTypes[] = { L"Integer", L"Double", L"String", L"Integer", L"Double" };
+        for (uint32_t column = 0; column < 5; ++column)
+        {
+            page[L"leaderboardInfo"][L"columns"][column][L"statName"] = web::json::value::string(L"stat" + std::to_wstring(column));
+            page[L"leaderboardInfo"][L"columns"][column][L"type"] = web::json::value::string(columnTypes[column]);
+        }
+
+        auto& userList = page[L"userList"] = web::json::value::array(rowCount);
+        for (uint32_t row = 0; row < rowCount; ++row)
+        {
+            auto& jsonRow = userList[row];
+            jsonRow[L"gamertag"] = web::json::value::string(L"Gamer" + std::to_wstring(row % gamertagCount));
+            jsonRow[L"xuid"] = web::json::value::string(std::to_wstring(2533274790000000ULL + row));
+            jsonRow[L"percentile"] = web::json::value::number(1.0 - static_cast<double>(row) / rowCount);
+            jsonRow[L"rank"] = web::json::value::number(row + 1);
+            jsonRow[L"values"][0] = web::json::value::string(std::to_wstring(1000000 - row));
+            jsonRow[L"values"][1] = web::json::value::string(std::to_wstring(row) + L".5");
+            jsonRow[L"values"][2] = web::json::value::string(row % 2 == 0 ? L"Hardcore" : L"Casual");
+            jsonRow[L"values"][3] = web::json::value::string(std::to_wstring(-static_cast<int64_t>(row)));
+            jsonRow[L"values"][4] = web::json::value::string(L"0.25");
+        }
+
+        return page;
+    }
+
+    DEFINE_TEST_CASE(TestLeaderboardTableTypedColumns)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestLeaderboardTableTypedColumns);
+        auto result = serializers::deserialize_result(CreateTypedLeaderboardPage(10, 10), nullptr, nullptr, nullptr, _T("2017"));
+        VERIFY_IS_TRUE(!result.err());
+        auto table = result.payload().to_table();
+
+        VERIFY_ARE_EQUAL_UINT(10, table.row_count());
+        VERIFY_ARE_EQUAL_UINT(5, table.columns().size());
+        VERIFY_IS_TRUE(table.column_storage(0) == leaderboard_column_storage::uint64);
+        VERIFY_IS_TRUE(table.column_storage(1) == leaderboard_column_storage::floating_point);
+        VERIFY_IS_TRUE(table.column_storage(2) == leaderboard_column_storage::string);
+
+        // Row 3 as the service sent it, read back without string conversions
+        VERIFY_ARE_EQUAL_STR(L"Gamer3", table.gamertag(3));
+        VERIFY_IS_TRUE(table.xbox_user_id(3) == 2533274790000003ULL);
+        VERIFY_ARE_EQUAL_UINT(4, table.rank(3));
+        VERIFY_IS_TRUE(table.percentile(3) == 0.7);
+        VERIFY_IS_TRUE(table.uint64_value(3, 0) == 999997);
+        VERIFY_IS_TRUE(table.double_value(3, 1) == 3.5);
+        VERIFY_ARE_EQUAL_STR(L"Casual", table.string_value(3, 2));
+        VERIFY_ARE_EQUAL_INT(-3, table.int64_value(3, 3));
+
+        // Reading a column as the other numeric type converts; reading it as a string doesn't
+        VERIFY_IS_TRUE(table.double_value(3, 0) == 999997.0);
+        VERIFY_ARE_EQUAL_INT(3, table.int64_value(3, 1));
+        VERIFY_ARE_EQUAL_INT(0, table.int64_value(3, 2));
+        VERIFY_ARE_EQUAL_STR(L"", table.string_value(3, 0));
+        VERIFY_IS_TRUE(table.uint64_value(3, 1) == 3);
+        VERIFY_IS_TRUE(table.uint64_value(3, 2) == 0);
+
+        // Integer statistics use the full unsigned range
+        auto page = CreateTypedLeaderboardPage(1, 1);
+        page[L"userList"][0][L"values"][0] = web::json::value::string(L"18446744073709551615");
+        auto maxValueResult = serializers::deserialize_result(page, nullptr, nullptr, nullptr, _T("2017"));
+        VERIFY_IS_TRUE(!maxValueResult.err());
+        VERIFY_IS_TRUE(maxValueResult.payload().to_table().uint64_value(0, 0) == 18446744073709551615ULL);
+
+        // Rows stay in service order
+        for (size_t row = 0; row < table.row_count(); ++row)
+        {
+            VERIFY_ARE_EQUAL_STR(result.payload().rows()[row].xbox_user_id(), std::to_wstring(table.xbox_user_id(row)));
+        }
+    }
+
+    DEFINE_TEST_CASE(TestLeaderboardTableInternsStrings)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestLeaderboardTableInternsStrings);
+        auto result = serializers::deserialize_result(CreateTypedLeaderboardPage(100, 4), nullptr, nullptr, nullptr, _T("2017"));
+        VERIFY_IS_TRUE(!result.err());
+        auto table = result.payload().to_table();
+
+        // One copy per distinct gamertag and column string, shared by every row that has it
+        VERIFY_IS_TRUE(&table.gamertag(0) == &table.gamertag(4));
+        VERIFY_IS_TRUE(&table.gamertag(1) != &table.gamertag(2));
+        VERIFY_IS_TRUE(&table.string_value(0, 2) == &table.string_value(98, 2));
+        VERIFY_ARE_EQUAL_STR(L"Gamer1", table.gamertag(97));
+
+        // A row missing its values reads as zero and empty rather than failing
+        auto page = CreateTypedLeaderboardPage(2, 2);
+        page[L"userList"][1][L"values"] = web::json::value::array();
+        auto shortRowResult = serializers::deserialize_result(page, nullptr, nullptr, nullptr, _T("2017"));
+        auto shortRowTable = shortRowResult.payload().to_table();
+        VERIFY_ARE_EQUAL_INT(0, shortRowTable.int64_value(1, 0));
+        VERIFY_IS_TRUE(shortRowTable.double_value(1, 1) == 0);
+        VERIFY_ARE_EQUAL_STR(L"", shortRowTable.string_value(1, 2));
+    }
+
+    DEFINE_TEST_CASE(TestLeaderboardTableParseBenchmark)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestLeaderboardTableParseBenchmark);
+        const uint32_t rowCount = 1000;
+        const uint32_t frameCount = 60;
+        auto page = CreateTypedLeaderboardPage(rowCount, 250);
+
+        auto parseStart = std::chrono::steady_clock::now();
+        auto result = serializers::deserialize_result(page, nullptr, nullptr, nullptr, _T("2017"));
+        auto parseEnd = std::chrono::steady_clock::now();
+        auto table = result.payload().to_table();
+        auto tableEnd = std::chrono::steady_clock::now();
+        VERIFY_ARE_EQUAL_UINT(rowCount, table.row_count());
+
+        // What a title sorting by a numeric column does each frame with either representation
+        const auto& rows = result.payload().rows();
+        std::vector<size_t> order(rowCount);
+        auto rowsSortStart = std::chrono::steady_clock::now();
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+            std::sort(order.begin(), order.end(), [&rows](size_t a, size_t b)
+            {
+                return std::stod(rows[a].column_values()[1]) > std::stod(rows[b].column_values()[1]);
+            });
+        }
+        auto rowsSortEnd = std::chrono::steady_clock::now();
+        std::vector<size_t> tableOrder(rowCount);
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            for (size_t i = 0; i < tableOrder.size(); ++i) tableOrder[i] = i;
+            std::sort(tableOrder.begin(), tableOrder.end(), [&table](size_t a, size_t b)
+            {
+                return table.double_value(a, 1) > table.double_value(b, 1);
+            });
+        }
+        auto tableSortEnd = std::chrono::steady_clock::now();
+        VERIFY_IS_TRUE(order == tableOrder);
+
+        size_t rowsBytes = rows.capacity() * sizeof(leaderboard_row);
+        for (const auto& row : rows)
+        {
+            rowsBytes += (row.gamertag().capacity() + row.xbox_user_id().capacity()) * sizeof(wchar_t);
+            rowsBytes += row.column_values().capacity() * sizeof(string_t);
+            for (const auto& value : row.column_values())
+            {
+                rowsBytes += value.capacity() * sizeof(wchar_t);
+            }
+        }
+
+        auto toMicroseconds = [](std::chrono::steady_clock::duration duration)
+        {
+            return static_cast<int>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+        };
+        TEST_LOG(FormatString(L"%d rows x 5 columns: parse %d us, build table %d us", static_cast<int>(rowCount), toMicroseconds(parseEnd - parseStart), toMicroseconds(tableEnd - parseEnd)).c_str());
+        TEST_LOG(FormatString(L"%d sorted frames: rows %d us, table %d us", static_cast<int>(frameCount), toMicroseconds(rowsSortEnd - rowsSortStart), toMicroseconds(tableSortEnd - rowsSortEnd)).c_str());
+        TEST_LOG(FormatString(L"Memory: rows ~%d bytes, table ~%d bytes", static_cast<int>(rowsBytes), static_cast<int>(table.memory_footprint())).c_str());
+
+        VERIFY_IS_TRUE(table.memory_footprint() < rowsBytes);
+    }
 };
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_END
@@ -5,6 +5,7 @@
 #define TEST_CLASS_OWNER L"jasonsa"
 #define TEST_CLASS_AREA L"Marketplace"
 #include "UnitTestIncludes.h"
+#include "xbox_live_context_impl.h"
 
 using namespace Microsoft::Xbox::Services;
 using namespace Microsoft::Xbox::Services::Marketplace;
@@ -1369,6 +1370,105 @@ public:
             )).get(),
             E_INVALIDARG);
     }
+
+    xbox::services::marketplace::inventory_item CreateConsumableInventoryItem(
+        _In_ uint32_t balance
+        )
+    {
+        auto itemJson = web::json::value::parse(defaultInventoryItemsResponse)[L"items"][0];
+        itemJson[L"consumable"][L"quantity"] = web::json::value(balance);
+        return xbox::services::marketplace::inventory_item::_Deserialize(itemJson).payload();
+    }
+
+    static web::json::value CreateConsumeResponse(
+        _In_ uint32_t newQuantity
+        )
+    {
+        auto responseJson = web::json::value::parse(expectedConsumeInventoryItemResponse);
+        responseJson[L"newQuantity"] = web::json::value(newQuantity);
+        return responseJson;
+    }
+
+    DEFINE_TEST_CASE(TestConsumeInventoryItemBatched)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestConsumeInventoryItemBatched);
+
+        auto httpCall = m_mockXboxSystemFactory->GetMockHttpCall();
+        httpCall->ResultValue = StockMocks::CreateMockHttpCallResponse(CreateConsumeResponse(5));
+        XboxLiveContext^ xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto xboxLiveContextImpl = std::make_shared<xbox_live_context_impl>(xboxLiveContext->User);
+        xboxLiveContextImpl->init();
+        auto& inventoryService = xboxLiveContextImpl->inventory_service();
+
+        auto inventoryItem = CreateConsumableInventoryItem(10);
+        std::vector<pplx::task<xbox_live_result<xbox::services::marketplace::consume_inventory_item_result>>> consumeTasks;
+        for (int i = 0; i < 5; ++i)
+        {
+            consumeTasks.push_back(inventoryService.consume_inventory_item_batched(inventoryItem, 1));
+        }
+
+        // The local balance drops before the service has been called
+        VERIFY_ARE_EQUAL_UINT(5, inventoryService.local_consumable_balance(inventoryItem));
+
+        for (auto& consumeTask : consumeTasks)
+        {
+            auto result = consumeTask.get();
+            VERIFY_IS_TRUE(!result.err());
+            VERIFY_ARE_EQUAL_UINT(5, result.payload().consumable_balance());
+        }
+
+        VERIFY_ARE_EQUAL_INT(1, httpCall->CallCounter);
+        VERIFY_ARE_EQUAL_UINT(1, inventoryService._Consumption_service_call_count());
+        auto requestJson = web::json::value::parse(httpCall->request_body().request_message_string());
+        VERIFY_ARE_EQUAL_INT(5, requestJson[L"RemoveQuantity"].as_integer());
+        VERIFY_IS_FALSE(requestJson[L"TransactionId"].as_string().empty());
+        VERIFY_ARE_EQUAL_UINT(5, inventoryService.local_consumable_balance(inventoryItem));
+    }
+
+    DEFINE_TEST_CASE(TestConsumeInventoryItemBatchedRejectedAggregate)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestConsumeInventoryItemBatchedRejectedAggregate);
+
+        // Each consume request gets its own mock http call, so the handler sees every request body
+        auto requestCount = std::make_shared<std::atomic<int>>(0);
+        auto consumeResponseStruct = std::make_shared<HttpResponseStruct>();
+        consumeResponseStruct->responseList = { StockMocks::CreateMockHttpCallResponse(CreateConsumeResponse(0)) };
+        consumeResponseStruct->fRequestPostFunc = [requestCount](std::shared_ptr<http_call_response>& response, const string_t& requestBody)
+        {
+            ++(*requestCount);
+
+            // Only requests for up to two items are accepted
+            auto removeQuantity = web::json::value::parse(requestBody)[L"RemoveQuantity"].as_integer();
+            response = removeQuantity > 2 ?
+                StockMocks::CreateMockHttpCallResponse(L"", 409) :
+                StockMocks::CreateMockHttpCallResponse(CreateConsumeResponse(0));
+        };
+
+        std::unordered_map<xbox_live_api, std::shared_ptr<HttpResponseStruct>> responses;
+        responses[xbox_live_api::consume_inventory_item] = consumeResponseStruct;
+        m_mockXboxSystemFactory->add_http_api_state_response(responses);
+        XboxLiveContext^ xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto xboxLiveContextImpl = std::make_shared<xbox_live_context_impl>(xboxLiveContext->User);
+        xboxLiveContextImpl->init();
+        auto& inventoryService = xboxLiveContextImpl->inventory_service();
+
+        auto inventoryItem = CreateConsumableInventoryItem(4);
+        std::vector<pplx::task<xbox_live_result<xbox::services::marketplace::consume_inventory_item_result>>> consumeTasks;
+        for (int i = 0; i < 4; ++i)
+        {
+            consumeTasks.push_back(inventoryService.consume_inventory_item_batched(inventoryItem, 1));
+        }
+
+        for (auto& consumeTask : consumeTasks)
+        {
+            VERIFY_IS_TRUE(!consumeTask.get().err());
+        }
+
+        // The rejected aggregate of 4 is replayed as two chunks of 2
+        VERIFY_ARE_EQUAL_INT(3, requestCount->load());
+        VERIFY_ARE_EQUAL_UINT(3, inventoryService._Consumption_service_call_count());
+        VERIFY_ARE_EQUAL_UINT(0, inventoryService.local_consumable_balance(inventoryItem));
+    }
 };
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_END
@@ -121,6 +121,136 @@ public:
         httpCall->ResultValue = StockMocks::CreateMockHttpCallResponse(web::json::value::parse(peoplehubResponse));
     }
 
+    DEFINE_TEST_CASE(PeopleHubTestGetSocialGraphOnlyRequestsUsedDecorations)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(PeopleHubTestGetSocialGraphOnlyRequestsUsedDecorations);
+        std::vector<string_t> xuids;
+        xuids.push_back(_T("1"));
+
+        auto peoplehubService = SocialManagerHelper::GetPeoplehubService();
+        auto httpCall = m_mockXboxSystemFactory->GetMockHttpCall();
+        httpCall->ResultValue = StockMocks::CreateMockHttpCallResponse(web::json::value::parse(peoplehubResponse));
+        auto userGroup = peoplehubService.get_social_graph(_T("TestXboxUserId"), social_manager_extra_detail_level::no_extra_detail, xuids).get();
+        VERIFY_IS_TRUE(!userGroup.err());
+        VERIFY_ARE_EQUAL_STR(L"/users/xuid(TestXboxUserId)/people/batch", httpCall->PathQueryFragment.to_string());
+        auto tracker = social_decoration_tracker::get_singleton_instance();
+        for (auto& socialUser : userGroup.payload())
+        {
+            VERIFY_IS_TRUE(tracker->fetched_detail_level(socialUser._Xbox_user_id_as_integer()) == social_manager_extra_detail_level::no_extra_detail);
+        }
+
+        userGroup = peoplehubService.get_social_graph(_T("TestXboxUserId"), social_manager_extra_detail_level::no_extra_detail, xuids, true).get();
+        VERIFY_IS_TRUE(!userGroup.err());
+        VERIFY_ARE_EQUAL_STR(L"/users/xuid(TestXboxUserId)/people/batch/decoration/presenceDetail", httpCall->PathQueryFragment.to_string());
+
+        userGroup = peoplehubService.get_social_graph(_T("TestXboxUserId"), social_manager_extra_detail_level::preferred_color_level, xuids).get();
+        VERIFY_IS_TRUE(!userGroup.err());
+        for (auto& socialUser : userGroup.payload())
+        {
+            VERIFY_IS_TRUE(tracker->fetched_detail_level(socialUser._Xbox_user_id_as_integer()) == social_manager_extra_detail_level::preferred_color_level);
+        }
+
+        tracker->reset();
+        VERIFY_IS_TRUE(tracker->fetched_detail_level(userGroup.payload()[0]._Xbox_user_id_as_integer()) == social_manager_extra_detail_level::no_extra_detail);
+    }
+
+    DEFINE_TEST_CASE(PeopleHubTestDecorationAccessIsTracked)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(PeopleHubTestDecorationAccessIsTracked);
+        auto tracker = std::make_shared<social_decoration_tracker>();
+        VERIFY_IS_TRUE(tracker->accessed_detail_level() == social_manager_extra_detail_level::no_extra_detail);
+
+        xbox_social_user socialUser = xbox_social_user::_Deserialize(web::json::value::parse(peoplehubResponse)[_T("people")][0]).payload();
+        tracker->record_access(socialUser, social_manager_extra_detail_level::title_history_level);
+        VERIFY_IS_TRUE(tracker->accessed_detail_level() == social_manager_extra_detail_level::title_history_level);
+
+        auto pendingFetches = tracker->take_pending_fetches();
+        VERIFY_ARE_EQUAL_UINT(1, pendingFetches.size());
+        VERIFY_IS_TRUE(pendingFetches[socialUser._Xbox_user_id_as_integer()] == social_manager_extra_detail_level::title_history_level);
+        VERIFY_IS_TRUE(tracker->take_pending_fetches().empty());
+
+        // Users already fetched with the decoration don't need another round trip
+        tracker->record_fetch(socialUser._Xbox_user_id_as_integer(), social_manager_extra_detail_level::title_history_level);
+        tracker->record_access(socialUser, social_manager_extra_detail_level::title_history_level);
+        VERIFY_IS_TRUE(tracker->take_pending_fetches().empty());
+
+        // Decorations a filter needs are requested before anything reads them
+        tracker->reset();
+        VERIFY_IS_TRUE(tracker->accessed_detail_level() == social_manager_extra_detail_level::no_extra_detail);
+        tracker->require_decorations(social_manager_extra_detail_level::title_history_level);
+        VERIFY_IS_TRUE(tracker->accessed_detail_level() == social_manager_extra_detail_level::title_history_level);
+        VERIFY_IS_TRUE(tracker->take_pending_fetches().empty());
+    }
+
+    DEFINE_TEST_CASE(PeopleHubTestGetSocialGraphSharded)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(PeopleHubTestGetSocialGraphSharded);
+        std::vector<string_t> xuids;
+        for (uint32_t i = 0; i < 250; ++i)
+        {
+            xuids.push_back(utils::uint32_to_string_t(i + 1));
+        }
+
+        auto peoplehubService = SocialManagerHelper::GetPeoplehubService();
+        auto httpCall = m_mockXboxSystemFactory->GetMockHttpCall();
+        httpCall->ResultValue = StockMocks::CreateMockHttpCallResponse(web::json::value::parse(peoplehubResponse));
+        size_t responseUserCount = web::json::value::parse(peoplehubResponse)[_T("people")].size();
+
+        std::mutex chunkLock;
+        std::vector<size_t> chunkSizes;
+        uint32_t lastChunkCount = 0;
+        auto result = peoplehubService.get_social_graph_sharded(
+            _T("TestXboxUserId"),
+            social_manager_extra_detail_level::no_extra_detail,
+            xuids,
+            false,
+            [&](const std::vector<string_t>& chunkUsers, const xbox_live_result<std::vector<xbox_social_user>>& chunkResult, bool isLastChunk)
+            {
+                std::lock_guard<std::mutex> lock(chunkLock);
+                VERIFY_IS_TRUE(!chunkResult.err());
+                chunkSizes.push_back(chunkUsers.size());
+                if (isLastChunk) ++lastChunkCount;
+            }).get();
+
+        VERIFY_IS_TRUE(!result.err());
+        VERIFY_ARE_EQUAL_INT(3, httpCall->CallCounter);
+        VERIFY_ARE_EQUAL_UINT(3, chunkSizes.size());
+        VERIFY_ARE_EQUAL_UINT(1, lastChunkCount);
+        std::sort(chunkSizes.begin(), chunkSizes.end());
+        VERIFY_ARE_EQUAL_UINT(50, chunkSizes[0]);
+        VERIFY_ARE_EQUAL_UINT(100, chunkSizes[1]);
+        VERIFY_ARE_EQUAL_UINT(100, chunkSizes[2]);
+        VERIFY_ARE_EQUAL_UINT(3 * responseUserCount, result.payload().size());
+        VERIFY_ARE_EQUAL_STR(L"/users/xuid(TestXboxUserId)/people/batch", httpCall->PathQueryFragment.to_string());
+    }
+
+    DEFINE_TEST_CASE(PeopleHubTestGetSocialGraphShardedRetriesTransientErrorsOnly)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(PeopleHubTestGetSocialGraphShardedRetriesTransientErrorsOnly);
+        std::vector<string_t> xuids;
+        for (uint32_t i = 0; i < 150; ++i)
+        {
+            xuids.push_back(utils::uint32_to_string_t(i + 1));
+        }
+
+        auto peoplehubService = SocialManagerHelper::GetPeoplehubService();
+        auto httpCall = m_mockXboxSystemFactory->GetMockHttpCall();
+
+        // A bad request fails the same way every time, so each chunk is sent once
+        httpCall->ResultValue = StockMocks::CreateMockHttpCallResponse(L"", 404);
+        int callsBefore = httpCall->CallCounter;
+        auto result = peoplehubService.get_social_graph_sharded(_T("TestXboxUserId"), social_manager_extra_detail_level::no_extra_detail, xuids, false).get();
+        VERIFY_IS_TRUE(result.err());
+        VERIFY_ARE_EQUAL_INT(2, httpCall->CallCounter - callsBefore);
+
+        // An unavailable service is retried up to the attempt limit
+        httpCall->ResultValue = StockMocks::CreateMockHttpCallResponse(L"", 503);
+        callsBefore = httpCall->CallCounter;
+        result = peoplehubService.get_social_graph_sharded(_T("TestXboxUserId"), social_manager_extra_detail_level::no_extra_detail, xuids, false).get();
+        VERIFY_IS_TRUE(result.err());
+        VERIFY_ARE_EQUAL_INT(6, httpCall->CallCounter - callsBefore);
+    }
+
     DEFINE_TEST_CASE(PeopleHubTestOverloadStrings)
     {
         DEFINE_TEST_CASE_PROPERTIES(PeopleHubTestOverloadStrings);
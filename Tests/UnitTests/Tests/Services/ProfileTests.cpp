@@ -171,6 +171,13 @@ public:
 
     }
 
+    // The batch profile request body is written as UTF-8 bytes rather than a string
+    static string_t RequestBodyString(_In_ const std::shared_ptr<MockHttpCall>& httpCall)
+    {
+        const auto& body = httpCall->request_body().request_message_vector();
+        return utility::conversions::to_string_t(std::string(body.begin(), body.end()));
+    }
+
     DEFINE_TEST_CASE(TestGetUserProfileAsync)
     {
         DEFINE_TEST_CASE_PROPERTIES(TestGetUserProfileAsync);
@@ -186,12 +193,38 @@ public:
         VERIFY_ARE_EQUAL_STR(L"POST", httpCall->HttpMethod);
         VERIFY_ARE_EQUAL_STR(L"https://profile.mockenv.xboxlive.com", httpCall->ServerName);
         VERIFY_ARE_EQUAL_STR(L"/users/batch/profile/settings", httpCall->PathQueryFragment.to_string());
-        VERIFY_ARE_EQUAL_STR(LR"({"settings":["AppDisplayName","AppDisplayPicRaw","GameDisplayName","GameDisplayPicRaw","Gamerscore","Gamertag"],"userIds":["xboxUserId_0"]})", httpCall->request_body().request_message_string());
+        VERIFY_ARE_EQUAL_STR(LR"({"settings":["AppDisplayName","AppDisplayPicRaw","GameDisplayName","GameDisplayPicRaw","Gamerscore","Gamertag"],"userIds":["xboxUserId_0"]})", RequestBodyString(httpCall));
 
         auto result = task.get();
         VerifyXboxUserProfileProperties(result, &x);
     }
 
+    DEFINE_TEST_CASE(TestGetUserProfilesRequestBodyMatchesJsonValue)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestGetUserProfilesRequestBodyMatchesJsonValue);
+        auto httpCall = m_mockXboxSystemFactory->GetMockHttpCall();
+        httpCall->ResultValue = StockMocks::CreateMockHttpCallResponse(web::json::value::parse(L"{\"profileUsers\":[]}"));
+
+        // Ids that need escaping as well as plain ones, so the writer's escaping is compared too
+        std::vector<string_t> xboxUserIds = { L"2533274790000000", L"quote\" backslash\\ tab\t", L"\u00e9\u4e2d \U0001F600" };
+        GetMockXboxLiveContext_Cpp()->profile_service().get_user_profiles(xboxUserIds).wait();
+
+        // The request the service built as a web::json::value before it wrote the body with json_writer
+        web::json::value expected;
+        expected[L"userIds"] = utils::serialize_vector<string_t>(utils::json_string_serializer, xboxUserIds);
+        expected[L"settings"] = web::json::value::array();
+        std::vector<string_t> settings = { L"AppDisplayName", L"AppDisplayPicRaw", L"GameDisplayName", L"GameDisplayPicRaw", L"Gamerscore", L"Gamertag" };
+        for (uint32_t i = 0; i < settings.size(); ++i)
+        {
+            expected[L"settings"][i] = web::json::value::string(settings[i]);
+        }
+
+        std::string expectedBody = utility::conversions::to_utf8string(expected.serialize());
+        const auto& body = httpCall->request_body().request_message_vector();
+        VERIFY_ARE_EQUAL_UINT(expectedBody.size(), body.size());
+        VERIFY_IS_TRUE(std::equal(body.begin(), body.end(), expectedBody.begin()));
+    }
+
     DEFINE_TEST_CASE(TestGetUserProfilesAsync)
     {
         DEFINE_TEST_CASE_PROPERTIES(TestGetUserProfilesAsync);
@@ -214,7 +247,7 @@ public:
         VERIFY_ARE_EQUAL_STR(L"POST", httpCall->HttpMethod);
         VERIFY_ARE_EQUAL_STR(L"https://profile.mockenv.xboxlive.com", httpCall->ServerName);
         VERIFY_ARE_EQUAL_STR(L"/users/batch/profile/settings", httpCall->PathQueryFragment.to_string());
-        VERIFY_ARE_EQUAL_STR(LR"({"settings":["AppDisplayName","AppDisplayPicRaw","GameDisplayName","GameDisplayPicRaw","Gamerscore","Gamertag"],"userIds":["xboxUserId_0","xboxUserId_1","xboxUserId_2","xboxUserId_3"]})", httpCall->request_body().request_message_string());
+        VERIFY_ARE_EQUAL_STR(LR"({"settings":["AppDisplayName","AppDisplayPicRaw","GameDisplayName","GameDisplayPicRaw","Gamerscore","Gamertag"],"userIds":["xboxUserId_0","xboxUserId_1","xboxUserId_2","xboxUserId_3"]})", RequestBodyString(httpCall));
 
         auto profiles = task.get();
         int index = 0;
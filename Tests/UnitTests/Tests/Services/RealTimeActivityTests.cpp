@@ -58,7 +58,14 @@ public:
 
     void on_event_received(_In_ const web::json::value& data) override
     {
-        UNREFERENCED_PARAMETER(data);
+        std::lock_guard<std::mutex> lock(dataLock);
+        auto start = std::chrono::high_resolution_clock::now();
+        lastData = data;
+        ++receivedCount;
+
+        // Stands in for a title parsing the payload
+        data.serialize();
+        handlerTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start);
         recieved_data = true;
     }
 
@@ -82,6 +89,11 @@ public:
         }
     }
 
+    void SetResourceUri(_In_ const string_t& uri)
+    {
+        set_resource_uri(uri);
+    }
+
     void reset()
     {
         pendingSubEvent.reset();
@@ -89,9 +101,15 @@ public:
         closedEvent.reset();
         pendingUnsubEvent.reset();
         recieved_data = false;
+        receivedCount = 0;
+        handlerTime = std::chrono::microseconds::zero();
     }
 
     bool recieved_data = false;
+    std::mutex dataLock;
+    web::json::value lastData;
+    int receivedCount = 0;
+    std::chrono::microseconds handlerTime = std::chrono::microseconds::zero();
 
     concurrency::event pendingSubEvent;
     concurrency::event subscribedEvent;
@@ -100,6 +118,71 @@ public:
 
 };
 
+// Stands in for the RTA service on one connection, allowing at most subscriptionLimit subscriptions on it
+struct LimitedRtaConnection
+{
+    std::mutex lock;
+    std::map<int, string_t> subscribedUris;
+    int rejectedCount = 0;
+
+    bool HasUri(_In_ const string_t& uri)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return std::any_of(subscribedUris.begin(), subscribedUris.end(), [&uri](const std::pair<const int, string_t>& entry)
+        {
+            return entry.second == uri;
+        });
+    }
+
+    int SubscriptionCount()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return static_cast<int>(subscribedUris.size());
+    }
+};
+
+std::shared_ptr<LimitedRtaConnection> SetWebSocketRTALimitedResponser(std::shared_ptr<MockWebSocketClient> ws, int subscriptionLimit)
+{
+    auto connection = std::make_shared<LimitedRtaConnection>();
+    ws->set_send_handler([ws, connection, subscriptionLimit](string_t msg)
+    {
+        auto msgJson = web::json::value::parse(msg);
+        int apiId = msgJson[0].as_integer();
+        int sequence = msgJson[1].as_integer();
+
+        stringstream_t response;
+        {
+            std::lock_guard<std::mutex> guard(connection->lock);
+            if (apiId == 1) //subscribe
+            {
+                if (static_cast<int>(connection->subscribedUris.size()) < subscriptionLimit)
+                {
+                    connection->subscribedUris[sequence] = msgJson[2].as_string();
+                    response << "[1," << sequence << ",0," << sequence << ",{}]";
+                }
+                else
+                {
+                    ++connection->rejectedCount;
+                    response << "[1," << sequence << ",1,\"subscription limit reached\"]";
+                }
+            }
+            else if (apiId == 2) //unsubscribe
+            {
+                connection->subscribedUris.erase(msgJson[2].as_integer());
+                response << "[2," << sequence << ",0]";
+            }
+        }
+
+        // will deadlock if return directly here, return in other thread
+        string_t responseString = response.str();
+        pplx::create_task([ws, responseString]()
+        {
+            ws->recieve_message(responseString);
+        });
+    });
+    return connection;
+}
+
 DEFINE_TEST_CLASS(RealTimeActivityTests)
 {
 public:
@@ -121,6 +204,85 @@ public:
         ws->recieve_message(subscriptionResponse.str());
     }
 
+    void SendValueEvent(std::shared_ptr<MockWebSocketClient> ws, int id, int value)
+    {
+        stringstream_t eventMessage;
+        eventMessage << "[3,";    //[3,(subscriptionNum),{"value":(value)}]
+        eventMessage << id;
+        eventMessage << ",{\"value\":";
+        eventMessage << value;
+        eventMessage << "}]";
+        ws->recieve_message(eventMessage.str());
+    }
+
+    std::shared_ptr<TestSubscription> CreateSubscribedTestSubscription(
+        _In_ std::shared_ptr<real_time_activity_service> nativeRTA,
+        _In_ std::shared_ptr<MockWebSocketClient> mockSocket,
+        _In_ std::shared_ptr<StateChangeHelper> helper
+        )
+    {
+        auto subscription = std::make_shared<TestSubscription>(
+        ([](xbox::services::real_time_activity::real_time_activity_subscription_error_event_args args)
+        {
+            args.err_message();
+        }));
+
+        VERIFY_IS_TRUE(!nativeRTA->_Add_subscription(subscription).err());
+        subscription->pendingSubEvent.wait();
+        helper->connectedEvent.wait();
+        mockSocket->recieve_message(rtaSubscriptionsResponseJson);
+        subscription->subscribedEvent.wait();
+        return subscription;
+    }
+
+    std::shared_ptr<TestSubscription> CreatePresenceTestSubscription(_In_ int index)
+    {
+        auto subscription = std::make_shared<TestSubscription>(
+        ([](xbox::services::real_time_activity::real_time_activity_subscription_error_event_args args)
+        {
+            args.err_message();
+        }));
+
+        stringstream_t uri;
+        uri << L"https://userpresence.xboxlive.com/users/xuid(" << 2814600000000000 + index << L")/richpresence";
+        subscription->SetResourceUri(uri.str());
+        return subscription;
+    }
+
+    std::vector<std::shared_ptr<TestSubscription>> AddShardedSubscriptions(
+        _In_ std::shared_ptr<real_time_activity_service> nativeRTA,
+        _In_ int subscriptionCount
+        )
+    {
+        std::vector<std::shared_ptr<TestSubscription>> subscriptions;
+        for (int i = 0; i < subscriptionCount; ++i)
+        {
+            auto subscription = CreatePresenceTestSubscription(i);
+            VERIFY_IS_TRUE(!nativeRTA->_Add_subscription(subscription).err());
+            subscriptions.push_back(subscription);
+        }
+
+        for (auto& subscription : subscriptions)
+        {
+            subscription->subscribedEvent.wait();
+        }
+        return subscriptions;
+    }
+
+    // Sends eventCount events for subscription 0 at roughly 1000 a second, the way a hot presence or stat subscription would
+    void SendEventsAtOneThousandPerSecond(std::shared_ptr<MockWebSocketClient> ws, int eventCount)
+    {
+        const int eventsPerBatch = 10;
+        for (int i = 0; i < eventCount; ++i)
+        {
+            SendValueEvent(ws, 0, i);
+            if (i % eventsPerBatch == eventsPerBatch - 1)
+            {
+                Sleep(10);
+            }
+        }
+    }
+
 
     DEFINE_TEST_CASE(SubscriptionTest)
     {
@@ -959,6 +1121,318 @@ public:
             xboxLiveContextTest->RealTimeActivityService->Deactivate();
         }
     }
+
+    DEFINE_TEST_CASE(TestEventConflationDeliversLatestEvent)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestEventConflationDeliversLatestEvent);
+        auto xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto mockSocket = m_mockXboxSystemFactory->GetMockWebSocketClient();
+        SetWebSocketRTAAutoResponser(mockSocket, L"{}", 0, false);
+        auto helper = SetupStateChangeHelper(xboxLiveContext->RealTimeActivityService);
+        auto nativeRTA = xboxLiveContext->RealTimeActivityService->GetCppObj();
+        nativeRTA->enable_event_conflation(std::chrono::milliseconds(200));
+        nativeRTA->activate();
+        auto subscription = CreateSubscribedTestSubscription(nativeRTA, mockSocket, helper);
+
+        // The first event goes straight through, the rest are held back and replaced by the next one
+        for (int i = 0; i < 50; ++i)
+        {
+            SendValueEvent(mockSocket, 0, i);
+        }
+        VERIFY_ARE_EQUAL_INT(1, subscription->receivedCount);
+        VERIFY_ARE_EQUAL_INT(0, subscription->lastData[L"value"].as_integer());
+
+        Sleep(500);
+        VERIFY_ARE_EQUAL_INT(2, subscription->receivedCount);
+        VERIFY_ARE_EQUAL_INT(49, subscription->lastData[L"value"].as_integer());
+        VERIFY_ARE_EQUAL_INT(48, static_cast<int>(nativeRTA->conflated_event_count(subscription)));
+
+        // Gaps are counted per subscription
+        VERIFY_ARE_EQUAL_INT(0, static_cast<int>(nativeRTA->conflated_event_count(CreatePresenceTestSubscription(0))));
+
+        // Removing the subscription drops anything still held back for it, along with its count
+        SendValueEvent(mockSocket, 0, 50);
+        SendValueEvent(mockSocket, 0, 51);
+        nativeRTA->_Remove_subscription(subscription);
+        Sleep(500);
+        VERIFY_ARE_EQUAL_INT(2, subscription->receivedCount);
+        VERIFY_ARE_EQUAL_INT(0, static_cast<int>(nativeRTA->conflated_event_count(subscription)));
+        nativeRTA->deactivate();
+    }
+
+    DEFINE_TEST_CASE(TestDisableEventConflation)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestDisableEventConflation);
+        auto xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto mockSocket = m_mockXboxSystemFactory->GetMockWebSocketClient();
+        SetWebSocketRTAAutoResponser(mockSocket, L"{}", 0, false);
+        auto helper = SetupStateChangeHelper(xboxLiveContext->RealTimeActivityService);
+        auto nativeRTA = xboxLiveContext->RealTimeActivityService->GetCppObj();
+        nativeRTA->enable_event_conflation(std::chrono::seconds(10));
+        nativeRTA->activate();
+        auto subscription = CreateSubscribedTestSubscription(nativeRTA, mockSocket, helper);
+
+        SendValueEvent(mockSocket, 0, 0);
+        SendValueEvent(mockSocket, 0, 1);
+        VERIFY_ARE_EQUAL_INT(1, subscription->receivedCount);
+
+        // The held back event is replaced by the first one after conflation is off, and every event is delivered from then on
+        nativeRTA->disable_event_conflation();
+        for (int i = 2; i < 12; ++i)
+        {
+            SendValueEvent(mockSocket, 0, i);
+            VERIFY_ARE_EQUAL_INT(i, subscription->receivedCount);
+            VERIFY_ARE_EQUAL_INT(i, subscription->lastData[L"value"].as_integer());
+        }
+        VERIFY_ARE_EQUAL_INT(1, static_cast<int>(nativeRTA->conflated_event_count(subscription)));
+        nativeRTA->deactivate();
+    }
+
+    DEFINE_TEST_CASE(TestEventConflationAtOneThousandEventsPerSecond)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestEventConflationAtOneThousandEventsPerSecond);
+        auto xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto mockSocket = m_mockXboxSystemFactory->GetMockWebSocketClient();
+        SetWebSocketRTAAutoResponser(mockSocket, L"{}", 0, false);
+        auto helper = SetupStateChangeHelper(xboxLiveContext->RealTimeActivityService);
+        auto nativeRTA = xboxLiveContext->RealTimeActivityService->GetCppObj();
+        nativeRTA->activate();
+        auto subscription = CreateSubscribedTestSubscription(nativeRTA, mockSocket, helper);
+
+        const int eventCount = 1000;
+        SendEventsAtOneThousandPerSecond(mockSocket, eventCount);
+        int unconflatedCount = subscription->receivedCount;
+        auto unconflatedHandlerTime = subscription->handlerTime;
+        VERIFY_ARE_EQUAL_INT(eventCount, unconflatedCount);
+
+        const std::chrono::milliseconds interval(100);
+        nativeRTA->enable_event_conflation(interval);
+        subscription->reset();
+        SendEventsAtOneThousandPerSecond(mockSocket, eventCount);
+        Sleep(static_cast<DWORD>(interval.count() * 3));
+
+        TEST_LOG(FormatString(L"Handler invocations: %d without conflation, %d with", unconflatedCount, subscription->receivedCount).c_str());
+        TEST_LOG(FormatString(L"Handler time: %dus without conflation, %dus with",
+            static_cast<int>(unconflatedHandlerTime.count()),
+            static_cast<int>(subscription->handlerTime.count())).c_str());
+
+        // About one delivery per interval over the ~1 second of events, plus the first and the trailing one
+        VERIFY_IS_TRUE(subscription->receivedCount <= 20);
+        VERIFY_ARE_EQUAL_INT(eventCount, subscription->receivedCount + static_cast<int>(nativeRTA->conflated_event_count(subscription)));
+        VERIFY_ARE_EQUAL_INT(eventCount - 1, subscription->lastData[L"value"].as_integer());
+        nativeRTA->deactivate();
+    }
+
+    DEFINE_TEST_CASE(TestShardingPastSubscriptionLimit)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestShardingPastSubscriptionLimit);
+        m_mockXboxSystemFactory->reinit();
+        auto mockSockets = m_mockXboxSystemFactory->AddMultipleMockWebSocketClients(3);
+        std::vector<std::shared_ptr<LimitedRtaConnection>> connections;
+        for (auto& mockSocket : mockSockets)
+        {
+            connections.push_back(SetWebSocketRTALimitedResponser(mockSocket, 3));
+        }
+
+        auto xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto nativeRTA = xboxLiveContext->RealTimeActivityService->GetCppObj();
+        int errorCount = 0;
+        nativeRTA->add_subscription_error_handler([&errorCount](const real_time_activity_subscription_error_event_args&)
+        {
+            ++errorCount;
+        });
+        nativeRTA->enable_connection_sharding(3, 3);
+        nativeRTA->activate();
+
+        auto subscriptions = AddShardedSubscriptions(nativeRTA, 9);
+
+        // Every connection filled up to the limit and none of them had to refuse a subscription
+        VERIFY_ARE_EQUAL_INT(3, static_cast<int>(nativeRTA->_Connection_count()));
+        for (auto& connection : connections)
+        {
+            VERIFY_ARE_EQUAL_INT(3, connection->SubscriptionCount());
+            VERIFY_ARE_EQUAL_INT(0, connection->rejectedCount);
+        }
+        VERIFY_ARE_EQUAL_INT(0, errorCount);
+
+        // Subscription ids are per connection, so each connection's event reaches exactly one of the subscriptions placed on it
+        for (size_t i = 0; i < mockSockets.size(); ++i)
+        {
+            for (auto& subscription : subscriptions)
+            {
+                subscription->reset();
+            }
+
+            SendEvent(mockSockets[i], subscriptions[0]->subscription_id());
+            int receivedCount = 0;
+            for (auto& subscription : subscriptions)
+            {
+                receivedCount += subscription->receivedCount;
+            }
+            VERIFY_ARE_EQUAL_INT(1, receivedCount);
+        }
+
+        nativeRTA->deactivate();
+        for (auto& subscription : subscriptions)
+        {
+            VERIFY_ARE_EQUAL_INT(subscription->state(), real_time_activity_subscription_state::closed);
+        }
+    }
+
+    DEFINE_TEST_CASE(TestShardingPlacementIsConsistent)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestShardingPlacementIsConsistent);
+        m_mockXboxSystemFactory->reinit();
+        auto mockSockets = m_mockXboxSystemFactory->AddMultipleMockWebSocketClients(4);
+        std::vector<std::shared_ptr<LimitedRtaConnection>> connections;
+        for (auto& mockSocket : mockSockets)
+        {
+            connections.push_back(SetWebSocketRTALimitedResponser(mockSocket, 2));
+        }
+
+        auto xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto nativeRTA = xboxLiveContext->RealTimeActivityService->GetCppObj();
+        nativeRTA->enable_connection_sharding(2, 4);
+        nativeRTA->activate();
+        auto subscriptions = AddShardedSubscriptions(nativeRTA, 8);
+
+        // A removed subscription goes back to the connection it was on when it is added again
+        for (auto& subscription : subscriptions)
+        {
+            auto connection = std::find_if(connections.begin(), connections.end(), [&subscription](const std::shared_ptr<LimitedRtaConnection>& c)
+            {
+                return c->HasUri(subscription->resource_uri());
+            });
+            VERIFY_IS_TRUE(connection != connections.end());
+
+            subscription->reset();
+            nativeRTA->_Remove_subscription(subscription);
+            subscription->closedEvent.wait();
+            VERIFY_IS_FALSE((*connection)->HasUri(subscription->resource_uri()));
+
+            VERIFY_IS_TRUE(!nativeRTA->_Add_subscription(subscription).err());
+            subscription->subscribedEvent.wait();
+            VERIFY_IS_TRUE((*connection)->HasUri(subscription->resource_uri()));
+        }
+
+        VERIFY_ARE_EQUAL_INT(4, static_cast<int>(nativeRTA->_Connection_count()));
+        for (auto& connection : connections)
+        {
+            VERIFY_ARE_EQUAL_INT(0, connection->rejectedCount);
+        }
+        nativeRTA->deactivate();
+    }
+
+    DEFINE_TEST_CASE(TestShardReconnectIsIsolatedAndRebalanced)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestShardReconnectIsIsolatedAndRebalanced);
+        m_mockXboxSystemFactory->reinit();
+        auto mockSockets = m_mockXboxSystemFactory->AddMultipleMockWebSocketClients(2);
+        std::vector<std::shared_ptr<LimitedRtaConnection>> connections;
+        for (auto& mockSocket : mockSockets)
+        {
+            connections.push_back(SetWebSocketRTALimitedResponser(mockSocket, 2));
+        }
+
+        auto xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto nativeRTA = xboxLiveContext->RealTimeActivityService->GetCppObj();
+        int resyncCount = 0;
+        nativeRTA->add_resync_handler([&resyncCount]()
+        {
+            ++resyncCount;
+        });
+        std::mutex connectionStatesLock;
+        std::vector<real_time_activity_connection_state> connectionStates;
+        nativeRTA->add_connection_state_change_handler([&connectionStatesLock, &connectionStates](real_time_activity_connection_state connectionState)
+        {
+            std::lock_guard<std::mutex> guard(connectionStatesLock);
+            connectionStates.push_back(connectionState);
+        });
+        auto waitForConnected = [&connectionStatesLock, &connectionStates]()
+        {
+            for (int i = 0; i < 500; ++i)
+            {
+                {
+                    std::lock_guard<std::mutex> guard(connectionStatesLock);
+                    if (!connectionStates.empty() && connectionStates.back() == real_time_activity_connection_state::connected)
+                    {
+                        return;
+                    }
+                }
+                Sleep(10);
+            }
+        };
+        nativeRTA->enable_connection_sharding(2, 2);
+        nativeRTA->activate();
+        auto subscriptions = AddShardedSubscriptions(nativeRTA, 4);
+
+        std::vector<std::shared_ptr<TestSubscription>> firstConnectionSubscriptions;
+        std::vector<std::shared_ptr<TestSubscription>> secondConnectionSubscriptions;
+        for (auto& subscription : subscriptions)
+        {
+            subscription->reset();
+            if (connections[0]->HasUri(subscription->resource_uri()))
+            {
+                firstConnectionSubscriptions.push_back(subscription);
+            }
+            else
+            {
+                secondConnectionSubscriptions.push_back(subscription);
+            }
+        }
+        VERIFY_ARE_EQUAL_INT(2, static_cast<int>(firstConnectionSubscriptions.size()));
+        VERIFY_ARE_EQUAL_INT(2, static_cast<int>(secondConnectionSubscriptions.size()));
+
+        // Make room on the first connection
+        nativeRTA->_Remove_subscription(firstConnectionSubscriptions[0]);
+        firstConnectionSubscriptions[0]->closedEvent.wait();
+        auto untouchedSubscription = firstConnectionSubscriptions[1];
+        untouchedSubscription->reset();
+
+        waitForConnected();
+        {
+            std::lock_guard<std::mutex> guard(connectionStatesLock);
+            VERIFY_IS_TRUE(!connectionStates.empty());
+            VERIFY_ARE_EQUAL_INT(connectionStates.back(), real_time_activity_connection_state::connected);
+            connectionStates.clear();
+        }
+
+        // Drop the second connection; the service forgets its subscriptions
+        {
+            std::lock_guard<std::mutex> guard(connections[1]->lock);
+            connections[1]->subscribedUris.clear();
+        }
+        mockSockets[1]->m_closeHandler(1001, L"");
+        for (auto& subscription : secondConnectionSubscriptions)
+        {
+            subscription->pendingSubEvent.wait();
+            subscription->subscribedEvent.wait();
+        }
+
+        // The first connection never noticed, and the reconnecting subscriptions filled the room it had
+        VERIFY_IS_TRUE(untouchedSubscription->pendingSubEvent.wait(0) != 0);
+        VERIFY_ARE_EQUAL_INT(untouchedSubscription->state(), real_time_activity_subscription_state::subscribed);
+        mockSockets[1]->recieve_message(rtaResyncMessage);
+        VERIFY_ARE_EQUAL_INT(1, resyncCount);
+
+        // The title heard the second connection drop and come back through the combined state
+        waitForConnected();
+        {
+            std::lock_guard<std::mutex> guard(connectionStatesLock);
+            VERIFY_IS_TRUE(connectionStates.size() >= 2);
+            VERIFY_IS_TRUE(connectionStates.front() != real_time_activity_connection_state::connected);
+            VERIFY_ARE_EQUAL_INT(connectionStates.back(), real_time_activity_connection_state::connected);
+        }
+
+        VERIFY_ARE_EQUAL_INT(3, connections[0]->SubscriptionCount() + connections[1]->SubscriptionCount());
+        VERIFY_IS_TRUE(connections[0]->SubscriptionCount() <= 2);
+        VERIFY_IS_TRUE(connections[1]->SubscriptionCount() <= 2);
+        for (auto& connection : connections)
+        {
+            VERIFY_ARE_EQUAL_INT(0, connection->rejectedCount);
+        }
+        nativeRTA->deactivate();
+    }
 };
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_END
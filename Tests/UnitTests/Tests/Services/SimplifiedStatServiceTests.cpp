@@ -115,7 +115,8 @@ public:
         statsValueDoc.do_work();
         auto updateStatResult = simplifiedStatService.update_stats_value_document(statsValueDoc).get();
         VERIFY_IS_TRUE(!updateStatResult.err());
-        auto& serializedRequest = web::json::value::parse(httpCall->request_body().request_message_string());
+        const auto& requestBody = httpCall->request_body().request_message_vector();
+        auto& serializedRequest = web::json::value::parse(utility::conversions::to_string_t(std::string(requestBody.begin(), requestBody.end())));
         auto& compareValue = web::json::value::parse(statValueDocumentResponse);
         
         auto& versionField = serializedRequest[_T("revision")];
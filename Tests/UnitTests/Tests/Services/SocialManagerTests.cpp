@@ -13,6 +13,7 @@
 #include "SocialUserGroupLoadedEventArgs_WinRT.h"
 #include "MockSocialManager.h"
 #include "SocialManagerHelper.h"
+#include "span_tracer.h"
 
 using namespace xbox::services;
 using namespace xbox::services::presence;
@@ -1432,6 +1433,57 @@ public:
         return GetPeoplehubResponseStruct(returnObject, errorCode);
     }
 
+    struct PeoplehubBatchStandInStats
+    {
+        std::mutex lock;
+        uint32_t requestCount = 0;
+        size_t largestRequest = 0;
+        std::unordered_map<string_t, uint32_t> requestedUsers;
+    };
+
+    // Local stand-in for the peoplehub batch endpoint: answers each request with exactly the users it asked for
+    std::shared_ptr<HttpResponseStruct> CreatePeoplehubBatchStandIn(const std::shared_ptr<PeoplehubBatchStandInStats>& stats)
+    {
+        web::json::value emptyPeople;
+        emptyPeople[L"people"] = web::json::value::array();
+        auto responseStruct = GetPeoplehubResponseStruct(emptyPeople);
+        responseStruct->fRequestPostFunc = [stats](std::shared_ptr<http_call_response>& response, const string_t& requestBody)
+        {
+            if (requestBody.empty())
+            {
+                return;
+            }
+
+            auto request = web::json::value::parse(requestBody);
+            if (!request.has_field(L"xuids"))
+            {
+                return;
+            }
+
+            auto& xuids = request[L"xuids"].as_array();
+            web::json::value jsonArray = web::json::value::array(xuids.size());
+            for (size_t i = 0; i < xuids.size(); ++i)
+            {
+                auto jsonBlob = defaultPeoplehubTemplate;
+                jsonBlob[L"xuid"] = xuids.at(i);
+                jsonArray[i] = jsonBlob;
+            }
+
+            web::json::value returnObject;
+            returnObject[L"people"] = jsonArray;
+            response = StockMocks::CreateMockHttpCallResponse(returnObject);
+
+            std::lock_guard<std::mutex> guard(stats->lock);
+            ++stats->requestCount;
+            stats->largestRequest = __max(stats->largestRequest, xuids.size());
+            for (auto& xuid : xuids)
+            {
+                ++stats->requestedUsers[xuid.as_string()];
+            }
+        };
+        return responseStruct;
+    }
+
     // Tests behavior of user group from list
     DEFINE_TEST_CASE(TestSocialManagerSocialUserGroupFromList)
     {
@@ -1588,6 +1640,208 @@ public:
         Cleanup(socialManagerInitializationStruct, xboxLiveContext);
     }
 
+    DEFINE_TEST_CASE(TestSocialUserGroupFromListBeyondHundredUsers)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestSocialUserGroupFromListBeyondHundredUsers);
+        m_mockXboxSystemFactory->reinit();
+        auto xboxLiveContext = GetMockXboxLiveContext_Cpp();
+        auto socialManagerInitializationStruct = Initialize(xboxLiveContext, true);
+
+        const uint32_t listSize = 2000;
+        Platform::Collections::Vector<Platform::String^>^ vec = ref new Platform::Collections::Vector<Platform::String^>();
+        for (uint32_t i = 0; i < listSize; ++i)
+        {
+            stringstream_t str;
+            str << (200000 + i);
+            vec->Append(ref new Platform::String(str.str().c_str()));
+        }
+
+        auto stats = std::make_shared<PeoplehubBatchStandInStats>();
+        std::unordered_map<string_t, std::shared_ptr<HttpResponseStruct>> responses;
+        responses[_T("https://peoplehub.mockenv.xboxlive.com")] = CreatePeoplehubBatchStandIn(stats);
+        m_mockXboxSystemFactory->add_http_state_response(responses);
+
+        auto createStart = std::chrono::steady_clock::now();
+        auto socialUserGroup = socialManagerInitializationStruct.socialManager->CreateSocialUserGroupFromList(xboxLiveContext->user(), vec->GetView());
+        VERIFY_ARE_EQUAL_UINT(listSize, socialUserGroup->UsersTrackedBySocialUserGroup->Size);
+
+        // The group fills in as chunks are merged, so partial sizes show up before it is complete
+        uint32_t doWorkCount = 0;
+        uint32_t partialViewCount = 0;
+        bool groupLoaded = false;
+        uint32_t lastViewSize = 0;
+        // Give up after 500 idle polls (about 5 seconds) rather than hang if a chunk never completes;
+        // only idle polls sleep so consecutive chunk merges are still seen as partial views
+        for (uint32_t idlePolls = 0; idlePolls < 500 && (!groupLoaded || socialUserGroup->Users->Size < listSize);)
+        {
+            auto changeList = socialManagerInitializationStruct.socialManager->DoWork();
+            ++doWorkCount;
+            for (auto evt : changeList)
+            {
+                if (evt->EventType == SocialEventType::SocialUserGroupLoaded)
+                {
+                    VERIFY_ARE_EQUAL_INT(0, evt->ErrorCode);
+                    groupLoaded = true;
+                }
+            }
+
+            auto viewSize = socialUserGroup->Users->Size;
+            if (viewSize > 0 && viewSize < listSize)
+            {
+                ++partialViewCount;
+            }
+
+            if (changeList.empty() && viewSize == lastViewSize)
+            {
+                ++idlePolls;
+                Sleep(10);
+            }
+            lastViewSize = viewSize;
+        }
+        VERIFY_IS_TRUE(groupLoaded);
+        auto loadTime = std::chrono::steady_clock::now() - createStart;
+
+        TEST_LOG(FormatString(L"%d users: %d peoplehub requests, %d do_work calls (%d with a partial view), %d ms",
+            static_cast<int>(listSize),
+            static_cast<int>(stats->requestCount),
+            static_cast<int>(doWorkCount),
+            static_cast<int>(partialViewCount),
+            static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(loadTime).count())).c_str());
+
+        VERIFY_ARE_EQUAL_UINT(listSize, socialUserGroup->Users->Size);
+        VERIFY_ARE_EQUAL_UINT(listSize, stats->requestedUsers.size());
+        VERIFY_ARE_EQUAL_UINT((listSize + 99) / 100, stats->requestCount);
+        VERIFY_IS_TRUE(stats->largestRequest <= 100);
+        VERIFY_IS_TRUE(partialViewCount > 0);
+
+        socialManagerInitializationStruct.socialManager->DestroySocialUserGroup(socialUserGroup);
+        Cleanup(socialManagerInitializationStruct, xboxLiveContext);
+    }
+
+    DEFINE_TEST_CASE(TestSocialUserGroupFromListSharesDuplicateUsers)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestSocialUserGroupFromListSharesDuplicateUsers);
+        m_mockXboxSystemFactory->reinit();
+        auto xboxLiveContext = GetMockXboxLiveContext_Cpp();
+        auto socialManagerInitializationStruct = Initialize(xboxLiveContext, true);
+
+        // Each roster user is listed twice, and the first ten are already in the social graph
+        std::vector<Platform::String^> rosterUsers;
+        for (uint32_t i = 1; i <= 10; ++i)
+        {
+            rosterUsers.push_back(USER_LIST[i - 1]);
+        }
+        for (uint32_t i = 0; i < 140; ++i)
+        {
+            stringstream_t str;
+            str << (300000 + i);
+            rosterUsers.push_back(ref new Platform::String(str.str().c_str()));
+        }
+        Platform::Collections::Vector<Platform::String^>^ vec = ref new Platform::Collections::Vector<Platform::String^>(rosterUsers);
+        for (auto user : rosterUsers)
+        {
+            vec->Append(user);
+        }
+
+        auto stats = std::make_shared<PeoplehubBatchStandInStats>();
+        std::unordered_map<string_t, std::shared_ptr<HttpResponseStruct>> responses;
+        responses[_T("https://peoplehub.mockenv.xboxlive.com")] = CreatePeoplehubBatchStandIn(stats);
+        m_mockXboxSystemFactory->add_http_state_response(responses);
+
+        auto socialUserGroup = socialManagerInitializationStruct.socialManager->CreateSocialUserGroupFromList(xboxLiveContext->user(), vec->GetView());
+        bool groupLoaded = false;
+        // Give up after 5 seconds rather than hang if the group never loads
+        for (uint32_t i = 0; i < 500 && !groupLoaded; ++i)
+        {
+            for (auto evt : socialManagerInitializationStruct.socialManager->DoWork())
+            {
+                groupLoaded |= evt->EventType == SocialEventType::SocialUserGroupLoaded;
+            }
+            Sleep(10);
+        }
+        VERIFY_IS_TRUE(groupLoaded);
+
+        // Only users new to the graph are fetched, and each of them once
+        VERIFY_ARE_EQUAL_UINT(140, stats->requestedUsers.size());
+        for (auto& requestedUser : stats->requestedUsers)
+        {
+            VERIFY_ARE_EQUAL_UINT(1, requestedUser.second);
+        }
+
+        socialManagerInitializationStruct.socialManager->DestroySocialUserGroup(socialUserGroup);
+
+        Cleanup(socialManagerInitializationStruct, xboxLiveContext);
+    }
+
+    DEFINE_TEST_CASE(TestSocialUserGroupUpdateLargeList)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestSocialUserGroupUpdateLargeList);
+        m_mockXboxSystemFactory->reinit();
+        auto xboxLiveContext = GetMockXboxLiveContext_Cpp();
+        auto socialManagerInitializationStruct = Initialize(xboxLiveContext, true);
+
+        auto makeRoster = [](uint32_t firstXuid, uint32_t count)
+        {
+            Platform::Collections::Vector<Platform::String^>^ roster = ref new Platform::Collections::Vector<Platform::String^>();
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                stringstream_t str;
+                str << (firstXuid + i);
+                roster->Append(ref new Platform::String(str.str().c_str()));
+            }
+            return roster;
+        };
+
+        auto stats = std::make_shared<PeoplehubBatchStandInStats>();
+        std::unordered_map<string_t, std::shared_ptr<HttpResponseStruct>> responses;
+        responses[_T("https://peoplehub.mockenv.xboxlive.com")] = CreatePeoplehubBatchStandIn(stats);
+        m_mockXboxSystemFactory->add_http_state_response(responses);
+
+        auto socialUserGroup = socialManagerInitializationStruct.socialManager->CreateSocialUserGroupFromList(xboxLiveContext->user(), makeRoster(400000, 1500)->GetView());
+        bool groupLoaded = false;
+        // Give up after 5 seconds rather than hang if the group never loads
+        for (uint32_t i = 0; i < 500 && !groupLoaded; ++i)
+        {
+            for (auto evt : socialManagerInitializationStruct.socialManager->DoWork())
+            {
+                groupLoaded |= evt->EventType == SocialEventType::SocialUserGroupLoaded;
+            }
+            Sleep(10);
+        }
+        VERIFY_IS_TRUE(groupLoaded);
+
+        // Half the bracket is swapped out; only the 750 new users are fetched
+        uint32_t requestedBeforeUpdate = static_cast<uint32_t>(stats->requestedUsers.size());
+        auto updateStart = std::chrono::steady_clock::now();
+        socialManagerInitializationStruct.socialManager->UpdateSocialUserGroup(socialUserGroup, makeRoster(400750, 1500)->GetView());
+        auto updateTime = std::chrono::steady_clock::now() - updateStart;
+        VERIFY_ARE_EQUAL_UINT(1500, socialUserGroup->UsersTrackedBySocialUserGroup->Size);
+        VERIFY_ARE_EQUAL_STR(socialUserGroup->UsersTrackedBySocialUserGroup->GetAt(0), _T("400750"));
+
+        bool groupUpdated = false;
+        // Give up after 5 seconds rather than hang if the update never completes
+        for (uint32_t i = 0; i < 500 && (!groupUpdated || socialUserGroup->Users->Size < 1500); ++i)
+        {
+            for (auto evt : socialManagerInitializationStruct.socialManager->DoWork())
+            {
+                if (evt->EventType == SocialEventType::SocialUserGroupUpdated)
+                {
+                    VERIFY_ARE_EQUAL_INT(0, evt->ErrorCode);
+                    groupUpdated = true;
+                }
+            }
+            Sleep(10);
+        }
+        VERIFY_IS_TRUE(groupUpdated);
+
+        TEST_LOG(FormatString(L"Updating a 1500 user list took %d us", static_cast<int>(std::chrono::duration_cast<std::chrono::microseconds>(updateTime).count())).c_str());
+        VERIFY_ARE_EQUAL_UINT(requestedBeforeUpdate + 750, stats->requestedUsers.size());
+        VERIFY_ARE_EQUAL_UINT(1500, socialUserGroup->Users->Size);
+
+        socialManagerInitializationStruct.socialManager->DestroySocialUserGroup(socialUserGroup);
+        Cleanup(socialManagerInitializationStruct, xboxLiveContext);
+    }
+
     // Tests refresh for RTA resync
     DEFINE_TEST_CASE(TestSocialManagerResync)
     {
@@ -1882,11 +2136,9 @@ public:
 #pragma warning(suppress: 6387)
         VERIFY_THROWS_HR_CX(socialManagerInitializationStruct.socialManager->CreateSocialUserGroupFromList(xboxLiveContext->user(), nullptr), E_INVALIDARG);
         VERIFY_THROWS_HR_CX(socialManagerInitializationStruct.socialManager->CreateSocialUserGroupFromList(xboxLiveContext->user(), socialUserListEmpty->GetView()), E_INVALIDARG);
-        VERIFY_THROWS_HR_CX(socialManagerInitializationStruct.socialManager->CreateSocialUserGroupFromList(xboxLiveContext->user(), socialUserListLarge->GetView()), E_INVALIDARG);
         auto groupList = socialManagerInitializationStruct.socialManager->CreateSocialUserGroupFromList(xboxLiveContext->user(), socialUserList->GetView());
         auto groupFilter = socialManagerInitializationStruct.socialManager->CreateSocialUserGroupFromFilters(xboxLiveContext->user(), PresenceFilter::All, RelationshipFilter::Friends);
         VERIFY_THROWS_HR_CX(socialManagerInitializationStruct.socialManager->UpdateSocialUserGroup(nullptr, socialUserList->GetView()), E_INVALIDARG);
-        VERIFY_THROWS_HR_CX(socialManagerInitializationStruct.socialManager->UpdateSocialUserGroup(groupList, socialUserListLarge->GetView()), E_INVALIDARG);
         VERIFY_THROWS_HR_CX(socialManagerInitializationStruct.socialManager->UpdateSocialUserGroup(groupFilter, socialUserListLarge->GetView()), E_INVALIDARG);
 
 #pragma warning(suppress: 6387)
@@ -2617,6 +2869,223 @@ public:
 
         Cleanup(socialManagerInitializationStruct, xboxLiveContext);
     }
+    DEFINE_TEST_CASE(TestAddLocalUserTrace)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestAddLocalUserTrace);
+        m_mockXboxSystemFactory->reinit();
+        auto exporter = std::make_shared<chrome_trace_exporter>();
+        span_tracer::get_span_tracer_singleton()->set_exporter(exporter);
+
+        auto xboxLiveContext = GetMockXboxLiveContext_Cpp();
+        auto socialManagerInitializationStruct = Initialize(xboxLiveContext, true);
+
+        // The span ends just after local_user_added is queued, so it may still be open here
+        auto findSpan = [&exporter](const std::string& name, trace_span_record& found)
+        {
+            for (const auto& span : exporter->spans())
+            {
+                if (span.name == name)
+                {
+                    found = span;
+                    return true;
+                }
+            }
+            return false;
+        };
+        trace_span_record addLocalUserSpan;
+        for (uint32_t i = 0; i < 100 && !findSpan("social_manager::add_local_user", addLocalUserSpan); ++i)
+        {
+            Sleep(10);
+        }
+        span_tracer::get_span_tracer_singleton()->set_exporter(nullptr);
+        TEST_LOG(utility::conversions::to_string_t(exporter->to_json()).c_str());
+
+        trace_span_record subscribeSpan;
+        VERIFY_IS_TRUE(findSpan("social_manager::add_local_user", addLocalUserSpan));
+        VERIFY_IS_TRUE(findSpan("social_graph::subscribe_presence", subscribeSpan));
+        VERIFY_ARE_EQUAL_UINT(0, addLocalUserSpan.parentSpanId);
+        VERIFY_IS_TRUE(subscribeSpan.traceId == addLocalUserSpan.traceId);
+        VERIFY_IS_TRUE(subscribeSpan.parentSpanId == addLocalUserSpan.spanId);
+        VERIFY_IS_TRUE(subscribeSpan.endTime <= addLocalUserSpan.endTime);
+
+        Cleanup(socialManagerInitializationStruct, xboxLiveContext);
+    }
+
+    DEFINE_TEST_CASE(TestSocialManagerInternalEventQueueBatchSize)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestSocialManagerInternalEventQueueBatchSize);
+        xsapi_internal_vector(uint64_t) userList;
+        for (uint64_t i = 1; i <= 800; ++i)
+        {
+            userList.push_back(i);
+        }
+
+        auto countEvents = [](internal_event_queue& eventQueue, size_t& userCount)
+        {
+            size_t eventCount = 0;
+            userCount = 0;
+            while (!eventQueue.empty())
+            {
+                userCount += eventQueue.pop().users_affected_as_string_vec().size();
+                ++eventCount;
+            }
+            return eventCount;
+        };
+
+        size_t userCount = 0;
+        internal_event_queue defaultQueue;
+        defaultQueue.push(internal_social_event_type::users_removed, userList);
+        VERIFY_ARE_EQUAL_UINT(80, countEvents(defaultQueue, userCount));
+        VERIFY_ARE_EQUAL_UINT(800, userCount);
+
+        internal_event_queue largeQueue;
+        largeQueue.set_max_users_affected_per_event(300);
+        largeQueue.push(internal_social_event_type::users_removed, userList);
+        VERIFY_ARE_EQUAL_UINT(3, countEvents(largeQueue, userCount));
+        VERIFY_ARE_EQUAL_UINT(800, userCount);
+
+        // An empty change still produces the one event that carries its completion context
+        call_buffer_timer_completion_context completionContext;
+        completionContext.isNull = false;
+        largeQueue.push(internal_social_event_type::users_removed, xsapi_internal_vector(uint64_t)(), completionContext);
+        VERIFY_ARE_EQUAL_UINT(1, largeQueue.size());
+        VERIFY_IS_FALSE(largeQueue.pop().completion_context().isNull);
+
+        // Zero is clamped so the queue can never divide by it
+        largeQueue.set_max_users_affected_per_event(0);
+        largeQueue.push(internal_social_event_type::users_removed, xsapi_internal_vector(uint64_t)(userList.begin(), userList.begin() + 3));
+        VERIFY_ARE_EQUAL_UINT(3, countEvents(largeQueue, userCount));
+    }
+
+    DEFINE_TEST_CASE(TestSocialEventUsersUnionDedupesAffectedUsers)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestSocialEventUsersUnionDedupesAffectedUsers);
+        auto xboxLiveContext = GetMockXboxLiveContext_Cpp();
+        auto makeEvent = [&xboxLiveContext](social_event_type eventType, uint32_t firstXuid, uint32_t lastXuid)
+        {
+            std::vector<xbox_user_id_container> usersAffected;
+            for (uint32_t i = firstXuid; i <= lastXuid; ++i)
+            {
+                stringstream_t stream;
+                stream << i;
+                usersAffected.push_back(xbox_user_id_container(stream.str().c_str()));
+            }
+            return social_event(xboxLiveContext->user(), eventType, usersAffected);
+        };
+
+        std::vector<social_event> socialEvents;
+        socialEvents.push_back(makeEvent(social_event_type::presence_changed, 1, 10));
+        socialEvents.push_back(makeEvent(social_event_type::presence_changed, 6, 15));
+        socialEvents.push_back(makeEvent(social_event_type::profiles_changed, 1, 20));
+        socialEvents.push_back(makeEvent(social_event_type::users_added_to_social_graph, 30, 31));
+        socialEvents.push_back(makeEvent(social_event_type::local_user_added, 40, 41));
+
+        social_event_users_union usersAffected;
+        usersAffected.add_events(socialEvents);
+        VERIFY_ARE_EQUAL_UINT(20, usersAffected.refilteredUsers.size());
+        VERIFY_ARE_EQUAL_UINT(2, usersAffected.addedUsers.size());
+        VERIFY_ARE_EQUAL_UINT(0, usersAffected.removedUsers.size());
+        VERIFY_ARE_EQUAL_STR(L"1", usersAffected.refilteredUsers[0].xbox_user_id());
+
+        // Only events appended after the index are folded in, as each graph's do_work appends its own
+        size_t firstNewEventIndex = socialEvents.size();
+        socialEvents.push_back(makeEvent(social_event_type::presence_changed, 18, 25));
+        socialEvents.push_back(makeEvent(social_event_type::users_removed_from_social_graph, 30, 30));
+        usersAffected.add_events(socialEvents, firstNewEventIndex);
+        VERIFY_ARE_EQUAL_UINT(25, usersAffected.refilteredUsers.size());
+        VERIFY_ARE_EQUAL_UINT(2, usersAffected.addedUsers.size());
+        VERIFY_ARE_EQUAL_UINT(1, usersAffected.removedUsers.size());
+    }
+
+    // Counts the presence_changed events and do_work time a polled presence refresh of every user produces
+    void RunBulkPresenceRefresh(
+        _In_ SocialManagerInitializationStruct& socialManagerInitializationStruct,
+        _In_ const std::shared_ptr<xbox_live_context>& xboxLiveContext,
+        _In_ bool useOnline,
+        _Out_ uint32_t& presenceEventCount,
+        _Out_ uint32_t& doWorkCount,
+        _Out_ std::chrono::steady_clock::duration& doWorkTime
+        )
+    {
+        std::unordered_map<string_t, std::shared_ptr<HttpResponseStruct>> responses;
+        responses[_T("https://userpresence.mockenv.xboxlive.com")] = GetPresenceResponseStruct(GenerateInitialPresenceJSON(useOnline));
+        m_mockXboxSystemFactory->add_http_state_response(responses);
+
+        presenceEventCount = 0;
+        doWorkCount = 0;
+        doWorkTime = std::chrono::steady_clock::duration::zero();
+        size_t userCount = 0;
+        socialManagerInitializationStruct.socialManager->SetRichPresencePollingState(xboxLiveContext->user(), true);
+
+        // Give up after 5 seconds rather than hang if the refresh never reaches every user
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (userCount < USER_LIST.size() && std::chrono::steady_clock::now() < deadline)
+        {
+            auto doWorkStart = std::chrono::steady_clock::now();
+            auto changeList = socialManagerInitializationStruct.socialManager->DoWork();
+            doWorkTime += std::chrono::steady_clock::now() - doWorkStart;
+            ++doWorkCount;
+            for (auto evt : changeList)
+            {
+                if (evt->EventType == SocialEventType::PresenceChanged)
+                {
+                    userCount += evt->UsersAffected->Size;
+                    ++presenceEventCount;
+                }
+            }
+        }
+        socialManagerInitializationStruct.socialManager->SetRichPresencePollingState(xboxLiveContext->user(), false);
+        VERIFY_ARE_EQUAL_UINT(USER_LIST.size(), userCount);
+    }
+
+    // Puts the social manager's batch size back to the default however the test exits
+    struct RestoreMaxUsersAffectedPerEvent
+    {
+        ~RestoreMaxUsersAffectedPerEvent()
+        {
+            social_manager::get_singleton_instance()->set_max_users_affected_per_event(internal_event_queue::DEFAULT_MAX_USERS_AFFECTED_PER_EVENT);
+        }
+    };
+
+    DEFINE_TEST_CASE(TestSocialManagerBulkPresenceChangeBatching)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestSocialManagerBulkPresenceChangeBatching);
+        m_mockXboxSystemFactory->reinit();
+        auto xboxLiveContext = GetMockXboxLiveContext_Cpp();
+        auto socialManagerInitializationStruct = Initialize(xboxLiveContext, true);
+        auto socialUserGroupOnline = socialManagerInitializationStruct.socialManager->CreateSocialUserGroupFromFilters(
+            xboxLiveContext->user(),
+            PresenceFilter::AllOnline,
+            RelationshipFilter::Friends
+            );
+        auto socialManagerCpp = social_manager::get_singleton_instance();
+        RestoreMaxUsersAffectedPerEvent restoreMaxUsersAffectedPerEvent;
+        VERIFY_IS_TRUE(socialManagerCpp->max_users_affected_per_event() == internal_event_queue::DEFAULT_MAX_USERS_AFFECTED_PER_EVENT);
+        VERIFY_IS_TRUE(socialManagerCpp->set_max_users_affected_per_event(0).err() == xbox_live_error_code::invalid_argument);
+
+        auto toMicroseconds = [](std::chrono::steady_clock::duration duration)
+        {
+            return static_cast<int>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+        };
+
+        uint32_t presenceEventCount = 0;
+        uint32_t doWorkCount = 0;
+        std::chrono::steady_clock::duration doWorkTime;
+        RunBulkPresenceRefresh(socialManagerInitializationStruct, xboxLiveContext, false, presenceEventCount, doWorkCount, doWorkTime);
+        TEST_LOG(FormatString(L"%d users, %d per event: %d presence events over %d do_work calls, %d us", static_cast<int>(USER_LIST.size()), static_cast<int>(internal_event_queue::DEFAULT_MAX_USERS_AFFECTED_PER_EVENT), static_cast<int>(presenceEventCount), static_cast<int>(doWorkCount), toMicroseconds(doWorkTime)).c_str());
+        VERIFY_ARE_EQUAL_UINT((USER_LIST.size() + internal_event_queue::DEFAULT_MAX_USERS_AFFECTED_PER_EVENT - 1) / internal_event_queue::DEFAULT_MAX_USERS_AFFECTED_PER_EVENT, presenceEventCount);
+        VERIFY_ARE_EQUAL_UINT(0, socialUserGroupOnline->Users->Size);
+
+        VERIFY_IS_FALSE(socialManagerCpp->set_max_users_affected_per_event(static_cast<uint32_t>(USER_LIST.size())).err());
+        RunBulkPresenceRefresh(socialManagerInitializationStruct, xboxLiveContext, true, presenceEventCount, doWorkCount, doWorkTime);
+        TEST_LOG(FormatString(L"%d users, %d per event: %d presence events over %d do_work calls, %d us", static_cast<int>(USER_LIST.size()), static_cast<int>(USER_LIST.size()), static_cast<int>(presenceEventCount), static_cast<int>(doWorkCount), toMicroseconds(doWorkTime)).c_str());
+        VERIFY_ARE_EQUAL_UINT(1, presenceEventCount);
+        VERIFY_ARE_EQUAL_UINT(USER_LIST.size(), socialUserGroupOnline->Users->Size);
+
+        socialManagerInitializationStruct.socialManager->DestroySocialUserGroup(socialUserGroupOnline);
+        socialUserGroupOnline = nullptr;
+        Cleanup(socialManagerInitializationStruct, xboxLiveContext);
+    }
 };
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_END
\ No newline at end of file
@@ -9,9 +9,12 @@
 #include "xbox_live_context_impl.h"
 #include "StatisticManager_WinRT.h"
 #include "StatsManagerHelper.h"
+#include "Stats/Manager/stats_manager_internal.h"
 
 using namespace Microsoft::Xbox::Services::Statistics::Manager;
 using namespace Microsoft::Xbox::Services::Leaderboard;
+using xbox::services::stats::manager::stats_flush_scheduler;
+using xbox::services::stats::manager::stats_flush_scheduler_stats;
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_BEGIN
 
@@ -214,6 +217,157 @@ public:
 
         Cleanup(statsManager, user);
     }
+
+    static const int FLUSH_DURATION_MS = 100;
+
+    // Stands in for update_stats_value_document: each flush takes FLUSH_DURATION_MS and the number in flight is tracked
+    struct FlushRecorder
+    {
+        FlushRecorder() : inFlight(0), peakInFlight(0), overlappingUserFlushes(0) {}
+
+        std::function<pplx::task<xbox_live_result<void>>(const string_t&)> Handler(_In_ std::function<std::error_code(const string_t&)> resultForUser = nullptr)
+        {
+            return [this, resultForUser](const string_t& xboxUserId)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(recorderLock);
+                    int concurrent = ++inFlight;
+                    peakInFlight = __max(peakInFlight, concurrent);
+                    if (++inFlightByUser[xboxUserId] > 1)
+                    {
+                        ++overlappingUserFlushes;
+                    }
+                    startTimes[xboxUserId].push_back(std::chrono::steady_clock::now());
+                }
+
+                std::error_code result = resultForUser != nullptr ? resultForUser(xboxUserId) : std::error_code();
+                return pplx::create_task([this, xboxUserId, result]()
+                {
+                    Sleep(FLUSH_DURATION_MS);
+                    std::lock_guard<std::mutex> lock(recorderLock);
+                    --inFlight;
+                    --inFlightByUser[xboxUserId];
+                    return xbox_live_result<void>(result);
+                });
+            };
+        }
+
+        std::mutex recorderLock;
+        int inFlight;
+        int peakInFlight;
+        int overlappingUserFlushes;
+        std::map<string_t, int> inFlightByUser;
+        std::map<string_t, std::vector<std::chrono::steady_clock::time_point>> startTimes;
+    };
+
+    static stats_flush_scheduler_stats WaitForFlushes(_In_ const std::shared_ptr<stats_flush_scheduler>& scheduler, _In_ uint64_t flushCount)
+    {
+        for (int i = 0; i < 500 && scheduler->stats().flushesCompleted < flushCount; ++i)
+        {
+            Sleep(10);
+        }
+        auto stats = scheduler->stats();
+        VERIFY_ARE_EQUAL_UINT(flushCount, stats.flushesCompleted);
+        return stats;
+    }
+
+    DEFINE_TEST_CASE(StatisticManagerFlushSchedulerFourUsers)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(StatisticManagerFlushSchedulerFourUsers);
+        std::vector<string_t> users = { L"1", L"2", L"3", L"4" };
+
+        // All four users flushed in the same window go out as one burst
+        FlushRecorder recorder;
+        auto scheduler = std::make_shared<stats_flush_scheduler>(recorder.Handler());
+        scheduler->request_flush(users);
+        auto stats = WaitForFlushes(scheduler, 4);
+        TEST_LOG(FormatString(L"limit 4: burst %d, max latency %dms", static_cast<int>(stats.peakConcurrentFlushes), static_cast<int>(stats.maxFlushLatency.count())).c_str());
+        VERIFY_ARE_EQUAL_INT(4, recorder.peakInFlight);
+        VERIFY_IS_TRUE(stats.maxFlushLatency.count() < 2 * FLUSH_DURATION_MS);
+
+        // Under a lower limit the rest queue, so the burst stays within it at the cost of latency
+        FlushRecorder limitedRecorder;
+        auto limitedScheduler = std::make_shared<stats_flush_scheduler>(limitedRecorder.Handler(), 2);
+        limitedScheduler->request_flush(users);
+        stats = WaitForFlushes(limitedScheduler, 4);
+        TEST_LOG(FormatString(L"limit 2: burst %d, max latency %dms", static_cast<int>(stats.peakConcurrentFlushes), static_cast<int>(stats.maxFlushLatency.count())).c_str());
+        VERIFY_ARE_EQUAL_INT(2, limitedRecorder.peakInFlight);
+        VERIFY_IS_TRUE(stats.maxFlushLatency.count() >= 2 * FLUSH_DURATION_MS);
+    }
+
+    DEFINE_TEST_CASE(StatisticManagerFlushSchedulerKeepsUserOrder)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(StatisticManagerFlushSchedulerKeepsUserOrder);
+        FlushRecorder recorder;
+        auto scheduler = std::make_shared<stats_flush_scheduler>(recorder.Handler());
+
+        // Asking again while the first flush is in flight queues a second one behind it
+        scheduler->request_flush(std::vector<string_t>{ L"1" });
+        scheduler->request_flush(std::vector<string_t>{ L"1", L"2" });
+        scheduler->request_flush(std::vector<string_t>{ L"1" });
+        WaitForFlushes(scheduler, 3);
+
+        VERIFY_ARE_EQUAL_INT(0, recorder.overlappingUserFlushes);
+        VERIFY_ARE_EQUAL_UINT(2, recorder.startTimes[L"1"].size());
+        VERIFY_IS_TRUE(recorder.startTimes[L"1"][1] - recorder.startTimes[L"1"][0] >= std::chrono::milliseconds(FLUSH_DURATION_MS));
+    }
+
+    DEFINE_TEST_CASE(StatisticManagerFlushSchedulerSharedBackoff)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(StatisticManagerFlushSchedulerSharedBackoff);
+        const std::chrono::milliseconds backoff(300);
+        FlushRecorder recorder;
+        std::atomic<bool> throttled(false);
+        auto scheduler = std::make_shared<stats_flush_scheduler>(
+            recorder.Handler([&throttled](const string_t& xboxUserId)
+            {
+                bool throttle = xboxUserId == L"1" && !throttled.exchange(true);
+                return throttle ? std::make_error_code(xbox_live_error_code::http_status_429_too_many_requests) : std::error_code();
+            }),
+            1,
+            backoff);
+
+        // User 1 is throttled, so user 2 waits out the backoff too and user 1 goes again first
+        scheduler->request_flush(std::vector<string_t>{ L"1", L"2" });
+        auto stats = WaitForFlushes(scheduler, 2);
+        VERIFY_ARE_EQUAL_UINT(1, stats.throttledFlushes);
+        VERIFY_ARE_EQUAL_UINT(2, recorder.startTimes[L"1"].size());
+        VERIFY_ARE_EQUAL_UINT(1, recorder.startTimes[L"2"].size());
+        VERIFY_IS_TRUE(recorder.startTimes[L"1"][1] - recorder.startTimes[L"1"][0] >= backoff);
+        VERIFY_IS_TRUE(recorder.startTimes[L"2"][0] > recorder.startTimes[L"1"][1]);
+    }
+
+    DEFINE_TEST_CASE(StatisticManagerFlushSchedulerFinalFlush)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(StatisticManagerFlushSchedulerFinalFlush);
+        FlushRecorder recorder;
+        auto scheduler = std::make_shared<stats_flush_scheduler>(recorder.Handler());
+        auto finalFlushHandler = recorder.Handler();
+
+        // The final flush replaces the queued one and still waits for the flush already in flight
+        auto finalResults = std::make_shared<std::atomic<int>>(0);
+        scheduler->request_flush(std::vector<string_t>{ L"1" });
+        scheduler->request_flush(std::vector<string_t>{ L"1" });
+        scheduler->request_final_flush(
+            L"1",
+            [finalFlushHandler]() { return finalFlushHandler(L"1"); },
+            [finalResults](const xbox_live_result<void>& result)
+            {
+                if (!result.err())
+                {
+                    ++(*finalResults);
+                }
+            });
+        WaitForFlushes(scheduler, 2);
+        for (int i = 0; i < 100 && finalResults->load() == 0; ++i)
+        {
+            Sleep(10);
+        }
+
+        VERIFY_ARE_EQUAL_INT(1, finalResults->load());
+        VERIFY_ARE_EQUAL_INT(0, recorder.overlappingUserFlushes);
+        VERIFY_ARE_EQUAL_UINT(2, recorder.startTimes[L"1"].size());
+    }
 };
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_END
\ No newline at end of file
@@ -7,12 +7,50 @@
 #include "UnitTestIncludes.h"
 
 #include "TitleStorageService_WinRT.h"
+#include "xbox_live_context_impl.h"
+#include "title_storage_internal.h"
 
 using namespace Microsoft::Xbox::Services;
 using namespace Microsoft::Xbox::Services::TitleStorage;
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_BEGIN
 
+// A fresh directory under %TEMP% for one test, removed with everything in it when the test ends
+class TempCacheDirectory
+{
+public:
+    TempCacheDirectory()
+    {
+        wchar_t tempPath[MAX_PATH];
+        VERIFY_IS_TRUE(GetTempPathW(MAX_PATH, tempPath) > 0);
+        m_path = string_t(tempPath) + L"xsapi_blobcache_" + utils::create_guid(true);
+        VERIFY_IS_TRUE(CreateDirectoryW(m_path.c_str(), nullptr) != 0);
+    }
+
+    ~TempCacheDirectory()
+    {
+        WIN32_FIND_DATAW findData;
+        HANDLE findHandle = FindFirstFileW((m_path + L"\\*").c_str(), &findData);
+        if (findHandle != INVALID_HANDLE_VALUE)
+        {
+            do
+            {
+                if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+                {
+                    DeleteFileW((m_path + L"\\" + findData.cFileName).c_str());
+                }
+            } while (FindNextFileW(findHandle, &findData));
+            FindClose(findHandle);
+        }
+        RemoveDirectoryW(m_path.c_str());
+    }
+
+    const string_t& path() const { return m_path; }
+
+private:
+    string_t m_path;
+};
+
 const web::json::value queryJson = web::json::value::parse(LR"(
 {
     "quotaInfo": {
@@ -779,6 +817,363 @@ public:
             E_INVALIDARG
             );
     }
+
+    DEFINE_TEST_CASE(DownloadBlobFromCacheTest)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(DownloadBlobFromCacheTest);
+        auto xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto xboxLiveContextImpl = std::make_shared<xbox_live_context_impl>(xboxLiveContext->User);
+        xboxLiveContextImpl->init();
+        auto& titleStorageService = xboxLiveContextImpl->title_storage_service();
+
+        TempCacheDirectory cacheDirectory;
+        VERIFY_IS_TRUE(!titleStorageService.enable_blob_cache(cacheDirectory.path(), 1024 * 1024).err());
+        auto blobCache = titleStorageService._Blob_cache();
+
+        std::string blobData = utility::conversions::to_utf8string(downloadJson);
+        std::vector<unsigned char> blob(blobData.begin(), blobData.end());
+        web::http::http_response httpResponse;
+        httpResponse.headers().add(L"ETag", L"\"0x8D1C76581F12853\"");
+
+        auto httpCall = m_mockXboxSystemFactory->GetMockHttpCall();
+        httpCall->ResultValue = StockMocks::CreateMockHttpCallResponse(blob, 200, httpResponse);
+
+        title_storage::title_storage_blob_metadata blobMetadata(
+            _T("123456789"),
+            title_storage::title_storage_type::json_storage,
+            _T("cachedBlobPath"),
+            title_storage::title_storage_blob_type::json,
+            _T("TestXboxUserId")
+            );
+
+        auto result = titleStorageService.download_blob(
+            blobMetadata,
+            std::make_shared<std::vector<unsigned char>>(),
+            title_storage::title_storage_e_tag_match_condition::not_used
+            ).get();
+        VERIFY_IS_TRUE(!result.err());
+        VERIFY_ARE_EQUAL_UINT(blob.size(), result.payload().blob_buffer()->size());
+        VERIFY_ARE_EQUAL_UINT(blob.size(), blobCache->bytes_downloaded());
+
+        // The blob hasn't changed, so the repeat download is served from the cache
+        httpCall->ResultValue = StockMocks::CreateMockHttpCallResponse(std::vector<unsigned char>(), 304, httpResponse);
+        result = titleStorageService.download_blob(
+            blobMetadata,
+            std::make_shared<std::vector<unsigned char>>(),
+            title_storage::title_storage_e_tag_match_condition::not_used
+            ).get();
+        VERIFY_IS_TRUE(!result.err());
+        VERIFY_IS_TRUE(blob == *result.payload().blob_buffer());
+        VERIFY_ARE_EQUAL_STR(L"\"0x8D1C76581F12853\"", result.payload().blob_metadata().e_tag());
+        VERIFY_ARE_EQUAL_UINT(blob.size(), blobCache->bytes_downloaded());
+        VERIFY_ARE_EQUAL_UINT(blob.size(), blobCache->bytes_served_from_cache());
+        VERIFY_ARE_EQUAL_INT(2, httpCall->CallCounter);
+
+        titleStorageService.disable_blob_cache();
+    }
+
+    DEFINE_TEST_CASE(BlobCacheSharedBetweenServicesTest)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(BlobCacheSharedBetweenServicesTest);
+        auto xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto firstContextImpl = std::make_shared<xbox_live_context_impl>(xboxLiveContext->User);
+        firstContextImpl->init();
+        auto secondContextImpl = std::make_shared<xbox_live_context_impl>(xboxLiveContext->User);
+        secondContextImpl->init();
+
+        TempCacheDirectory cacheDirectory;
+        VERIFY_IS_TRUE(!firstContextImpl->title_storage_service().enable_blob_cache(cacheDirectory.path(), 1024 * 1024).err());
+        VERIFY_IS_TRUE(!secondContextImpl->title_storage_service().enable_blob_cache(cacheDirectory.path() + L"\\", 1024 * 1024).err());
+
+        // Both services write through one index, so neither loses the other's entries
+        auto blobCache = firstContextImpl->title_storage_service()._Blob_cache();
+        VERIFY_IS_TRUE(blobCache == secondContextImpl->title_storage_service()._Blob_cache());
+
+        std::vector<unsigned char> blob = { 1, 2, 3 };
+        blobCache->write(L"first", L"\"etag1\"", blob);
+        secondContextImpl->title_storage_service()._Blob_cache()->write(L"second", L"\"etag2\"", blob);
+
+        firstContextImpl->title_storage_service().disable_blob_cache();
+        secondContextImpl->title_storage_service().disable_blob_cache();
+        blobCache = nullptr;
+
+        // Reloaded from disk, the index has both entries
+        auto reloadedCache = title_storage::title_storage_blob_cache::get_cache(cacheDirectory.path(), 1024 * 1024);
+        VERIFY_ARE_EQUAL_STR(L"\"etag1\"", reloadedCache->cached_e_tag(L"first"));
+        VERIFY_ARE_EQUAL_STR(L"\"etag2\"", reloadedCache->cached_e_tag(L"second"));
+    }
+
+    DEFINE_TEST_CASE(SyncBlobsDownloadsOnlyChangedBlobsTest)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(SyncBlobsDownloadsOnlyChangedBlobsTest);
+        auto xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto xboxLiveContextImpl = std::make_shared<xbox_live_context_impl>(xboxLiveContext->User);
+        xboxLiveContextImpl->init();
+        auto& titleStorageService = xboxLiveContextImpl->title_storage_service();
+
+        const uint32_t blobCount = 500;
+        const uint32_t changedBlobCount = 25;
+
+        // The listing has every blob at etagN; the manifest is stale for every 20th blob
+        title_storage::title_storage_sync_manifest manifest;
+        web::json::value blobsJson = web::json::value::array();
+        for (uint32_t i = 0; i < blobCount; ++i)
+        {
+            stringstream_t blobPath;
+            blobPath << L"sync/blob" << i << L".json";
+            stringstream_t eTag;
+            eTag << L"\"etag" << i << L"\"";
+
+            blobsJson[i][L"fileName"] = web::json::value::string(blobPath.str() + L",json");
+            blobsJson[i][L"etag"] = web::json::value::string(eTag.str());
+            blobsJson[i][L"size"] = web::json::value::number(10);
+
+            title_storage::title_storage_blob_metadata manifestBlob(
+                L"123456789",
+                title_storage::title_storage_type::json_storage,
+                blobPath.str(),
+                title_storage::title_storage_blob_type::json,
+                L"TestXboxUserId"
+                );
+            manifestBlob._Set_e_tag_and_length(i % (blobCount / changedBlobCount) == 0 ? L"\"stale\"" : eTag.str(), 10);
+            manifest.update(manifestBlob);
+        }
+        web::json::value listingJson;
+        listingJson[L"blobs"] = blobsJson;
+
+        wchar_t tempPath[MAX_PATH];
+        VERIFY_IS_TRUE(GetTempPathW(MAX_PATH, tempPath) > 0);
+        string_t manifestFilePath = string_t(tempPath) + L"syncmanifest.json";
+        VERIFY_IS_TRUE(manifest.save(manifestFilePath));
+
+        std::string blobData = "{\"a\":12345}";
+        web::http::http_response httpResponse;
+        httpResponse.headers().add(L"ETag", L"\"downloaded\"");
+        auto blobResponse = StockMocks::CreateMockHttpCallResponse(std::vector<unsigned char>(blobData.begin(), blobData.end()), 200, httpResponse);
+
+        // Each call gets its own mock http call, so parallel downloads don't share a response
+        auto downloadCount = std::make_shared<std::atomic<int>>(0);
+        auto listResponseStruct = std::make_shared<HttpResponseStruct>();
+        listResponseStruct->responseList = { StockMocks::CreateMockHttpCallResponse(listingJson) };
+        auto downloadResponseStruct = std::make_shared<HttpResponseStruct>();
+        downloadResponseStruct->responseList = { blobResponse };
+        downloadResponseStruct->fRequestPostFunc = [downloadCount](std::shared_ptr<http_call_response>&, const string_t&)
+        {
+            ++(*downloadCount);
+        };
+
+        std::unordered_map<xbox_live_api, std::shared_ptr<HttpResponseStruct>> responses;
+        responses[xbox_live_api::get_blob_metadata] = listResponseStruct;
+        responses[xbox_live_api::download_blob] = downloadResponseStruct;
+        m_mockXboxSystemFactory->add_http_api_state_response(responses);
+
+        title_storage::title_storage_sync_request syncRequest(
+            L"123456789",
+            title_storage::title_storage_type::json_storage,
+            L"sync",
+            L"TestXboxUserId",
+            manifestFilePath
+            );
+        auto result = titleStorageService.sync_blobs(syncRequest).get();
+        VERIFY_IS_TRUE(!result.err());
+        VERIFY_ARE_EQUAL_UINT(changedBlobCount, result.payload().downloaded_blobs().size());
+        VERIFY_ARE_EQUAL_UINT(blobCount - changedBlobCount, result.payload().unchanged_blob_count());
+        VERIFY_ARE_EQUAL_UINT(0, result.payload().failed_blob_paths().size());
+        VERIFY_ARE_EQUAL_INT(changedBlobCount, downloadCount->load());
+
+        stringstream_t syncTime;
+        syncTime << L"Synced " << blobCount << L" blobs with " << changedBlobCount << L" changed in " << result.payload().sync_duration().count() << L"ms";
+        TEST_LOG(syncTime.str().c_str());
+
+        // The committed manifest records the downloaded versions
+        auto committedManifest = title_storage::title_storage_sync_manifest::load(manifestFilePath);
+        VERIFY_ARE_EQUAL_STR(L"\"downloaded\"", committedManifest.find(L"sync/blob0.json")->eTag);
+        VERIFY_ARE_EQUAL_STR(L"\"etag1\"", committedManifest.find(L"sync/blob1.json")->eTag);
+
+        DeleteFileW(manifestFilePath.c_str());
+    }
+
+    DEFINE_TEST_CASE(SyncBlobsUploadsLocalChangesTest)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(SyncBlobsUploadsLocalChangesTest);
+        auto xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto xboxLiveContextImpl = std::make_shared<xbox_live_context_impl>(xboxLiveContext->User);
+        xboxLiveContextImpl->init();
+        auto& titleStorageService = xboxLiveContextImpl->title_storage_service();
+
+        // sync/unchanged.json is as of the last sync, sync/conflicted.json was changed by someone else since,
+        // and sync/new.json doesn't exist remotely yet
+        web::json::value listingJson;
+        listingJson[L"blobs"][0][L"fileName"] = web::json::value::string(L"sync/unchanged.json,json");
+        listingJson[L"blobs"][0][L"etag"] = web::json::value::string(L"\"unchanged1\"");
+        listingJson[L"blobs"][0][L"size"] = web::json::value::number(10);
+        listingJson[L"blobs"][1][L"fileName"] = web::json::value::string(L"sync/conflicted.json,json");
+        listingJson[L"blobs"][1][L"etag"] = web::json::value::string(L"\"conflicted2\"");
+        listingJson[L"blobs"][1][L"size"] = web::json::value::number(10);
+
+        auto makeBlobMetadata = [](const string_t& blobPath, const string_t& eTag)
+        {
+            title_storage::title_storage_blob_metadata blobMetadata(
+                L"123456789",
+                title_storage::title_storage_type::json_storage,
+                blobPath,
+                title_storage::title_storage_blob_type::json,
+                L"TestXboxUserId"
+                );
+            blobMetadata._Set_e_tag_and_length(eTag, 10);
+            return blobMetadata;
+        };
+
+        title_storage::title_storage_sync_manifest manifest;
+        manifest.update(makeBlobMetadata(L"sync/unchanged.json", L"\"unchanged1\""));
+        manifest.update(makeBlobMetadata(L"sync/conflicted.json", L"\"conflicted1\""));
+
+        wchar_t tempPath[MAX_PATH];
+        VERIFY_IS_TRUE(GetTempPathW(MAX_PATH, tempPath) > 0);
+        string_t manifestFilePath = string_t(tempPath) + L"syncuploadmanifest.json";
+        VERIFY_IS_TRUE(manifest.save(manifestFilePath));
+
+        web::http::http_response httpResponse;
+        httpResponse.headers().add(L"ETag", L"\"uploaded\"");
+        auto uploadCount = std::make_shared<std::atomic<int>>(0);
+        auto listResponseStruct = std::make_shared<HttpResponseStruct>();
+        listResponseStruct->responseList = { StockMocks::CreateMockHttpCallResponse(listingJson) };
+        auto uploadResponseStruct = std::make_shared<HttpResponseStruct>();
+        uploadResponseStruct->responseList = { StockMocks::CreateMockHttpCallResponse(std::vector<unsigned char>(), 200, httpResponse) };
+        uploadResponseStruct->fRequestPostFunc = [uploadCount](std::shared_ptr<http_call_response>&, const string_t&)
+        {
+            ++(*uploadCount);
+        };
+
+        std::unordered_map<xbox_live_api, std::shared_ptr<HttpResponseStruct>> responses;
+        responses[xbox_live_api::get_blob_metadata] = listResponseStruct;
+        responses[xbox_live_api::upload_blob] = uploadResponseStruct;
+        m_mockXboxSystemFactory->add_http_api_state_response(responses);
+
+        auto makeBlobBuffer = [](const std::string& blobData)
+        {
+            return std::make_shared<std::vector<unsigned char>>(blobData.begin(), blobData.end());
+        };
+
+        title_storage::title_storage_sync_request syncRequest(
+            L"123456789",
+            title_storage::title_storage_type::json_storage,
+            L"sync",
+            L"TestXboxUserId",
+            manifestFilePath
+            );
+        syncRequest.add_upload(makeBlobMetadata(L"sync/unchanged.json", string_t()), makeBlobBuffer("{\"u\":1}"));
+        syncRequest.add_upload(makeBlobMetadata(L"sync/conflicted.json", string_t()), makeBlobBuffer("{\"c\":1}"));
+        syncRequest.add_upload(makeBlobMetadata(L"sync/new.json", string_t()), makeBlobBuffer("{\"n\":1}"));
+
+        auto result = titleStorageService.sync_blobs(syncRequest).get();
+        VERIFY_IS_TRUE(!result.err());
+        VERIFY_ARE_EQUAL_UINT(2, result.payload().uploaded_blobs().size());
+        VERIFY_ARE_EQUAL_UINT(1, result.payload().conflicted_blob_paths().size());
+        VERIFY_ARE_EQUAL_STR(L"sync/conflicted.json", result.payload().conflicted_blob_paths()[0]);
+        VERIFY_ARE_EQUAL_UINT(0, result.payload().failed_blob_paths().size());
+
+        // Only the two uploads that didn't conflict were sent
+        VERIFY_ARE_EQUAL_INT(2, uploadCount->load());
+        std::set<string_t> uploadedPaths;
+        for (const auto& uploadedBlob : result.payload().uploaded_blobs())
+        {
+            uploadedPaths.insert(uploadedBlob.blob_path());
+        }
+        VERIFY_IS_TRUE(uploadedPaths.find(L"sync/unchanged.json") != uploadedPaths.end());
+        VERIFY_IS_TRUE(uploadedPaths.find(L"sync/new.json") != uploadedPaths.end());
+
+        // The committed manifest records the uploaded versions and keeps the conflicted blob's old entry
+        auto committedManifest = title_storage::title_storage_sync_manifest::load(manifestFilePath);
+        VERIFY_ARE_EQUAL_STR(L"\"uploaded\"", committedManifest.find(L"sync/unchanged.json")->eTag);
+        VERIFY_ARE_EQUAL_STR(L"\"uploaded\"", committedManifest.find(L"sync/new.json")->eTag);
+        VERIFY_ARE_EQUAL_STR(L"\"conflicted1\"", committedManifest.find(L"sync/conflicted.json")->eTag);
+
+        DeleteFileW(manifestFilePath.c_str());
+    }
+
+    DEFINE_TEST_CASE(UploadBlobFromStreamingSourceTest)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(UploadBlobFromStreamingSourceTest);
+        auto xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto xboxLiveContextImpl = std::make_shared<xbox_live_context_impl>(xboxLiveContext->User);
+        xboxLiveContextImpl->init();
+        auto& titleStorageService = xboxLiveContextImpl->title_storage_service();
+
+        // 64 MB produced on demand, so the length is only known once the source runs dry
+        const uint64_t blobLength = 64 * 1024 * 1024;
+        auto bytesProduced = std::make_shared<uint64_t>(0);
+        auto blobSource = [bytesProduced, blobLength](unsigned char* buffer, size_t bufferSize)
+        {
+            size_t count = static_cast<size_t>(__min(static_cast<uint64_t>(bufferSize), blobLength - *bytesProduced));
+            memset(buffer, static_cast<int>(*bytesProduced % 251), count);
+            *bytesProduced += count;
+            return count;
+        };
+
+        web::http::http_response httpResponse;
+        httpResponse.headers().add(L"ETag", L"\"0x8D1C76581F12853\"");
+        auto uploadCount = std::make_shared<std::atomic<int>>(0);
+        auto uploadResponseStruct = std::make_shared<HttpResponseStruct>();
+        uploadResponseStruct->responseList = { StockMocks::CreateMockHttpCallResponse(largeUploadJson, 200, httpResponse) };
+        uploadResponseStruct->fRequestPostFunc = [uploadCount](std::shared_ptr<http_call_response>&, const string_t&)
+        {
+            // Injected service latency, which the read of the next block overlaps
+            ++(*uploadCount);
+            Sleep(20);
+        };
+
+        std::unordered_map<xbox_live_api, std::shared_ptr<HttpResponseStruct>> responses;
+        responses[xbox_live_api::upload_blob] = uploadResponseStruct;
+        m_mockXboxSystemFactory->add_http_api_state_response(responses);
+
+        title_storage::title_storage_blob_metadata blobMetadata(
+            _T("123456789"),
+            title_storage::title_storage_type::global_storage,
+            _T("streamedBlobPath"),
+            title_storage::title_storage_blob_type::binary,
+            _T("")
+            );
+
+        auto startTime = std::chrono::steady_clock::now();
+        auto result = titleStorageService.upload_blob(
+            blobMetadata,
+            blobSource,
+            title_storage::title_storage_e_tag_match_condition::not_used,
+            title_storage::title_storage_service::MIN_UPLOAD_BLOCK_SIZE
+            ).get();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+
+        VERIFY_IS_TRUE(!result.err());
+        VERIFY_ARE_EQUAL_UINT(blobLength, result.payload().length());
+        VERIFY_ARE_EQUAL_STR(L"\"0x8D1C76581F12853\"", result.payload().e_tag());
+        VERIFY_IS_TRUE(m_mockXboxSystemFactory->GetMockHttpCall()->PathQueryFragment.to_string().find(L"finalBlock=true") != string_t::npos);
+
+        // Blocks grow from the 1 KB minimum, so this only takes far fewer than 64K requests if sizes adapt
+        VERIFY_IS_TRUE(*uploadCount < 100);
+
+        stringstream_t throughput;
+        throughput << L"Uploaded " << blobLength << L" bytes in " << *uploadCount << L" blocks, " << elapsed.count() << L"ms";
+        TEST_LOG(throughput.str().c_str());
+    }
+
+    DEFINE_TEST_CASE(UploadBlockSizeAdaptsToThroughputTest)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(UploadBlockSizeAdaptsToThroughputTest);
+        const uint32_t blockSize = 256 * 1024;
+
+        // Fast sends grow the block, by at most a factor of two
+        VERIFY_ARE_EQUAL_UINT(blockSize * 2, title_storage::title_storage_upload_pipeline::adapt_block_size(blockSize, blockSize, std::chrono::milliseconds(10)));
+
+        // Sends slower than the target shrink it, by at most a factor of two
+        VERIFY_ARE_EQUAL_UINT(blockSize / 2, title_storage::title_storage_upload_pipeline::adapt_block_size(blockSize, blockSize, std::chrono::milliseconds(60000)));
+        VERIFY_ARE_EQUAL_UINT(250 * 1024, title_storage::title_storage_upload_pipeline::adapt_block_size(300 * 1024, 300 * 1024, std::chrono::milliseconds(2400)));
+
+        // A short final block doesn't count, and sizes stay within the service limits
+        VERIFY_ARE_EQUAL_UINT(blockSize, title_storage::title_storage_upload_pipeline::adapt_block_size(blockSize, 100, std::chrono::milliseconds(60000)));
+        VERIFY_ARE_EQUAL_UINT(title_storage::title_storage_service::MAX_UPLOAD_BLOCK_SIZE, title_storage::title_storage_upload_pipeline::adapt_block_size(title_storage::title_storage_service::MAX_UPLOAD_BLOCK_SIZE, title_storage::title_storage_service::MAX_UPLOAD_BLOCK_SIZE, std::chrono::milliseconds(1)));
+        VERIFY_ARE_EQUAL_UINT(title_storage::title_storage_service::MIN_UPLOAD_BLOCK_SIZE, title_storage::title_storage_upload_pipeline::adapt_block_size(title_storage::title_storage_service::MIN_UPLOAD_BLOCK_SIZE, title_storage::title_storage_service::MIN_UPLOAD_BLOCK_SIZE, std::chrono::milliseconds(60000)));
+    }
 };
 
 NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_END
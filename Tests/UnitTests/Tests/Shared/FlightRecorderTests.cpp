@@ -0,0 +1,170 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#define TEST_CLASS_OWNER L"jasonsa"
+#define TEST_CLASS_AREA L"FlightRecorder"
+#include "UnitTestIncludes.h"
+#include "xbox_live_context_impl.h"
+#include "flight_recorder.h"
+#include <thread>
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_BEGIN
+
+DEFINE_TEST_CLASS(FlightRecorderTests)
+{
+public:
+    DEFINE_TEST_CLASS_PROPS(FlightRecorderTests)
+
+    static string_t DumpFilePath()
+    {
+        wchar_t tempPath[MAX_PATH];
+        VERIFY_IS_TRUE(GetTempPathW(MAX_PATH, tempPath) > 0);
+        return string_t(tempPath) + L"xsapi_flight_recorder.bin";
+    }
+
+    DEFINE_TEST_CASE(TestHttpCallsAreRecorded)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestHttpCallsAreRecorded);
+        auto xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto xboxLiveContextImpl = std::make_shared<xbox_live_context_impl>(xboxLiveContext->User);
+        xboxLiveContextImpl->init();
+
+        // Calls only reach http_call_impl, where they are recorded, with the client mocked rather than the call
+        m_mockXboxSystemFactory->setup_mock_for_http_client();
+        auto httpClient = m_mockXboxSystemFactory->GetMockHttpClient();
+        httpClient->ResultValue.set_body(web::json::value::parse(L"{}"));
+        httpClient->ResultValue.set_status_code(400);
+
+        auto recorder = flight_recorder::get_flight_recorder_singleton();
+        uint64_t recordCount = recorder->record_count();
+        xboxLiveContextImpl->achievement_service().update_achievement(xboxLiveContextImpl->xbox_live_user_id(), L"1", 50).wait();
+        VERIFY_IS_TRUE(recorder->record_count() >= recordCount + 2);
+
+        // The last completion carries the call's status and is paired with a start under the same id
+        auto records = recorder->snapshot();
+        auto completed = std::find_if(records.rbegin(), records.rend(), [](const flight_record& record)
+        {
+            return record.type == static_cast<uint16_t>(flight_record_type::http_call_completed);
+        });
+        VERIFY_IS_TRUE(completed != records.rend());
+        VERIFY_ARE_EQUAL_INT(400, static_cast<int>(completed->value));
+        VERIFY_ARE_EQUAL_INT(static_cast<int>(xbox_live_api::update_achievement), static_cast<int>(completed->source));
+
+        auto started = std::find_if(completed, records.rend(), [&completed](const flight_record& record)
+        {
+            return record.type == static_cast<uint16_t>(flight_record_type::http_call_started) && record.id == completed->id;
+        });
+        VERIFY_IS_TRUE(started != records.rend());
+        VERIFY_IS_TRUE(started->timestamp <= completed->timestamp);
+    }
+
+    DEFINE_TEST_CASE(TestBufferWrapsAndDumps)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestBufferWrapsAndDumps);
+        auto recorder = std::make_shared<flight_recorder>();
+
+        // Only the newest CAPACITY records survive, oldest first
+        uint32_t recordCount = static_cast<uint32_t>(flight_recorder::CAPACITY + 100);
+        for (uint32_t i = 0; i < recordCount; ++i)
+        {
+            recorder->record(flight_record_type::social_manager_events, 0, 0, i);
+        }
+        auto records = recorder->snapshot();
+        VERIFY_ARE_EQUAL_UINT(flight_recorder::CAPACITY, records.size());
+        VERIFY_ARE_EQUAL_UINT(100, records.front().value);
+        VERIFY_ARE_EQUAL_UINT(recordCount - 1, records.back().value);
+
+        VERIFY_IS_TRUE(!recorder->dump(DumpFilePath()).err());
+        std::ifstream in(DumpFilePath(), std::ios::in | std::ios::binary);
+        uint32_t header[4] = {};
+        in.read(reinterpret_cast<char*>(header), sizeof(header));
+        VERIFY_ARE_EQUAL_UINT(flight_recorder::DUMP_MAGIC, header[0]);
+        VERIFY_ARE_EQUAL_UINT(flight_recorder::DUMP_VERSION, header[1]);
+        VERIFY_ARE_EQUAL_UINT(sizeof(flight_record), header[2]);
+        VERIFY_ARE_EQUAL_UINT(flight_recorder::CAPACITY, header[3]);
+
+        std::vector<flight_record> dumped(header[3]);
+        in.read(reinterpret_cast<char*>(dumped.data()), dumped.size() * sizeof(flight_record));
+        VERIFY_IS_TRUE(in.good());
+        VERIFY_IS_TRUE(memcmp(dumped.data(), records.data(), dumped.size() * sizeof(flight_record)) == 0);
+    }
+
+    DEFINE_TEST_CASE(TestRecordOverhead)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestRecordOverhead);
+        auto recorder = std::make_shared<flight_recorder>();
+        const uint32_t recordsPerThread = 1000000;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < recordsPerThread; ++i)
+        {
+            recorder->record(flight_record_type::http_call_started, 1, i, i);
+        }
+        auto singleThreadTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start);
+
+        // The way the SDK's call sites record, fetching the singleton for every record
+        VERIFY_IS_TRUE(flight_recorder::get_flight_recorder_singleton() == flight_recorder::get_flight_recorder_singleton());
+        start = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < recordsPerThread; ++i)
+        {
+            flight_recorder::get_flight_recorder_singleton()->record(flight_record_type::http_call_started, 1, i, i);
+        }
+        auto callSiteTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start);
+
+        // Four writers at once, with a reader taking snapshots; every record must land and every snapshot must be whole
+        const uint32_t threadCount = 4;
+        std::atomic<bool> writersDone(false);
+        std::vector<std::thread> writers;
+        start = std::chrono::high_resolution_clock::now();
+        for (uint32_t t = 0; t < threadCount; ++t)
+        {
+            writers.push_back(std::thread([recorder, t, recordsPerThread]()
+            {
+                for (uint32_t i = 0; i < recordsPerThread; ++i)
+                {
+                    recorder->record(flight_record_type::http_call_completed, static_cast<uint16_t>(t), t, i, i);
+                }
+            }));
+        }
+
+        uint32_t snapshotCount = 0;
+        uint32_t tornRecordCount = 0;
+        std::thread reader([recorder, &writersDone, &snapshotCount, &tornRecordCount]()
+        {
+            while (!writersDone)
+            {
+                for (const auto& record : recorder->snapshot())
+                {
+                    // Writers always store duration equal to value, so a mismatch would be a torn record
+                    if (record.value != record.duration)
+                    {
+                        ++tornRecordCount;
+                    }
+                }
+                ++snapshotCount;
+            }
+        });
+
+        for (auto& writer : writers)
+        {
+            writer.join();
+        }
+        auto concurrentTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start);
+        writersDone = true;
+        reader.join();
+
+        VERIFY_ARE_EQUAL_UINT(static_cast<uint64_t>(recordsPerThread) * (threadCount + 1), recorder->record_count());
+        VERIFY_ARE_EQUAL_UINT(flight_recorder::CAPACITY, recorder->snapshot().size());
+        VERIFY_ARE_EQUAL_UINT(0, tornRecordCount);
+
+        TEST_LOG(FormatString(L"Single writer: %dns per record", static_cast<int>(singleThreadTime.count() / recordsPerThread)).c_str());
+        TEST_LOG(FormatString(L"Single writer through the singleton: %dns per record", static_cast<int>(callSiteTime.count() / recordsPerThread)).c_str());
+        TEST_LOG(FormatString(L"%d writers: %dns per record, %d snapshots taken alongside",
+            static_cast<int>(threadCount),
+            static_cast<int>(concurrentTime.count() / (recordsPerThread * threadCount)),
+            static_cast<int>(snapshotCount)).c_str());
+    }
+};
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_END
@@ -199,6 +199,48 @@ public:
         VerifyDelay(g_callLog[2].m_time, g_callLog[1].m_time, 0);
     }
 
+    DEFINE_TEST_CASE(TestCircuitBreakerOpensAndRecovers)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestCircuitBreakerOpensAndRecovers);
+        auto responseJson = web::json::value::parse(defaultStringVerifyResult);
+        auto httpClient = m_mockXboxSystemFactory->GetMockHttpClient();
+        auto requestString = std::wstring(L"xboxUserId");
+        auto xboxLiveContext = GetMockXboxLiveContext_Cpp();
+        xboxLiveContext->settings()->set_http_timeout_window(std::chrono::seconds(0));
+        m_mockXboxSystemFactory->setup_mock_for_http_client();
+
+        auto healthManager = http_endpoint_health_manager::get_http_endpoint_health_manager_singleton();
+        healthManager->set_open_duration(std::chrono::milliseconds(500));
+        string_t endpoint = utils::create_xboxlive_endpoint(_T("client-strings"), xboxLiveContext->application_config());
+
+        // The endpoint is down: every request fails until the circuit opens
+        httpClient->ResultValue.set_body(responseJson);
+        httpClient->ResultValue.set_status_code(503);
+        for (uint32_t i = 0; i < http_endpoint_health_manager::FAILURE_THRESHOLD; ++i)
+        {
+            auto result = xboxLiveContext->string_service().verify_string(requestString).get();
+            VERIFY_IS_TRUE(result.err() == xbox_live_error_code::http_status_503_service_unavailable);
+        }
+        VERIFY_IS_TRUE(healthManager->stats(endpoint).state == http_circuit_state::open);
+
+        // While open, calls fail fast without reaching the endpoint
+        auto fastFailResult = xboxLiveContext->string_service().verify_string(requestString).get();
+        VERIFY_IS_TRUE(fastFailResult.err() == xbox_live_error_code::http_endpoint_circuit_open);
+        VERIFY_IS_TRUE(fastFailResult.err() == xbox_live_error_condition::network);
+
+        // The endpoint recovers; once the open period passes a single probe closes the circuit
+        httpClient->ResultValue.set_status_code(200);
+        Sleep(700);
+        auto probeResult = xboxLiveContext->string_service().verify_string(requestString).get();
+        VERIFY_IS_TRUE(!probeResult.err());
+
+        auto stats = healthManager->stats(endpoint);
+        VERIFY_IS_TRUE(stats.state == http_circuit_state::closed);
+        VERIFY_ARE_EQUAL_UINT(1, stats.timesOpened);
+        VERIFY_ARE_EQUAL_UINT(3, stats.stateTransitionCount); // closed -> open -> half_open -> closed
+        VERIFY_ARE_EQUAL_UINT(1, stats.fastFailCount);
+    }
+
     static void LogCalls(_In_ const std::chrono::steady_clock::time_point& timeStart)
     {
         std::chrono::steady_clock::time_point timeLast = timeStart;
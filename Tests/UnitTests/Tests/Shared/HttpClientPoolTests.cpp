@@ -0,0 +1,176 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#define TEST_CLASS_OWNER L"jasonsa"
+#define TEST_CLASS_AREA L"HttpClientPool"
+#include "UnitTestIncludes.h"
+#include <xsapi/xbox_live_context.h>
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_BEGIN
+
+const std::wstring defaultPoolStringVerifyResult =
+LR"(
+    {
+    "verifyStringResult":
+    [
+        {
+            "resultCode": 0
+        }
+    ]}
+    )";
+
+// Stands in for a TLS host: the first request on a client resolves the host and does the handshake,
+// later requests ride the open connection
+class HandshakeCountingHttpClient : public xbox_http_client
+{
+public:
+    HandshakeCountingHttpClient(_In_ bool isReachable) :
+        m_isReachable(isReachable),
+        m_connected(false),
+        m_requestCount(0),
+        m_handshakeCount(0)
+    {
+    }
+
+    pplx::task<web::http::http_response> get_request(
+        _In_ web::http::http_request request,
+        _In_ pplx::cancellation_token token = pplx::cancellation_token::none()
+        ) override
+    {
+        ++m_requestCount;
+        if (!m_connected.exchange(true))
+        {
+            ++m_handshakeCount;
+        }
+
+        bool isReachable = m_isReachable;
+        return pplx::create_task([isReachable]()
+        {
+            if (!isReachable)
+            {
+                throw web::http::http_exception(L"host not found");
+            }
+
+            web::http::http_response response(200);
+            response.set_body(web::json::value::parse(defaultPoolStringVerifyResult));
+            return response;
+        });
+    }
+
+    uint32_t request_count() const { return m_requestCount; }
+    uint32_t handshake_count() const { return m_handshakeCount; }
+
+private:
+    bool m_isReachable;
+    std::atomic<bool> m_connected;
+    std::atomic<uint32_t> m_requestCount;
+    std::atomic<uint32_t> m_handshakeCount;
+};
+
+DEFINE_TEST_CLASS(HttpClientPoolTests)
+{
+public:
+    DEFINE_TEST_CLASS_PROPS(HttpClientPoolTests)
+
+    std::shared_ptr<std::map<string_t, std::vector<std::shared_ptr<HandshakeCountingHttpClient>>>> SetupHandshakeCountingHosts(
+        _In_ const string_t& unreachableHost = string_t()
+        )
+    {
+        auto clientsByHost = std::make_shared<std::map<string_t, std::vector<std::shared_ptr<HandshakeCountingHttpClient>>>>();
+        m_mockXboxSystemFactory->setup_mock_for_http_client();
+        m_mockXboxSystemFactory->set_http_client_factory([clientsByHost, unreachableHost](const web::http::uri& baseUri)
+        {
+            auto client = std::make_shared<HandshakeCountingHttpClient>(baseUri.host() != unreachableHost);
+            (*clientsByHost)[baseUri.host()].push_back(client);
+            return client;
+        });
+        return clientsByHost;
+    }
+
+    static uint32_t HandshakeCount(_In_ const std::vector<std::shared_ptr<HandshakeCountingHttpClient>>& clients)
+    {
+        uint32_t handshakeCount = 0;
+        for (const auto& client : clients)
+        {
+            handshakeCount += client->handshake_count();
+        }
+        return handshakeCount;
+    }
+
+    DEFINE_TEST_CASE(TestPrewarmTakesHandshakeOffFirstCall)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestPrewarmTakesHandshakeOffFirstCall);
+        auto xboxLiveContext = GetMockXboxLiveContext_Cpp();
+        auto pool = http_client_pool::get_http_client_pool_singleton();
+        auto clientsByHost = SetupHandshakeCountingHosts();
+
+        // Without pre-warming, the first call to a host does the handshake and later calls reuse the connection
+        string_t stringsHost = web::uri(utils::create_xboxlive_endpoint(_T("client-strings"), xboxLiveContext->application_config())).host();
+        xboxLiveContext->string_service().verify_string(L"xboxUserId").wait();
+        VERIFY_ARE_EQUAL_UINT(1, HandshakeCount((*clientsByHost)[stringsHost]));
+        xboxLiveContext->string_service().verify_string(L"xboxUserId").wait();
+        VERIFY_ARE_EQUAL_UINT(1, HandshakeCount((*clientsByHost)[stringsHost]));
+        VERIFY_ARE_EQUAL_UINT(1, (*clientsByHost)[stringsHost].size());
+
+        VERIFY_IS_TRUE(!xboxLiveContext->prewarm_service_connections().get().err());
+
+        std::vector<string_t> services = { _T("social"), _T("peoplehub"), _T("userpresence"), _T("sessiondirectory"), _T("statsread") };
+        for (const auto& service : services)
+        {
+            string_t endpoint = utils::create_xboxlive_endpoint(service, xboxLiveContext->application_config());
+            VERIFY_IS_TRUE(pool->is_warm(endpoint));
+            VERIFY_ARE_EQUAL_UINT(1, (*clientsByHost)[web::uri(endpoint).host()].size());
+            VERIFY_ARE_EQUAL_UINT(1, HandshakeCount((*clientsByHost)[web::uri(endpoint).host()]));
+        }
+
+        // The first real call after pre-warming rides the warmed connection instead of doing its own handshake
+        xboxLiveContext->presence_service().get_presence(L"TestXboxUserId").wait();
+        auto& presenceClients = (*clientsByHost)[web::uri(utils::create_xboxlive_endpoint(_T("userpresence"), xboxLiveContext->application_config())).host()];
+        VERIFY_ARE_EQUAL_UINT(1, presenceClients.size());
+        VERIFY_ARE_EQUAL_UINT(2, presenceClients[0]->request_count());
+        VERIFY_ARE_EQUAL_UINT(1, presenceClients[0]->handshake_count());
+    }
+
+    DEFINE_TEST_CASE(TestPrewarmSkipsUnreachableHosts)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestPrewarmSkipsUnreachableHosts);
+        auto xboxLiveContext = GetMockXboxLiveContext_Cpp();
+        auto pool = http_client_pool::get_http_client_pool_singleton();
+        string_t sessionEndpoint = utils::create_xboxlive_endpoint(_T("sessiondirectory"), xboxLiveContext->application_config());
+        string_t statsEndpoint = utils::create_xboxlive_endpoint(_T("statsread"), xboxLiveContext->application_config());
+        auto clientsByHost = SetupHandshakeCountingHosts(web::uri(sessionEndpoint).host());
+
+        xboxLiveContext->prewarm_service_connections().wait();
+        VERIFY_IS_TRUE(pool->is_unreachable(sessionEndpoint));
+        VERIFY_IS_TRUE(!pool->is_warm(sessionEndpoint));
+        VERIFY_IS_TRUE(pool->is_warm(statsEndpoint));
+
+        // A second pre-warm neither retries the unreachable host nor reconnects to warm ones
+        xboxLiveContext->prewarm_service_connections().wait();
+        VERIFY_ARE_EQUAL_UINT(1, (*clientsByHost)[web::uri(sessionEndpoint).host()][0]->request_count());
+        VERIFY_ARE_EQUAL_UINT(1, (*clientsByHost)[web::uri(statsEndpoint).host()][0]->request_count());
+    }
+
+    DEFINE_TEST_CASE(TestPooledClientExpiresAfterTtl)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestPooledClientExpiresAfterTtl);
+        auto pool = http_client_pool::get_http_client_pool_singleton();
+        auto clientsByHost = SetupHandshakeCountingHosts();
+        auto config = http_call_impl::create_client_config(std::chrono::seconds(DEFAULT_HTTP_TIMEOUT_SECONDS));
+
+        auto client = pool->get_client(L"https://social.xboxlive.com", config);
+        VERIFY_IS_TRUE(client == pool->get_client(L"https://social.xboxlive.com", config));
+
+        // Timeouts are applied per request, so calls with a different timeout share the connection
+        VERIFY_IS_TRUE(client == pool->get_client(L"https://social.xboxlive.com", http_call_impl::create_client_config(std::chrono::seconds(MIN_HTTP_TIMEOUT_SECONDS))));
+        VERIFY_ARE_EQUAL_UINT(1, (*clientsByHost)[L"social.xboxlive.com"].size());
+
+        // The TTL runs from creation, so even a client in constant use is replaced and the host resolved afresh
+        pool->set_client_ttl(std::chrono::milliseconds(0));
+        VERIFY_IS_TRUE(client != pool->get_client(L"https://social.xboxlive.com", config));
+        VERIFY_ARE_EQUAL_UINT(2, (*clientsByHost)[L"social.xboxlive.com"].size());
+    }
+};
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_END
@@ -0,0 +1,212 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#define TEST_CLASS_OWNER L"jasonsa"
+#define TEST_CLASS_AREA L"JsonWriter"
+#include "UnitTestIncludes.h"
+#include "json_writer.h"
+#include "Stats/Manager/stats_manager_internal.h"
+#include "social_manager_internal.h"
+
+using namespace xbox::services::stats::manager;
+using namespace xbox::services::social::manager;
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_BEGIN
+
+DEFINE_TEST_CLASS(JsonWriterTests)
+{
+public:
+    DEFINE_TEST_CLASS_PROPS(JsonWriterTests)
+
+    static std::string Utf8(_In_ const web::json::value& value)
+    {
+        return utility::conversions::to_utf8string(value.serialize());
+    }
+
+    static std::string Utf8(_In_ const json_writer& writer)
+    {
+        return std::string(writer.buffer().begin(), writer.buffer().end());
+    }
+
+    static std::vector<string_t> CreateXuids(_In_ uint32_t count)
+    {
+        std::vector<string_t> xuids;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            xuids.push_back(utility::conversions::to_string_t(std::to_string(2533274790000000ULL + i)));
+        }
+        return xuids;
+    }
+
+    static stats_value_document CreateStatsValueDocument()
+    {
+        stats_value_document document;
+        document.set_stat(L"headshots", 8.0);
+        document.set_stat(L"accuracy", 0.1);
+        document.set_stat(L"distanceTravelled", 123456789.125);
+        document.set_stat(L"Deaths", -3.0);
+        document.set_stat(L"title", L"Sergeant \"Sarge\" Éclair\t\U0001F3AE");
+        for (uint32_t i = 0; i < 20; ++i)
+        {
+            document.set_stat(FormatString(L"stat%d", i).c_str(), i * 1.5);
+        }
+        document.do_work();
+        document.set_revision_from_clock();
+        return document;
+    }
+
+    DEFINE_TEST_CASE(TestWriterMatchesJsonValue)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestWriterMatchesJsonValue);
+
+        // Every kind of value, with keys in the sorted order web::json::value writes them in
+        string_t escapes = L"quote\" backslash\\ slash/ \b\f\n\r\t \x01\x1f\x7f é中 \U0001F600";
+        web::json::value expected;
+        expected[L"array"] = web::json::value::array();
+        expected[L"array"][0] = web::json::value::number(1);
+        expected[L"array"][1] = web::json::value::string(L"two");
+        expected[L"array"][2] = web::json::value::array();
+        expected[L"array"][3] = web::json::value::object();
+        expected[L"bool"] = web::json::value::boolean(true);
+        expected[L"doubles"] = web::json::value::array();
+        expected[L"doubles"][0] = web::json::value::number(0.1);
+        expected[L"doubles"][1] = web::json::value::number(-2.5);
+        expected[L"doubles"][2] = web::json::value::number(1e300);
+        expected[L"doubles"][3] = web::json::value::number(8.0);
+        expected[L"escapes"] = web::json::value::string(escapes);
+        expected[L"int64"] = web::json::value::number(std::numeric_limits<int64_t>::min());
+        expected[L"key\"escaped"] = web::json::value::boolean(false);
+        expected[L"null"] = web::json::value::null();
+        expected[L"uint64"] = web::json::value::number(std::numeric_limits<uint64_t>::max());
+
+        json_writer writer(0);
+        writer.start_object();
+        writer.write_key(L"array");
+        writer.start_array();
+        writer.write_number(static_cast<int64_t>(1));
+        writer.write_string(L"two");
+        writer.start_array();
+        writer.end_array();
+        writer.start_object();
+        writer.end_object();
+        writer.end_array();
+        writer.write_key(L"bool");
+        writer.write_bool(true);
+        writer.write_key(L"doubles");
+        writer.start_array();
+        writer.write_number(0.1);
+        writer.write_number(-2.5);
+        writer.write_number(1e300);
+        writer.write_number(8.0);
+        writer.end_array();
+        writer.write_key(L"escapes");
+        writer.write_string(escapes);
+        writer.write_key(L"int64");
+        writer.write_number(std::numeric_limits<int64_t>::min());
+        writer.write_key(L"key\"escaped");
+        writer.write_bool(false);
+        writer.write_key(L"null");
+        writer.write_null();
+        writer.write_key(L"uint64");
+        writer.write_number(std::numeric_limits<uint64_t>::max());
+        writer.end_object();
+
+        TEST_LOG(utility::conversions::to_string_t(Utf8(writer)).c_str());
+        VERIFY_IS_TRUE(Utf8(expected) == Utf8(writer));
+
+        writer.reset();
+        writer.start_array();
+        writer.end_array();
+        VERIFY_IS_TRUE(Utf8(writer) == "[]");
+    }
+
+    DEFINE_TEST_CASE(TestRequestBuildersMatchJsonValue)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestRequestBuildersMatchJsonValue);
+
+        auto document = CreateStatsValueDocument();
+        auto timestamp = utility::datetime::utc_now();
+        json_writer statsWriter;
+        document.serialize(timestamp, statsWriter);
+        VERIFY_IS_TRUE(Utf8(document.serialize(timestamp)) == Utf8(statsWriter));
+
+        auto xuids = CreateXuids(100);
+        web::json::value batchRequest;
+        batchRequest[L"xuids"] = utils::serialize_vector<string_t>(utils::json_string_serializer, xuids);
+        json_writer batchWriter;
+        peoplehub_service::serialize_batch_request(xuids, batchWriter);
+        VERIFY_IS_TRUE(Utf8(batchRequest) == Utf8(batchWriter));
+
+        // Taking the buffer leaves the writer ready for the next request
+        auto batchBody = batchWriter.take_buffer();
+        VERIFY_IS_TRUE(Utf8(batchRequest) == std::string(batchBody.begin(), batchBody.end()));
+        VERIFY_ARE_EQUAL_UINT(0, batchWriter.buffer().size());
+        batchWriter.start_array();
+        batchWriter.end_array();
+        VERIFY_IS_TRUE(Utf8(batchWriter) == "[]");
+    }
+
+    DEFINE_TEST_CASE(TestSerializerBenchmarks)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestSerializerBenchmarks);
+        const uint32_t iterations = 1000;
+        auto document = CreateStatsValueDocument();
+        auto timestamp = utility::datetime::utc_now();
+        auto xuids = CreateXuids(100);
+
+        // Each request builder: the DOM version (tree, serialize, convert to UTF-8 for the wire) against
+        // one writer reused across requests the way a caller holding onto it would
+        std::vector<std::pair<string_t, std::pair<std::function<size_t()>, std::function<void(json_writer&)>>>> serializers;
+        serializers.push_back(std::make_pair(string_t(L"stats_value_document"), std::make_pair(
+            std::function<size_t()>([&document, timestamp]() { return Utf8(document.serialize(timestamp)).size(); }),
+            std::function<void(json_writer&)>([&document, timestamp](json_writer& writer) { document.serialize(timestamp, writer); })
+            )));
+        serializers.push_back(std::make_pair(string_t(L"peoplehub batch"), std::make_pair(
+            std::function<size_t()>([&xuids]()
+            {
+                web::json::value request;
+                request[L"xuids"] = utils::serialize_vector<string_t>(utils::json_string_serializer, xuids);
+                return Utf8(request).size();
+            }),
+            std::function<void(json_writer&)>([&xuids](json_writer& writer) { peoplehub_service::serialize_batch_request(xuids, writer); })
+            )));
+
+        for (auto& serializer : serializers)
+        {
+            size_t domBytes = 0;
+            auto domStart = std::chrono::high_resolution_clock::now();
+            for (uint32_t i = 0; i < iterations; ++i)
+            {
+                domBytes = serializer.second.first();
+            }
+            auto domTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - domStart);
+
+            json_writer writer(0);
+            uint32_t bufferGrowths = 0;
+            size_t capacity = 0;
+            auto writerStart = std::chrono::high_resolution_clock::now();
+            for (uint32_t i = 0; i < iterations; ++i)
+            {
+                writer.reset();
+                serializer.second.second(writer);
+                if (writer.buffer().capacity() != capacity)
+                {
+                    capacity = writer.buffer().capacity();
+                    ++bufferGrowths;
+                }
+            }
+            auto writerTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - writerStart);
+
+            TEST_LOG(FormatString(L"%s: %d bytes, json::value %dus/request, json_writer %dus/request, %d buffer allocations over %d requests",
+                serializer.first.c_str(), writer.buffer().size(), domTime.count() / iterations, writerTime.count() / iterations, bufferGrowths, iterations).c_str());
+
+            VERIFY_ARE_EQUAL_UINT(domBytes, writer.buffer().size());
+
+            // The buffer only grows while serializing the first request; every later one reuses it
+            VERIFY_IS_TRUE(bufferGrowths < 8);
+        }
+    }
+};
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_END
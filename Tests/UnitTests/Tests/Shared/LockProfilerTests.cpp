@@ -0,0 +1,187 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#define TEST_CLASS_OWNER L"jasonsa"
+#define TEST_CLASS_AREA L"LockProfiler"
+#include "UnitTestIncludes.h"
+#include "xsapi/social_manager.h"
+#include "xsapi/multiplayer_manager.h"
+#include "lock_profiler.h"
+#include "SocialManagerHelper.h"
+#include <thread>
+
+using namespace xbox::services::social::manager;
+using namespace xbox::services::multiplayer::manager;
+
+// The manager test below reads the sites of the SDK's own locks, which only exist in a profiling build
+static_assert(XSAPI_LOCK_PROFILING, "The unit test projects must define XSAPI_LOCK_PROFILING=1");
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_BEGIN
+
+DEFINE_TEST_CLASS(LockProfilerTests)
+{
+public:
+    DEFINE_TEST_CLASS_PROPS(LockProfilerTests)
+
+    static lock_site_stats FindSite(_In_ const std::string& name)
+    {
+        for (const auto& site : lock_profiler::get_lock_profiler_singleton().top_contended_sites(SIZE_MAX))
+        {
+            if (site.name == name)
+            {
+                return site;
+            }
+        }
+
+        VERIFY_IS_TRUE(false);
+        return lock_site_stats();
+    }
+
+    DEFINE_TEST_CASE(TestContendedWaitsAreMeasured)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestContendedWaitsAreMeasured);
+        const uint32_t threadCount = 8;
+        const uint32_t iterations = 2000;
+        profiled_mutex<std::mutex> hotMutex("LockProfilerTests::hotMutex");
+        profiled_mutex<std::mutex> coldMutex("LockProfilerTests::coldMutex");
+        lock_profiler::get_lock_profiler_singleton().reset();
+
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < threadCount; ++i)
+        {
+            threads.push_back(std::thread([&]()
+            {
+                for (uint32_t j = 0; j < iterations; ++j)
+                {
+                    std::lock_guard<profiled_mutex<std::mutex>> lock(hotMutex);
+                    std::this_thread::yield();
+                }
+            }));
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        {
+            std::lock_guard<profiled_mutex<std::mutex>> lock(coldMutex);
+        }
+
+        auto hot = FindSite("LockProfilerTests::hotMutex");
+        auto cold = FindSite("LockProfilerTests::coldMutex");
+        TEST_LOG(FormatString(L"hot: %d acquisitions, %d contended", static_cast<int>(hot.acquisitions), static_cast<int>(hot.contendedAcquisitions)).c_str());
+        VERIFY_ARE_EQUAL_UINT(threadCount * iterations, hot.acquisitions);
+        VERIFY_IS_TRUE(hot.contendedAcquisitions > 0);
+        VERIFY_IS_TRUE(hot.totalWait > std::chrono::nanoseconds::zero());
+        VERIFY_IS_TRUE(hot.maxWait <= hot.totalWait);
+
+        // Every contended acquisition lands in exactly one histogram bucket
+        uint64_t histogramTotal = 0;
+        for (auto bucket : hot.waitHistogram)
+        {
+            histogramTotal += bucket;
+        }
+        VERIFY_ARE_EQUAL_UINT(hot.contendedAcquisitions, histogramTotal);
+
+        VERIFY_ARE_EQUAL_UINT(1, cold.acquisitions);
+        VERIFY_ARE_EQUAL_UINT(0, cold.contendedAcquisitions);
+
+        // Sorted by time spent waiting, so the hot site comes before the cold one
+        auto top = lock_profiler::get_lock_profiler_singleton().top_contended_sites(1);
+        VERIFY_ARE_EQUAL_UINT(1, top.size());
+        VERIFY_IS_TRUE(top[0].totalWait >= hot.totalWait);
+    }
+
+    DEFINE_TEST_CASE(TestRecursiveHoldCountsOutermostLock)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestRecursiveHoldCountsOutermostLock);
+        profiled_mutex<std::recursive_mutex> mutex("LockProfilerTests::recursiveMutex");
+        lock_profiler::get_lock_profiler_singleton().reset();
+
+        {
+            std::lock_guard<profiled_mutex<std::recursive_mutex>> outer(mutex);
+            {
+                std::lock_guard<profiled_mutex<std::recursive_mutex>> inner(mutex);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+
+        auto site = FindSite("LockProfilerTests::recursiveMutex");
+        VERIFY_ARE_EQUAL_UINT(2, site.acquisitions);
+        VERIFY_ARE_EQUAL_UINT(0, site.contendedAcquisitions);
+
+        // One hold, from the outer lock to its unlock, which includes the sleep after the inner unlock
+        VERIFY_IS_TRUE(site.maxHold >= std::chrono::milliseconds(20));
+        VERIFY_ARE_EQUAL_INT(site.maxHold.count(), site.totalHold.count());
+    }
+
+    DEFINE_TEST_CASE(TestManagersUnderLoadReport)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestManagersUnderLoadReport);
+        const uint32_t threadCount = 8;
+        const uint32_t iterations = 500;
+        auto xboxLiveContext = GetMockXboxLiveContext_Cpp();
+
+        std::unordered_map<string_t, std::shared_ptr<HttpResponseStruct>> responses;
+        auto peoplehubResponseStruct = std::make_shared<HttpResponseStruct>();
+        peoplehubResponseStruct->responseList = { StockMocks::CreateMockHttpCallResponse(web::json::value::parse(peoplehubResponse)) };
+        responses[_T("https://peoplehub.mockenv.xboxlive.com")] = peoplehubResponseStruct;
+        m_mockXboxSystemFactory->add_http_state_response(responses);
+
+        // A local user in each manager, so do_work has a social graph to update and a lobby to write
+        auto socialManager = social_manager::get_singleton_instance();
+        VERIFY_IS_TRUE(!socialManager->add_local_user(xboxLiveContext->user(), social_manager_extra_detail_level::no_extra_detail).err());
+        bool userAdded = false;
+        for (uint32_t i = 0; i < 500 && !userAdded; ++i)
+        {
+            for (const auto& socialEvent : socialManager->do_work())
+            {
+                userAdded |= socialEvent.event_type() == social_event_type::local_user_added;
+            }
+            Sleep(10);
+        }
+        VERIFY_IS_TRUE(userAdded);
+
+        auto multiplayerManager = multiplayer_manager::get_singleton_instance();
+        multiplayerManager->initialize(_T("MockLobbySessionTemplateName"));
+        VERIFY_IS_TRUE(!multiplayerManager->lobby_session()->add_local_user(xboxLiveContext->user()).err());
+        lock_profiler::get_lock_profiler_singleton().reset();
+
+        // Games call do_work from the title thread while other threads reach the managers; this has every thread do both
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < threadCount; ++i)
+        {
+            threads.push_back(std::thread([&]()
+            {
+                for (uint32_t j = 0; j < iterations; ++j)
+                {
+                    social_manager::get_singleton_instance()->do_work();
+                    multiplayer_manager::get_singleton_instance()->do_work();
+                }
+            }));
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        auto report = lock_profiler::get_lock_profiler_singleton().format_report(10);
+        TEST_LOG(utility::conversions::to_string_t(report).c_str());
+
+        // Each pass through both managers fetches both singletons and takes the user's social graph lock
+        auto singletonLock = FindSite("xsapi_singleton::m_singletonLock");
+        VERIFY_IS_TRUE(singletonLock.acquisitions >= threadCount * iterations * 2);
+        auto socialGraphLock = FindSite("social_graph::m_socialGraphPriorityMutex");
+        VERIFY_IS_TRUE(socialGraphLock.acquisitions >= threadCount * iterations);
+        auto localUserLock = FindSite("multiplayer_local_user_manager::m_lock");
+        VERIFY_IS_TRUE(localUserLock.acquisitions > 0);
+        VERIFY_IS_TRUE(report.find("xsapi_singleton::m_singletonLock") != std::string::npos);
+
+        multiplayerManager->lobby_session()->remove_local_user(xboxLiveContext->user());
+        multiplayerManager->do_work();
+        socialManager->remove_local_user(xboxLiveContext->user());
+        socialManager->do_work();
+    }
+};
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_END
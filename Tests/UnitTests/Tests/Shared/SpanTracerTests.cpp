@@ -0,0 +1,182 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#define TEST_CLASS_OWNER L"jasonsa"
+#define TEST_CLASS_AREA L"SpanTracer"
+#include "UnitTestIncludes.h"
+#include "xbox_live_context_impl.h"
+#include "span_tracer.h"
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_BEGIN
+
+class counting_trace_exporter : public trace_exporter
+{
+public:
+    counting_trace_exporter() : m_count(0) {}
+
+    void export_span(_In_ const trace_span_record& span) override
+    {
+        UNREFERENCED_PARAMETER(span);
+        ++m_count;
+    }
+
+    uint64_t count() const { return m_count; }
+
+private:
+    std::atomic<uint64_t> m_count;
+};
+
+DEFINE_TEST_CLASS(SpanTracerTests)
+{
+public:
+    DEFINE_TEST_CLASS_PROPS(SpanTracerTests)
+
+    DEFINE_TEST_CASE(TestHttpAttemptsJoinCallerTrace)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestHttpAttemptsJoinCallerTrace);
+        auto xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto xboxLiveContextImpl = std::make_shared<xbox_live_context_impl>(xboxLiveContext->User);
+        xboxLiveContextImpl->init();
+        m_mockXboxSystemFactory->setup_mock_for_http_client();
+        auto httpClient = m_mockXboxSystemFactory->GetMockHttpClient();
+        httpClient->ResultValue.set_body(web::json::value::parse(L"{}"));
+        httpClient->ResultValue.set_status_code(400);
+
+        auto exporter = std::make_shared<chrome_trace_exporter>();
+        span_tracer::get_span_tracer_singleton()->set_exporter(exporter);
+
+        trace_context rootContext;
+        {
+            trace_span root("SpanTracerTests::root");
+            rootContext = root.context();
+            trace_context_scope scope(rootContext);
+            xboxLiveContextImpl->achievement_service().update_achievement(xboxLiveContextImpl->xbox_live_user_id(), L"1", 50).wait();
+        }
+
+        // Made with no span current, so it starts a trace of its own
+        xboxLiveContextImpl->achievement_service().update_achievement(xboxLiveContextImpl->xbox_live_user_id(), L"1", 50).wait();
+        span_tracer::get_span_tracer_singleton()->set_exporter(nullptr);
+
+        auto spans = exporter->spans();
+        VERIFY_ARE_EQUAL_UINT(3, spans.size());
+        auto root = std::find_if(spans.begin(), spans.end(), [](const trace_span_record& span) { return span.name == "SpanTracerTests::root"; });
+        VERIFY_IS_TRUE(root != spans.end());
+        VERIFY_ARE_EQUAL_UINT(0, root->parentSpanId);
+
+        size_t childCount = 0;
+        size_t rootCount = 0;
+        for (const auto& span : spans)
+        {
+            if (span.spanId == rootContext.spanId)
+            {
+                continue;
+            }
+
+            VERIFY_IS_TRUE(span.name.find("POST https://achievements") == 0);
+            VERIFY_IS_TRUE(span.startTime <= span.endTime);
+            if (span.parentSpanId == rootContext.spanId)
+            {
+                VERIFY_IS_TRUE(span.traceId == rootContext.traceId);
+                VERIFY_IS_TRUE(span.startTime >= root->startTime && span.endTime <= root->endTime);
+                ++childCount;
+            }
+            else
+            {
+                VERIFY_ARE_EQUAL_UINT(0, span.parentSpanId);
+                VERIFY_IS_TRUE(span.traceId == span.spanId);
+                ++rootCount;
+            }
+        }
+        VERIFY_ARE_EQUAL_UINT(1, childCount);
+        VERIFY_ARE_EQUAL_UINT(1, rootCount);
+    }
+
+    DEFINE_TEST_CASE(TestContextFollowsContinuations)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestContextFollowsContinuations);
+        auto exporter = std::make_shared<chrome_trace_exporter>();
+        span_tracer::get_span_tracer_singleton()->set_exporter(exporter);
+
+        auto root = std::make_shared<trace_span>("SpanTracerTests::chain");
+        trace_context rootContext = root->context();
+        bool isContextLeaked = false;
+        {
+            trace_context_scope scope(rootContext);
+            auto traceContext = span_tracer::current_context();
+            pplx::create_task([&isContextLeaked, traceContext]()
+            {
+                // A new thread starts with no trace until the captured one is put back
+                isContextLeaked = span_tracer::current_context().is_valid();
+                trace_context_scope traceScope(traceContext);
+                trace_span step("SpanTracerTests::step1");
+                return step.context();
+            })
+            .then([root](trace_context stepContext)
+            {
+                trace_context_scope traceScope(stepContext);
+                trace_span step("SpanTracerTests::step2");
+                root->end();
+            }).wait();
+        }
+        VERIFY_IS_FALSE(isContextLeaked);
+        VERIFY_IS_FALSE(span_tracer::current_context().is_valid());
+        span_tracer::get_span_tracer_singleton()->set_exporter(nullptr);
+
+        auto spans = exporter->spans();
+        VERIFY_ARE_EQUAL_UINT(3, spans.size());
+        std::map<std::string, trace_span_record> spansByName;
+        for (const auto& span : spans)
+        {
+            VERIFY_IS_TRUE(span.traceId == rootContext.traceId);
+            spansByName[span.name] = span;
+        }
+        VERIFY_IS_TRUE(spansByName["SpanTracerTests::step1"].parentSpanId == rootContext.spanId);
+        VERIFY_IS_TRUE(spansByName["SpanTracerTests::step2"].parentSpanId == spansByName["SpanTracerTests::step1"].spanId);
+
+        // The three spans nest under one async track in the Chrome trace
+        auto json = web::json::value::parse(utility::conversions::to_string_t(exporter->to_json()));
+        auto events = json[L"traceEvents"].as_array();
+        VERIFY_ARE_EQUAL_UINT(6, events.size());
+        VERIFY_ARE_EQUAL_STR(L"b", events[0][L"ph"].as_string());
+        VERIFY_ARE_EQUAL_STR(L"SpanTracerTests::chain", events[0][L"name"].as_string());
+        for (const auto& evt : events)
+        {
+            VERIFY_ARE_EQUAL_STR(events[0][L"id"].as_string(), evt[L"id"].as_string());
+        }
+    }
+
+    DEFINE_TEST_CASE(TestSpanOverhead)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestSpanOverhead);
+        const uint32_t spanCount = 100000;
+        span_tracer::get_span_tracer_singleton()->set_exporter(nullptr);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < spanCount; ++i)
+        {
+            trace_span span("SpanTracerTests::disabled");
+        }
+        auto disabledNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count() / spanCount;
+
+        auto exporter = std::make_shared<counting_trace_exporter>();
+        span_tracer::get_span_tracer_singleton()->set_exporter(exporter);
+        start = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < spanCount; ++i)
+        {
+            trace_span span("SpanTracerTests::enabled");
+            trace_context_scope scope(span.context());
+        }
+        auto enabledNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count() / spanCount;
+        span_tracer::get_span_tracer_singleton()->set_exporter(nullptr);
+
+        TEST_LOG(FormatString(L"Per span: %d ns traced, %d ns with tracing off", static_cast<int>(enabledNs), static_cast<int>(disabledNs)).c_str());
+        VERIFY_ARE_EQUAL_UINT(spanCount, exporter->count());
+
+        // Loose bounds that only catch a regression by an order of magnitude, e.g. a lock on the disabled path
+        VERIFY_IS_TRUE(disabledNs < 200);
+        VERIFY_IS_TRUE(enabledNs < 20000);
+    }
+};
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_END
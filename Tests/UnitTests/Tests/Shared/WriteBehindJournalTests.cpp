@@ -0,0 +1,263 @@
+// Copyright (c) Microsoft Corporation
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "pch.h"
+#define TEST_CLASS_OWNER L"jasonsa"
+#define TEST_CLASS_AREA L"WriteBehindJournal"
+#include "UnitTestIncludes.h"
+#include "xsapi/stats_manager.h"
+#include "xbox_live_context_impl.h"
+#include "write_behind_journal.h"
+#include "StatisticManager_WinRT.h"
+#include "StatsManagerHelper.h"
+#include <random>
+
+using namespace Microsoft::Xbox::Services::Statistics::Manager;
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_BEGIN
+
+DEFINE_TEST_CLASS(WriteBehindJournalTests)
+{
+public:
+    DEFINE_TEST_CLASS_PROPS(WriteBehindJournalTests)
+
+    static string_t JournalDirectory()
+    {
+        wchar_t tempPath[MAX_PATH];
+        VERIFY_IS_TRUE(GetTempPathW(MAX_PATH, tempPath) > 0);
+        return tempPath;
+    }
+
+    static string_t JournalFilePath()
+    {
+        return JournalDirectory() + write_behind_journal::JOURNAL_FILE_NAME;
+    }
+
+    static std::string ReadJournalFile()
+    {
+        std::ifstream in(JournalFilePath(), std::ios::in | std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    static void WriteJournalFile(_In_ const std::string& contents)
+    {
+        std::ofstream out(JournalFilePath(), std::ios::out | std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), contents.size());
+    }
+
+    std::shared_ptr<write_behind_journal> OpenEmptyJournal()
+    {
+        DeleteFileW(JournalFilePath().c_str());
+        auto journal = write_behind_journal::get_write_behind_journal_singleton();
+        VERIFY_IS_TRUE(!xbox_live_services_settings::get_singleton_instance()->enable_write_journal(JournalDirectory()).err());
+        return journal;
+    }
+
+    // Leaves the file exactly as it was at the last commit plus tornTail, as if the process was killed
+    // partway through writing the next batch, and then opens it again like the next launch would
+    static void CrashAndRestart(
+        _In_ const std::shared_ptr<write_behind_journal>& journal,
+        _In_ const std::string& tornTail = std::string()
+        )
+    {
+        std::string committed = ReadJournalFile();
+        journal->close();
+        WriteJournalFile(committed + tornTail);
+        VERIFY_IS_TRUE(!journal->open(JournalDirectory()).err());
+    }
+
+    void SetMockResult(_In_ int statusCode)
+    {
+        m_mockXboxSystemFactory->GetMockHttpCall()->ResultValue = StockMocks::CreateMockHttpCallResponse(web::json::value::parse(L"{}"), statusCode);
+    }
+
+    DEFINE_TEST_CASE(TestPendingWritesReplayedOnAddLocalUser)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestPendingWritesReplayedOnAddLocalUser);
+        auto xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto xboxLiveContextImpl = std::make_shared<xbox_live_context_impl>(xboxLiveContext->User);
+        xboxLiveContextImpl->init();
+        auto journal = OpenEmptyJournal();
+
+        // The service is down, so both writes stay pending
+        SetMockResult(503);
+        string_t xboxUserId = xboxLiveContextImpl->xbox_live_user_id();
+        VERIFY_IS_TRUE(xboxLiveContextImpl->achievement_service().update_achievement(xboxUserId, L"1", 50).get().err());
+        VERIFY_IS_TRUE(xboxLiveContextImpl->reputation_service().submit_reputation_feedback(
+            L"2814613569642996",
+            social::reputation_feedback_type::fair_play_quitter,
+            L"sessionName",
+            L"reasonMessage",
+            L"evidenceResourceId"
+            ).get().err());
+        VERIFY_ARE_EQUAL_UINT(2, journal->pending_write_count());
+
+        journal->commit();
+        CrashAndRestart(journal);
+        VERIFY_ARE_EQUAL_UINT(2, journal->pending_write_count());
+        VERIFY_IS_TRUE(journal->has_pending_writes(xboxUserId));
+
+        // The service is back; adding the user sends both writes again before reading the stats document
+        std::vector<string_t> replayedBodies;
+        auto acknowledge = std::make_shared<HttpResponseStruct>();
+        acknowledge->responseList = { StockMocks::CreateMockHttpCallResponse(web::json::value::parse(L"{}"), 200) };
+        acknowledge->fRequestPostFunc = [&replayedBodies](std::shared_ptr<http_call_response>&, const string_t& requestBody)
+        {
+            replayedBodies.push_back(requestBody);
+        };
+        auto svdResponse = std::make_shared<HttpResponseStruct>();
+        svdResponse->responseList = { StockMocks::CreateMockHttpCallResponse(web::json::value::parse(statValueDocumentResponse), 200) };
+
+        std::unordered_map<string_t, std::shared_ptr<HttpResponseStruct>> responses;
+        responses[_T("https://achievements.mockenv.xboxlive.com")] = acknowledge;
+        responses[_T("https://reputation.mockenv.xboxlive.com")] = acknowledge;
+        responses[_T("https://statsread.mockenv.xboxlive.com")] = svdResponse;
+        m_mockXboxSystemFactory->add_http_state_response(responses);
+
+        auto statsManager = StatisticManager::SingletonInstance;
+        auto user = xboxLiveContext->User;
+        statsManager->AddLocalUser(user);
+        bool isDone = false;
+        while (!isDone)
+        {
+            for (auto evt : statsManager->DoWork())
+            {
+                isDone = isDone || evt->EventType == StatisticEventType::LocalUserAdded;
+            }
+        }
+
+        VERIFY_ARE_EQUAL_UINT(2, replayedBodies.size());
+        VERIFY_IS_TRUE(std::any_of(replayedBodies.begin(), replayedBodies.end(), [](const string_t& body)
+        {
+            return web::json::value::parse(body).has_field(L"achievements");
+        }));
+        VERIFY_ARE_EQUAL_UINT(0, journal->pending_write_count());
+
+        // With everything acknowledged the file starts over
+        journal->commit();
+        VERIFY_ARE_EQUAL_UINT(0, ReadJournalFile().size());
+
+        statsManager->RemoveLocalUser(user);
+        isDone = false;
+        while (!isDone)
+        {
+            for (auto evt : statsManager->DoWork())
+            {
+                isDone = isDone || evt->EventType == StatisticEventType::LocalUserRemoved;
+            }
+        }
+    }
+
+    DEFINE_TEST_CASE(TestPendingWritesReplayedOnContextInit)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestPendingWritesReplayedOnContextInit);
+        auto xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto xboxLiveContextImpl = std::make_shared<xbox_live_context_impl>(xboxLiveContext->User);
+        xboxLiveContextImpl->init();
+        auto journal = OpenEmptyJournal();
+
+        SetMockResult(503);
+        string_t xboxUserId = xboxLiveContextImpl->xbox_live_user_id();
+        VERIFY_IS_TRUE(xboxLiveContextImpl->achievement_service().update_achievement(xboxUserId, L"1", 50).get().err());
+        VERIFY_ARE_EQUAL_UINT(1, journal->pending_write_count());
+        journal->commit();
+        CrashAndRestart(journal);
+
+        // The key the write was journaled under goes out with the replay
+        auto replayedKeys = std::make_shared<std::vector<string_t>>();
+        auto acknowledge = std::make_shared<HttpResponseStruct>();
+        acknowledge->responseList = { StockMocks::CreateMockHttpCallResponse(web::json::value::parse(L"{}"), 200) };
+        acknowledge->fRequestPostFunc = [replayedKeys](std::shared_ptr<http_call_response>& response, const string_t&)
+        {
+            auto key = response->response_headers().find(write_behind_journal::IDEMPOTENCY_KEY_HEADER);
+            replayedKeys->push_back(key == response->response_headers().end() ? string_t() : key->second);
+        };
+        std::unordered_map<string_t, std::shared_ptr<HttpResponseStruct>> responses;
+        responses[_T("https://achievements.mockenv.xboxlive.com")] = acknowledge;
+        m_mockXboxSystemFactory->add_http_state_response(responses);
+
+        // A title that never touches stats manager still gets its writes sent, just by creating a context
+        auto replayingContextImpl = std::make_shared<xbox_live_context_impl>(xboxLiveContext->User);
+        replayingContextImpl->init();
+        for (uint32_t i = 0; i < 500 && journal->pending_write_count() > 0; ++i)
+        {
+            Sleep(10);
+        }
+
+        VERIFY_ARE_EQUAL_UINT(0, journal->pending_write_count());
+        VERIFY_ARE_EQUAL_UINT(1, replayedKeys->size());
+        VERIFY_IS_FALSE((*replayedKeys)[0].empty());
+    }
+
+    DEFINE_TEST_CASE(TestGroupCommitFlushesOncePerWindow)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestGroupCommitFlushesOncePerWindow);
+        auto xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto xboxLiveContextImpl = std::make_shared<xbox_live_context_impl>(xboxLiveContext->User);
+        xboxLiveContextImpl->init();
+        auto journal = OpenEmptyJournal();
+        SetMockResult(503);
+
+        const uint32_t writeCount = 20;
+        for (uint32_t i = 0; i < writeCount; ++i)
+        {
+            xboxLiveContextImpl->achievement_service().update_achievement(xboxLiveContextImpl->xbox_live_user_id(), L"1", i).wait();
+        }
+
+        Sleep(static_cast<DWORD>(write_behind_journal::GROUP_COMMIT_WINDOW.count() * 4));
+        TEST_LOG(FormatString(L"%d writes, %d commits", writeCount, static_cast<int>(journal->commit_count())).c_str());
+        VERIFY_IS_TRUE(journal->commit_count() <= 2);
+        VERIFY_ARE_EQUAL_UINT(writeCount, journal->pending_write_count());
+
+        // Nothing left to write, so an explicit commit doesn't flush again
+        auto commitCount = journal->commit_count();
+        journal->commit();
+        VERIFY_ARE_EQUAL_UINT(commitCount, journal->commit_count());
+    }
+
+    DEFINE_TEST_CASE(TestTornWritesSurviveRepeatedCrashes)
+    {
+        DEFINE_TEST_CASE_PROPERTIES(TestTornWritesSurviveRepeatedCrashes);
+        auto xboxLiveContext = GetMockXboxLiveContext_WinRT();
+        auto xboxLiveContextImpl = std::make_shared<xbox_live_context_impl>(xboxLiveContext->User);
+        xboxLiveContextImpl->init();
+        auto journal = OpenEmptyJournal();
+
+        std::mt19937 random(1234);
+        size_t expectedPending = 0;
+        for (uint32_t crash = 0; crash < 50; ++crash)
+        {
+            SetMockResult(503);
+            uint32_t writeCount = random() % 5 + 1;
+            for (uint32_t i = 0; i < writeCount; ++i)
+            {
+                xboxLiveContextImpl->achievement_service().update_achievement(xboxLiveContextImpl->xbox_live_user_id(), L"1", crash % 100).wait();
+            }
+            expectedPending += writeCount;
+            journal->commit();
+
+            // Every few launches the service is reachable and everything pending is acknowledged
+            if (crash % 10 == 9)
+            {
+                SetMockResult(200);
+                journal->replay(xboxLiveContextImpl->user_context(), xboxLiveContextImpl->settings()).wait();
+                expectedPending = 0;
+                journal->commit();
+                VERIFY_ARE_EQUAL_UINT(0, ReadJournalFile().size());
+            }
+
+            // Killed partway through writing the next batch: only a prefix of its first line reached the disk
+            std::string nextLine = ReadJournalFile();
+            if (nextLine.empty())
+            {
+                nextLine = "{\"op\":\"ack\",\"key\":\"00000000-0000-0000-0000-000000000000\"}\n";
+            }
+            nextLine = nextLine.substr(0, nextLine.find('\n'));
+            CrashAndRestart(journal, nextLine.substr(0, random() % nextLine.size()));
+
+            VERIFY_ARE_EQUAL_UINT(expectedPending, journal->pending_write_count());
+        }
+    }
+};
+
+NAMESPACE_MICROSOFT_XBOX_SERVICES_SYSTEM_CPP_END